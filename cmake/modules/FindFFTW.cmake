@@ -0,0 +1,44 @@
+# - Find FFTW
+#==============================================================================
+# Find the native FFTW3 includes and libraries (double and single precision).
+#
+#  FFTW_INC_DIR          - Hint for the location of fftw3.h.
+#  FFTW_LIB_DIR          - Hint for the location of the FFTW libraries.
+#  FFTW_INCLUDE_DIR      - Where to find fftw3.h.
+#  FFTW_LIBRARIES        - List of libraries when using FFTW.
+#  FFTW_THREADS_FOUND    - True if the FFTW threads libraries were found
+#                          (either the POSIX threads or the OpenMP versions).
+#  FFTW_FOUND            - True if FFTW found.
+#==============================================================================
+
+find_path(FFTW_INCLUDE_DIR fftw3.h HINTS ${FFTW_INC_DIR})
+find_library(FFTW_LIBRARY_DOUBLE NAMES fftw3 HINTS ${FFTW_LIB_DIR})
+find_library(FFTW_LIBRARY_SINGLE NAMES fftw3f HINTS ${FFTW_LIB_DIR})
+find_library(FFTW_THREADS_LIBRARY_DOUBLE NAMES fftw3_threads fftw3_omp
+    HINTS ${FFTW_LIB_DIR})
+find_library(FFTW_THREADS_LIBRARY_SINGLE NAMES fftw3f_threads fftw3f_omp
+    HINTS ${FFTW_LIB_DIR})
+mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARY_DOUBLE FFTW_LIBRARY_SINGLE
+    FFTW_THREADS_LIBRARY_DOUBLE FFTW_THREADS_LIBRARY_SINGLE)
+
+# The threads libraries must be listed before the serial ones.
+set(FFTW_LIBRARIES)
+if (FFTW_THREADS_LIBRARY_DOUBLE AND FFTW_THREADS_LIBRARY_SINGLE)
+    set(FFTW_THREADS_FOUND TRUE)
+    list(APPEND FFTW_LIBRARIES
+        ${FFTW_THREADS_LIBRARY_DOUBLE} ${FFTW_THREADS_LIBRARY_SINGLE})
+endif()
+if (FFTW_LIBRARY_DOUBLE AND FFTW_LIBRARY_SINGLE)
+    list(APPEND FFTW_LIBRARIES ${FFTW_LIBRARY_DOUBLE} ${FFTW_LIBRARY_SINGLE})
+endif()
+
+# Handle the QUIETLY and REQUIRED arguments and set FFTW_FOUND to TRUE if
+# all listed variables are TRUE.
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(FFTW DEFAULT_MSG
+    FFTW_LIBRARY_DOUBLE FFTW_LIBRARY_SINGLE FFTW_INCLUDE_DIR)
+
+if (NOT FFTW_FOUND)
+    set(FFTW_LIBRARIES)
+    set(FFTW_THREADS_FOUND FALSE)
+endif()
@@ -73,6 +73,11 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
         oskar_beam_pattern_set_num_devices(h, -1);
     else
         oskar_beam_pattern_set_num_devices(h, s->to_int("num_devices", status));
+    if (s->starts_with("num_threads_per_device", "auto", status))
+        oskar_beam_pattern_set_num_threads_per_device(h, -1);
+    else
+        oskar_beam_pattern_set_num_threads_per_device(h,
+                s->to_int("num_threads_per_device", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
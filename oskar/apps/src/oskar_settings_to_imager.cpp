@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, The University of Oxford
+ * Copyright (c) 2017-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -100,20 +100,29 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_weighting(h,
             s->to_string("weighting", status), status);
     if (s->starts_with("algorithm", "FFT", status) ||
-            s->starts_with("algorithm", "fft", status))
+            s->starts_with("algorithm", "fft", status) ||
+            s->starts_with("algorithm", "W-s", status))
     {
         oskar_imager_set_grid_kernel(h,
                 s->to_string("fft/kernel_type", status),
                 s->to_int("fft/support", status),
                 s->to_int("fft/oversample", status), status);
     }
-    if (!s->starts_with("wproj/num_w_planes", "auto", status))
+    if (s->starts_with("algorithm", "W-s", status))
+    {
+        if (!s->starts_with("wstack/num_w_layers", "auto", status))
+            oskar_imager_set_num_w_planes(h,
+                    s->to_int("wstack/num_w_layers", status));
+    }
+    else if (!s->starts_with("wproj/num_w_planes", "auto", status))
         oskar_imager_set_num_w_planes(h,
                 s->to_int("wproj/num_w_planes", status));
     oskar_imager_set_fft_on_gpu(h, s->to_int("fft/use_gpu", status));
     oskar_imager_set_grid_on_gpu(h, s->to_int("fft/grid_on_gpu", status));
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
+    oskar_imager_set_w_kernel_cache_dir(h,
+            s->to_string("wproj/kernel_cache_dir", status));
     if (s->first_letter("direction", status) == 'R')
         oskar_imager_set_direction(h,
                 s->to_double("direction/ra_deg", status),
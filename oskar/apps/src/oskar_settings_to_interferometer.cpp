@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, The University of Oxford
+ * Copyright (c) 2017-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,6 +28,7 @@
 
 #include "apps/oskar_settings_log.h"
 #include "apps/oskar_settings_to_interferometer.h"
+#include "math/oskar_cmath.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -75,6 +76,11 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     else
         oskar_interferometer_set_num_devices(h,
                 s->to_int("num_devices", status));
+    if (s->starts_with("num_threads_per_device", "auto", status))
+        oskar_interferometer_set_num_threads_per_device(h, -1);
+    else
+        oskar_interferometer_set_num_threads_per_device(h,
+                s->to_int("num_threads_per_device", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
@@ -110,6 +116,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_string("correlation_type", status), status);
     oskar_interferometer_set_max_times_per_block(h,
             s->to_int("max_time_samples_per_block", status));
+    oskar_interferometer_set_num_vis_buffers(h,
+            s->to_int("num_vis_buffers", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
     oskar_interferometer_set_output_measurement_set(h,
@@ -118,6 +126,23 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("force_polarised_ms", status));
     oskar_interferometer_set_ignore_w_components(h,
             s->to_int("ignore_w_components", status));
+    oskar_interferometer_set_fused_correlation(h,
+            s->to_int("fused_correlation", status));
+    oskar_interferometer_set_station_beam_interp_tolerance(h,
+            s->to_double("station_beam_interp_tolerance", status));
+    s->end_group();
+
+    // Set ionosphere settings.
+    s->begin_group("ionosphere");
+    if (s->to_int("enable", status))
+    {
+        int num_files = 0;
+        const char* const* files = s->to_string_list("TID_file",
+                &num_files, status);
+        oskar_interferometer_set_ionosphere(h, 1,
+                s->to_double("min_elevation_deg", status) * M_PI / 180.0,
+                s->to_double("TEC0", status), num_files, files, status);
+    }
     s->end_group();
 
     // Return handle to interferometer simulator.
@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <vector>
 
 using oskar::SettingsTree;
 
@@ -44,7 +45,7 @@ using oskar::SettingsTree;
 
 /* Private functions. */
 static void set_station_data(oskar_Station* station, SettingsTree* s,
-        int* status);
+        std::vector<const oskar_Element*>& tabulated, int* status);
 
 oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
         oskar_Log* log, int* status)
@@ -148,8 +149,9 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
             break;
         }
     }
+    std::vector<const oskar_Element*> tabulated;
     for (int i = 0; i < num_stations; ++i)
-        set_station_data(oskar_telescope_station(t, i), s, status);
+        set_station_data(oskar_telescope_station(t, i), s, tabulated, status);
 
     /* Apply element level overrides. */
     s->clear_group();
@@ -273,6 +275,8 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
                 oskar_telescope_set_tec_screen_path(t, screen_path);
                 oskar_telescope_set_tec_screen_height(t,
                         s->to_double("screen_height_km", status));
+                oskar_telescope_set_tec_screen_max_buffer(t,
+                        s->to_double("max_buffer_size_mb", status));
                 const double pixel_size =
                         s->to_double("screen_pixel_size_m", status);
                 /*const double time_interval =
@@ -308,7 +312,8 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
 }
 
 
-void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
+void set_station_data(oskar_Station* station, SettingsTree* s,
+        std::vector<const oskar_Element*>& tabulated, int* status)
 {
     if (*status || !station) return;
     s->clear_group();
@@ -319,6 +324,8 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
             s->to_int("enable", status));
     oskar_station_set_normalise_array_pattern(station,
             s->to_int("normalise", status));
+    oskar_station_set_array_pattern_nufft_accuracy(station,
+            s->to_double("nufft_accuracy", status));
     oskar_station_set_seed_time_variable_errors(station,
             (unsigned int) s->to_int(
                     "element/seed_time_variable_errors", status));
@@ -335,6 +342,8 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
     char taper_type = s->first_letter("taper/type", status);
     double cosine_power = s->to_double("taper/cosine_power", status);
     double fwhm_rad = s->to_double("taper/gaussian_fwhm_deg", status) * D2R;
+    double lut_cellsize_rad = s->to_int("lookup_table/enable", status) ?
+            s->to_double("lookup_table/cellsize_deg", status) * D2R : 0.0;
     for (int i = 0; i < oskar_station_num_element_types(station); ++i)
     {
         oskar_Element* element = oskar_station_element(station, i);
@@ -343,6 +352,19 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
         oskar_element_set_taper_type(element, &taper_type, status);
         oskar_element_set_cosine_power(element, cosine_power);
         oskar_element_set_gaussian_fwhm_rad(element, fwhm_rad);
+        if (lut_cellsize_rad <= 0.0) continue;
+
+        /* Tabulate each distinct set of element data only once. */
+        bool shared = false;
+        for (size_t j = 0; j < tabulated.size() && !shared; ++j)
+            shared = oskar_element_share_lookup_tables(element,
+                    tabulated[j], status);
+        if (!shared)
+        {
+            oskar_element_create_lookup_tables(element,
+                    lut_cellsize_rad, status);
+            tabulated.push_back(element);
+        }
     }
 
     /* Recursively set data for child stations. */
@@ -350,6 +372,7 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
     {
         int num_elements = oskar_station_num_elements(station);
         for (int i = 0; i < num_elements; ++i)
-            set_station_data(oskar_station_child(station, i), s, status);
+            set_station_data(oskar_station_child(station, i), s,
+                    tabulated, status);
     }
 }
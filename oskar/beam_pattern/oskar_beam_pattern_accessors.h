@@ -47,6 +47,9 @@ oskar_Log* oskar_beam_pattern_log(oskar_BeamPattern* h);
 OSKAR_EXPORT
 int oskar_beam_pattern_num_gpus(const oskar_BeamPattern* h);
 
+OSKAR_EXPORT
+int oskar_beam_pattern_num_threads_per_device(const oskar_BeamPattern* h);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_auto_power_fits(oskar_BeamPattern* h, int flag);
 
@@ -129,6 +132,10 @@ void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value);
 OSKAR_EXPORT
 void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_num_threads_per_device(oskar_BeamPattern* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels);
@@ -88,6 +88,7 @@ struct oskar_BeamPattern
 {
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
+    int num_threads_per_device;
     int coord_type, max_chunk_size;
     int num_time_steps, num_channels, num_chunks;
     int pol_mode, width, height, num_pixels, nside;
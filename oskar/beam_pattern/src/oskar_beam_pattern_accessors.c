@@ -55,6 +55,17 @@ int oskar_beam_pattern_num_gpus(const oskar_BeamPattern* h)
 }
 
 
+int oskar_beam_pattern_num_threads_per_device(const oskar_BeamPattern* h)
+{
+    int value;
+    if (!h) return 1;
+    value = h->num_threads_per_device;
+    if (value < 1 && h->num_devices > 0)
+        value = oskar_get_num_procs() / h->num_devices;
+    return value < 1 ? 1 : value;
+}
+
+
 void oskar_beam_pattern_set_auto_power_fits(oskar_BeamPattern* h, int flag)
 {
     h->auto_power_fits = flag;
@@ -262,6 +273,13 @@ void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value)
 }
 
 
+void oskar_beam_pattern_set_num_threads_per_device(oskar_BeamPattern* h,
+        int value)
+{
+    h->num_threads_per_device = value;
+}
+
+
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels)
 {
@@ -636,6 +636,10 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                     oskar_telescope_tec_screen_height_km(d->tel),
                     oskar_telescope_tec_screen_pixel_size_m(d->tel),
                     oskar_telescope_tec_screen_time_interval_sec(d->tel));
+            oskar_station_work_set_tec_screen_max_buffer(d->work, (size_t)
+                    (oskar_telescope_tec_screen_max_buffer_mb(d->tel) *
+                    1024.0 * 1024.0));
+            oskar_station_work_set_time_range(d->work, 0, h->num_time_steps);
             if (oskar_telescope_ionosphere_screen_type(d->tel) == 'E')
                 oskar_station_work_set_tec_screen_path(d->work,
                         oskar_telescope_tec_screen_path(d->tel));
@@ -199,9 +199,10 @@ static void* run_blocks(void* arg)
     const int device_id = thread_id - 1;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism, and give each compute device its own
+     * team of threads for the CPU kernels. */
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    omp_set_num_threads(oskar_beam_pattern_num_threads_per_device(h));
 #endif
 
     if (device_id >= 0 && device_id < h->num_gpus)
@@ -309,20 +310,37 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         oskar_mem_copy_contents(d->z, h->z, 0, offset, chunk_size, status);
     }
 
-    /* Generate beam for this pixel chunk, for all active stations. */
+    /* Generate beam for this pixel chunk, for all active stations.
+     * If station beam duplication is allowed, copy the beam from an
+     * earlier active station if it is identical. */
+    const int duplicate = oskar_telescope_allow_station_beam_duplication(
+            d->tel);
     for (i = 0; i < h->num_active_stations; ++i)
     {
+        int j = i;
         const oskar_Station* station =
                 oskar_telescope_station_const(d->tel, h->station_ids[i]);
         if (!station)
             station = oskar_telescope_station_const(d->tel, 0);
         const int offset = i * chunk_size;
-        oskar_evaluate_station_beam(chunk_size,
-                h->coord_type, d->x, d->y, d->z,
-                oskar_telescope_phase_centre_ra_rad(d->tel),
-                oskar_telescope_phase_centre_dec_rad(d->tel),
-                station,
-                d->work, i_time, freq_hz, gast, offset, d->jones_data, status);
+        if (duplicate)
+        {
+            const int equivalent = oskar_telescope_station_equivalent(
+                    d->tel, h->station_ids[i]);
+            for (j = 0; j < i; ++j)
+                if (oskar_telescope_station_equivalent(
+                        d->tel, h->station_ids[j]) == equivalent) break;
+        }
+        if (j < i)
+            oskar_mem_copy_contents(d->jones_data, d->jones_data,
+                    offset, j * chunk_size, chunk_size, status);
+        else
+            oskar_evaluate_station_beam(chunk_size,
+                    h->coord_type, d->x, d->y, d->z,
+                    oskar_telescope_phase_centre_ra_rad(d->tel),
+                    oskar_telescope_phase_centre_dec_rad(d->tel),
+                    station, d->work, i_time, freq_hz, gast,
+                    offset, d->jones_data, status);
         if (d->auto_power[0])
             oskar_evaluate_auto_power(chunk_size,
                     offset, d->jones_data, 1.0, 0.0, 0.0, 0.0,
@@ -6,7 +6,7 @@
         const FP delta_phi1, const FP delta_phi2,\
         GLOBAL_OUT(FP, theta), GLOBAL_OUT(FP, phi1), GLOBAL_OUT(FP, phi2))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     FP p1, p2, r;\
     const FP twopi = 2 * ((FP) M_PI);\
     const FP xx = x[i + off_in], yy = y[i + off_in], zz = z[i + off_in];\
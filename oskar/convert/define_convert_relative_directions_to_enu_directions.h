@@ -8,7 +8,7 @@
         const int offset_out, GLOBAL_OUT(FP, x), GLOBAL_OUT(FP, y),\
         GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     const int i_in = i + offset_in, i_out = i + offset_out;\
     FP l_, m_, n_, t;\
     if (at_origin) {\
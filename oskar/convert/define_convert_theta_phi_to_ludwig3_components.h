@@ -8,13 +8,13 @@
         const int offset,\
         GLOBAL FP4c *jones)\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     FP sin_p_x, cos_p_x, sin_p_y, cos_p_y;\
     FP2 x_theta_, x_phi_, y_theta_, y_phi_;\
     const FP p_x = phi_x[i];\
     const FP p_y = phi_y[i];\
-    SINCOS(p_x, sin_p_x, cos_p_x);\
-    SINCOS(p_y, sin_p_y, cos_p_y);\
+    VSINCOS(FP, p_x, sin_p_x, cos_p_x);\
+    VSINCOS(FP, p_y, sin_p_y, cos_p_y);\
     const int j = i + offset;\
     if (swap_xy) {\
         x_theta_ = jones[j].c, x_phi_ = jones[j].d;\
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "convert/oskar_convert_apparent_ha_dec_to_enu_directions.h"
+#include "math/oskar_vmath.h"
 #include <math.h>
 
 #ifdef __cplusplus
@@ -55,10 +56,8 @@ void oskar_convert_apparent_ha_dec_to_enu_directions_f(int n,
         sd = dec[i];
 
         /* Find direction cosines. */
-        sinHA = sinf(sh);
-        sinDec = sinf(sd);
-        cosHA = cosf(sh);
-        cosDec = cosf(sd);
+        oskar_vsincos_f(sh, &sinHA, &cosHA);
+        oskar_vsincos_f(sd, &sinDec, &cosDec);
         t = cosDec * cosHA;
         X1 = cosLat * sinDec - sinLat * t;
         Y2 = sinLat * sinDec + cosLat * t;
@@ -93,10 +92,8 @@ void oskar_convert_apparent_ha_dec_to_enu_directions_d(int n,
         sd = dec[i];
 
         /* Find direction cosines. */
-        sinHA = sin(sh);
-        sinDec = sin(sd);
-        cosHA = cos(sh);
-        cosDec = cos(sd);
+        oskar_vsincos_d(sh, &sinHA, &cosHA);
+        oskar_vsincos_d(sd, &sinDec, &cosDec);
         t = cosDec * cosHA;
         X1 = cosLat * sinDec - sinLat * t;
         Y2 = sinLat * sinDec + cosLat * t;
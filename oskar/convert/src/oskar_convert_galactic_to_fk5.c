@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,6 +28,7 @@
 
 #include "convert/oskar_convert_galactic_to_fk5.h"
 #include "math/oskar_cmath.h"
+#include "math/oskar_vmath.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,13 +49,14 @@ void oskar_convert_galactic_to_fk5_f(int num_points, const float* l,
     {
         double p[3];  /* Input */
         double p1[3]; /* Output */
-        double t;
+        double t, sin_l, cos_l, sin_b, cos_b;
 
         /* Convert Galactic coordinates to Cartesian vector. */
-        t = cos(b[j]);
-        p[0] = cos(l[j]) * t;
-        p[1] = sin(l[j]) * t;
-        p[2] = sin(b[j]);
+        oskar_vsincos_d(l[j], &sin_l, &cos_l);
+        oskar_vsincos_d(b[j], &sin_b, &cos_b);
+        p[0] = cos_l * cos_b;
+        p[1] = sin_l * cos_b;
+        p[2] = sin_b;
 
         /* Rotate to equatorial frame. */
         for (i = 0; i < 3; i++)
@@ -83,13 +85,14 @@ void oskar_convert_galactic_to_fk5_d(int num_points, const double* l,
     {
         double p[3];  /* Input */
         double p1[3]; /* Output */
-        double t;
+        double t, sin_l, cos_l, sin_b, cos_b;
 
         /* Convert Galactic coordinates to Cartesian vector. */
-        t = cos(b[j]);
-        p[0] = cos(l[j]) * t;
-        p[1] = sin(l[j]) * t;
-        p[2] = sin(b[j]);
+        oskar_vsincos_d(l[j], &sin_l, &cos_l);
+        oskar_vsincos_d(b[j], &sin_b, &cos_b);
+        p[0] = cos_l * cos_b;
+        p[1] = sin_l * cos_b;
+        p[2] = sin_b;
 
         /* Rotate to equatorial frame. */
         for (i = 0; i < 3; i++)
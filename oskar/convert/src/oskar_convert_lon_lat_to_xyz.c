@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,7 +27,7 @@
  */
 
 #include "convert/oskar_convert_lon_lat_to_xyz.h"
-#include <math.h>
+#include "math/oskar_vmath.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,10 +40,8 @@ void oskar_convert_lon_lat_to_xyz_f(int num_points, const float* lon_rad,
     float cos_lon, sin_lon, cos_lat, sin_lat;
     for (i = 0; i < num_points; ++i)
     {
-        cos_lon = cosf(lon_rad[i]);
-        sin_lon = sinf(lon_rad[i]);
-        cos_lat = cosf(lat_rad[i]);
-        sin_lat = sinf(lat_rad[i]);
+        oskar_vsincos_f(lon_rad[i], &sin_lon, &cos_lon);
+        oskar_vsincos_f(lat_rad[i], &sin_lat, &cos_lat);
 
         x[i] = cos_lat * cos_lon;
         y[i] = cos_lat * sin_lon;
@@ -58,10 +56,8 @@ void oskar_convert_lon_lat_to_xyz_d(int num_points, const double* lon_rad,
     double cos_lon, sin_lon, cos_lat, sin_lat;
     for (i = 0; i < num_points; ++i)
     {
-        cos_lon = cos(lon_rad[i]);
-        sin_lon = sin(lon_rad[i]);
-        cos_lat = cos(lat_rad[i]);
-        sin_lat = sin(lat_rad[i]);
+        oskar_vsincos_d(lon_rad[i], &sin_lon, &cos_lon);
+        oskar_vsincos_d(lat_rad[i], &sin_lat, &cos_lat);
 
         x[i] = cos_lat * cos_lon;
         y[i] = cos_lat * sin_lon;
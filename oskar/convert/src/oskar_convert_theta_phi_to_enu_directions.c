@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,7 +27,7 @@
  */
 
 #include "convert/oskar_convert_theta_phi_to_enu_directions.h"
-#include <math.h>
+#include "math/oskar_vmath.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -99,13 +99,14 @@ void oskar_convert_theta_phi_to_enu_directions_d(unsigned int num,
         double* z)
 {
     unsigned int i;
-    double sin_theta;
+    double sin_theta, cos_theta, sin_phi, cos_phi;
     for (i = 0; i < num; ++i)
     {
-        sin_theta = sin(theta[i]);
-        x[i] = sin_theta * cos(phi[i]);
-        y[i] = sin_theta * sin(phi[i]);
-        z[i] = cos(theta[i]);
+        oskar_vsincos_d(theta[i], &sin_theta, &cos_theta);
+        oskar_vsincos_d(phi[i], &sin_phi, &cos_phi);
+        x[i] = sin_theta * cos_phi;
+        y[i] = sin_theta * sin_phi;
+        z[i] = cos_theta;
     }
 }
 
@@ -114,13 +115,14 @@ void oskar_convert_theta_phi_to_enu_directions_f(unsigned int num,
         float* z)
 {
     unsigned int i;
-    float sin_theta;
+    float sin_theta, cos_theta, sin_phi, cos_phi;
     for (i = 0; i < num; ++i)
     {
-        sin_theta = sinf(theta[i]);
-        x[i] = sin_theta * cosf(phi[i]);
-        y[i] = sin_theta * sinf(phi[i]);
-        z[i] = cosf(theta[i]);
+        oskar_vsincos_f(theta[i], &sin_theta, &cos_theta);
+        oskar_vsincos_f(phi[i], &sin_phi, &cos_phi);
+        x[i] = sin_theta * cos_phi;
+        y[i] = sin_theta * sin_phi;
+        z[i] = cos_theta;
     }
 }
 
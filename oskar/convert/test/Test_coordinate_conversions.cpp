@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 #include "convert/oskar_convert_lon_lat_to_relative_directions.h"
 #include "convert/oskar_convert_lon_lat_to_xyz.h"
 #include "convert/oskar_convert_relative_directions_to_lon_lat.h"
+#include "convert/oskar_convert_theta_phi_to_enu_directions.h"
 #include "convert/oskar_convert_xyz_to_lon_lat.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_evaluate_image_lm_grid.h"
@@ -73,6 +74,53 @@ TEST(coordinate_conversions, lon_lat_to_xyz)
     free(lat_out);
 }
 
+TEST(coordinate_conversions, theta_phi_to_enu_directions)
+{
+    const unsigned int num_pts = 1000;
+    double *x, *y, *z, *theta, *phi;
+    float *x_f, *y_f, *z_f, *theta_f, *phi_f;
+    x = (double*)malloc(num_pts * sizeof(double));
+    y = (double*)malloc(num_pts * sizeof(double));
+    z = (double*)malloc(num_pts * sizeof(double));
+    theta = (double*)malloc(num_pts * sizeof(double));
+    phi = (double*)malloc(num_pts * sizeof(double));
+    x_f = (float*)malloc(num_pts * sizeof(float));
+    y_f = (float*)malloc(num_pts * sizeof(float));
+    z_f = (float*)malloc(num_pts * sizeof(float));
+    theta_f = (float*)malloc(num_pts * sizeof(float));
+    phi_f = (float*)malloc(num_pts * sizeof(float));
+    for (unsigned int i = 0; i < num_pts; ++i)
+    {
+        theta[i] = M_PI * i / num_pts;
+        phi[i] = 2.0 * M_PI * ((i * 37) % num_pts) / num_pts - M_PI;
+        theta_f[i] = (float) theta[i];
+        phi_f[i] = (float) phi[i];
+    }
+
+    oskar_convert_theta_phi_to_enu_directions_d(num_pts, theta, phi, x, y, z);
+    oskar_convert_theta_phi_to_enu_directions_f(num_pts, theta_f, phi_f,
+            x_f, y_f, z_f);
+    for (unsigned int i = 0; i < num_pts; ++i)
+    {
+        ASSERT_NEAR(sin(theta[i]) * cos(phi[i]), x[i], 1e-15);
+        ASSERT_NEAR(sin(theta[i]) * sin(phi[i]), y[i], 1e-15);
+        ASSERT_NEAR(cos(theta[i]), z[i], 1e-15);
+        ASSERT_NEAR(sin(theta_f[i]) * cos(phi_f[i]), x_f[i], 1e-6);
+        ASSERT_NEAR(sin(theta_f[i]) * sin(phi_f[i]), y_f[i], 1e-6);
+        ASSERT_NEAR(cos(theta_f[i]), z_f[i], 1e-6);
+    }
+    free(x);
+    free(y);
+    free(z);
+    free(theta);
+    free(phi);
+    free(x_f);
+    free(y_f);
+    free(z_f);
+    free(theta_f);
+    free(phi_f);
+}
+
 TEST(coordinate_conversions, ra_dec_to_directions)
 {
     // Image size.
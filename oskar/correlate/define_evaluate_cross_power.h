@@ -1,29 +1,36 @@
 /* Copyright (c) 2014-2020, The University of Oxford. See LICENSE file. */
 
+/* The sum over station pairs (p < q) of p * conj(q) is evaluated as
+ * the sum over p of p * conj(r), where r is the sum of all stations after p.
+ * This gives the same result using one pass through the stations. */
+
 #define OSKAR_CROSS_POWER_MATRIX(NAME, FP, FP2, FP4c) KERNEL(NAME) (\
         const int num_sources, const int num_stations, GLOBAL_IN(FP4c, jones),\
         const FP src_I, const FP src_Q, const FP src_U, const FP src_V,\
         const FP norm, const int offset_out, GLOBAL_OUT(FP4c, out))\
 {\
     KERNEL_LOOP_PAR_X(int, i, 0, num_sources)\
-    FP4c sum, b;\
+    FP4c sum, r, b;\
     OSKAR_CLEAR_COMPLEX_MATRIX(FP, sum)\
+    OSKAR_CLEAR_COMPLEX_MATRIX(FP, r)\
     OSKAR_CONSTRUCT_B(FP, b, src_I, src_Q, src_U, src_V)\
-    for (int SP = 0; SP < num_stations; ++SP) {\
+    for (int SP = num_stations - 1; SP >= 0; --SP) {\
         FP4c p, q;\
-        OSKAR_LOAD_MATRIX(p, jones[SP * num_sources + i])\
+        OSKAR_LOAD_MATRIX(q, jones[SP * num_sources + i])\
+        p = q;\
         OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(FP2, p, b)\
-        for (int SQ = SP + 1; SQ < num_stations; ++SQ) {\
-            OSKAR_LOAD_MATRIX(q, jones[SQ * num_sources + i])\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.a, p.a, q.a)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.a, p.b, q.b)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.b, p.a, q.c)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.b, p.b, q.d)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.c, p.c, q.a)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.c, p.d, q.b)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.d, p.c, q.c)\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.d, p.d, q.d)\
-        }\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.a, p.a, r.a)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.a, p.b, r.b)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.b, p.a, r.c)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.b, p.b, r.d)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.c, p.c, r.a)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.c, p.d, r.b)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.d, p.c, r.c)\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum.d, p.d, r.d)\
+        r.a.x += q.a.x; r.a.y += q.a.y;\
+        r.b.x += q.b.x; r.b.y += q.b.y;\
+        r.c.x += q.c.x; r.c.y += q.c.y;\
+        r.d.x += q.d.x; r.d.y += q.d.y;\
     }\
     sum.a.x *= norm; sum.a.y *= norm;\
     sum.b.x *= norm; sum.b.y *= norm;\
@@ -44,17 +51,13 @@ OSKAR_REGISTER_KERNEL(NAME)
     (void) src_U;\
     (void) src_V;\
     KERNEL_LOOP_PAR_X(int, i, 0, num_sources)\
-    FP2 sum;\
+    FP2 sum, r;\
     MAKE_ZERO2(FP, sum);\
-    for (int SP = 0; SP < num_stations; ++SP) {\
-        FP2 partial_sum;\
-        MAKE_ZERO2(FP, partial_sum);\
+    MAKE_ZERO2(FP, r);\
+    for (int SP = num_stations - 1; SP >= 0; --SP) {\
         const FP2 p = jones[SP * num_sources + i];\
-        for (int SQ = SP + 1; SQ < num_stations; ++SQ) {\
-            const FP2 q = jones[SQ * num_sources + i];\
-            OSKAR_MUL_ADD_COMPLEX_CONJUGATE(partial_sum, p, q)\
-        }\
-        sum.x += partial_sum.x; sum.y += partial_sum.y;\
+        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum, p, r)\
+        r.x += p.x; r.y += p.y;\
     }\
     sum.x *= norm; sum.y *= norm;\
     out[i + offset_out] = sum;\
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -65,6 +65,9 @@ extern "C" {
  * @param[in]  frequency_hz Current observation frequency, in Hz.
  * @param[in]  offset_out   Output visibility start offset.
  * @param[out] vis          Output visibility amplitudes.
+ * @param[in,out] work      Work buffer in host memory, used and resized
+ *                          by the CPU correlators. If NULL, a temporary
+ *                          buffer is allocated internally.
  * @param[in,out] status    Status return code.
  */
 OSKAR_EXPORT
@@ -72,7 +75,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
         const oskar_Sky* sky, const oskar_Telescope* tel,
         const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
         double gast, double frequency_hz, int offset_out, oskar_Mem* vis,
-        int* status);
+        oskar_Mem* work, int* status);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_FUSED_H_
+#define OSKAR_CROSS_CORRELATE_FUSED_H_
+
+/**
+ * @file oskar_cross_correlate_fused.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Multiply a set of station beams with a set of source brightness
+ * matrices and the interferometer phase to form visibilities
+ * (i.e. V = K E B E* K*).
+ *
+ * @details
+ * This gives the same result as calling oskar_cross_correlate() with the
+ * product of Jones K and Jones E, but the interferometer phase is evaluated
+ * inside the correlator for each baseline, so neither Jones K nor the joined
+ * Jones matrices need to be stored.
+ *
+ * Source flux filtering is not applied here: sources to be excluded
+ * should have their station beam set to zero beforehand.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * @param[in]  num_sources  Number of sources to use.
+ * @param[in]  E            Set of station beam Jones matrices.
+ * @param[in]  sky          Sky model.
+ * @param[in]  tel          Telescope model.
+ * @param[in]  u            Station u coordinates, in metres.
+ * @param[in]  v            Station v coordinates, in metres.
+ * @param[in]  w            Station w coordinates, in metres.
+ * @param[in]  gast         Greenwich apparent sidereal time, in radians.
+ * @param[in]  frequency_hz Current observation frequency, in Hz.
+ * @param[in]  ignore_w_components If set, ignore station w coordinates.
+ * @param[in]  offset_out   Output visibility start offset.
+ * @param[out] vis          Output visibility amplitudes.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_fused(int num_sources, const oskar_Jones* E,
+        const oskar_Sky* sky, const oskar_Telescope* tel,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double gast, double frequency_hz, int ignore_w_components,
+        int offset_out, oskar_Mem* vis, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_FUSED_H_ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_GEMM_OMP_H_
+#define OSKAR_CROSS_CORRELATE_GEMM_OMP_H_
+
+/**
+ * @file oskar_cross_correlate_gemm_omp.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <utility/oskar_vector_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Point-source correlate function using matrix products
+ * (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones matrices for pairs
+ * of stations and summing along the source dimension.
+ *
+ * The product of each Jones matrix with the source brightness is formed
+ * only once per station, and the visibilities are then evaluated as a
+ * blocked complex matrix product over sources, in the same way as a
+ * Hermitian rank-k update.
+ * Bandwidth smearing, time-average smearing and Gaussian sources are
+ * not supported by this function.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Matrix of Jones matrices to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_point_gemm_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float4c* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float4c* vis, oskar_Mem* work, int* status);
+
+/**
+ * @brief
+ * Point-source correlate function using matrix products
+ * (double precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones matrices for pairs
+ * of stations and summing along the source dimension.
+ *
+ * The product of each Jones matrix with the source brightness is formed
+ * only once per station, and the visibilities are then evaluated as a
+ * blocked complex matrix product over sources, in the same way as a
+ * Hermitian rank-k update.
+ * Bandwidth smearing, time-average smearing and Gaussian sources are
+ * not supported by this function.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Matrix of Jones matrices to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_point_gemm_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double4c* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double4c* vis, oskar_Mem* work, int* status);
+
+/**
+ * @brief
+ * Scalar point-source correlate function using matrix products
+ * (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones scalars for pairs
+ * of stations and summing along the source dimension.
+ *
+ * The product of each Jones scalar with the source brightness is formed
+ * only once per station, and the visibilities are then evaluated as a
+ * blocked complex matrix product over sources, in the same way as a
+ * Hermitian rank-k update.
+ * Bandwidth smearing, time-average smearing and Gaussian sources are
+ * not supported by this function.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Matrix of Jones scalars to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_point_gemm_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float2* jones, const float* I,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float2* vis, oskar_Mem* work, int* status);
+
+/**
+ * @brief
+ * Scalar point-source correlate function using matrix products
+ * (double precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones scalars for pairs
+ * of stations and summing along the source dimension.
+ *
+ * The product of each Jones scalar with the source brightness is formed
+ * only once per station, and the visibilities are then evaluated as a
+ * blocked complex matrix product over sources, in the same way as a
+ * Hermitian rank-k update.
+ * Bandwidth smearing, time-average smearing and Gaussian sources are
+ * not supported by this function.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Matrix of Jones scalars to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_point_gemm_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double2* jones, const double* I,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double2* vis, oskar_Mem* work, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_GEMM_OMP_H_ */
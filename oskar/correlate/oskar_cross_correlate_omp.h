@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -34,6 +34,7 @@
  */
 
 #include <oskar_global.h>
+#include <mem/oskar_mem.h>
 #include <utility/oskar_vector_types.h>
 
 #ifdef __cplusplus
@@ -74,6 +75,8 @@ extern "C" {
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_point_omp_f(
@@ -86,7 +89,7 @@ void oskar_cross_correlate_point_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* vis);
+        float dec0_rad, float4c* vis, oskar_Mem* work, int* status);
 
 /**
  * @brief
@@ -122,6 +125,8 @@ void oskar_cross_correlate_point_omp_f(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_point_omp_d(
@@ -134,7 +139,8 @@ void oskar_cross_correlate_point_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* vis);
+        double dec0_rad, double4c* vis, oskar_Mem* work,
+        int* status);
 
 /**
  * @brief
@@ -176,6 +182,8 @@ void oskar_cross_correlate_point_omp_d(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_gaussian_omp_f(
@@ -188,7 +196,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* vis);
+        float gha0_rad, float dec0_rad, float4c* vis, oskar_Mem* work,
+        int* status);
 
 /**
  * @brief
@@ -230,6 +239,8 @@ void oskar_cross_correlate_gaussian_omp_f(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_gaussian_omp_d(
@@ -242,7 +253,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* vis);
+        double gha0_rad, double dec0_rad, double4c* vis, oskar_Mem* work,
+        int* status);
 
 #ifdef __cplusplus
 }
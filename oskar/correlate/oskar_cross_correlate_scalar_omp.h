@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -34,6 +34,7 @@
  */
 
 #include <oskar_global.h>
+#include <mem/oskar_mem.h>
 #include <utility/oskar_vector_types.h>
 
 #ifdef __cplusplus
@@ -71,6 +72,8 @@ extern "C" {
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_scalar_point_omp_f(
@@ -81,7 +84,8 @@ void oskar_cross_correlate_scalar_point_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, const float time_int_sec,
-        const float gha0_rad, const float dec0_rad, float2* vis);
+        const float gha0_rad, const float dec0_rad, float2* vis,
+        oskar_Mem* work, int* status);
 
 /**
  * @brief
@@ -114,6 +118,8 @@ void oskar_cross_correlate_scalar_point_omp_f(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_scalar_point_omp_d(
@@ -124,7 +130,8 @@ void oskar_cross_correlate_scalar_point_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, const double time_int_sec,
-        const double gha0_rad, const double dec0_rad, double2* vis);
+        const double gha0_rad, const double dec0_rad, double2* vis,
+        oskar_Mem* work, int* status);
 
 /**
  * @brief
@@ -163,6 +170,8 @@ void oskar_cross_correlate_scalar_point_omp_d(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_scalar_gaussian_omp_f(
@@ -175,7 +184,7 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float2* vis);
+        float dec0_rad, float2* vis, oskar_Mem* work, int* status);
 
 /**
  * @brief
@@ -214,6 +223,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
  * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] work       Work buffer in host memory, of any type.
+ * @param[in,out] status     Status return code.
  */
 OSKAR_EXPORT
 void oskar_cross_correlate_scalar_gaussian_omp_d(
@@ -226,7 +237,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double2* vis);
+        double dec0_rad, double2* vis, oskar_Mem* work,
+        int* status);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_TILE_SIZE_H_
+#define OSKAR_CROSS_CORRELATE_TILE_SIZE_H_
+
+/**
+ * @file oskar_cross_correlate_tile_size.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the tile sizes to use in the CPU cross-correlation kernels.
+ *
+ * @details
+ * The CPU correlators divide the stations into tiles, and the sources into
+ * blocks. Each pair of station tiles is processed one source block at a time,
+ * so that the Jones data for the block can be reused from cache by all
+ * baselines in the tile.
+ *
+ * By default, the tile sizes are chosen so that the Jones data for a pair
+ * of station tiles fits in a quarter of the level-2 cache, while leaving
+ * enough tiles to keep all OpenMP threads busy.
+ *
+ * The sizes can be set explicitly using the environment variables
+ * OSKAR_XCORR_TILE_STATIONS and OSKAR_XCORR_TILE_SOURCES.
+ *
+ * @param[in] num_sources      Number of sources.
+ * @param[in] num_stations     Number of stations.
+ * @param[in] bytes_per_source Size of Jones data per station per source.
+ * @param[out] tile_stations   Number of stations in each tile.
+ * @param[out] tile_sources    Number of sources in each block.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_tile_size(int num_sources, int num_stations,
+        int bytes_per_source, int* tile_stations, int* tile_sources);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_TILE_SIZE_H_ */
@@ -47,6 +47,8 @@ extern "C" {
  * @details
  * This function evaluates the average cross-power product for the supplied
  * sources from all stations.
+ * The cost is linear in the number of stations: the sum over all station
+ * pairs is formed in a single pass, using a running sum of station beams.
  *
  * The \p jones block is two dimensional, and the source dimension
  * is the fastest varying.
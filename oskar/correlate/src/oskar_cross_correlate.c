@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,6 +28,7 @@
 
 #include "correlate/oskar_cross_correlate.h"
 #include "correlate/oskar_cross_correlate_cuda.h"
+#include "correlate/oskar_cross_correlate_gemm_omp.h"
 #include "correlate/oskar_cross_correlate_omp.h"
 #include "correlate/oskar_cross_correlate_scalar_cuda.h"
 #include "correlate/oskar_cross_correlate_scalar_omp.h"
@@ -44,8 +45,9 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
         const oskar_Sky* sky, const oskar_Telescope* tel,
         const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
         double gast, double frequency_hz, int offset_out, oskar_Mem* vis,
-        int* status)
+        oskar_Mem* work, int* status)
 {
+    oskar_Mem* temp_work = 0;
     const oskar_Mem *J, *src_a, *src_b, *src_c, *src_l, *src_m, *src_n;
     const oskar_Mem *src_I, *src_Q, *src_U, *src_V, *x, *y;
     double uv_filter_min, uv_filter_max;
@@ -137,6 +139,9 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
     /* Select kernel. */
     if (location == OSKAR_CPU)
     {
+        if (!work)
+            work = temp_work = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0,
+                    status);
         if (use_extended)
         {
             switch (oskar_mem_type(vis))
@@ -162,7 +167,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float4c(vis, status));
+                        oskar_mem_float4c(vis, status), work, status);
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
                 oskar_cross_correlate_gaussian_omp_d(
@@ -185,7 +190,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double4c(vis, status));
+                        oskar_mem_double4c(vis, status), work, status);
                 break;
             case OSKAR_SINGLE_COMPLEX:
                 oskar_cross_correlate_scalar_gaussian_omp_f(
@@ -205,7 +210,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float2(vis, status));
+                        oskar_mem_float2(vis, status), work, status);
                 break;
             case OSKAR_DOUBLE_COMPLEX:
                 oskar_cross_correlate_scalar_gaussian_omp_d(
@@ -225,11 +230,67 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double2(vis, status));
+                        oskar_mem_double2(vis, status), work, status);
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
-                return;
+                break;
+            }
+        }
+        else if (frac_bandwidth == 0.0 && time_avg == 0.0)
+        {
+            /* Point sources without smearing use a matrix product. */
+            switch (oskar_mem_type(vis))
+            {
+            case OSKAR_SINGLE_COMPLEX_MATRIX:
+                oskar_cross_correlate_point_gemm_omp_f(
+                        num_sources, num_stations, offset_out,
+                        oskar_mem_float4c_const(J, status),
+                        oskar_mem_float_const(src_I, status),
+                        oskar_mem_float_const(src_Q, status),
+                        oskar_mem_float_const(src_U, status),
+                        oskar_mem_float_const(src_V, status),
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        oskar_mem_float4c(vis, status), work, status);
+                break;
+            case OSKAR_DOUBLE_COMPLEX_MATRIX:
+                oskar_cross_correlate_point_gemm_omp_d(
+                        num_sources, num_stations, offset_out,
+                        oskar_mem_double4c_const(J, status),
+                        oskar_mem_double_const(src_I, status),
+                        oskar_mem_double_const(src_Q, status),
+                        oskar_mem_double_const(src_U, status),
+                        oskar_mem_double_const(src_V, status),
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        oskar_mem_double4c(vis, status), work, status);
+                break;
+            case OSKAR_SINGLE_COMPLEX:
+                oskar_cross_correlate_scalar_point_gemm_omp_f(
+                        num_sources, num_stations, offset_out,
+                        oskar_mem_float2_const(J, status),
+                        oskar_mem_float_const(src_I, status),
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        oskar_mem_float2(vis, status), work, status);
+                break;
+            case OSKAR_DOUBLE_COMPLEX:
+                oskar_cross_correlate_scalar_point_gemm_omp_d(
+                        num_sources, num_stations, offset_out,
+                        oskar_mem_double2_const(J, status),
+                        oskar_mem_double_const(src_I, status),
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        oskar_mem_double2(vis, status), work, status);
+                break;
+            default:
+                *status = OSKAR_ERR_BAD_DATA_TYPE;
+                break;
             }
         }
         else
@@ -254,7 +315,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float4c(vis, status));
+                        oskar_mem_float4c(vis, status), work, status);
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
                 oskar_cross_correlate_point_omp_d(
@@ -274,7 +335,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double4c(vis, status));
+                        oskar_mem_double4c(vis, status), work, status);
                 break;
             case OSKAR_SINGLE_COMPLEX:
                 oskar_cross_correlate_scalar_point_omp_f(
@@ -291,7 +352,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float2(vis, status));
+                        oskar_mem_float2(vis, status), work, status);
                 break;
             case OSKAR_DOUBLE_COMPLEX:
                 oskar_cross_correlate_scalar_point_omp_d(
@@ -308,13 +369,14 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double2(vis, status));
+                        oskar_mem_double2(vis, status), work, status);
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
-                return;
+                break;
             }
         }
+        oskar_mem_free(temp_work, status);
     }
     else if (location == OSKAR_GPU)
     {
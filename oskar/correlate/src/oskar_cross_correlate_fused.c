@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_cross_correlate_fused.h"
+#include "correlate/oskar_cross_correlate_fused_omp.h"
+
+#include <float.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_fused(int num_sources, const oskar_Jones* E,
+        const oskar_Sky* sky, const oskar_Telescope* tel,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double gast, double frequency_hz, int ignore_w_components,
+        int offset_out, oskar_Mem* vis, int* status)
+{
+    const oskar_Mem *J, *src_a, *src_b, *src_c, *src_l, *src_m, *src_n;
+    const oskar_Mem *src_I, *src_Q, *src_U, *src_V, *x, *y;
+    double uv_filter_min, uv_filter_max;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const int use_extended = oskar_sky_use_extended(sky);
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / frequency_hz;
+
+    /* Get time-average smearing term and Greenwich hour angle. */
+    const double time_avg = oskar_telescope_time_average_sec(tel);
+    const double gha0 = gast - oskar_telescope_phase_centre_ra_rad(tel);
+    const double dec0 = oskar_telescope_phase_centre_dec_rad(tel);
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Check data locations. */
+    const int location = oskar_sky_mem_location(sky);
+    if (oskar_telescope_mem_location(tel) != location ||
+            oskar_jones_mem_location(E) != location ||
+            oskar_mem_location(vis) != location ||
+            oskar_mem_location(u) != location ||
+            oskar_mem_location(v) != location ||
+            oskar_mem_location(w) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check for consistent data types. */
+    const int jones_type = oskar_jones_type(E);
+    const int base_type = oskar_sky_precision(sky);
+    if (oskar_mem_precision(vis) != base_type ||
+            oskar_type_precision(jones_type) != base_type ||
+            oskar_mem_type(u) != base_type || oskar_mem_type(v) != base_type ||
+            oskar_mem_type(w) != base_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_type(vis) != jones_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Check the input dimensions. */
+    if (oskar_jones_num_sources(E) < num_sources ||
+            (int)oskar_mem_length(u) != num_stations ||
+            (int)oskar_mem_length(v) != num_stations ||
+            (int)oskar_mem_length(w) != num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Get handles to arrays. */
+    J = oskar_jones_mem_const(E);
+    src_I = oskar_sky_I_const(sky);
+    src_Q = oskar_sky_Q_const(sky);
+    src_U = oskar_sky_U_const(sky);
+    src_V = oskar_sky_V_const(sky);
+    src_l = oskar_sky_l_const(sky);
+    src_m = oskar_sky_m_const(sky);
+    src_n = oskar_sky_n_const(sky);
+    src_a = oskar_sky_gaussian_a_const(sky);
+    src_b = oskar_sky_gaussian_b_const(sky);
+    src_c = oskar_sky_gaussian_c_const(sky);
+    x = oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    y = oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+
+    /* Select kernel. */
+    switch (oskar_mem_type(vis))
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        oskar_cross_correlate_fused_omp_f(
+                num_sources, num_stations, offset_out,
+                oskar_mem_float4c_const(J, status),
+                oskar_mem_float_const(src_I, status),
+                oskar_mem_float_const(src_Q, status),
+                oskar_mem_float_const(src_U, status),
+                oskar_mem_float_const(src_V, status),
+                oskar_mem_float_const(src_l, status),
+                oskar_mem_float_const(src_m, status),
+                oskar_mem_float_const(src_n, status), use_extended,
+                oskar_mem_float_const(src_a, status),
+                oskar_mem_float_const(src_b, status),
+                oskar_mem_float_const(src_c, status),
+                oskar_mem_float_const(u, status),
+                oskar_mem_float_const(v, status),
+                oskar_mem_float_const(w, status),
+                oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_float4c(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        oskar_cross_correlate_fused_omp_d(
+                num_sources, num_stations, offset_out,
+                oskar_mem_double4c_const(J, status),
+                oskar_mem_double_const(src_I, status),
+                oskar_mem_double_const(src_Q, status),
+                oskar_mem_double_const(src_U, status),
+                oskar_mem_double_const(src_V, status),
+                oskar_mem_double_const(src_l, status),
+                oskar_mem_double_const(src_m, status),
+                oskar_mem_double_const(src_n, status), use_extended,
+                oskar_mem_double_const(src_a, status),
+                oskar_mem_double_const(src_b, status),
+                oskar_mem_double_const(src_c, status),
+                oskar_mem_double_const(u, status),
+                oskar_mem_double_const(v, status),
+                oskar_mem_double_const(w, status),
+                oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_double4c(vis, status));
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        oskar_cross_correlate_scalar_fused_omp_f(
+                num_sources, num_stations, offset_out,
+                oskar_mem_float2_const(J, status),
+                oskar_mem_float_const(src_I, status),
+                oskar_mem_float_const(src_l, status),
+                oskar_mem_float_const(src_m, status),
+                oskar_mem_float_const(src_n, status), use_extended,
+                oskar_mem_float_const(src_a, status),
+                oskar_mem_float_const(src_b, status),
+                oskar_mem_float_const(src_c, status),
+                oskar_mem_float_const(u, status),
+                oskar_mem_float_const(v, status),
+                oskar_mem_float_const(w, status),
+                oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_float2(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        oskar_cross_correlate_scalar_fused_omp_d(
+                num_sources, num_stations, offset_out,
+                oskar_mem_double2_const(J, status),
+                oskar_mem_double_const(src_I, status),
+                oskar_mem_double_const(src_l, status),
+                oskar_mem_double_const(src_m, status),
+                oskar_mem_double_const(src_n, status), use_extended,
+                oskar_mem_double_const(src_a, status),
+                oskar_mem_double_const(src_b, status),
+                oskar_mem_double_const(src_c, status),
+                oskar_mem_double_const(u, status),
+                oskar_mem_double_const(v, status),
+                oskar_mem_double_const(w, status),
+                oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_double2(vis, status));
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_cross_correlate_fused_omp.h"
+#include "math/define_multiply.h"
+#include "math/oskar_kahan_sum.h"
+#include "math/oskar_vmath.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+template<typename T1, typename T2>
+struct is_same
+{
+    enum { value = false }; // is_same represents a bool.
+    typedef is_same<T1,T2> type; // to qualify as a metafunction.
+};
+
+template<typename T>
+struct is_same<T,T>
+{
+    enum { value = true };
+    typedef is_same<T,T> type;
+};
+
+// Returns the smearing term for source i on the current baseline.
+#define XCORR_SMEARING(REAL)                                                \
+        REAL smearing;                                                      \
+        if (GAUSSIAN)                                                       \
+        {                                                                   \
+            const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +         \
+                    source_c[i] * vv2;                                      \
+            smearing = oskar_vexp((REAL) -t);                               \
+        }                                                                   \
+        else smearing = (REAL) 1;                                           \
+        if (BANDWIDTH_SMEARING || TIME_SMEARING)                            \
+        {                                                                   \
+            if (BANDWIDTH_SMEARING)                                         \
+            {                                                               \
+                const REAL t = uu * l + vv * m + ww * n;                    \
+                smearing *= oskar_vsinc(t);                                 \
+            }                                                               \
+            if (TIME_SMEARING)                                              \
+            {                                                               \
+                const REAL t = du * l + dv * m + dw * n;                    \
+                smearing *= oskar_vsinc(t);                                 \
+            }                                                               \
+        }
+
+// Returns the interferometer phase for source i on the current baseline.
+#define XCORR_PHASE(REAL, REAL2)                                            \
+        REAL2 phasor;                                                       \
+        {                                                                   \
+            const REAL phase = pu * l + pv * m + pw * n;                    \
+            oskar_vsincos(phase, phasor.y, phasor.x);                       \
+        }
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2, typename REAL4c
+>
+void oskar_xcorr_fused_omp(
+        const int                    num_sources,
+        const int                    num_stations,
+        const int                    offset_out,
+        const REAL4c* const RESTRICT jones,
+        const REAL*   const RESTRICT source_I,
+        const REAL*   const RESTRICT source_Q,
+        const REAL*   const RESTRICT source_U,
+        const REAL*   const RESTRICT source_V,
+        const REAL*   const RESTRICT source_l,
+        const REAL*   const RESTRICT source_m,
+        const REAL*   const RESTRICT source_n,
+        const REAL*   const RESTRICT source_a,
+        const REAL*   const RESTRICT source_b,
+        const REAL*   const RESTRICT source_c,
+        const REAL*   const RESTRICT station_u,
+        const REAL*   const RESTRICT station_v,
+        const REAL*   const RESTRICT station_w,
+        const REAL*   const RESTRICT station_x,
+        const REAL*   const RESTRICT station_y,
+        const REAL                   uv_min_lambda,
+        const REAL                   uv_max_lambda,
+        const REAL                   inv_wavelength,
+        const REAL                   frac_bandwidth,
+        const REAL                   time_int_sec,
+        const REAL                   gha0_rad,
+        const REAL                   dec0_rad,
+        const int                    ignore_w,
+        REAL4c*             RESTRICT vis)
+{
+    const REAL wavenumber = 2 * ((REAL) M_PI) * inv_wavelength;
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Pointer to source vector for station q.
+        const REAL4c* const station_q = &jones[SQ * num_sources];
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+            REAL4c m1, m2, sum, guard;
+            OSKAR_CLEAR_COMPLEX_MATRIX(REAL, sum)
+            if (is_same<REAL, float>::value)
+                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, guard)
+
+            // Pointer to source vector for station p.
+            const REAL4c* const station_p = &jones[SP * num_sources];
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+
+            // Get the baseline coordinates for the interferometer phase.
+            const REAL pu = wavenumber * (station_u[SP] - station_u[SQ]);
+            const REAL pv = wavenumber * (station_v[SP] - station_v[SQ]);
+            const REAL pw = ignore_w ? (REAL) 0 :
+                    wavenumber * (station_w[SP] - station_w[SQ]);
+
+            // Loop over sources.
+            for (int i = 0; i < num_sources; ++i)
+            {
+                const REAL l = source_l[i];
+                const REAL m = source_m[i];
+                const REAL n = source_n[i] - (REAL) 1;
+                XCORR_SMEARING(REAL)
+                XCORR_PHASE(REAL, REAL2)
+
+                // Construct source brightness matrix.
+                OSKAR_CONSTRUCT_B(REAL, m2,
+                        source_I[i], source_Q[i], source_U[i], source_V[i])
+
+                // Multiply first Jones matrix with source brightness matrix.
+                OSKAR_LOAD_MATRIX(m1, station_p[i])
+                OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
+
+                // Multiply result with second (Hermitian transposed) Jones matrix.
+                OSKAR_LOAD_MATRIX(m2, station_q[i])
+                OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
+
+                // Apply the interferometer phase.
+                OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(REAL2, m1, phasor)
+
+                // Multiply result by smearing term and accumulate.
+                if (is_same<REAL, float>::value)
+                {
+                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX_MATRIX(
+                            REAL, sum, m1, smearing, guard)
+                }
+                else
+                {
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum, m1, smearing)
+                }
+            }
+
+            // Add result to the baseline visibility.
+            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
+            OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(vis[i], sum);
+        }
+    }
+}
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2
+>
+void oskar_xcorr_scalar_fused_omp(
+        const int                   num_sources,
+        const int                   num_stations,
+        const int                   offset_out,
+        const REAL2* const RESTRICT jones,
+        const REAL*  const RESTRICT source_I,
+        const REAL*  const RESTRICT source_l,
+        const REAL*  const RESTRICT source_m,
+        const REAL*  const RESTRICT source_n,
+        const REAL*  const RESTRICT source_a,
+        const REAL*  const RESTRICT source_b,
+        const REAL*  const RESTRICT source_c,
+        const REAL*  const RESTRICT station_u,
+        const REAL*  const RESTRICT station_v,
+        const REAL*  const RESTRICT station_w,
+        const REAL*  const RESTRICT station_x,
+        const REAL*  const RESTRICT station_y,
+        const REAL                  uv_min_lambda,
+        const REAL                  uv_max_lambda,
+        const REAL                  inv_wavelength,
+        const REAL                  frac_bandwidth,
+        const REAL                  time_int_sec,
+        const REAL                  gha0_rad,
+        const REAL                  dec0_rad,
+        const int                   ignore_w,
+        REAL2*             RESTRICT vis)
+{
+    const REAL wavenumber = 2 * ((REAL) M_PI) * inv_wavelength;
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Pointer to source vector for station q.
+        const REAL2* const station_q = &jones[SQ * num_sources];
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+            REAL2 t1, t2, sum, guard;
+            sum.x = sum.y = (REAL) 0;
+            if (is_same<REAL, float>::value)
+                guard.x = guard.y = (REAL) 0;
+
+            // Pointer to source vector for station p.
+            const REAL2* const station_p = &jones[SP * num_sources];
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+
+            // Get the baseline coordinates for the interferometer phase.
+            const REAL pu = wavenumber * (station_u[SP] - station_u[SQ]);
+            const REAL pv = wavenumber * (station_v[SP] - station_v[SQ]);
+            const REAL pw = ignore_w ? (REAL) 0 :
+                    wavenumber * (station_w[SP] - station_w[SQ]);
+
+            // Loop over sources.
+            for (int i = 0; i < num_sources; ++i)
+            {
+                const REAL l = source_l[i];
+                const REAL m = source_m[i];
+                const REAL n = source_n[i] - (REAL) 1;
+                XCORR_SMEARING(REAL)
+                XCORR_PHASE(REAL, REAL2)
+                smearing *= source_I[i];
+
+                // Multiply Jones scalars and apply the interferometer phase.
+                t1 = station_p[i];
+                t2 = station_q[i];
+                OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+                OSKAR_MUL_COMPLEX_IN_PLACE(REAL2, t1, phasor)
+
+                // Multiply result by smearing term and accumulate.
+                if (is_same<REAL, float>::value)
+                {
+                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX(
+                            REAL, sum, t1, smearing, guard)
+                }
+                else
+                {
+                    sum.x += t1.x * smearing;
+                    sum.y += t1.y * smearing;
+                }
+            }
+
+            // Add result to the baseline visibility.
+            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
+            vis[i].x += sum.x;
+            vis[i].y += sum.y;
+        }
+    }
+}
+
+#define XCORR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2, REAL4c)                 \
+        oskar_xcorr_fused_omp<BS, TS, GAUSSIAN, REAL, REAL2, REAL4c>        \
+        (num_sources, num_stations, offset_out, jones,                      \
+                I, Q, U, V, l, m, n, a, b, c,                               \
+                station_u, station_v, station_w, station_x, station_y,      \
+                uv_min_lambda, uv_max_lambda, inv_wavelength,               \
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad,           \
+                ignore_w, vis);
+
+#define XCORR_SCALAR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2, REAL4c)          \
+        oskar_xcorr_scalar_fused_omp<BS, TS, GAUSSIAN, REAL, REAL2>         \
+        (num_sources, num_stations, offset_out, jones,                      \
+                I, l, m, n, a, b, c,                                        \
+                station_u, station_v, station_w, station_x, station_y,      \
+                uv_min_lambda, uv_max_lambda, inv_wavelength,               \
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad,           \
+                ignore_w, vis);
+
+#define XCORR_SELECT_SMEARING(KERNEL, GAUSSIAN, REAL, REAL2, REAL4c)        \
+        if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
+            KERNEL(false, false, GAUSSIAN, REAL, REAL2, REAL4c)             \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec == (REAL)0)      \
+            KERNEL(true, false, GAUSSIAN, REAL, REAL2, REAL4c)              \
+        else if (frac_bandwidth == (REAL)0 && time_int_sec != (REAL)0)      \
+            KERNEL(false, true, GAUSSIAN, REAL, REAL2, REAL4c)              \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec != (REAL)0)      \
+            KERNEL(true, true, GAUSSIAN, REAL, REAL2, REAL4c)
+
+#define XCORR_SELECT(KERNEL, REAL, REAL2, REAL4c)                           \
+        if (extended)                                                       \
+        {                                                                   \
+            XCORR_SELECT_SMEARING(KERNEL, true, REAL, REAL2, REAL4c)        \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            XCORR_SELECT_SMEARING(KERNEL, false, REAL, REAL2, REAL4c)       \
+        }
+
+void oskar_cross_correlate_fused_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float4c* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* l, const float* m, const float* n, int extended,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, float uv_min_lambda, float uv_max_lambda,
+        float inv_wavelength, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w, float4c* vis)
+{
+    XCORR_SELECT(XCORR_KERNEL, float, float2, float4c)
+}
+
+void oskar_cross_correlate_fused_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double4c* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* l, const double* m, const double* n, int extended,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, double uv_min_lambda, double uv_max_lambda,
+        double inv_wavelength, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w, double4c* vis)
+{
+    XCORR_SELECT(XCORR_KERNEL, double, double2, double4c)
+}
+
+void oskar_cross_correlate_scalar_fused_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float2* jones, const float* I,
+        const float* l, const float* m, const float* n, int extended,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, float uv_min_lambda, float uv_max_lambda,
+        float inv_wavelength, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w, float2* vis)
+{
+    XCORR_SELECT(XCORR_SCALAR_KERNEL, float, float2, float4c)
+}
+
+void oskar_cross_correlate_scalar_fused_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double2* jones, const double* I,
+        const double* l, const double* m, const double* n, int extended,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, double uv_min_lambda, double uv_max_lambda,
+        double inv_wavelength, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w, double2* vis)
+{
+    XCORR_SELECT(XCORR_SCALAR_KERNEL, double, double2, double4c)
+}
@@ -0,0 +1,495 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_cross_correlate_gemm_omp.h"
+#include "correlate/oskar_cross_correlate_work_buffer.h"
+#include "math/oskar_kahan_sum.h"
+#include "utility/oskar_cpu_isa.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename T1, typename T2>
+struct is_same
+{
+    enum { value = false }; // is_same represents a bool.
+    typedef is_same<T1,T2> type; // to qualify as a metafunction.
+};
+
+template<typename T>
+struct is_same<T,T>
+{
+    enum { value = true };
+    typedef is_same<T,T> type;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define OMP_SIMD _Pragma("omp simd")
+#else
+#define OMP_SIMD
+#endif
+
+// Number of sources in each block of the matrix product.
+// Partial sums of each block are combined using Kahan summation
+// in single precision.
+#define GEMM_BLOCK 128
+
+// Alignment of the arrays in the work buffer, in bytes.
+#define GEMM_ALIGN 64
+
+// Component indices of Jones matrices.
+enum { AR, AI, BR, BI, CR, CI, DR, DI, NUM_COMPONENTS };
+
+// Traits of the matrix and scalar versions.
+// PB is the number of rows (stations SP) in each block of the product.
+// QB is the number of columns (stations SQ) in each panel: this is the
+// dimension that is vectorised, so it is a multiple of the SIMD width.
+template<typename REAL, bool MATRIX> struct GemmTraits;
+template<> struct GemmTraits<float, true>
+{ enum { NC = NUM_COMPONENTS, PB = 2, QB = 16 }; };
+template<> struct GemmTraits<double, true>
+{ enum { NC = NUM_COMPONENTS, PB = 2, QB = 8 }; };
+template<> struct GemmTraits<float, false>
+{ enum { NC = 2, PB = 4, QB = 16 }; };
+template<> struct GemmTraits<double, false>
+{ enum { NC = 2, PB = 4, QB = 8 }; };
+
+// Returns the size of an array in bytes, rounded up to the alignment.
+template<typename REAL>
+static size_t aligned_size(size_t num_elements)
+{
+    return GEMM_ALIGN * ((num_elements * sizeof(REAL) + GEMM_ALIGN - 1) /
+            GEMM_ALIGN);
+}
+
+// Forms the product of each Jones matrix with the source brightness matrix,
+// M = J B, and stores it as an array of [station][source][component].
+// Copies the Jones matrices into panels of QB stations, stored as
+// an array of [panel][source][component][station in panel].
+// (The input is accessed as an array of reals, as it is not guaranteed
+// to have the full alignment of the matrix type.)
+template<typename REAL, int QB>
+static void pack_matrix(const int num_sources, const int num_stations,
+        const REAL* const RESTRICT jones, const REAL* const RESTRICT I,
+        const REAL* const RESTRICT Q, const REAL* const RESTRICT U,
+        const REAL* const RESTRICT V, REAL* RESTRICT m, REAL* RESTRICT panels)
+{
+#pragma omp parallel for
+    for (int SP = 0; SP < num_stations; ++SP)
+    {
+        const REAL* const RESTRICT j = &jones[
+                (long) SP * num_sources * NUM_COMPONENTS];
+        REAL* const RESTRICT mp = &m[(long) SP * num_sources * NUM_COMPONENTS];
+        REAL* const RESTRICT pp = &panels[(long) (SP / QB) * num_sources *
+                NUM_COMPONENTS * QB + (SP % QB)];
+        for (int i = 0; i < num_sources; ++i)
+        {
+            // Source brightness matrix B = [I + Q, U + iV; U - iV, I - Q].
+            const REAL* const RESTRICT jj = &j[i * NUM_COMPONENTS];
+            const REAL I_Q = I[i] + Q[i], I_mQ = I[i] - Q[i];
+            const REAL U_ = U[i], V_ = V[i];
+            const REAL ar = jj[AR], ai = jj[AI], br = jj[BR], bi = jj[BI];
+            const REAL cr = jj[CR], ci = jj[CI], dr = jj[DR], di = jj[DI];
+            REAL* const RESTRICT mm = &mp[i * NUM_COMPONENTS];
+            mm[AR] = ar * I_Q + br * U_ + bi * V_;
+            mm[AI] = ai * I_Q + bi * U_ - br * V_;
+            mm[BR] = ar * U_ - ai * V_ + br * I_mQ;
+            mm[BI] = ai * U_ + ar * V_ + bi * I_mQ;
+            mm[CR] = cr * I_Q + dr * U_ + di * V_;
+            mm[CI] = ci * I_Q + di * U_ - dr * V_;
+            mm[DR] = cr * U_ - ci * V_ + dr * I_mQ;
+            mm[DI] = ci * U_ + cr * V_ + di * I_mQ;
+            for (int k = 0; k < NUM_COMPONENTS; ++k)
+                pp[(i * NUM_COMPONENTS + k) * QB] = jj[k];
+        }
+    }
+}
+
+// Forms the product of each Jones scalar with the source brightness,
+// and copies the Jones scalars into panels, as for pack_matrix().
+template<typename REAL, int QB>
+static void pack_scalar(const int num_sources, const int num_stations,
+        const REAL* const RESTRICT jones, const REAL* const RESTRICT I,
+        REAL* RESTRICT m, REAL* RESTRICT panels)
+{
+#pragma omp parallel for
+    for (int SP = 0; SP < num_stations; ++SP)
+    {
+        const REAL* const RESTRICT j = &jones[(long) SP * num_sources * 2];
+        REAL* const RESTRICT mp = &m[(long) SP * num_sources * 2];
+        REAL* const RESTRICT pp = &panels[(long) (SP / QB) * num_sources *
+                2 * QB + (SP % QB)];
+        for (int i = 0; i < num_sources; ++i)
+        {
+            mp[2 * i]     = I[i] * j[2 * i];
+            mp[2 * i + 1] = I[i] * j[2 * i + 1];
+            pp[(2 * i) * QB]     = j[2 * i];
+            pp[(2 * i + 1) * QB] = j[2 * i + 1];
+        }
+    }
+}
+
+// Evaluates the product of PB rows of M with one panel of Jones matrices
+// (Hermitian transposed), for sources i0 to i1.
+template<typename REAL, int PB, int QB>
+static ALWAYS_INLINE void oskar_xcorr_gemm_block_matrix(
+        const int i0, const int i1, const REAL* const RESTRICT m,
+        const long m_stride, const REAL* const RESTRICT panel,
+        REAL acc[PB][NUM_COMPONENTS][QB])
+{
+    for (int k = 0; k < PB; ++k)
+        for (int c = 0; c < NUM_COMPONENTS; ++c)
+            for (int j = 0; j < QB; ++j)
+                acc[k][c][j] = (REAL) 0;
+    for (int i = i0; i < i1; ++i)
+    {
+        const REAL* const RESTRICT q = &panel[i * NUM_COMPONENTS * QB];
+        for (int k = 0; k < PB; ++k)
+        {
+            const REAL* const RESTRICT mm =
+                    &m[k * m_stride + i * NUM_COMPONENTS];
+            const REAL m11r = mm[AR], m11i = mm[AI];
+            const REAL m12r = mm[BR], m12i = mm[BI];
+            const REAL m21r = mm[CR], m21i = mm[CI];
+            const REAL m22r = mm[DR], m22i = mm[DI];
+            REAL (*const RESTRICT a)[QB] = acc[k];
+            OMP_SIMD
+            for (int j = 0; j < QB; ++j)
+            {
+                const REAL qar = q[AR * QB + j], qai = q[AI * QB + j];
+                const REAL qbr = q[BR * QB + j], qbi = q[BI * QB + j];
+                const REAL qcr = q[CR * QB + j], qci = q[CI * QB + j];
+                const REAL qdr = q[DR * QB + j], qdi = q[DI * QB + j];
+                a[AR][j] += m11r * qar + m11i * qai + m12r * qbr + m12i * qbi;
+                a[AI][j] += m11i * qar - m11r * qai + m12i * qbr - m12r * qbi;
+                a[BR][j] += m11r * qcr + m11i * qci + m12r * qdr + m12i * qdi;
+                a[BI][j] += m11i * qcr - m11r * qci + m12i * qdr - m12r * qdi;
+                a[CR][j] += m21r * qar + m21i * qai + m22r * qbr + m22i * qbi;
+                a[CI][j] += m21i * qar - m21r * qai + m22i * qbr - m22r * qbi;
+                a[DR][j] += m21r * qcr + m21i * qci + m22r * qdr + m22i * qdi;
+                a[DI][j] += m21i * qcr - m21r * qci + m22i * qdr - m22r * qdi;
+            }
+        }
+    }
+}
+
+// Evaluates the product of PB rows of M with one panel of Jones scalars
+// (conjugated), for sources i0 to i1.
+template<typename REAL, int PB, int QB>
+static ALWAYS_INLINE void oskar_xcorr_gemm_block_scalar(
+        const int i0, const int i1, const REAL* const RESTRICT m,
+        const long m_stride, const REAL* const RESTRICT panel,
+        REAL acc[PB][2][QB])
+{
+    for (int k = 0; k < PB; ++k)
+        for (int j = 0; j < QB; ++j)
+            acc[k][0][j] = acc[k][1][j] = (REAL) 0;
+    for (int i = i0; i < i1; ++i)
+    {
+        const REAL* const RESTRICT q = &panel[i * 2 * QB];
+        for (int k = 0; k < PB; ++k)
+        {
+            const REAL pr = m[k * m_stride + 2 * i];
+            const REAL pi = m[k * m_stride + 2 * i + 1];
+            REAL (*const RESTRICT a)[QB] = acc[k];
+            OMP_SIMD
+            for (int j = 0; j < QB; ++j)
+            {
+                const REAL qr = q[j], qi = q[QB + j];
+                a[0][j] += pr * qr + pi * qi;
+                a[1][j] += pi * qr - pr * qi;
+            }
+        }
+    }
+}
+
+#define GEMM_PANEL_ARGS(REAL, REALC)                                        \
+        const int q0, const int num_sources, const int num_stations,        \
+        const int offset_out, const REAL* const RESTRICT m,                 \
+        const REAL* const RESTRICT panels,                                  \
+        const REAL* const RESTRICT station_u,                               \
+        const REAL* const RESTRICT station_v,                               \
+        const REAL uv_min_lambda, const REAL uv_max_lambda,                 \
+        const REAL inv_wavelength, REAL* RESTRICT sum, REAL* RESTRICT guard,\
+        REALC* RESTRICT vis
+
+#define GEMM_PANEL_PARAMS                                                   \
+        q0, num_sources, num_stations, offset_out, m, panels,               \
+        station_u, station_v, uv_min_lambda, uv_max_lambda,                 \
+        inv_wavelength, sum, guard, vis
+
+// Correlates the panel of stations starting at q0 with all stations SP > SQ.
+// The sum and guard arrays hold the accumulated visibilities of the panel,
+// as an array of [station SP][component][station in panel].
+template<bool MATRIX, typename REAL, typename REALC>
+static ALWAYS_INLINE void oskar_xcorr_gemm_panel(
+        GEMM_PANEL_ARGS(REAL, REALC))
+{
+    enum {
+        NC = GemmTraits<REAL, MATRIX>::NC,
+        PB = GemmTraits<REAL, MATRIX>::PB,
+        QB = GemmTraits<REAL, MATRIX>::QB
+    };
+    const long m_stride = (long) num_sources * NC;
+    const REAL* const RESTRICT panel = &panels[(q0 / QB) * m_stride * QB];
+    const int q1 = (q0 + QB < num_stations) ? q0 + QB : num_stations;
+    const int p_start = ((q0 + 1) / PB) * PB;
+    REAL acc[PB][NC][QB];
+
+    // Clear the accumulated visibilities for this panel.
+    memset(sum, 0, (size_t) num_stations * NC * QB * sizeof(REAL));
+    memset(guard, 0, (size_t) num_stations * NC * QB * sizeof(REAL));
+
+    // Loop over blocks of sources.
+    for (int i0 = 0; i0 < num_sources; i0 += GEMM_BLOCK)
+    {
+        const int i1 = (i0 + GEMM_BLOCK < num_sources) ?
+                i0 + GEMM_BLOCK : num_sources;
+
+        // Loop over blocks of PB rows.
+        // (The rows of M are padded to a multiple of PB.)
+        for (int p0 = p_start; p0 < num_stations; p0 += PB)
+        {
+            if (MATRIX)
+                oskar_xcorr_gemm_block_matrix<REAL, PB, QB>(i0, i1,
+                        &m[p0 * m_stride], m_stride, panel,
+                        (REAL (*)[NUM_COMPONENTS][QB]) acc);
+            else
+                oskar_xcorr_gemm_block_scalar<REAL, PB, QB>(i0, i1,
+                        &m[p0 * m_stride], m_stride, panel,
+                        (REAL (*)[2][QB]) acc);
+
+            // Add partial sums for this block.
+            for (int k = 0; k < PB; ++k)
+            {
+                REAL* const RESTRICT s = &sum[(p0 + k) * NC * QB];
+                REAL* const RESTRICT g = &guard[(p0 + k) * NC * QB];
+                const REAL* const RESTRICT a = &acc[k][0][0];
+                if (is_same<REAL, float>::value)
+                {
+                    for (int j = 0; j < NC * QB; ++j)
+                        OSKAR_KAHAN_SUM(REAL, s[j], a[j], g[j])
+                }
+                else
+                {
+                    for (int j = 0; j < NC * QB; ++j) s[j] += a[j];
+                }
+            }
+        }
+    }
+
+    // Add results to the baseline visibilities.
+    // (Access as an array of reals, as the output is not guaranteed
+    // to have the full alignment of the matrix type.)
+    for (int SQ = q0; SQ < q1; ++SQ)
+    {
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            const REAL uu = (station_u[SP] - station_u[SQ]) * inv_wavelength;
+            const REAL vv = (station_v[SP] - station_v[SQ]) * inv_wavelength;
+            const REAL uv_len = sqrt(uu * uu + vv * vv);
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            const int b = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            REAL* const RESTRICT out = (REAL*) &vis[b];
+            const REAL* const RESTRICT s = &sum[SP * NC * QB + (SQ - q0)];
+            for (int c = 0; c < NC; ++c) out[c] += s[c * QB];
+        }
+    }
+}
+
+// Versions of the panel function compiled for each instruction set.
+#define GEMM_PANEL_ISA(NAME, TARGET)                                        \
+template<bool MATRIX, typename REAL, typename REALC>                        \
+TARGET static void NAME(GEMM_PANEL_ARGS(REAL, REALC))                       \
+{                                                                           \
+    oskar_xcorr_gemm_panel<MATRIX, REAL, REALC>(GEMM_PANEL_PARAMS);         \
+}
+
+GEMM_PANEL_ISA(oskar_xcorr_gemm_panel_generic, )
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+GEMM_PANEL_ISA(oskar_xcorr_gemm_panel_sse4, OSKAR_TARGET_SSE4)
+GEMM_PANEL_ISA(oskar_xcorr_gemm_panel_avx2, OSKAR_TARGET_AVX2)
+GEMM_PANEL_ISA(oskar_xcorr_gemm_panel_avx512, OSKAR_TARGET_AVX512)
+#endif
+
+template<bool MATRIX, typename REAL, typename REALC>
+void oskar_xcorr_gemm_omp(
+        const int                   num_sources,
+        const int                   num_stations,
+        const int                   offset_out,
+        const REALC* const RESTRICT jones,
+        const REAL*  const RESTRICT source_I,
+        const REAL*  const RESTRICT source_Q,
+        const REAL*  const RESTRICT source_U,
+        const REAL*  const RESTRICT source_V,
+        const REAL*  const RESTRICT station_u,
+        const REAL*  const RESTRICT station_v,
+        const REAL                  uv_min_lambda,
+        const REAL                  uv_max_lambda,
+        const REAL                  inv_wavelength,
+        REALC*             RESTRICT vis,
+        oskar_Mem*                  work,
+        int*                        status)
+{
+    enum {
+        NC = GemmTraits<REAL, MATRIX>::NC,
+        PB = GemmTraits<REAL, MATRIX>::PB,
+        QB = GemmTraits<REAL, MATRIX>::QB
+    };
+    int num_threads = 1;
+    if (*status || num_sources <= 0 || num_stations <= 1) return;
+
+    // Get the work buffer, which holds the packed arrays (padded to whole
+    // blocks), followed by the partial sums for each thread.
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    const int num_panels = (num_stations + QB - 1) / QB;
+    const size_t m_size = (size_t) (num_stations + PB) * num_sources * NC;
+    const size_t panel_size = (size_t) QB * num_sources * NC;
+    const size_t sum_size = (size_t) (num_stations + PB) * NC * QB;
+    const size_t panels_offset = aligned_size<REAL>(m_size);
+    const size_t sums_offset = panels_offset +
+            aligned_size<REAL>(num_panels * panel_size);
+    const size_t sums_stride = 2 * aligned_size<REAL>(sum_size);
+    char* buffer = (char*) oskar_cross_correlate_work_buffer(work,
+            sums_offset + num_threads * sums_stride, status);
+    if (*status) return;
+    REAL* m = (REAL*) buffer;
+    REAL* panels = (REAL*) (buffer + panels_offset);
+
+    // Clear the padding, then form the brightness-weighted Jones data
+    // and the Jones panels.
+    memset(m + (size_t) num_stations * num_sources * NC, 0,
+            (size_t) PB * num_sources * NC * sizeof(REAL));
+    memset(panels + (num_panels - 1) * panel_size, 0,
+            panel_size * sizeof(REAL));
+    if (MATRIX)
+        pack_matrix<REAL, QB>(num_sources, num_stations,
+                (const REAL*) jones, source_I, source_Q, source_U, source_V,
+                m, panels);
+    else
+        pack_scalar<REAL, QB>(num_sources, num_stations,
+                (const REAL*) jones, source_I, m, panels);
+    const int isa = oskar_cpu_isa();
+
+    // Loop over panels of stations SQ.
+#pragma omp parallel num_threads(num_threads)
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        REAL* sum = (REAL*) (buffer + sums_offset + thread * sums_stride);
+        REAL* guard = (REAL*) (buffer + sums_offset + thread * sums_stride +
+                sums_stride / 2);
+#pragma omp for schedule(dynamic, 1)
+        for (int t = 0; t < num_panels; ++t)
+        {
+            const int q0 = t * QB;
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+            if (isa >= OSKAR_CPU_ISA_AVX512)
+                oskar_xcorr_gemm_panel_avx512<MATRIX, REAL, REALC>(
+                        GEMM_PANEL_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_AVX2)
+                oskar_xcorr_gemm_panel_avx2<MATRIX, REAL, REALC>(
+                        GEMM_PANEL_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_SSE4)
+                oskar_xcorr_gemm_panel_sse4<MATRIX, REAL, REALC>(
+                        GEMM_PANEL_PARAMS);
+            else
+#endif
+                oskar_xcorr_gemm_panel_generic<MATRIX, REAL, REALC>(
+                        GEMM_PANEL_PARAMS);
+        }
+    }
+}
+
+void oskar_cross_correlate_point_gemm_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float4c* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float4c* vis, oskar_Mem* work, int* status)
+{
+    oskar_xcorr_gemm_omp<true, float, float4c>(num_sources, num_stations,
+            offset_out, jones, I, Q, U, V, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, vis, work, status);
+}
+
+void oskar_cross_correlate_point_gemm_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double4c* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double4c* vis, oskar_Mem* work, int* status)
+{
+    oskar_xcorr_gemm_omp<true, double, double4c>(num_sources, num_stations,
+            offset_out, jones, I, Q, U, V, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, vis, work, status);
+}
+
+void oskar_cross_correlate_scalar_point_gemm_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float2* jones, const float* I,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float2* vis, oskar_Mem* work, int* status)
+{
+    oskar_xcorr_gemm_omp<false, float, float2>(num_sources, num_stations,
+            offset_out, jones, I, 0, 0, 0, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, vis, work, status);
+}
+
+void oskar_cross_correlate_scalar_point_gemm_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double2* jones, const double* I,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double2* vis, oskar_Mem* work, int* status)
+{
+    oskar_xcorr_gemm_omp<false, double, double2>(num_sources, num_stations,
+            offset_out, jones, I, 0, 0, 0, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, vis, work, status);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,11 +28,21 @@
 
 #include "correlate/define_correlate_utils.h"
 #include "correlate/oskar_cross_correlate_omp.h"
+#include "correlate/oskar_cross_correlate_tile_size.h"
+#include "correlate/oskar_cross_correlate_work_buffer.h"
 #include "math/define_multiply.h"
 #include "math/oskar_kahan_sum.h"
+#include "math/oskar_vmath.h"
+#include "utility/oskar_cpu_isa.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
 
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template<typename T1, typename T2>
 struct is_same
 {
@@ -47,6 +57,353 @@ struct is_same<T,T>
     typedef is_same<T,T> type;
 };
 
+#if defined(__GNUC__) || defined(__clang__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#define NOINLINE __attribute__((noinline))
+#else
+#define ALWAYS_INLINE inline
+#define NOINLINE
+#endif
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define OMP_SIMD_SUM _Pragma("omp simd reduction(+:s0,s1,s2,s3,s4,s5,s6,s7)")
+#else
+#define OMP_SIMD_SUM
+#endif
+
+// Number of sources summed in each SIMD block.
+// Partial sums of each block are combined using Kahan summation
+// in single precision.
+#define XCORR_BLOCK 128
+
+// Alignment of the baseline lists in the work buffer, in bytes.
+#define XCORR_ALIGN 64
+
+// Component indices of Jones matrices in structure-of-arrays form.
+enum { AR, AI, BR, BI, CR, CI, DR, DI, NUM_COMPONENTS };
+
+// Copies the Jones matrices into structure-of-arrays form, so that each
+// real component is contiguous in memory across all sources.
+template<typename REAL, typename REAL4c>
+static void jones_to_soa(const int num_sources, const int num_stations,
+        const REAL4c* const RESTRICT jones, REAL* RESTRICT soa)
+{
+    const long n = (long) num_sources * (long) num_stations;
+#pragma omp parallel for
+    for (long j = 0; j < n; ++j)
+    {
+        soa[AR * n + j] = jones[j].a.x; soa[AI * n + j] = jones[j].a.y;
+        soa[BR * n + j] = jones[j].b.x; soa[BI * n + j] = jones[j].b.y;
+        soa[CR * n + j] = jones[j].c.x; soa[CI * n + j] = jones[j].c.y;
+        soa[DR * n + j] = jones[j].d.x; soa[DI * n + j] = jones[j].d.y;
+    }
+}
+
+// Per-baseline terms and accumulators for a tile of baselines.
+template<typename REAL>
+struct XcorrBaseline
+{
+    REAL uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+    REAL sum[NUM_COMPONENTS], guard[NUM_COMPONENTS];
+    int use;
+};
+
+#define XCORR_TILE_ARGS(REAL, REAL4c)                                       \
+        const int q0, const int p0, const int tile_stations,                \
+        const int tile_sources, XcorrBaseline<REAL>* RESTRICT baselines,    \
+        const int num_sources, const int num_stations,                      \
+        const int offset_out, const REAL* const RESTRICT jones,             \
+        const REAL* const RESTRICT source_I,                                \
+        const REAL* const RESTRICT source_Q,                                \
+        const REAL* const RESTRICT source_U,                                \
+        const REAL* const RESTRICT source_V,                                \
+        const REAL* const RESTRICT source_l,                                \
+        const REAL* const RESTRICT source_m,                                \
+        const REAL* const RESTRICT source_n,                                \
+        const REAL* const RESTRICT source_a,                                \
+        const REAL* const RESTRICT source_b,                                \
+        const REAL* const RESTRICT source_c,                                \
+        const REAL* const RESTRICT station_u,                               \
+        const REAL* const RESTRICT station_v,                               \
+        const REAL* const RESTRICT station_w,                               \
+        const REAL* const RESTRICT station_x,                               \
+        const REAL* const RESTRICT station_y,                               \
+        const REAL uv_min_lambda, const REAL uv_max_lambda,                 \
+        const REAL inv_wavelength, const REAL frac_bandwidth,               \
+        const REAL time_int_sec, const REAL gha0_rad, const REAL dec0_rad,  \
+        REAL4c* RESTRICT vis
+
+#define XCORR_TILE_PARAMS                                                   \
+        q0, p0, tile_stations, tile_sources, baselines,                     \
+        num_sources, num_stations, offset_out, jones,                       \
+        source_I, source_Q, source_U, source_V,                             \
+        source_l, source_m, source_n, source_a, source_b, source_c,         \
+        station_u, station_v, station_w, station_x, station_y,              \
+        uv_min_lambda, uv_max_lambda, inv_wavelength, frac_bandwidth,       \
+        time_int_sec, gha0_rad, dec0_rad, vis
+
+#define XCORR_BLOCK_ARGS(REAL)                                              \
+        const int j0, const int j1, const long n,                           \
+        const XcorrBaseline<REAL>* RESTRICT b,                              \
+        const REAL* const RESTRICT p, const REAL* const RESTRICT q,         \
+        const REAL* const RESTRICT source_I,                                \
+        const REAL* const RESTRICT source_Q,                                \
+        const REAL* const RESTRICT source_U,                                \
+        const REAL* const RESTRICT source_V,                                \
+        const REAL* const RESTRICT source_l,                                \
+        const REAL* const RESTRICT source_m,                                \
+        const REAL* const RESTRICT source_n,                                \
+        const REAL* const RESTRICT source_a,                                \
+        const REAL* const RESTRICT source_b,                                \
+        const REAL* const RESTRICT source_c,                                \
+        REAL* RESTRICT s
+
+#define XCORR_BLOCK_SOURCES                                                 \
+        source_I, source_Q, source_U, source_V, source_l, source_m,         \
+        source_n, source_a, source_b, source_c
+
+#define XCORR_BLOCK_PARAMS                                                  \
+        j0, j1, n, b, p, q, XCORR_BLOCK_SOURCES, s
+
+// Sums the contributions of sources j0 to (j1 - 1) to baseline b,
+// and writes the partial sums to s.
+// The tile function calls this through a separate (not inlined) function
+// for each instruction set, so that there is only one vectorised copy of
+// the loop, and the order of summation does not depend on the tile size.
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, typename REAL
+>
+static ALWAYS_INLINE void oskar_xcorr_block(XCORR_BLOCK_ARGS(REAL))
+{
+    const REAL uu = b->uu, vv = b->vv, ww = b->ww;
+    const REAL uu2 = b->uu2, vv2 = b->vv2, uuvv = b->uuvv;
+    const REAL du = b->du, dv = b->dv, dw = b->dw;
+    REAL s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    REAL s4 = 0, s5 = 0, s6 = 0, s7 = 0;
+    OMP_SIMD_SUM
+    for (int i = j0; i < j1; ++i)
+    {
+        REAL smearing;
+        if (GAUSSIAN)
+        {
+            const REAL t = source_a[i] * uu2 +
+                    source_b[i] * uuvv + source_c[i] * vv2;
+            smearing = oskar_vexp((REAL) -t);
+        }
+        else smearing = (REAL) 1;
+        if (BANDWIDTH_SMEARING || TIME_SMEARING)
+        {
+            const REAL l = source_l[i];
+            const REAL m = source_m[i];
+            const REAL n_ = source_n[i] - (REAL) 1;
+            if (BANDWIDTH_SMEARING)
+            {
+                const REAL t = uu * l + vv * m + ww * n_;
+                smearing *= oskar_vsinc(t);
+            }
+            if (TIME_SMEARING)
+            {
+                const REAL t = du * l + dv * m + dw * n_;
+                smearing *= oskar_vsinc(t);
+            }
+        }
+
+        // Source brightness matrix
+        // B = [I + Q, U + iV; U - iV, I - Q].
+        const REAL I_Q = source_I[i] + source_Q[i];
+        const REAL I_mQ = source_I[i] - source_Q[i];
+        const REAL U = source_U[i], V = source_V[i];
+
+        // Multiply first Jones matrix with source
+        // brightness matrix.
+        const REAL ar = p[AR * n + i], ai = p[AI * n + i];
+        const REAL br = p[BR * n + i], bi = p[BI * n + i];
+        const REAL cr = p[CR * n + i], ci = p[CI * n + i];
+        const REAL dr = p[DR * n + i], di = p[DI * n + i];
+        const REAL m11r = ar * I_Q + br * U + bi * V;
+        const REAL m11i = ai * I_Q + bi * U - br * V;
+        const REAL m12r = ar * U - ai * V + br * I_mQ;
+        const REAL m12i = ai * U + ar * V + bi * I_mQ;
+        const REAL m21r = cr * I_Q + dr * U + di * V;
+        const REAL m21i = ci * I_Q + di * U - dr * V;
+        const REAL m22r = cr * U - ci * V + dr * I_mQ;
+        const REAL m22i = ci * U + cr * V + di * I_mQ;
+
+        // Multiply result with second (Hermitian
+        // transposed) Jones matrix, multiply by smearing
+        // term and accumulate.
+        const REAL qar = q[AR * n + i], qai = q[AI * n + i];
+        const REAL qbr = q[BR * n + i], qbi = q[BI * n + i];
+        const REAL qcr = q[CR * n + i], qci = q[CI * n + i];
+        const REAL qdr = q[DR * n + i], qdi = q[DI * n + i];
+        s0 += smearing * (m11r * qar + m11i * qai + m12r * qbr + m12i * qbi);
+        s1 += smearing * (m11i * qar - m11r * qai + m12i * qbr - m12r * qbi);
+        s2 += smearing * (m11r * qcr + m11i * qci + m12r * qdr + m12i * qdi);
+        s3 += smearing * (m11i * qcr - m11r * qci + m12i * qdr - m12r * qdi);
+        s4 += smearing * (m21r * qar + m21i * qai + m22r * qbr + m22i * qbi);
+        s5 += smearing * (m21i * qar - m21r * qai + m22i * qbr - m22r * qbi);
+        s6 += smearing * (m21r * qcr + m21i * qci + m22r * qdr + m22i * qdi);
+        s7 += smearing * (m21i * qcr - m21r * qci + m22i * qdr - m22r * qdi);
+    }
+    s[AR] = s0; s[AI] = s1; s[BR] = s2; s[BI] = s3;
+    s[CR] = s4; s[CI] = s5; s[DR] = s6; s[DI] = s7;
+}
+
+// Correlates the stations in the tile starting at q0 with those in the
+// tile starting at p0, for all baselines with SP > SQ.
+// Sources are processed in blocks of tile_sources, so that the Jones data
+// for the block is reused from cache by all baselines in the tile.
+// Each SIMD block of sources is summed by the given block function.
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL4c
+>
+static ALWAYS_INLINE void oskar_xcorr_tile(XCORR_TILE_ARGS(REAL, REAL4c),
+        void (*block)(XCORR_BLOCK_ARGS(REAL)))
+{
+    const long n = (long) num_sources * (long) num_stations;
+    const int q1 = (q0 + tile_stations < num_stations) ?
+            q0 + tile_stations : num_stations;
+    const int p1 = (p0 + tile_stations < num_stations) ?
+            p0 + tile_stations : num_stations;
+
+    // Set up the baselines in the tile.
+    for (int SQ = q0; SQ < q1; ++SQ)
+    {
+        for (int SP = p0; SP < p1; ++SP)
+        {
+            XcorrBaseline<REAL>* RESTRICT b =
+                    &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+            REAL uv_len;
+            b->use = 0;
+            if (SP <= SQ) continue;
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ],
+                    station_w[SP], station_w[SQ],
+                    b->uu, b->vv, b->ww, b->uu2, b->vv2, b->uuvv, uv_len);
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            b->du = b->dv = b->dw = 0;
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], b->du, b->dv, b->dw);
+            for (int k = 0; k < NUM_COMPONENTS; ++k)
+                b->sum[k] = b->guard[k] = 0;
+            b->use = 1;
+        }
+    }
+
+    // Loop over blocks of sources.
+    for (int i0 = 0; i0 < num_sources; i0 += tile_sources)
+    {
+        const int i1 = (i0 + tile_sources < num_sources) ?
+                i0 + tile_sources : num_sources;
+
+        // Loop over baselines in the tile.
+        for (int SQ = q0; SQ < q1; ++SQ)
+        {
+            // Pointer to source vector for station q.
+            const REAL* const RESTRICT q = &jones[SQ * num_sources];
+
+            for (int SP = (p0 > SQ ? p0 : SQ + 1); SP < p1; ++SP)
+            {
+                XcorrBaseline<REAL>* RESTRICT b =
+                        &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+                if (!b->use) continue;
+
+                // Pointer to source vector for station p.
+                const REAL* const RESTRICT p = &jones[SP * num_sources];
+
+                // Loop over SIMD blocks within this block of sources.
+                for (int j0 = i0; j0 < i1; j0 += XCORR_BLOCK)
+                {
+                    const int j1 = (j0 + XCORR_BLOCK < i1) ?
+                            j0 + XCORR_BLOCK : i1;
+                    REAL s[NUM_COMPONENTS];
+                    block(XCORR_BLOCK_PARAMS);
+
+                    // Add partial sums for this block.
+                    REAL* const RESTRICT sum = b->sum;
+                    REAL* const RESTRICT guard = b->guard;
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM(REAL, sum[AR], s[AR], guard[AR])
+                        OSKAR_KAHAN_SUM(REAL, sum[AI], s[AI], guard[AI])
+                        OSKAR_KAHAN_SUM(REAL, sum[BR], s[BR], guard[BR])
+                        OSKAR_KAHAN_SUM(REAL, sum[BI], s[BI], guard[BI])
+                        OSKAR_KAHAN_SUM(REAL, sum[CR], s[CR], guard[CR])
+                        OSKAR_KAHAN_SUM(REAL, sum[CI], s[CI], guard[CI])
+                        OSKAR_KAHAN_SUM(REAL, sum[DR], s[DR], guard[DR])
+                        OSKAR_KAHAN_SUM(REAL, sum[DI], s[DI], guard[DI])
+                    }
+                    else
+                    {
+                        for (int k = 0; k < NUM_COMPONENTS; ++k)
+                            sum[k] += s[k];
+                    }
+                }
+            }
+        }
+    }
+
+    // Add results to the baseline visibilities.
+    // (Access as an array of reals, as the output is not guaranteed
+    // to have the full alignment of the matrix type.)
+    for (int SQ = q0; SQ < q1; ++SQ)
+    {
+        for (int SP = (p0 > SQ ? p0 : SQ + 1); SP < p1; ++SP)
+        {
+            const XcorrBaseline<REAL>* RESTRICT b =
+                    &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+            if (!b->use) continue;
+            const int j = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            REAL* const RESTRICT out = (REAL*) &vis[j];
+            for (int k = 0; k < NUM_COMPONENTS; ++k) out[k] += b->sum[k];
+        }
+    }
+}
+
+// Versions of the tile function compiled for each instruction set.
+#define XCORR_TILE_ISA(NAME, TARGET)                                        \
+template                                                                    \
+<                                                                           \
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, typename REAL   \
+>                                                                           \
+TARGET static NOINLINE void NAME##_block(XCORR_BLOCK_ARGS(REAL))            \
+{                                                                           \
+    oskar_xcorr_block<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,          \
+            REAL>(XCORR_BLOCK_PARAMS);                                      \
+}                                                                           \
+template                                                                    \
+<                                                                           \
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,                 \
+typename REAL, typename REAL4c                                              \
+>                                                                           \
+TARGET static void NAME(XCORR_TILE_ARGS(REAL, REAL4c))                      \
+{                                                                           \
+    oskar_xcorr_tile<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,           \
+            REAL, REAL4c>(XCORR_TILE_PARAMS,                                \
+            NAME##_block<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,       \
+                    REAL>);                                                 \
+}
+
+XCORR_TILE_ISA(oskar_xcorr_tile_generic, )
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+XCORR_TILE_ISA(oskar_xcorr_tile_sse4, OSKAR_TARGET_SSE4)
+XCORR_TILE_ISA(oskar_xcorr_tile_avx2, OSKAR_TARGET_AVX2)
+XCORR_TILE_ISA(oskar_xcorr_tile_avx512, OSKAR_TARGET_AVX512)
+#endif
+
 template
 <
 // Compile-time parameters.
@@ -57,7 +414,7 @@ void oskar_xcorr_omp(
         const int                    num_sources,
         const int                    num_stations,
         const int                    offset_out,
-        const REAL4c* const RESTRICT jones,
+        const REAL4c* const RESTRICT jones_in,
         const REAL*   const RESTRICT source_I,
         const REAL*   const RESTRICT source_Q,
         const REAL*   const RESTRICT source_U,
@@ -80,95 +437,75 @@ void oskar_xcorr_omp(
         const REAL                   time_int_sec,
         const REAL                   gha0_rad,
         const REAL                   dec0_rad,
-        REAL4c*             RESTRICT vis)
+        REAL4c*             RESTRICT vis,
+        oskar_Mem*                   work,
+        int*                         status)
 {
-    // Loop over stations.
-#pragma omp parallel for schedule(dynamic, 1)
-    for (int SQ = 0; SQ < num_stations; ++SQ)
-    {
-        // Pointer to source vector for station q.
-        const REAL4c* const station_q = &jones[SQ * num_sources];
+    int tile_stations = 0, tile_sources = 0, num_threads = 1;
+    if (*status || num_sources <= 0 || num_stations <= 1) return;
+    const int isa = oskar_cpu_isa();
 
-        // Loop over baselines for this station.
-        for (int SP = SQ + 1; SP < num_stations; ++SP)
-        {
-            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
-            REAL4c m1, m2, sum, guard;
-            OSKAR_CLEAR_COMPLEX_MATRIX(REAL, sum)
-            if (is_same<REAL, float>::value)
-                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, guard)
+    // Get the tile sizes.
+    // Source blocks are a multiple of the SIMD block size, so that the
+    // order of summation does not depend on the tile size.
+    oskar_cross_correlate_tile_size(num_sources, num_stations,
+            NUM_COMPONENTS * sizeof(REAL), &tile_stations, &tile_sources);
+    tile_sources = XCORR_BLOCK *
+            ((tile_sources + XCORR_BLOCK - 1) / XCORR_BLOCK);
+    const int num_tiles = (num_stations + tile_stations - 1) / tile_stations;
+    const int num_tile_pairs = num_tiles * (num_tiles + 1) / 2;
 
-            // Pointer to source vector for station p.
-            const REAL4c* const station_p = &jones[SP * num_sources];
+    // Get the work buffer, which holds the Jones matrices in
+    // structure-of-arrays form, followed by a baseline list per thread.
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    const size_t soa_bytes = NUM_COMPONENTS * sizeof(REAL) *
+            (size_t) num_sources * (size_t) num_stations;
+    const size_t baselines_offset = XCORR_ALIGN *
+            ((soa_bytes + XCORR_ALIGN - 1) / XCORR_ALIGN);
+    const size_t baselines_per_thread =
+            (size_t) tile_stations * (size_t) tile_stations;
+    char* buffer = (char*) oskar_cross_correlate_work_buffer(work,
+            baselines_offset + num_threads * baselines_per_thread *
+            sizeof(XcorrBaseline<REAL>), status);
+    if (*status) return;
+    REAL* jones = (REAL*) buffer;
+    jones_to_soa<REAL, REAL4c>(num_sources, num_stations, jones_in, jones);
 
-            // Get common baseline values.
-            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
-                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
-                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
-
-            // Apply the baseline length filter.
-            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
-
-            // Compute the deltas for time-average smearing.
-            if (TIME_SMEARING)
-                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
-                        station_y[SP], station_y[SQ], du, dv, dw);
-
-            // Loop over sources.
-            for (int i = 0; i < num_sources; ++i)
-            {
-                REAL smearing;
-                if (GAUSSIAN)
-                {
-                    const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +
-                            source_c[i] * vv2;
-                    smearing = exp((REAL) -t);
-                }
-                else smearing = (REAL) 1;
-                if (BANDWIDTH_SMEARING || TIME_SMEARING)
-                {
-                    const REAL l = source_l[i];
-                    const REAL m = source_m[i];
-                    const REAL n = source_n[i] - (REAL) 1;
-                    if (BANDWIDTH_SMEARING)
-                    {
-                        const REAL t = uu * l + vv * m + ww * n;
-                        smearing *= OSKAR_SINC(REAL, t);
-                    }
-                    if (TIME_SMEARING)
-                    {
-                        const REAL t = du * l + dv * m + dw * n;
-                        smearing *= OSKAR_SINC(REAL, t);
-                    }
-                }
-
-                // Construct source brightness matrix.
-                OSKAR_CONSTRUCT_B(REAL, m2,
-                        source_I[i], source_Q[i], source_U[i], source_V[i])
-
-                // Multiply first Jones matrix with source brightness matrix.
-                OSKAR_LOAD_MATRIX(m1, station_p[i])
-                OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
-
-                // Multiply result with second (Hermitian transposed) Jones matrix.
-                OSKAR_LOAD_MATRIX(m2, station_q[i])
-                OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
-
-                // Multiply result by smearing term and accumulate.
-                if (is_same<REAL, float>::value)
-                {
-                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX_MATRIX(
-                            REAL, sum, m1, smearing, guard)
-                }
-                else
-                {
-                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum, m1, smearing)
-                }
-            }
-
-            // Add result to the baseline visibility.
-            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
-            OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(vis[i], sum);
+    // Loop over pairs of station tiles.
+#pragma omp parallel num_threads(num_threads)
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        XcorrBaseline<REAL>* baselines = (XcorrBaseline<REAL>*) (
+                buffer + baselines_offset) + thread * baselines_per_thread;
+#pragma omp for schedule(dynamic, 1)
+        for (int t = 0; t < num_tile_pairs; ++t)
+        {
+            // Get the tile indices, with tile_p >= tile_q.
+            int tile_q = 0, tile_p = t;
+            while (tile_p >= num_tiles - tile_q)
+                tile_p -= (num_tiles - tile_q++);
+            tile_p += tile_q;
+            const int q0 = tile_q * tile_stations;
+            const int p0 = tile_p * tile_stations;
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+            if (isa >= OSKAR_CPU_ISA_AVX512)
+                oskar_xcorr_tile_avx512<BANDWIDTH_SMEARING, TIME_SMEARING,
+                        GAUSSIAN, REAL, REAL4c>(XCORR_TILE_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_AVX2)
+                oskar_xcorr_tile_avx2<BANDWIDTH_SMEARING, TIME_SMEARING,
+                        GAUSSIAN, REAL, REAL4c>(XCORR_TILE_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_SSE4)
+                oskar_xcorr_tile_sse4<BANDWIDTH_SMEARING, TIME_SMEARING,
+                        GAUSSIAN, REAL, REAL4c>(XCORR_TILE_PARAMS);
+            else
+#endif
+                oskar_xcorr_tile_generic<BANDWIDTH_SMEARING, TIME_SMEARING,
+                        GAUSSIAN, REAL, REAL4c>(XCORR_TILE_PARAMS);
         }
     }
 }
@@ -180,7 +517,7 @@ void oskar_xcorr_omp(
                 d_station_u, d_station_v, d_station_w,                      \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, d_vis, work, status);
 
 #define XCORR_SELECT(GAUSSIAN, REAL, REAL2, REAL4c)                         \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
@@ -202,7 +539,7 @@ void oskar_cross_correlate_point_omp_f(
         const float* d_station_x, const float* d_station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* d_vis)
+        float dec0_rad, float4c* d_vis, oskar_Mem* work, int* status)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, float, float2, float4c)
@@ -218,7 +555,7 @@ void oskar_cross_correlate_point_omp_d(
         const double* d_station_x, const double* d_station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* d_vis)
+        double dec0_rad, double4c* d_vis, oskar_Mem* work, int* status)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, double, double2, double4c)
@@ -234,7 +571,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* d_station_w, const float* d_station_x,
         const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* d_vis)
+        float gha0_rad, float dec0_rad, float4c* d_vis, oskar_Mem* work,
+        int* status)
 {
     XCORR_SELECT(true, float, float2, float4c)
 }
@@ -249,7 +587,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* d_station_w, const double* d_station_x,
         const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* d_vis)
+        double gha0_rad, double dec0_rad, double4c* d_vis, oskar_Mem* work,
+        int* status)
 {
     XCORR_SELECT(true, double, double2, double4c)
 }
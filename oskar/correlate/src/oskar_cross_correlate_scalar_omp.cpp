@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,11 +28,20 @@
 
 #include "correlate/define_correlate_utils.h"
 #include "correlate/oskar_cross_correlate_scalar_omp.h"
+#include "correlate/oskar_cross_correlate_tile_size.h"
+#include "correlate/oskar_cross_correlate_work_buffer.h"
 #include "math/define_multiply.h"
 #include "math/oskar_kahan_sum.h"
+#include "math/oskar_vmath.h"
+#include "utility/oskar_cpu_isa.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
-#include <stdio.h>
+
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 template<typename T1, typename T2>
 struct is_same
@@ -48,6 +57,300 @@ struct is_same<T,T>
     typedef is_same<T,T> type;
 };
 
+#if defined(__GNUC__) || defined(__clang__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#define NOINLINE __attribute__((noinline))
+#else
+#define ALWAYS_INLINE inline
+#define NOINLINE
+#endif
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define OMP_SIMD_SUM _Pragma("omp simd reduction(+:s0,s1)")
+#else
+#define OMP_SIMD_SUM
+#endif
+
+// Number of sources summed in each SIMD block.
+// Partial sums of each block are combined using Kahan summation
+// in single precision.
+#define XCORR_BLOCK 128
+
+// Alignment of the baseline lists in the work buffer, in bytes.
+#define XCORR_ALIGN 64
+
+// Copies the Jones scalars into structure-of-arrays form, so that the
+// real and imaginary parts are each contiguous in memory.
+template<typename REAL, typename REAL2>
+static void jones_to_soa(const int num_sources, const int num_stations,
+        const REAL2* const RESTRICT jones, REAL* RESTRICT soa)
+{
+    const long n = (long) num_sources * (long) num_stations;
+#pragma omp parallel for
+    for (long j = 0; j < n; ++j)
+    {
+        soa[j] = jones[j].x;
+        soa[n + j] = jones[j].y;
+    }
+}
+
+// Per-baseline terms and accumulators for a tile of baselines.
+template<typename REAL>
+struct XcorrBaseline
+{
+    REAL uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+    REAL sum[2], guard[2];
+    int use;
+};
+
+#define XCORR_TILE_ARGS(REAL, REAL2)                                        \
+        const int q0, const int p0, const int tile_stations,                \
+        const int tile_sources, XcorrBaseline<REAL>* RESTRICT baselines,    \
+        const int num_sources, const int num_stations,                      \
+        const int offset_out, const REAL* const RESTRICT jones,             \
+        const REAL* const RESTRICT source_I,                                \
+        const REAL* const RESTRICT source_l,                                \
+        const REAL* const RESTRICT source_m,                                \
+        const REAL* const RESTRICT source_n,                                \
+        const REAL* const RESTRICT source_a,                                \
+        const REAL* const RESTRICT source_b,                                \
+        const REAL* const RESTRICT source_c,                                \
+        const REAL* const RESTRICT station_u,                               \
+        const REAL* const RESTRICT station_v,                               \
+        const REAL* const RESTRICT station_w,                               \
+        const REAL* const RESTRICT station_x,                               \
+        const REAL* const RESTRICT station_y,                               \
+        const REAL uv_min_lambda, const REAL uv_max_lambda,                 \
+        const REAL inv_wavelength, const REAL frac_bandwidth,               \
+        const REAL time_int_sec, const REAL gha0_rad, const REAL dec0_rad,  \
+        REAL2* RESTRICT vis
+
+#define XCORR_TILE_PARAMS                                                   \
+        q0, p0, tile_stations, tile_sources, baselines,                     \
+        num_sources, num_stations, offset_out, jones, source_I,             \
+        source_l, source_m, source_n, source_a, source_b, source_c,         \
+        station_u, station_v, station_w, station_x, station_y,              \
+        uv_min_lambda, uv_max_lambda, inv_wavelength, frac_bandwidth,       \
+        time_int_sec, gha0_rad, dec0_rad, vis
+
+#define XCORR_BLOCK_ARGS(REAL)                                              \
+        const int j0, const int j1, const long n,                           \
+        const XcorrBaseline<REAL>* RESTRICT b,                              \
+        const REAL* const RESTRICT p, const REAL* const RESTRICT q,         \
+        const REAL* const RESTRICT source_I,                                \
+        const REAL* const RESTRICT source_l,                                \
+        const REAL* const RESTRICT source_m,                                \
+        const REAL* const RESTRICT source_n,                                \
+        const REAL* const RESTRICT source_a,                                \
+        const REAL* const RESTRICT source_b,                                \
+        const REAL* const RESTRICT source_c,                                \
+        REAL* RESTRICT s
+
+#define XCORR_BLOCK_SOURCES                                                 \
+        source_I, source_l, source_m, source_n, source_a, source_b,         \
+        source_c
+
+#define XCORR_BLOCK_PARAMS                                                  \
+        j0, j1, n, b, p, q, XCORR_BLOCK_SOURCES, s
+
+// Sums the contributions of sources j0 to (j1 - 1) to baseline b,
+// and writes the partial sums to s.
+// The tile function calls this through a separate (not inlined) function
+// for each instruction set, so that there is only one vectorised copy of
+// the loop, and the order of summation does not depend on the tile size.
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, typename REAL
+>
+static ALWAYS_INLINE void oskar_xcorr_scalar_block(XCORR_BLOCK_ARGS(REAL))
+{
+    const REAL uu = b->uu, vv = b->vv, ww = b->ww;
+    const REAL uu2 = b->uu2, vv2 = b->vv2, uuvv = b->uuvv;
+    const REAL du = b->du, dv = b->dv, dw = b->dw;
+    REAL s0 = 0, s1 = 0;
+    OMP_SIMD_SUM
+    for (int i = j0; i < j1; ++i)
+    {
+        REAL smearing;
+        if (GAUSSIAN)
+        {
+            const REAL t = source_a[i] * uu2 +
+                    source_b[i] * uuvv + source_c[i] * vv2;
+            smearing = oskar_vexp((REAL) -t);
+        }
+        else smearing = (REAL) 1;
+        smearing *= source_I[i];
+        if (BANDWIDTH_SMEARING || TIME_SMEARING)
+        {
+            const REAL l = source_l[i];
+            const REAL m = source_m[i];
+            const REAL n_ = source_n[i] - (REAL) 1;
+            if (BANDWIDTH_SMEARING)
+            {
+                const REAL t = uu * l + vv * m + ww * n_;
+                smearing *= oskar_vsinc(t);
+            }
+            if (TIME_SMEARING)
+            {
+                const REAL t = du * l + dv * m + dw * n_;
+                smearing *= oskar_vsinc(t);
+            }
+        }
+
+        // Multiply Jones scalars, multiply by smearing term
+        // and accumulate.
+        const REAL pr = p[i], pi = p[n + i];
+        const REAL qr = q[i], qi = q[n + i];
+        s0 += smearing * (pr * qr + pi * qi);
+        s1 += smearing * (pi * qr - pr * qi);
+    }
+    s[0] = s0;
+    s[1] = s1;
+}
+
+// Correlates the stations in the tile starting at q0 with those in the
+// tile starting at p0, for all baselines with SP > SQ.
+// Sources are processed in blocks of tile_sources, so that the Jones data
+// for the block is reused from cache by all baselines in the tile.
+// Each SIMD block of sources is summed by the given block function.
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2
+>
+static ALWAYS_INLINE void oskar_xcorr_scalar_tile(XCORR_TILE_ARGS(REAL, REAL2),
+        void (*block)(XCORR_BLOCK_ARGS(REAL)))
+{
+    const long n = (long) num_sources * (long) num_stations;
+    const int q1 = (q0 + tile_stations < num_stations) ?
+            q0 + tile_stations : num_stations;
+    const int p1 = (p0 + tile_stations < num_stations) ?
+            p0 + tile_stations : num_stations;
+
+    // Set up the baselines in the tile.
+    for (int SQ = q0; SQ < q1; ++SQ)
+    {
+        for (int SP = p0; SP < p1; ++SP)
+        {
+            XcorrBaseline<REAL>* RESTRICT b =
+                    &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+            REAL uv_len;
+            b->use = 0;
+            if (SP <= SQ) continue;
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ],
+                    station_w[SP], station_w[SQ],
+                    b->uu, b->vv, b->ww, b->uu2, b->vv2, b->uuvv, uv_len);
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            b->du = b->dv = b->dw = 0;
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], b->du, b->dv, b->dw);
+            b->sum[0] = b->sum[1] = b->guard[0] = b->guard[1] = 0;
+            b->use = 1;
+        }
+    }
+
+    // Loop over blocks of sources.
+    for (int i0 = 0; i0 < num_sources; i0 += tile_sources)
+    {
+        const int i1 = (i0 + tile_sources < num_sources) ?
+                i0 + tile_sources : num_sources;
+
+        // Loop over baselines in the tile.
+        for (int SQ = q0; SQ < q1; ++SQ)
+        {
+            // Pointer to source vector for station q.
+            const REAL* const RESTRICT q = &jones[SQ * num_sources];
+
+            for (int SP = (p0 > SQ ? p0 : SQ + 1); SP < p1; ++SP)
+            {
+                XcorrBaseline<REAL>* RESTRICT b =
+                        &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+                if (!b->use) continue;
+
+                // Pointer to source vector for station p.
+                const REAL* const RESTRICT p = &jones[SP * num_sources];
+
+                // Loop over SIMD blocks within this block of sources.
+                for (int j0 = i0; j0 < i1; j0 += XCORR_BLOCK)
+                {
+                    const int j1 = (j0 + XCORR_BLOCK < i1) ?
+                            j0 + XCORR_BLOCK : i1;
+                    REAL s[2];
+                    block(XCORR_BLOCK_PARAMS);
+
+                    // Add partial sums for this block.
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM(REAL, b->sum[0], s[0], b->guard[0])
+                        OSKAR_KAHAN_SUM(REAL, b->sum[1], s[1], b->guard[1])
+                    }
+                    else
+                    {
+                        b->sum[0] += s[0];
+                        b->sum[1] += s[1];
+                    }
+                }
+            }
+        }
+    }
+
+    // Add results to the baseline visibilities.
+    for (int SQ = q0; SQ < q1; ++SQ)
+    {
+        for (int SP = (p0 > SQ ? p0 : SQ + 1); SP < p1; ++SP)
+        {
+            const XcorrBaseline<REAL>* RESTRICT b =
+                    &baselines[(SQ - q0) * tile_stations + (SP - p0)];
+            if (!b->use) continue;
+            const int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            vis[i].x += b->sum[0];
+            vis[i].y += b->sum[1];
+        }
+    }
+}
+
+// Versions of the tile function compiled for each instruction set.
+#define XCORR_TILE_ISA(NAME, TARGET)                                        \
+template                                                                    \
+<                                                                           \
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, typename REAL   \
+>                                                                           \
+TARGET static NOINLINE void NAME##_block(XCORR_BLOCK_ARGS(REAL))            \
+{                                                                           \
+    oskar_xcorr_scalar_block<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,   \
+            REAL>(XCORR_BLOCK_PARAMS);                                      \
+}                                                                           \
+template                                                                    \
+<                                                                           \
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,                 \
+typename REAL, typename REAL2                                               \
+>                                                                           \
+TARGET static void NAME(XCORR_TILE_ARGS(REAL, REAL2))                       \
+{                                                                           \
+    oskar_xcorr_scalar_tile<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,    \
+            REAL, REAL2>(XCORR_TILE_PARAMS,                                 \
+            NAME##_block<BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN,       \
+                    REAL>);                                                 \
+}
+
+XCORR_TILE_ISA(oskar_xcorr_scalar_tile_generic, )
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+XCORR_TILE_ISA(oskar_xcorr_scalar_tile_sse4, OSKAR_TARGET_SSE4)
+XCORR_TILE_ISA(oskar_xcorr_scalar_tile_avx2, OSKAR_TARGET_AVX2)
+XCORR_TILE_ISA(oskar_xcorr_scalar_tile_avx512, OSKAR_TARGET_AVX512)
+#endif
+
 template
 <
 // Compile-time parameters.
@@ -58,7 +361,7 @@ void oskar_xcorr_scalar_omp(
         const int                   num_sources,
         const int                   num_stations,
         const int                   offset_out,
-        const REAL2* const RESTRICT jones,
+        const REAL2* const RESTRICT jones_in,
         const REAL*  const RESTRICT source_I,
         const REAL*  const RESTRICT source_l,
         const REAL*  const RESTRICT source_m,
@@ -78,94 +381,79 @@ void oskar_xcorr_scalar_omp(
         const REAL                  time_int_sec,
         const REAL                  gha0_rad,
         const REAL                  dec0_rad,
-        REAL2*             RESTRICT vis)
+        REAL2*             RESTRICT vis,
+        oskar_Mem*                  work,
+        int*                        status)
 {
-    // Loop over stations.
-#pragma omp parallel for schedule(dynamic, 1)
-    for (int SQ = 0; SQ < num_stations; ++SQ)
-    {
-        // Pointer to source vector for station q.
-        const REAL2* const station_q = &jones[SQ * num_sources];
-
-        // Loop over baselines for this station.
-        for (int SP = SQ + 1; SP < num_stations; ++SP)
-        {
-            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
-            REAL2 t1, t2, sum, guard;
-            sum.x = sum.y = (REAL) 0;
-            if (is_same<REAL, float>::value)
-                guard.x = guard.y = (REAL) 0;
+    int tile_stations = 0, tile_sources = 0, num_threads = 1;
+    if (*status || num_sources <= 0 || num_stations <= 1) return;
+    const int isa = oskar_cpu_isa();
 
-            // Pointer to source vector for station p.
-            const REAL2* const station_p = &jones[SP * num_sources];
+    // Get the tile sizes.
+    // Source blocks are a multiple of the SIMD block size, so that the
+    // order of summation does not depend on the tile size.
+    oskar_cross_correlate_tile_size(num_sources, num_stations,
+            2 * sizeof(REAL), &tile_stations, &tile_sources);
+    tile_sources = XCORR_BLOCK *
+            ((tile_sources + XCORR_BLOCK - 1) / XCORR_BLOCK);
+    const int num_tiles = (num_stations + tile_stations - 1) / tile_stations;
+    const int num_tile_pairs = num_tiles * (num_tiles + 1) / 2;
 
-            // Get common baseline values.
-            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
-                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
-                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
-
-            // Apply the baseline length filter.
-            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
-
-            // Compute the deltas for time-average smearing.
-            if (TIME_SMEARING)
-                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
-                        station_y[SP], station_y[SQ], du, dv, dw);
-
-            // Loop over sources.
-            for (int i = 0; i < num_sources; ++i)
-            {
-                REAL smearing;
-                if (GAUSSIAN)
-                {
-                    const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +
-                            source_c[i] * vv2;
-                    smearing = exp((REAL) -t);
-                }
-                else
-                {
-                    smearing = (REAL) 1;
-                }
-                smearing *= source_I[i];
-                if (BANDWIDTH_SMEARING || TIME_SMEARING)
-                {
-                    const REAL l = source_l[i];
-                    const REAL m = source_m[i];
-                    const REAL n = source_n[i] - (REAL) 1;
-                    if (BANDWIDTH_SMEARING)
-                    {
-                        const REAL t = uu * l + vv * m + ww * n;
-                        smearing *= OSKAR_SINC(REAL, t);
-                    }
-                    if (TIME_SMEARING)
-                    {
-                        const REAL t = du * l + dv * m + dw * n;
-                        smearing *= OSKAR_SINC(REAL, t);
-                    }
-                }
+    // Get the work buffer, which holds the Jones scalars in
+    // structure-of-arrays form, followed by a baseline list per thread.
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    const size_t soa_bytes = 2 * sizeof(REAL) *
+            (size_t) num_sources * (size_t) num_stations;
+    const size_t baselines_offset = XCORR_ALIGN *
+            ((soa_bytes + XCORR_ALIGN - 1) / XCORR_ALIGN);
+    const size_t baselines_per_thread =
+            (size_t) tile_stations * (size_t) tile_stations;
+    char* buffer = (char*) oskar_cross_correlate_work_buffer(work,
+            baselines_offset + num_threads * baselines_per_thread *
+            sizeof(XcorrBaseline<REAL>), status);
+    if (*status) return;
+    REAL* jones = (REAL*) buffer;
+    jones_to_soa<REAL, REAL2>(num_sources, num_stations, jones_in, jones);
 
-                // Multiply Jones scalars.
-                t1 = station_p[i];
-                t2 = station_q[i];
-                OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
-
-                // Multiply result by smearing term and accumulate.
-                if (is_same<REAL, float>::value)
-                {
-                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX(
-                            REAL, sum, t1, smearing, guard)
-                }
-                else
-                {
-                    sum.x += t1.x * smearing;
-                    sum.y += t1.y * smearing;
-                }
-            }
-
-            // Add result to the baseline visibility.
-            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
-            vis[i].x += sum.x;
-            vis[i].y += sum.y;
+    // Loop over pairs of station tiles.
+#pragma omp parallel num_threads(num_threads)
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        XcorrBaseline<REAL>* baselines = (XcorrBaseline<REAL>*) (
+                buffer + baselines_offset) + thread * baselines_per_thread;
+#pragma omp for schedule(dynamic, 1)
+        for (int t = 0; t < num_tile_pairs; ++t)
+        {
+            // Get the tile indices, with tile_p >= tile_q.
+            int tile_q = 0, tile_p = t;
+            while (tile_p >= num_tiles - tile_q)
+                tile_p -= (num_tiles - tile_q++);
+            tile_p += tile_q;
+            const int q0 = tile_q * tile_stations;
+            const int p0 = tile_p * tile_stations;
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+            if (isa >= OSKAR_CPU_ISA_AVX512)
+                oskar_xcorr_scalar_tile_avx512<BANDWIDTH_SMEARING,
+                        TIME_SMEARING, GAUSSIAN, REAL, REAL2>(
+                                XCORR_TILE_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_AVX2)
+                oskar_xcorr_scalar_tile_avx2<BANDWIDTH_SMEARING,
+                        TIME_SMEARING, GAUSSIAN, REAL, REAL2>(
+                                XCORR_TILE_PARAMS);
+            else if (isa == OSKAR_CPU_ISA_SSE4)
+                oskar_xcorr_scalar_tile_sse4<BANDWIDTH_SMEARING,
+                        TIME_SMEARING, GAUSSIAN, REAL, REAL2>(
+                                XCORR_TILE_PARAMS);
+            else
+#endif
+                oskar_xcorr_scalar_tile_generic<BANDWIDTH_SMEARING,
+                        TIME_SMEARING, GAUSSIAN, REAL, REAL2>(
+                                XCORR_TILE_PARAMS);
         }
     }
 }
@@ -176,7 +464,7 @@ void oskar_xcorr_scalar_omp(
                 d_a, d_b, d_c, d_station_u, d_station_v, d_station_w,       \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, d_vis, work, status);
 
 #define XCORR_SELECT(GAUSSIAN, REAL, REAL2)                                 \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
@@ -196,7 +484,8 @@ void oskar_cross_correlate_scalar_point_omp_f(
         const float* d_station_w, const float* d_station_x,
         const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, const float time_int_sec,
-        const float gha0_rad, const float dec0_rad, float2* d_vis)
+        const float gha0_rad, const float dec0_rad, float2* d_vis,
+        oskar_Mem* work, int* status)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, float, float2)
@@ -210,7 +499,8 @@ void oskar_cross_correlate_scalar_point_omp_d(
         const double* d_station_w, const double* d_station_x,
         const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, const double time_int_sec,
-        const double gha0_rad, const double dec0_rad, double2* d_vis)
+        const double gha0_rad, const double dec0_rad, double2* d_vis,
+        oskar_Mem* work, int* status)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, double, double2)
@@ -226,7 +516,7 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
         const float* d_station_x, const float* d_station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float2* d_vis)
+        float dec0_rad, float2* d_vis, oskar_Mem* work, int* status)
 {
     XCORR_SELECT(true, float, float2)
 }
@@ -241,7 +531,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_d(
         const double* d_station_x, const double* d_station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double2* d_vis)
+        double dec0_rad, double2* d_vis, oskar_Mem* work,
+        int* status)
 {
     XCORR_SELECT(true, double, double2)
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_cross_correlate_tile_size.h"
+
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if !defined(OSKAR_OS_WIN)
+#include <unistd.h>
+#endif
+
+#define DEFAULT_CACHE_SIZE  262144
+#define DEFAULT_TILE_SOURCES   256
+#define MAX_TILE_STATIONS        8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int cache_size(void)
+{
+    long size = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return (size > 0) ? (int) size : DEFAULT_CACHE_SIZE;
+}
+
+static int env_value(const char* name)
+{
+    const char* env = getenv(name);
+    return env ? atoi(env) : 0;
+}
+
+void oskar_cross_correlate_tile_size(int num_sources, int num_stations,
+        int bytes_per_source, int* tile_stations, int* tile_sources)
+{
+    int num_threads = 1, num_tiles, stations, sources;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    /* Fit the Jones data for two tiles into a quarter of the cache. */
+    sources = DEFAULT_TILE_SOURCES;
+    stations = cache_size() / (8 * sources * bytes_per_source);
+    if (stations > MAX_TILE_STATIONS) stations = MAX_TILE_STATIONS;
+
+    /* Make sure there are enough pairs of tiles to share between threads. */
+    for (; stations > 2; stations /= 2)
+    {
+        num_tiles = (num_stations + stations - 1) / stations;
+        if (num_tiles * (num_tiles + 1) / 2 >= 4 * num_threads) break;
+    }
+    if (stations < 2) stations = 2;
+
+    /* Override using environment variables, if set. */
+    if (env_value("OSKAR_XCORR_TILE_STATIONS") > 0)
+        stations = env_value("OSKAR_XCORR_TILE_STATIONS");
+    if (env_value("OSKAR_XCORR_TILE_SOURCES") > 0)
+        sources = env_value("OSKAR_XCORR_TILE_SOURCES");
+    if (stations > num_stations) stations = num_stations;
+    if (sources > num_sources) sources = num_sources;
+    *tile_stations = stations > 0 ? stations : 1;
+    *tile_sources = sources > 0 ? sources : 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,8 +31,11 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_omp.h"
+#include "correlate/oskar_cross_correlate_scalar_omp.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
+#include <complex>
 #include <cstdlib>
 
 // Comment out this line to disable benchmark timer printing.
@@ -162,7 +165,7 @@ protected:
         oskar_telescope_set_time_average(tel, time_average);
         oskar_timer_start(timer1);
         oskar_cross_correlate(oskar_sky_num_sources(sky), jones, sky,
-                tel, u_, v_, w_, 1.0, frequency, 0, vis1, &status);
+                tel, u_, v_, w_, 1.0, frequency, 0, vis1, 0, &status);
         time1 = oskar_timer_elapsed(timer1);
         destroyTestData();
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
@@ -180,7 +183,7 @@ protected:
         oskar_telescope_set_time_average(tel, time_average);
         oskar_timer_start(timer2);
         oskar_cross_correlate(oskar_sky_num_sources(sky), jones, sky,
-                tel, u_, v_, w_, 1.0, frequency, 0, vis2, &status);
+                tel, u_, v_, w_, 1.0, frequency, 0, vis2, 0, &status);
         time2 = oskar_timer_elapsed(timer2);
         destroyTestData();
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
@@ -384,6 +387,279 @@ TEST_F(cross_correlate, matrix_gaussian_timeSmearing_singleCPU_doubleGPU)
 #endif
 
 
+// Compare CPU version against direct evaluation of J B J^H.
+TEST_F(cross_correlate, matrix_point_reference_CPU)
+{
+    typedef std::complex<double> C;
+    int status = 0;
+    createTestData(OSKAR_DOUBLE, OSKAR_CPU, 1);
+    const int num_baselines = oskar_telescope_num_baselines(tel);
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_baselines, &status);
+    oskar_mem_clear_contents(vis, &status);
+    oskar_cross_correlate(num_sources, jones, sky, tel, u_, v_, w_,
+            1.0, 100e6, 0, vis, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double4c* J = oskar_mem_double4c_const(
+            oskar_jones_mem_const(jones), &status);
+    const double4c* V = oskar_mem_double4c_const(vis, &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    const double* Q = oskar_mem_double_const(oskar_sky_Q_const(sky), &status);
+    const double* U = oskar_mem_double_const(oskar_sky_U_const(sky), &status);
+    const double* V_ = oskar_mem_double_const(oskar_sky_V_const(sky), &status);
+    for (int q = 0, b = 0; q < num_stations; ++q)
+    {
+        for (int p = q + 1; p < num_stations; ++p, ++b)
+        {
+            C sum[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
+            for (int s = 0; s < num_sources; ++s)
+            {
+                const double4c& jp = J[p * num_sources + s];
+                const double4c& jq = J[q * num_sources + s];
+                const C P[2][2] = {
+                        {C(jp.a.x, jp.a.y), C(jp.b.x, jp.b.y)},
+                        {C(jp.c.x, jp.c.y), C(jp.d.x, jp.d.y)}};
+                const C Qh[2][2] = {
+                        {C(jq.a.x, -jq.a.y), C(jq.c.x, -jq.c.y)},
+                        {C(jq.b.x, -jq.b.y), C(jq.d.x, -jq.d.y)}};
+                const C B[2][2] = {
+                        {C(I[s] + Q[s], 0.0), C(U[s], V_[s])},
+                        {C(U[s], -V_[s]), C(I[s] - Q[s], 0.0)}};
+                for (int i = 0; i < 2; ++i)
+                    for (int j = 0; j < 2; ++j)
+                        for (int k = 0; k < 2; ++k)
+                            for (int l = 0; l < 2; ++l)
+                                sum[i][j] += P[i][k] * B[k][l] * Qh[l][j];
+            }
+            const double tol = 1e-10 * std::abs(sum[0][0]);
+            EXPECT_NEAR(sum[0][0].real(), V[b].a.x, tol);
+            EXPECT_NEAR(sum[0][0].imag(), V[b].a.y, tol);
+            EXPECT_NEAR(sum[0][1].real(), V[b].b.x, tol);
+            EXPECT_NEAR(sum[0][1].imag(), V[b].b.y, tol);
+            EXPECT_NEAR(sum[1][0].real(), V[b].c.x, tol);
+            EXPECT_NEAR(sum[1][0].imag(), V[b].c.y, tol);
+            EXPECT_NEAR(sum[1][1].real(), V[b].d.x, tol);
+            EXPECT_NEAR(sum[1][1].imag(), V[b].d.y, tol);
+        }
+    }
+    oskar_mem_free(vis, &status);
+    destroyTestData();
+}
+
+
+// Compare matrix product version against point source version (CPU only),
+// with a UV filter applied.
+TEST_F(cross_correlate, gemm_point_CPU)
+{
+    const double frequency = 100e6, inv_wavelength = frequency / 299792458.0;
+    const double uv_min = 0.3, uv_max = 1.2;
+    for (int matrix = 0; matrix <= 1; ++matrix)
+    {
+        for (int prec = 0; prec <= 1; ++prec)
+        {
+            int status = 0, type;
+            const int precision = prec ? OSKAR_DOUBLE : OSKAR_SINGLE;
+            createTestData(precision, OSKAR_CPU, matrix);
+            type = precision | OSKAR_COMPLEX;
+            if (matrix) type |= OSKAR_MATRIX;
+            const int num_baselines = oskar_telescope_num_baselines(tel);
+            oskar_Mem* vis1 = oskar_mem_create(type, OSKAR_CPU,
+                    num_baselines, &status);
+            oskar_Mem* vis2 = oskar_mem_create(type, OSKAR_CPU,
+                    num_baselines, &status);
+            oskar_Mem* work = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0,
+                    &status);
+            oskar_mem_clear_contents(vis1, &status);
+            oskar_mem_clear_contents(vis2, &status);
+            oskar_telescope_set_uv_filter(tel, uv_min, uv_max,
+                    "Wavelengths", &status);
+            oskar_cross_correlate(num_sources, jones, sky, tel, u_, v_, w_,
+                    1.0, frequency, 0, vis1, 0, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            const oskar_Mem* J = oskar_jones_mem_const(jones);
+            const oskar_Mem *I = oskar_sky_I_const(sky);
+            const oskar_Mem *Q = oskar_sky_Q_const(sky);
+            const oskar_Mem *U = oskar_sky_U_const(sky);
+            const oskar_Mem *V = oskar_sky_V_const(sky);
+            const oskar_Mem *l = oskar_sky_l_const(sky);
+            const oskar_Mem *m = oskar_sky_m_const(sky);
+            const oskar_Mem *n = oskar_sky_n_const(sky);
+            const oskar_Mem *x =
+                    oskar_telescope_station_true_offset_ecef_metres_const(
+                            tel, 0);
+            const oskar_Mem *y =
+                    oskar_telescope_station_true_offset_ecef_metres_const(
+                            tel, 1);
+            if (matrix && prec)
+                oskar_cross_correlate_point_omp_d(num_sources, num_stations,
+                        0, oskar_mem_double4c_const(J, &status),
+                        oskar_mem_double_const(I, &status),
+                        oskar_mem_double_const(Q, &status),
+                        oskar_mem_double_const(U, &status),
+                        oskar_mem_double_const(V, &status),
+                        oskar_mem_double_const(l, &status),
+                        oskar_mem_double_const(m, &status),
+                        oskar_mem_double_const(n, &status),
+                        oskar_mem_double_const(u_, &status),
+                        oskar_mem_double_const(v_, &status),
+                        oskar_mem_double_const(w_, &status),
+                        oskar_mem_double_const(x, &status),
+                        oskar_mem_double_const(y, &status),
+                        uv_min, uv_max, inv_wavelength, 0.0, 0.0, 0.0, 0.0,
+                        oskar_mem_double4c(vis2, &status), work, &status);
+            else if (matrix)
+                oskar_cross_correlate_point_omp_f(num_sources, num_stations,
+                        0, oskar_mem_float4c_const(J, &status),
+                        oskar_mem_float_const(I, &status),
+                        oskar_mem_float_const(Q, &status),
+                        oskar_mem_float_const(U, &status),
+                        oskar_mem_float_const(V, &status),
+                        oskar_mem_float_const(l, &status),
+                        oskar_mem_float_const(m, &status),
+                        oskar_mem_float_const(n, &status),
+                        oskar_mem_float_const(u_, &status),
+                        oskar_mem_float_const(v_, &status),
+                        oskar_mem_float_const(w_, &status),
+                        oskar_mem_float_const(x, &status),
+                        oskar_mem_float_const(y, &status),
+                        uv_min, uv_max, inv_wavelength, 0.0, 0.0, 0.0, 0.0,
+                        oskar_mem_float4c(vis2, &status), work, &status);
+            else if (prec)
+                oskar_cross_correlate_scalar_point_omp_d(num_sources,
+                        num_stations, 0, oskar_mem_double2_const(J, &status),
+                        oskar_mem_double_const(I, &status),
+                        oskar_mem_double_const(l, &status),
+                        oskar_mem_double_const(m, &status),
+                        oskar_mem_double_const(n, &status),
+                        oskar_mem_double_const(u_, &status),
+                        oskar_mem_double_const(v_, &status),
+                        oskar_mem_double_const(w_, &status),
+                        oskar_mem_double_const(x, &status),
+                        oskar_mem_double_const(y, &status),
+                        uv_min, uv_max, inv_wavelength, 0.0, 0.0, 0.0, 0.0,
+                        oskar_mem_double2(vis2, &status), work, &status);
+            else
+                oskar_cross_correlate_scalar_point_omp_f(num_sources,
+                        num_stations, 0, oskar_mem_float2_const(J, &status),
+                        oskar_mem_float_const(I, &status),
+                        oskar_mem_float_const(l, &status),
+                        oskar_mem_float_const(m, &status),
+                        oskar_mem_float_const(n, &status),
+                        oskar_mem_float_const(u_, &status),
+                        oskar_mem_float_const(v_, &status),
+                        oskar_mem_float_const(w_, &status),
+                        oskar_mem_float_const(x, &status),
+                        oskar_mem_float_const(y, &status),
+                        uv_min, uv_max, inv_wavelength, 0.0, 0.0, 0.0, 0.0,
+                        oskar_mem_float2(vis2, &status), work, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+            // Check that the UV filter removed some, but not all, baselines.
+            const int stride = matrix ? 8 : 2;
+            const void* v1 = oskar_mem_void_const(vis1);
+            int num_zero = 0;
+            for (int i = 0; i < num_baselines; ++i)
+                num_zero += prec ?
+                        (((const double*) v1)[i * stride] == 0.0) :
+                        (((const float*) v1)[i * stride] == 0.0f);
+            EXPECT_GT(num_zero, 0);
+            EXPECT_LT(num_zero, num_baselines);
+            check_values(vis1, vis2);
+            oskar_mem_free(vis1, &status);
+            oskar_mem_free(vis2, &status);
+            oskar_mem_free(work, &status);
+            destroyTestData();
+        }
+    }
+}
+
+static void set_env(const char* name, const char* value)
+{
+#ifdef _WIN32
+    _putenv_s(name, value ? value : "");
+#else
+    if (value) setenv(name, value, 1); else unsetenv(name);
+#endif
+}
+
+// Check that CPU results do not depend on the tile sizes used.
+TEST_F(cross_correlate, tile_sizes_CPU)
+{
+    const char* tiles[][2] = {
+            {"1", "1000"}, {"3", "100"}, {"7", "300"}, {"50", "128"}};
+    const int num_tiles = sizeof(tiles) / sizeof(tiles[0]);
+    for (int matrix = 0; matrix <= 1; ++matrix)
+    {
+        for (int prec = 0; prec <= 1; ++prec)
+        {
+            int status = 0, type;
+            const int precision = prec ? OSKAR_DOUBLE : OSKAR_SINGLE;
+            createTestData(precision, OSKAR_CPU, matrix);
+            type = precision | OSKAR_COMPLEX;
+            if (matrix) type |= OSKAR_MATRIX;
+            const int num_baselines = oskar_telescope_num_baselines(tel);
+            oskar_Mem* vis_ref = oskar_mem_create(type, OSKAR_CPU,
+                    num_baselines, &status);
+            oskar_Mem* vis = oskar_mem_create(type, OSKAR_CPU,
+                    num_baselines, &status);
+            oskar_Mem* work = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0,
+                    &status);
+            oskar_sky_set_use_extended(sky, 1);
+            oskar_telescope_set_channel_bandwidth(tel, bandwidth);
+            oskar_telescope_set_time_average(tel, 10.0);
+            oskar_mem_clear_contents(vis_ref, &status);
+            oskar_cross_correlate(num_sources, jones, sky, tel, u_, v_, w_,
+                    1.0, 100e6, 0, vis_ref, 0, &status);
+            for (int t = 0; t < num_tiles; ++t)
+            {
+                set_env("OSKAR_XCORR_TILE_STATIONS", tiles[t][0]);
+                set_env("OSKAR_XCORR_TILE_SOURCES", tiles[t][1]);
+                oskar_mem_clear_contents(vis, &status);
+                oskar_cross_correlate(num_sources, jones, sky, tel,
+                        u_, v_, w_, 1.0, 100e6, 0, vis, work, &status);
+                ASSERT_EQ(0, status) << oskar_get_error_string(status);
+                EXPECT_FALSE(oskar_mem_different(vis, vis_ref, 0, &status))
+                        << "Tile size " << tiles[t][0] << "x" << tiles[t][1];
+            }
+            set_env("OSKAR_XCORR_TILE_STATIONS", 0);
+            set_env("OSKAR_XCORR_TILE_SOURCES", 0);
+            oskar_mem_free(vis_ref, &status);
+            oskar_mem_free(vis, &status);
+            oskar_mem_free(work, &status);
+            destroyTestData();
+        }
+    }
+}
+
+// Check that a work buffer which cannot be resized gives an error,
+// both with smearing and without (using the matrix product correlator).
+TEST_F(cross_correlate, work_buffer_error_CPU)
+{
+    for (int matrix = 0; matrix <= 1; ++matrix)
+    {
+        for (int smearing = 0; smearing <= 1; ++smearing)
+        {
+            int status = 0, type;
+            createTestData(OSKAR_DOUBLE, OSKAR_CPU, matrix);
+            type = OSKAR_DOUBLE_COMPLEX;
+            if (matrix) type |= OSKAR_MATRIX;
+            oskar_Mem* vis = oskar_mem_create(type, OSKAR_CPU,
+                    oskar_telescope_num_baselines(tel), &status);
+            oskar_Mem* work = oskar_mem_create_alias_from_raw(0, OSKAR_CHAR,
+                    OSKAR_CPU, 0, &status);
+            oskar_telescope_set_channel_bandwidth(tel, smearing * bandwidth);
+            oskar_telescope_set_time_average(tel, smearing * 10.0);
+            oskar_cross_correlate(num_sources, jones, sky, tel, u_, v_, w_,
+                    1.0, 100e6, 0, vis, work, &status);
+            EXPECT_EQ((int) OSKAR_ERR_MEMORY_NOT_ALLOCATED, status);
+            status = 0;
+            oskar_mem_free(vis, &status);
+            oskar_mem_free(work, &status);
+            destroyTestData();
+        }
+    }
+}
+
 // SCALAR VERSIONS ////////////////////////////////////////////////////////////
 
 // CPU only.
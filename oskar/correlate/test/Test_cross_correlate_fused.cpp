@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_fused.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "utility/oskar_get_error_string.h"
+#include <cfloat>
+#include <cstdlib>
+
+static void run_test(int prec, int matrix, int extended, double time_average,
+        int ignore_w)
+{
+    int status = 0, type;
+    const int num_sources = 277, num_stations = 50;
+    const double frequency = 100e6, bandwidth = 1e4;
+
+    // Create the test data.
+    type = prec | OSKAR_COMPLEX;
+    if (matrix) type |= OSKAR_MATRIX;
+    oskar_Jones* E = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K = oskar_jones_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* J = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Sky* sky = oskar_sky_create(prec, OSKAR_CPU, num_sources, &status);
+    oskar_Telescope* tel = oskar_telescope_create(prec, OSKAR_CPU,
+            num_stations, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    srand(2);
+    oskar_mem_random_range(oskar_jones_mem(E), 1.0, 5.0, &status);
+    oskar_mem_random_range(u, -100.0, 100.0, &status);
+    oskar_mem_random_range(v, -100.0, 100.0, &status);
+    oskar_mem_random_range(w, -10.0, 10.0, &status);
+    oskar_mem_random_range(
+            oskar_telescope_station_true_offset_ecef_metres(tel, 0),
+            0.1, 1000.0, &status);
+    oskar_mem_random_range(
+            oskar_telescope_station_true_offset_ecef_metres(tel, 1),
+            0.1, 1000.0, &status);
+    oskar_mem_random_range(
+            oskar_telescope_station_true_offset_ecef_metres(tel, 2),
+            0.1, 1000.0, &status);
+    oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, &status);
+    oskar_mem_random_range(oskar_sky_Q(sky), 0.1, 1.0, &status);
+    oskar_mem_random_range(oskar_sky_U(sky), 0.1, 0.5, &status);
+    oskar_mem_random_range(oskar_sky_V(sky), 0.1, 0.2, &status);
+    oskar_mem_random_range(oskar_sky_l(sky), 0.1, 0.5, &status);
+    oskar_mem_random_range(oskar_sky_m(sky), 0.1, 0.5, &status);
+    oskar_mem_random_range(oskar_sky_n(sky), 0.7, 0.9, &status);
+    oskar_mem_random_range(oskar_sky_gaussian_a(sky), 0.1e-6, 0.2e-6,
+            &status);
+    oskar_mem_random_range(oskar_sky_gaussian_b(sky), 0.1e-6, 0.2e-6,
+            &status);
+    oskar_mem_random_range(oskar_sky_gaussian_c(sky), 0.1e-6, 0.2e-6,
+            &status);
+    oskar_sky_set_use_extended(sky, extended);
+    oskar_telescope_set_channel_bandwidth(tel, bandwidth);
+    oskar_telescope_set_time_average(tel, time_average);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Correlate the joined Jones matrices.
+    const int num_baselines = oskar_telescope_num_baselines(tel);
+    oskar_Mem* vis1 = oskar_mem_create(type, OSKAR_CPU, num_baselines,
+            &status);
+    oskar_Mem* vis2 = oskar_mem_create(type, OSKAR_CPU, num_baselines,
+            &status);
+    oskar_mem_clear_contents(vis1, &status);
+    oskar_mem_clear_contents(vis2, &status);
+    oskar_evaluate_jones_K(K, num_sources, oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky), oskar_sky_n_const(sky), u, v, w,
+            frequency, oskar_sky_I_const(sky), -DBL_MAX, DBL_MAX,
+            ignore_w, &status);
+    oskar_jones_join(J, K, E, &status);
+    oskar_cross_correlate(num_sources, J, sky, tel, u, v, w, 1.0,
+            frequency, 0, vis1, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Correlate the station beams directly.
+    oskar_cross_correlate_fused(num_sources, E, sky, tel, u, v, w, 1.0,
+            frequency, ignore_w, 0, vis2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare results.
+    double min_rel_error, max_rel_error, avg_rel_error, std_rel_error;
+    oskar_mem_evaluate_relative_error(vis2, vis1, &min_rel_error,
+            &max_rel_error, &avg_rel_error, &std_rel_error, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    if (prec == OSKAR_DOUBLE)
+    {
+        EXPECT_LT(max_rel_error, 1e-9) << std::setprecision(5) <<
+                "RELATIVE ERROR" <<
+                " MIN: " << min_rel_error << " MAX: " << max_rel_error <<
+                " AVG: " << avg_rel_error << " STD: " << std_rel_error;
+    }
+    else
+    {
+        // Phases are evaluated per baseline rather than per station,
+        // so allow for rounding in single precision.
+        EXPECT_LT(avg_rel_error, 1e-3) << std::setprecision(5) <<
+                "RELATIVE ERROR" <<
+                " MIN: " << min_rel_error << " MAX: " << max_rel_error <<
+                " AVG: " << avg_rel_error << " STD: " << std_rel_error;
+    }
+
+    // Free memory.
+    oskar_jones_free(E, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(J, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_mem_free(vis1, &status);
+    oskar_mem_free(vis2, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(cross_correlate_fused, matrix_point)
+{
+    run_test(OSKAR_SINGLE, 1, 0, 0.0, 0);
+    run_test(OSKAR_DOUBLE, 1, 0, 0.0, 0);
+}
+
+TEST(cross_correlate_fused, matrix_gaussian_timeSmearing)
+{
+    run_test(OSKAR_SINGLE, 1, 1, 10.0, 0);
+    run_test(OSKAR_DOUBLE, 1, 1, 10.0, 0);
+}
+
+TEST(cross_correlate_fused, scalar_point_ignore_w)
+{
+    run_test(OSKAR_SINGLE, 0, 0, 0.0, 1);
+    run_test(OSKAR_DOUBLE, 0, 0, 0.0, 1);
+}
+
+TEST(cross_correlate_fused, scalar_gaussian_timeSmearing)
+{
+    run_test(OSKAR_SINGLE, 0, 1, 10.0, 0);
+    run_test(OSKAR_DOUBLE, 0, 1, 10.0, 0);
+}
@@ -32,7 +32,9 @@
 
 #include "correlate/oskar_evaluate_cross_power.h"
 #include "utility/oskar_get_error_string.h"
+#include <complex>
 #include <cstdlib>
+#include <vector>
 
 // Comment out this line to disable benchmark timer printing.
  #define ALLOW_PRINTING 1
@@ -245,3 +247,119 @@ TEST_F(cross_power, scalar_singleCPU_doubleGPU)
             OSKAR_CPU, OSKAR_GPU, 0);
 }
 #endif
+
+// COMPARISON WITH PAIRWISE SUM.
+
+typedef std::complex<double> Complex;
+
+static void check_pairwise(int precision, int location, int matrix)
+{
+    int status = 0, i, p, q, c;
+    const int num_sources = 301, num_stations = 53;
+    const int num_comp = matrix ? 4 : 1;
+    const double I = 1.0, Q = 0.2, U = -0.3, V = 0.1;
+    int type = precision | OSKAR_COMPLEX;
+    if (matrix) type |= OSKAR_MATRIX;
+
+    // Generate random station beams in the range -1 to 1.
+    oskar_Mem* jones = oskar_mem_create(OSKAR_DOUBLE_COMPLEX | (type &
+            OSKAR_MATRIX), OSKAR_CPU, num_stations * num_sources, &status);
+    oskar_mem_random_uniform(jones, 1, 2, 3, 4, &status);
+    oskar_mem_scale_real(jones, 2.0, 0, oskar_mem_length(jones), &status);
+    oskar_mem_add_real(jones, -1.0, &status);
+    const Complex* j_ = (const Complex*) oskar_mem_void_const(jones);
+
+    // Evaluate the average cross-power directly over all station pairs.
+    const Complex B[] = {Complex(I + Q, 0.0), Complex(U, V),
+            Complex(U, -V), Complex(I - Q, 0.0)};
+    std::vector<Complex> ref(num_comp * num_sources);
+    for (i = 0; i < num_sources; ++i)
+    {
+        for (p = 0; p < num_stations; ++p)
+        {
+            const Complex* jp = &j_[num_comp * (p * num_sources + i)];
+            Complex pb[4];
+            if (matrix)
+            {
+                pb[0] = jp[0] * B[0] + jp[1] * B[2];
+                pb[1] = jp[0] * B[1] + jp[1] * B[3];
+                pb[2] = jp[2] * B[0] + jp[3] * B[2];
+                pb[3] = jp[2] * B[1] + jp[3] * B[3];
+            }
+            else pb[0] = jp[0];
+            for (q = p + 1; q < num_stations; ++q)
+            {
+                const Complex* jq = &j_[num_comp * (q * num_sources + i)];
+                Complex* r = &ref[num_comp * i];
+                if (matrix)
+                {
+                    r[0] += pb[0] * conj(jq[0]) + pb[1] * conj(jq[1]);
+                    r[1] += pb[0] * conj(jq[2]) + pb[1] * conj(jq[3]);
+                    r[2] += pb[2] * conj(jq[0]) + pb[3] * conj(jq[1]);
+                    r[3] += pb[2] * conj(jq[2]) + pb[3] * conj(jq[3]);
+                }
+                else r[0] += pb[0] * conj(jq[0]);
+            }
+        }
+    }
+
+    // Evaluate using the library function.
+    oskar_Mem* jones_in = oskar_mem_convert_precision(jones, precision,
+            &status);
+    oskar_Mem* jones_dev = oskar_mem_create_copy(jones_in, location, &status);
+    oskar_Mem* out_dev = oskar_mem_create(type, location, num_sources + 3,
+            &status);
+    oskar_evaluate_cross_power(num_sources, num_stations, jones_dev,
+            I, Q, U, V, 3, out_dev, &status);
+    oskar_Mem* out = oskar_mem_create_copy(out_dev, OSKAR_CPU, &status);
+    oskar_Mem* out_dbl = oskar_mem_convert_precision(out, OSKAR_DOUBLE,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results.
+    const double norm = 2.0 / (num_stations * (num_stations - 1));
+    const double tol = (precision == OSKAR_DOUBLE) ? 1e-12 : 1e-5;
+    const Complex* o = (const Complex*) oskar_mem_void_const(out_dbl);
+    for (i = 0; i < num_sources; ++i)
+    {
+        for (c = 0; c < num_comp; ++c)
+        {
+            const Complex t = norm * ref[num_comp * i + c];
+            const Complex v = o[num_comp * (i + 3) + c];
+            EXPECT_NEAR(t.real(), v.real(), tol);
+            EXPECT_NEAR(t.imag(), v.imag(), tol);
+        }
+    }
+    oskar_mem_free(jones, &status);
+    oskar_mem_free(jones_in, &status);
+    oskar_mem_free(jones_dev, &status);
+    oskar_mem_free(out_dev, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(out_dbl, &status);
+}
+
+TEST(cross_power_pairwise, cpu)
+{
+    check_pairwise(OSKAR_SINGLE, OSKAR_CPU, 0);
+    check_pairwise(OSKAR_DOUBLE, OSKAR_CPU, 0);
+    check_pairwise(OSKAR_SINGLE, OSKAR_CPU, 1);
+    check_pairwise(OSKAR_DOUBLE, OSKAR_CPU, 1);
+}
+
+#ifdef OSKAR_HAVE_CUDA
+TEST(cross_power_pairwise, gpu)
+{
+    check_pairwise(OSKAR_SINGLE, OSKAR_GPU, 0);
+    check_pairwise(OSKAR_DOUBLE, OSKAR_GPU, 0);
+    check_pairwise(OSKAR_SINGLE, OSKAR_GPU, 1);
+    check_pairwise(OSKAR_DOUBLE, OSKAR_GPU, 1);
+}
+#endif
+
+#ifdef OSKAR_HAVE_OPENCL
+TEST(cross_power_pairwise, cl)
+{
+    check_pairwise(OSKAR_SINGLE, OSKAR_CL, 0);
+    check_pairwise(OSKAR_SINGLE, OSKAR_CL, 1);
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -231,6 +231,7 @@ void benchmark(int num_stations, int num_sources, int type,
     // Allocate memory for visibility coordinates and output visibility slice.
     oskar_Mem* vis = oskar_mem_create(jones_type, location,
             oskar_telescope_num_baselines(tel), status);
+    oskar_Mem* work = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, status);
     oskar_Mem* u = oskar_mem_create(type, location, num_stations, status);
     oskar_Mem* v = oskar_mem_create(type, location, num_stations, status);
     oskar_Mem* w = oskar_mem_create(type, location, num_stations, status);
@@ -276,7 +277,7 @@ void benchmark(int num_stations, int num_sources, int type,
         oskar_mem_clear_contents(vis, status);
         oskar_timer_start(timer);
         oskar_cross_correlate(oskar_sky_num_sources(sky), J, sky, tel,
-                u, v, w, 0.0, 100e6, 0, vis, status);
+                u, v, w, 0.0, 100e6, 0, vis, work, status);
         times[i] = oskar_timer_elapsed(timer);
     }
 
@@ -297,6 +298,7 @@ void benchmark(int num_stations, int num_sources, int type,
     oskar_mem_free(v, status);
     oskar_mem_free(w, status);
     oskar_mem_free(vis, status);
+    oskar_mem_free(work, status);
     oskar_jones_free(J, status);
     oskar_telescope_free(tel, status);
     oskar_sky_free(sky, status);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,10 @@ extern "C" {
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * If OpenMP is available and there are enough visibilities, rows of the
+ * grid are updated in parallel. The result is identical to that obtained
+ * using a single thread.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
@@ -84,6 +88,10 @@ void oskar_grid_simple_d(
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * If OpenMP is available and there are enough visibilities, rows of the
+ * grid are updated in parallel. The result is identical to that obtained
+ * using a single thread.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
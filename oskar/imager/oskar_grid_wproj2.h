@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, The University of Oxford
+ * Copyright (c) 2018-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,10 @@ extern "C" {
  * @details
  * Gridding function for W-projection.
  *
+ * If OpenMP is available and there are enough visibilities, rows of the
+ * grid are updated in parallel. The result is identical to that obtained
+ * using a single thread.
+ *
  * @param[in] num_w_planes   Number of W-projection planes.
  * @param[in] support        GCF support size per W-plane.
  * @param[in] oversample     GCF oversample factor.
@@ -92,6 +96,10 @@ void oskar_grid_wproj2_d(
  * @details
  * Gridding function for W-projection.
  *
+ * If OpenMP is available and there are enough visibilities, rows of the
+ * grid are updated in parallel. The result is identical to that obtained
+ * using a single thread.
+ *
  * @param[in] num_w_planes   Number of W-projection planes.
  * @param[in] support        GCF support size per W-plane.
  * @param[in] oversample     GCF oversample factor.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -66,7 +66,8 @@ enum OSKAR_IMAGE_ALGORITHM
     OSKAR_ALGORITHM_DFT_2D,
     OSKAR_ALGORITHM_DFT_3D,
     OSKAR_ALGORITHM_WPROJ,
-    OSKAR_ALGORITHM_AWPROJ
+    OSKAR_ALGORITHM_AWPROJ,
+    OSKAR_ALGORITHM_WSTACK
 };
 
 enum OSKAR_IMAGE_WEIGHTING
@@ -77,6 +78,14 @@ enum OSKAR_IMAGE_WEIGHTING
     OSKAR_WEIGHTING_GRIDLESS_UNIFORM
 };
 
+enum OSKAR_IMAGER_W_KERNEL_TAGS
+{
+    OSKAR_IMAGER_TAG_W_KERNEL_PARAMS = 1,
+    OSKAR_IMAGER_TAG_W_SUPPORT       = 2,
+    OSKAR_IMAGER_TAG_W_KERNEL_START  = 3,
+    OSKAR_IMAGER_TAG_W_KERNELS       = 4
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_GRID_BANDS_H_
+#define OSKAR_PRIVATE_GRID_BANDS_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Work arrays used to grid visibilities in parallel on the CPU.
+ *
+ * The grid is divided into bands of whole rows, and each band is updated
+ * by only one thread. A visibility is gridded by every band its
+ * convolution kernel overlaps, but each band writes only its own rows.
+ * The visibilities for each band are kept in their original order, so
+ * every grid cell receives the same updates in the same order as it would
+ * if gridded serially, and the results are identical.
+ */
+struct oskar_GridBands
+{
+    int num_bands, band_height, num_chunks;
+    size_t num_points;
+    size_t* chunk_start; /* Start of each chunk of visibilities. */
+    int* row_min;        /* First grid row for each visibility, or -1. */
+    int* row_max;        /* Last grid row for each visibility. */
+    size_t* band_start;  /* Start of each band in band_vis. */
+    size_t* band_vis;    /* Visibility indices for each band. */
+    double* vis_norm;    /* Normalisation factor for each visibility. */
+};
+typedef struct oskar_GridBands oskar_GridBands;
+
+/*
+ * Sets up bands for gridding in parallel.
+ * Returns 0 if the visibilities should be gridded serially instead,
+ * in which case nothing is allocated.
+ *
+ * On success, the caller must fill row_min and row_max for every
+ * visibility (using chunk_start to divide the work between threads),
+ * then call oskar_grid_bands_sort().
+ */
+int oskar_grid_bands_create(oskar_GridBands* bands, size_t num_points,
+        int grid_size);
+
+/*
+ * Builds the list of visibilities for each band.
+ * Returns 0 if this could not be done, in which case the caller should
+ * free the bands and grid the visibilities serially instead.
+ */
+int oskar_grid_bands_sort(oskar_GridBands* bands);
+
+/*
+ * Accumulates the number of skipped visibilities and the grid
+ * normalisation in visibility order, then frees the work arrays.
+ * The accumulation is not done if num_skipped or norm is NULL.
+ */
+void oskar_grid_bands_free(oskar_GridBands* bands, size_t* num_skipped,
+        double* norm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_PRIVATE_GRID_BANDS_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -56,6 +56,14 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Visibilities waiting to be gridded into W-layers, for one image plane. */
+struct WStackBuffer
+{
+    size_t num_vis;
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+};
+typedef struct WStackBuffer WStackBuffer;
+
 struct oskar_Imager
 {
     char* output_name[4];
@@ -74,6 +82,7 @@ struct oskar_Imager
     int num_files, scale_norm_with_num_input_files;
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
+    char *w_kernel_cache_dir;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
@@ -111,6 +120,13 @@ struct oskar_Imager
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
 
+    /* W-stacking imager data. */
+    size_t w_stack_max_vis;
+    double w_layer_inc;
+    WStackBuffer* w_stack_buffers;
+    oskar_Mem *w_layer_uu, *w_layer_vv, *w_layer_vis, *w_layer_weight;
+    oskar_Mem *w_layer_grid, *w_layer_screen, *w_layer_taper;
+
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
 };
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014, The University of Oxford
+ * Copyright (c) 2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,25 +26,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_
-#define OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_
-
-/**
- * @file oskar_load_tid_parameter_file.h
- */
-
-#include <oskar_global.h>
-#include <oskar_Settings_old.h>
+#ifndef OSKAR_IMAGER_INIT_WSTACK_H_
+#define OSKAR_IMAGER_INIT_WSTACK_H_
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void oskar_settings_load_tid_parameter_file(oskar_SettingsTIDscreen* settings,
-        const char* filename, int* status);
+void oskar_imager_init_wstack(oskar_Imager* h, int* status);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_ */
+#endif /* OSKAR_IMAGER_INIT_WSTACK_H_ */
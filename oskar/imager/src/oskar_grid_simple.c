@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "imager/oskar_grid_simple.h"
+#include "imager/private_grid_bands.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -175,6 +176,230 @@ static void oskar_grid_simple_default_f(
 }
 
 
+static int oskar_grid_simple_bands_d(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const double* RESTRICT vis,
+        const double* RESTRICT weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        double* RESTRICT grid)
+{
+    int b, c;
+    oskar_GridBands bands;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+    if (!oskar_grid_bands_create(&bands, num_points, grid_size)) return 0;
+
+    /* Find the grid rows covered by each visibility. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < bands.num_chunks; ++c)
+    {
+        size_t i;
+        for (i = bands.chunk_start[c]; i < bands.chunk_start[c + 1]; ++i)
+        {
+            const double pos_u = -uu[i] * grid_scale;
+            const double pos_v = vv[i] * grid_scale;
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+            if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                    grid_v + support >= grid_size || grid_v - support < 0)
+            {
+                bands.row_min[i] = -1;
+                continue;
+            }
+            bands.row_min[i] = grid_v - support;
+            bands.row_max[i] = grid_v + support;
+        }
+    }
+    if (!oskar_grid_bands_sort(&bands))
+    {
+        oskar_grid_bands_free(&bands, 0, 0);
+        return 0;
+    }
+
+    /* Grid the visibilities in each band. */
+#pragma omp parallel for private(b) schedule(dynamic, 1)
+    for (b = 0; b < bands.num_bands; ++b)
+    {
+        size_t n;
+        const int row_start = b * bands.band_height;
+        const int row_end = row_start + bands.band_height;
+        for (n = bands.band_start[b]; n < bands.band_start[b + 1]; ++n)
+        {
+            double sum = 0.0;
+            int j, k;
+            const size_t i = bands.band_vis[n];
+
+            /* Convert UV coordinates to grid coordinates. */
+            const double pos_u = -uu[i] * grid_scale;
+            const double pos_v = vv[i] * grid_scale;
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+
+            /* Get visibility data. */
+            const double weight_i = weight[i];
+            const double v_re = weight_i * vis[2 * i];
+            const double v_im = weight_i * vis[2 * i + 1];
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+            const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+            /* Only the band containing the centre of the kernel
+             * accumulates the normalisation for the visibility. */
+            const int home = (grid_v >= row_start && grid_v < row_end);
+
+            /* Convolve this point onto the rows in this band. */
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const int in_band =
+                        (grid_v + j >= row_start && grid_v + j < row_end);
+                if (!in_band && !home) continue;
+                const double c1 = conv_func[abs(off_v + j * oversample)];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t p = (p1 + k) << 1;
+                    const double c = conv_func[abs(off_u + k * oversample)] * c1;
+                    if (in_band)
+                    {
+                        grid[p]     += v_re * c;
+                        grid[p + 1] += v_im * c;
+                    }
+                    sum += c;
+                }
+            }
+            if (home) bands.vis_norm[i] = sum * weight_i;
+        }
+    }
+    oskar_grid_bands_free(&bands, num_skipped, norm);
+    return 1;
+}
+
+
+static int oskar_grid_simple_bands_f(
+        const int support,
+        const int oversample,
+        const float* RESTRICT conv_func,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const float* RESTRICT vis,
+        const float* RESTRICT weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* RESTRICT grid)
+{
+    int b, c;
+    oskar_GridBands bands;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+    if (!oskar_grid_bands_create(&bands, num_points, grid_size)) return 0;
+
+    /* Find the grid rows covered by each visibility. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < bands.num_chunks; ++c)
+    {
+        size_t i;
+        for (i = bands.chunk_start[c]; i < bands.chunk_start[c + 1]; ++i)
+        {
+            const float pos_u = -uu[i] * grid_scale;
+            const float pos_v = vv[i] * grid_scale;
+            const int grid_u = (int)roundf(pos_u) + grid_centre;
+            const int grid_v = (int)roundf(pos_v) + grid_centre;
+            if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                    grid_v + support >= grid_size || grid_v - support < 0)
+            {
+                bands.row_min[i] = -1;
+                continue;
+            }
+            bands.row_min[i] = grid_v - support;
+            bands.row_max[i] = grid_v + support;
+        }
+    }
+    if (!oskar_grid_bands_sort(&bands))
+    {
+        oskar_grid_bands_free(&bands, 0, 0);
+        return 0;
+    }
+
+    /* Grid the visibilities in each band. */
+#pragma omp parallel for private(b) schedule(dynamic, 1)
+    for (b = 0; b < bands.num_bands; ++b)
+    {
+        size_t n;
+        const int row_start = b * bands.band_height;
+        const int row_end = row_start + bands.band_height;
+        for (n = bands.band_start[b]; n < bands.band_start[b + 1]; ++n)
+        {
+            double sum = 0.0;
+            int j, k;
+            const size_t i = bands.band_vis[n];
+
+            /* Convert UV coordinates to grid coordinates. */
+            const float pos_u = -uu[i] * grid_scale;
+            const float pos_v = vv[i] * grid_scale;
+            const int grid_u = (int)roundf(pos_u) + grid_centre;
+            const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+            /* Get visibility data. */
+            const float weight_i = weight[i];
+            const float v_re = weight_i * vis[2 * i];
+            const float v_im = weight_i * vis[2 * i + 1];
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u =
+                    (int)roundf((roundf(pos_u) - pos_u) * oversample);
+            const int off_v =
+                    (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+            /* Only the band containing the centre of the kernel
+             * accumulates the normalisation for the visibility. */
+            const int home = (grid_v >= row_start && grid_v < row_end);
+
+            /* Convolve this point onto the rows in this band. */
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const int in_band =
+                        (grid_v + j >= row_start && grid_v + j < row_end);
+                if (!in_band && !home) continue;
+                const float c1 = conv_func[abs(off_v + j * oversample)];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t p = (p1 + k) << 1;
+                    const float c = conv_func[abs(off_u + k * oversample)] * c1;
+                    if (in_band)
+                    {
+                        grid[p]     += v_re * c;
+                        grid[p + 1] += v_im * c;
+                    }
+                    sum += c;
+                }
+            }
+            if (home) bands.vis_norm[i] = sum * weight_i;
+        }
+    }
+    oskar_grid_bands_free(&bands, num_skipped, norm);
+    return 1;
+}
+
+
 void oskar_grid_simple_d(
         const int support,
         const int oversample,
@@ -194,6 +419,12 @@ void oskar_grid_simple_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Grid in parallel if possible. */
+    if (oskar_grid_simple_bands_d(support, oversample, conv_func, num_points,
+            uu, vv, vis, weight, cell_size_rad, grid_size,
+            num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -273,6 +504,12 @@ void oskar_grid_simple_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Grid in parallel if possible. */
+    if (oskar_grid_simple_bands_f(support, oversample, conv_func, num_points,
+            uu, vv, vis, weight, cell_size_rad, grid_size,
+            num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, The University of Oxford
+ * Copyright (c) 2018-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "imager/oskar_grid_wproj2.h"
+#include "imager/private_grid_bands.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -34,6 +35,278 @@
 extern "C" {
 #endif
 
+static int oskar_grid_wproj2_bands_d(
+        const size_t num_w_planes,
+        const int* RESTRICT support,
+        const int oversample,
+        const int* wkernel_start,
+        const double* RESTRICT wkernel,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const double* RESTRICT ww,
+        const double* RESTRICT vis,
+        const double* RESTRICT weight,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        double* RESTRICT grid)
+{
+    int b, c;
+    oskar_GridBands bands;
+    const int grid_centre = grid_size / 2;
+    const int oversample_h = oversample / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+    if (!oskar_grid_bands_create(&bands, num_points, grid_size)) return 0;
+
+    /* Find the grid rows covered by each visibility. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < bands.num_chunks; ++c)
+    {
+        size_t i;
+        for (i = bands.chunk_start[c]; i < bands.chunk_start[c + 1]; ++i)
+        {
+            const double pos_u = -uu[i] * grid_scale;
+            const double pos_v = vv[i] * grid_scale;
+            const size_t grid_w = (size_t)round(sqrt(fabs(ww[i] * w_scale)));
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+            const int w_support = grid_w < num_w_planes ?
+                    support[grid_w] : support[num_w_planes - 1];
+            if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                    grid_v + w_support >= grid_size || grid_v - w_support < 0)
+            {
+                bands.row_min[i] = -1;
+                continue;
+            }
+            bands.row_min[i] = grid_v - w_support;
+            bands.row_max[i] = grid_v + w_support;
+        }
+    }
+    if (!oskar_grid_bands_sort(&bands))
+    {
+        oskar_grid_bands_free(&bands, 0, 0);
+        return 0;
+    }
+
+    /* Grid the visibilities in each band. */
+#pragma omp parallel for private(b) schedule(dynamic, 1)
+    for (b = 0; b < bands.num_bands; ++b)
+    {
+        size_t n;
+        const int row_start = b * bands.band_height;
+        const int row_end = row_start + bands.band_height;
+        for (n = bands.band_start[b]; n < bands.band_start[b + 1]; ++n)
+        {
+            double sum = 0.0;
+            int j, k;
+            const size_t i = bands.band_vis[n];
+
+            /* Convert UV coordinates to grid coordinates. */
+            const double pos_u = -uu[i] * grid_scale;
+            const double pos_v = vv[i] * grid_scale;
+            const double ww_i = ww[i];
+            const double conv_conj = (ww_i > 0.0) ? -1.0 : 1.0;
+            const size_t grid_w = (size_t)round(sqrt(fabs(ww_i * w_scale)));
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+
+            /* Get visibility data. */
+            const double weight_i = weight[i];
+            const double v_re = weight_i * vis[2 * i];
+            const double v_im = weight_i * vis[2 * i + 1];
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u =
+                    (int)round((round(pos_u) - pos_u) * oversample);
+            const int off_v =
+                    (int)round((round(pos_v) - pos_v) * oversample);
+
+            /* Get kernel support size and start offset. */
+            const int w_support = grid_w < num_w_planes ?
+                    support[grid_w] : support[num_w_planes - 1];
+            const int kernel_start = grid_w < num_w_planes ?
+                    wkernel_start[grid_w] : wkernel_start[num_w_planes - 1];
+
+            /* Only the band containing the centre of the kernel
+             * accumulates the normalisation for the visibility. */
+            const int home = (grid_v >= row_start && grid_v < row_end);
+
+            /* Convolve this point onto the rows in this band. */
+            const int conv_len = 2 * w_support + 1;
+            const int width = (oversample_h * conv_len + 1) * conv_len;
+            const int mid =
+                    kernel_start + (abs(off_u) + 1) * width - 1 - w_support;
+            const int stride = (off_u >= 0) ? 1 : -1;
+            for (j = -w_support; j <= w_support; ++j)
+            {
+                const int in_band =
+                        (grid_v + j >= row_start && grid_v + j < row_end);
+                if (!in_band && !home) continue;
+                const int t = mid - abs(off_v + j * oversample) * conv_len;
+                size_t p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -w_support; k <= w_support; ++k)
+                {
+                    const int p = (t + stride * k) << 1;
+                    const double c_re = wkernel[p];
+                    const double c_im = wkernel[p + 1] * conv_conj;
+                    const size_t p2 = (p1 + k) << 1;
+                    if (in_band)
+                    {
+                        grid[p2]     += (v_re * c_re - v_im * c_im);
+                        grid[p2 + 1] += (v_im * c_re + v_re * c_im);
+                    }
+                    sum += c_re; /* Real part only. */
+                }
+            }
+            if (home) bands.vis_norm[i] = sum * weight_i;
+        }
+    }
+    oskar_grid_bands_free(&bands, num_skipped, norm);
+    return 1;
+}
+
+
+static int oskar_grid_wproj2_bands_f(
+        const size_t num_w_planes,
+        const int* RESTRICT support,
+        const int oversample,
+        const int* wkernel_start,
+        const float* RESTRICT wkernel,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const float* RESTRICT ww,
+        const float* RESTRICT vis,
+        const float* RESTRICT weight,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* RESTRICT grid)
+{
+    int b, c;
+    oskar_GridBands bands;
+    const int grid_centre = grid_size / 2;
+    const int oversample_h = oversample / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+    if (!oskar_grid_bands_create(&bands, num_points, grid_size)) return 0;
+
+    /* Find the grid rows covered by each visibility. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < bands.num_chunks; ++c)
+    {
+        size_t i;
+        for (i = bands.chunk_start[c]; i < bands.chunk_start[c + 1]; ++i)
+        {
+            const float pos_u = -uu[i] * grid_scale;
+            const float pos_v = vv[i] * grid_scale;
+            const size_t grid_w = (size_t)roundf(sqrtf(fabsf(ww[i] * w_scale)));
+            const int grid_u = (int)roundf(pos_u) + grid_centre;
+            const int grid_v = (int)roundf(pos_v) + grid_centre;
+            const int w_support = grid_w < num_w_planes ?
+                    support[grid_w] : support[num_w_planes - 1];
+            if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||
+                    grid_v + w_support >= grid_size || grid_v - w_support < 0)
+            {
+                bands.row_min[i] = -1;
+                continue;
+            }
+            bands.row_min[i] = grid_v - w_support;
+            bands.row_max[i] = grid_v + w_support;
+        }
+    }
+    if (!oskar_grid_bands_sort(&bands))
+    {
+        oskar_grid_bands_free(&bands, 0, 0);
+        return 0;
+    }
+
+    /* Grid the visibilities in each band. */
+#pragma omp parallel for private(b) schedule(dynamic, 1)
+    for (b = 0; b < bands.num_bands; ++b)
+    {
+        size_t n;
+        const int row_start = b * bands.band_height;
+        const int row_end = row_start + bands.band_height;
+        for (n = bands.band_start[b]; n < bands.band_start[b + 1]; ++n)
+        {
+            double sum = 0.0;
+            int j, k;
+            const size_t i = bands.band_vis[n];
+
+            /* Convert UV coordinates to grid coordinates. */
+            const float pos_u = -uu[i] * grid_scale;
+            const float pos_v = vv[i] * grid_scale;
+            const float ww_i = ww[i];
+            const float conv_conj = (ww_i > 0.0f) ? -1.0f : 1.0f;
+            const size_t grid_w = (size_t)roundf(sqrtf(fabsf(ww_i * w_scale)));
+            const int grid_u = (int)roundf(pos_u) + grid_centre;
+            const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+            /* Get visibility data. */
+            const float weight_i = weight[i];
+            const float v_re = weight_i * vis[2 * i];
+            const float v_im = weight_i * vis[2 * i + 1];
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u =
+                    (int)roundf((roundf(pos_u) - pos_u) * oversample);
+            const int off_v =
+                    (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+            /* Get kernel support size and start offset. */
+            const int w_support = grid_w < num_w_planes ?
+                    support[grid_w] : support[num_w_planes - 1];
+            const int kernel_start = grid_w < num_w_planes ?
+                    wkernel_start[grid_w] : wkernel_start[num_w_planes - 1];
+
+            /* Only the band containing the centre of the kernel
+             * accumulates the normalisation for the visibility. */
+            const int home = (grid_v >= row_start && grid_v < row_end);
+
+            /* Convolve this point onto the rows in this band. */
+            const int conv_len = 2 * w_support + 1;
+            const int width = (oversample_h * conv_len + 1) * conv_len;
+            const int mid =
+                    kernel_start + (abs(off_u) + 1) * width - 1 - w_support;
+            const int stride = (off_u >= 0) ? 1 : -1;
+            for (j = -w_support; j <= w_support; ++j)
+            {
+                const int in_band =
+                        (grid_v + j >= row_start && grid_v + j < row_end);
+                if (!in_band && !home) continue;
+                const int t = mid - abs(off_v + j * oversample) * conv_len;
+                size_t p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -w_support; k <= w_support; ++k)
+                {
+                    const int p = (t + stride * k) << 1;
+                    const float c_re = wkernel[p];
+                    const float c_im = wkernel[p + 1] * conv_conj;
+                    const size_t p2 = (p1 + k) << 1;
+                    if (in_band)
+                    {
+                        grid[p2]     += (v_re * c_re - v_im * c_im);
+                        grid[p2 + 1] += (v_im * c_re + v_re * c_im);
+                    }
+                    sum += c_re; /* Real part only. */
+                }
+            }
+            if (home) bands.vis_norm[i] = sum * weight_i;
+        }
+    }
+    oskar_grid_bands_free(&bands, num_skipped, norm);
+    return 1;
+}
+
+
 void oskar_grid_wproj2_d(
         const size_t num_w_planes,
         const int* RESTRICT support,
@@ -58,6 +331,12 @@ void oskar_grid_wproj2_d(
     const int oversample_h = oversample / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Grid in parallel if possible. */
+    if (oskar_grid_wproj2_bands_d(num_w_planes, support, oversample,
+            wkernel_start, wkernel, num_points, uu, vv, ww, vis, weight,
+            cell_size_rad, w_scale, grid_size, num_skipped, norm, grid))
+        return;
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -148,6 +427,12 @@ void oskar_grid_wproj2_f(
     const int oversample_h = oversample / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Grid in parallel if possible. */
+    if (oskar_grid_wproj2_bands_f(num_w_planes, support, oversample,
+            wkernel_start, wkernel, num_points, uu, vv, ww, vis, weight,
+            cell_size_rad, w_scale, grid_size, num_skipped, norm, grid))
+        return;
+
     /* Loop over visibilities. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -55,6 +55,7 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
     {
     case OSKAR_ALGORITHM_FFT:    return "FFT";
     case OSKAR_ALGORITHM_WPROJ:  return "W-projection";
+    case OSKAR_ALGORITHM_WSTACK: return "W-stacking";
     case OSKAR_ALGORITHM_DFT_2D: return "DFT 2D";
     case OSKAR_ALGORITHM_DFT_3D: return "DFT 3D";
     default:                     return "";
@@ -239,6 +240,14 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->support = 3;
         h->oversample = 100;
     }
+    else if (!strncmp(type, "W-S", 3) || !strncmp(type, "W-s", 3) ||
+            !strncmp(type, "w-s", 3))
+    {
+        h->algorithm = OSKAR_ALGORITHM_WSTACK;
+        h->kernel_type = 'S';
+        h->support = 3;
+        h->oversample = 100;
+    }
     else if (!strncmp(type, "W", 1) || !strncmp(type, "w", 1))
     {
         h->algorithm = OSKAR_ALGORITHM_WPROJ;
@@ -293,8 +302,10 @@ void oskar_imager_set_coords_only(oskar_Imager* h, int flag)
         if (h->ww_points > 0)
             h->ww_rms = sqrt(h->ww_rms / h->ww_points);
 
-        /* Calculate required number of w-planes if not set. */
-        if ((h->ww_max > 0.0) && (h->num_w_planes < 1))
+        /* Calculate required number of w-planes if not set.
+         * (The number of W-stacking layers is set when initialised.) */
+        if ((h->ww_max > 0.0) && (h->num_w_planes < 1) &&
+                (h->algorithm != OSKAR_ALGORITHM_WSTACK))
         {
             double max_uvw, ww_mid;
             max_uvw = 1.05 * h->ww_max;
@@ -710,6 +721,21 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h,
+        const char* dir_path)
+{
+    int len = 0;
+    free(h->w_kernel_cache_dir);
+    h->w_kernel_cache_dir = 0;
+    if (dir_path) len = (int) strlen(dir_path);
+    if (len > 0)
+    {
+        h->w_kernel_cache_dir = (char*) calloc(1 + len, 1);
+        strcpy(h->w_kernel_cache_dir, dir_path);
+    }
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (!strncmp(type, "N", 1) || !strncmp(type, "n", 1))
@@ -754,6 +780,12 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_cache_dir;
+}
+
+
 const char* oskar_imager_weighting(const oskar_Imager* h)
 {
     switch (h->weighting)
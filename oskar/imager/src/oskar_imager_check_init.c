@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 #include "imager/private_imager_init_dft.h"
 #include "imager/private_imager_init_fft.h"
 #include "imager/private_imager_init_wproj.h"
+#include "imager/private_imager_init_wstack.h"
 #include "utility/oskar_timer.h"
 
 #include <stdlib.h>
@@ -72,6 +73,9 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
     case OSKAR_ALGORITHM_WPROJ:
         oskar_imager_init_wproj(h, status);
         break;
+    case OSKAR_ALGORITHM_WSTACK:
+        oskar_imager_init_wstack(h, status);
+        break;
     default:
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
     }
@@ -33,6 +33,7 @@
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
@@ -76,6 +77,10 @@ void oskar_imager_finalise(oskar_Imager* h,
     oskar_log_section(h->log, 'M', "Finalising %d image plane(s)...",
             h->num_planes);
 
+    /* Grid any visibilities still waiting to be added to W-layers. */
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+        oskar_imager_flush_wstack(h, status);
+
     /* Adjust normalisation if required. */
     if (h->scale_norm_with_num_input_files)
     {
@@ -90,7 +95,8 @@ void oskar_imager_finalise(oskar_Imager* h,
     /* If gridding with multiple GPUs, copy grids to host and combine them. */
     if (h->grid_on_gpu && h->num_gpus > 1 && !(
             h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
-            h->algorithm == OSKAR_ALGORITHM_DFT_3D))
+            h->algorithm == OSKAR_ALGORITHM_DFT_3D ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK))
     {
         const size_t plane_size = (size_t) oskar_imager_plane_size(h);
         const size_t num_cells = plane_size * plane_size;
@@ -128,7 +134,8 @@ void oskar_imager_finalise(oskar_Imager* h,
         oskar_Mem *plane = h->planes[i];
         if (h->grid_on_gpu && h->num_gpus == 1 && !(
                 h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
-                h->algorithm == OSKAR_ALGORITHM_DFT_3D))
+                h->algorithm == OSKAR_ALGORITHM_DFT_3D ||
+                h->algorithm == OSKAR_ALGORITHM_WSTACK))
             plane = h->d[0].planes[i];
         if (!(output_grids[i]))
             output_grids[i] = oskar_mem_create(oskar_mem_type(plane),
@@ -148,7 +155,8 @@ void oskar_imager_finalise(oskar_Imager* h,
             oskar_Mem *plane = h->planes[i];
             if (h->grid_on_gpu && h->num_gpus > 0 && !(
                     h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
-                    h->algorithm == OSKAR_ALGORITHM_DFT_3D))
+                    h->algorithm == OSKAR_ALGORITHM_DFT_3D ||
+                    h->algorithm == OSKAR_ALGORITHM_WSTACK))
                 plane = h->d[0].planes[i];
             oskar_imager_finalise_plane(h, plane, h->plane_norm[i], status);
             if (plane != h->planes[i])
@@ -235,7 +243,10 @@ void oskar_imager_finalise(oskar_Imager* h,
             oskar_log_value(h->log, 'M', 0,
                     "Visibilities processed", "%lu",
                     (unsigned long) (h->num_vis_processed));
-        if (h->num_w_planes > 0)
+        if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+            oskar_log_value(h->log, 'M', 0,
+                    "W-stacking layers", "%d", h->num_w_planes);
+        else if (h->num_w_planes > 0)
             oskar_log_value(h->log, 'M', 0,
                     "W-projection planes", "%d", h->num_w_planes);
         if (h->fov_deg > 0.1)
@@ -337,25 +348,32 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         return;
     }
 
-    /* Perform FFT shift of the input grid. */
+    /* Perform FFT shift of the input grid.
+     * W-stacking has already transformed each layer to the image plane. */
     oskar_timer_resume(h->tmr_grid_finalise);
-    const int fft_loc = (h->fft_on_gpu && h->num_gpus > 0) ?
-            h->dev_loc : OSKAR_CPU;
-    if (fft_loc != OSKAR_CPU)
-        oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
-    oskar_fftphase(size, size, plane, status);
-
-    /* Call FFT. */
-    if (!h->fft)
-        h->fft = oskar_fft_create(h->imager_prec, fft_loc, 2, size, 0, status);
-    oskar_fft_exec(h->fft, plane, status);
+    if (h->algorithm != OSKAR_ALGORITHM_WSTACK)
+    {
+        const int fft_loc = (h->fft_on_gpu && h->num_gpus > 0) ?
+                h->dev_loc : OSKAR_CPU;
+        if (fft_loc != OSKAR_CPU)
+            oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
+        oskar_fftphase(size, size, plane, status);
+
+        /* Call FFT. */
+        if (!h->fft)
+            h->fft = oskar_fft_create(h->imager_prec, fft_loc, 2, size, 0,
+                    status);
+        oskar_fft_exec(h->fft, plane, status);
+        oskar_fftphase(size, size, plane, status);
+    }
 
     /* Generate grid correction function if required. */
     if (!h->corr_func)
     {
         oskar_Mem* corr_func = 0;
         corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        if (h->algorithm != OSKAR_ALGORITHM_FFT &&
+                h->algorithm != OSKAR_ALGORITHM_WSTACK)
             oskar_grid_correction_function_spheroidal(size, h->oversample,
                     oskar_mem_double(corr_func, status));
         else
@@ -371,8 +389,7 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
                 h->imager_prec, status);
     }
 
-    /* FFT shift again, and apply grid correction. */
-    oskar_fftphase(size, size, plane, status);
+    /* Apply grid correction. */
     oskar_grid_correction(size, h->corr_func, plane, status);
     oskar_timer_pause(h->tmr_grid_finalise);
 }
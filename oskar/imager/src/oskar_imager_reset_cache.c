@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,7 @@
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
 #include <fitsio.h>
@@ -64,6 +65,14 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_mem_free(h->w_layer_uu, status); h->w_layer_uu = 0;
+    oskar_mem_free(h->w_layer_vv, status); h->w_layer_vv = 0;
+    oskar_mem_free(h->w_layer_vis, status); h->w_layer_vis = 0;
+    oskar_mem_free(h->w_layer_weight, status); h->w_layer_weight = 0;
+    oskar_mem_free(h->w_layer_grid, status); h->w_layer_grid = 0;
+    oskar_mem_free(h->w_layer_screen, status); h->w_layer_screen = 0;
+    oskar_mem_free(h->w_layer_taper, status); h->w_layer_taper = 0;
+    oskar_imager_free_wstack_buffers(h, status);
 
     /* Free the image planes. */
     if (h->planes)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,6 +38,7 @@
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
 #include "log/oskar_log.h"
@@ -568,6 +569,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     i_plane, plane, plane_norm_ptr, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_WSTACK:
+            oskar_imager_update_plane_wstack(h, num_vis, pu, pv, pw, pa, ph,
+                    i_plane, plane, plane_norm_ptr, &num_skipped, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
@@ -626,7 +631,8 @@ void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
     }
 
     /* Update baseline W minimum, maximum and RMS. */
-    if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+    if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
     {
         size_t j;
         oskar_timer_resume(h->tmr_coord_scan);
@@ -688,7 +694,8 @@ void oskar_imager_allocate_planes(oskar_Imager* h, int *status)
     /* Allocate visibility planes on the devices if required. */
     if (h->grid_on_gpu && !(
             h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
-            h->algorithm == OSKAR_ALGORITHM_DFT_3D))
+            h->algorithm == OSKAR_ALGORITHM_DFT_3D ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK))
     {
         int j, norm_type;
         const int loc = h->dev_loc;
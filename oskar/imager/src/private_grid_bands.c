@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_grid_bands.h"
+
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Don't bother with threads for fewer visibilities than this. */
+#define MIN_POINTS 8192
+
+/* Minimum number of grid rows in each band. */
+#define MIN_BAND_HEIGHT 16
+
+/* Number of bands to use per thread, for load balancing. */
+#define BANDS_PER_THREAD 4
+
+int oskar_grid_bands_create(oskar_GridBands* bands, size_t num_points,
+        int grid_size)
+{
+    int c, num_threads = 1, num_bands;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) num_threads = omp_get_max_threads();
+#endif
+    if (num_threads < 2 || num_points < MIN_POINTS) return 0;
+    num_bands = BANDS_PER_THREAD * num_threads;
+    if (num_bands > grid_size / MIN_BAND_HEIGHT)
+        num_bands = grid_size / MIN_BAND_HEIGHT;
+    if (num_bands < 2) return 0;
+    bands->band_height = (grid_size + num_bands - 1) / num_bands;
+    bands->num_bands = (grid_size + bands->band_height - 1) /
+            bands->band_height;
+    bands->num_chunks = num_threads;
+    bands->num_points = num_points;
+    bands->chunk_start = (size_t*) malloc(
+            (num_threads + 1) * sizeof(size_t));
+    bands->row_min = (int*) malloc(num_points * sizeof(int));
+    bands->row_max = (int*) malloc(num_points * sizeof(int));
+    bands->band_start = (size_t*) calloc(
+            bands->num_bands + 1, sizeof(size_t));
+    bands->band_vis = 0;
+    bands->vis_norm = (double*) malloc(num_points * sizeof(double));
+    if (!bands->chunk_start || !bands->row_min || !bands->row_max ||
+            !bands->band_start || !bands->vis_norm)
+    {
+        oskar_grid_bands_free(bands, 0, 0);
+        return 0;
+    }
+    for (c = 0; c <= num_threads; ++c)
+        bands->chunk_start[c] = (num_points * c) / num_threads;
+    return 1;
+}
+
+
+int oskar_grid_bands_sort(oskar_GridBands* bands)
+{
+    int b, c;
+    size_t offset = 0, *counts;
+    const int num_bands = bands->num_bands;
+    const int num_chunks = bands->num_chunks;
+    const int band_height = bands->band_height;
+    counts = (size_t*) calloc(num_chunks * num_bands, sizeof(size_t));
+    if (!counts) return 0;
+
+    /* Count the visibilities in each band from each chunk. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i;
+        size_t* count = counts + c * num_bands;
+        for (i = bands->chunk_start[c]; i < bands->chunk_start[c + 1]; ++i)
+        {
+            int j;
+            if (bands->row_min[i] < 0) continue;
+            const int band_end = bands->row_max[i] / band_height;
+            for (j = bands->row_min[i] / band_height; j <= band_end; ++j)
+                count[j]++;
+        }
+    }
+
+    /* Convert the counts to offsets, so that visibilities in each band
+     * stay in their original order. */
+    for (b = 0; b < num_bands; ++b)
+    {
+        bands->band_start[b] = offset;
+        for (c = 0; c < num_chunks; ++c)
+        {
+            const size_t t = counts[c * num_bands + b];
+            counts[c * num_bands + b] = offset;
+            offset += t;
+        }
+    }
+    bands->band_start[num_bands] = offset;
+    bands->band_vis = (size_t*) malloc(offset * sizeof(size_t));
+    if (!bands->band_vis)
+    {
+        free(counts);
+        return 0;
+    }
+
+    /* Fill the list of visibilities for each band. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i;
+        size_t* pos = counts + c * num_bands;
+        for (i = bands->chunk_start[c]; i < bands->chunk_start[c + 1]; ++i)
+        {
+            int j;
+            if (bands->row_min[i] < 0) continue;
+            const int band_end = bands->row_max[i] / band_height;
+            for (j = bands->row_min[i] / band_height; j <= band_end; ++j)
+                bands->band_vis[pos[j]++] = i;
+        }
+    }
+    free(counts);
+    return 1;
+}
+
+
+void oskar_grid_bands_free(oskar_GridBands* bands, size_t* num_skipped,
+        double* norm)
+{
+    size_t i;
+    if (num_skipped && norm)
+    {
+        /* Sum the normalisation in the same order as the serial version. */
+        *num_skipped = 0;
+        for (i = 0; i < bands->num_points; ++i)
+        {
+            if (bands->row_min[i] < 0)
+                *num_skipped += 1;
+            else
+                *norm += bands->vis_norm[i];
+        }
+    }
+    free(bands->chunk_start);
+    free(bands->row_min);
+    free(bands->row_max);
+    free(bands->band_start);
+    free(bands->band_vis);
+    free(bands->vis_norm);
+}
+
+#ifdef __cplusplus
+}
+#endif
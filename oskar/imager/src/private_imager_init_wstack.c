@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_init_fft.h"
+#include "imager/private_imager_init_wstack.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum phase difference between adjacent W-layers, in radians,
+ * at the corner of the image. */
+#define MAX_LAYER_PHASE_STEP 1.0
+
+/* Memory used to buffer visibilities before gridding, for all planes. */
+#define MAX_BUFFER_BYTES (512 * 1024 * 1024)
+
+void oskar_imager_init_wstack(oskar_Imager* h, int* status)
+{
+    double max_w = 0.0;
+    if (*status) return;
+
+    /* Generate the (small, fixed) gridding kernel as for the FFT imager. */
+    oskar_imager_init_fft(h, status);
+
+    /* Get the maximum baseline W value to cover.
+     * Visibilities with negative W are gridded as their conjugates,
+     * so only the magnitude of W matters here. */
+    if (h->ww_max > 0.0)
+        max_w = h->ww_max;
+    else
+    {
+        max_w = 0.25 / fabs(h->cellsize_rad);
+        oskar_log_warning(h->log, "Baseline W range is not known: "
+                "W-layers will cover |W| up to %.3f wavelengths only.", max_w);
+    }
+
+    /* Evaluate number of W-layers if not set, and the layer spacing.
+     * The largest value of (1 - n) is at the corners of the image. */
+    if (h->num_w_planes < 1)
+    {
+        const double l_max = sin(0.5 * h->fov_deg * M_PI / 180.0);
+        const double r2 = 2.0 * l_max * l_max;
+        const double one_minus_n = 1.0 - (r2 < 1.0 ? sqrt(1.0 - r2) : 0.0);
+        h->num_w_planes = 1 + (int)ceil(
+                2.0 * M_PI * max_w * one_minus_n / MAX_LAYER_PHASE_STEP);
+    }
+    h->w_layer_inc = (h->num_w_planes > 1) ?
+            max_w / (h->num_w_planes - 1) : 0.0;
+
+    /* Create scratch arrays for one W-layer at a time. */
+    const int prec = h->imager_prec;
+    const int size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) size * (size_t) size;
+    const size_t vis_bytes = 6 * oskar_mem_element_size(prec);
+    h->w_stack_max_vis = MAX_BUFFER_BYTES /
+            (vis_bytes * (h->num_planes > 0 ? h->num_planes : 1));
+    oskar_mem_free(h->w_layer_uu, status);
+    oskar_mem_free(h->w_layer_vv, status);
+    oskar_mem_free(h->w_layer_vis, status);
+    oskar_mem_free(h->w_layer_weight, status);
+    oskar_mem_free(h->w_layer_grid, status);
+    oskar_mem_free(h->w_layer_screen, status);
+    oskar_mem_free(h->w_layer_taper, status);
+    h->w_layer_uu = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+    h->w_layer_vv = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+    h->w_layer_vis = oskar_mem_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
+    h->w_layer_weight = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+    h->w_layer_grid = oskar_mem_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_cells, status);
+    h->w_layer_screen = oskar_mem_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_cells, status);
+
+    /* The phase screen is not tapered: the grid correction is applied
+     * to the stacked image when it is finalised. */
+    h->w_layer_taper = oskar_mem_create(prec, OSKAR_CPU, size, status);
+    oskar_mem_set_value_real(h->w_layer_taper, 1.0, 0, size, status);
+
+    /* Create the FFT plan used to transform each layer. */
+    oskar_fft_free(h->fft);
+    h->fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0, status);
+
+    /* Record data about the layers. */
+    oskar_log_message(h->log, 'M', 0, "Baseline W values (wavelengths)");
+    oskar_log_message(h->log, 'M', 1, "Min: %.12e", h->ww_min);
+    oskar_log_message(h->log, 'M', 1, "Max: %.12e", h->ww_max);
+    oskar_log_message(h->log, 'M', 1, "RMS: %.12e", h->ww_rms);
+    oskar_log_message(h->log, 'M', 0,
+            "Using %d W-layers, spaced by %.3f wavelengths.",
+            h->num_w_planes, h->w_layer_inc);
+    if (h->grid_on_gpu && h->num_gpus > 0)
+        oskar_log_warning(h->log,
+                "W-stacking layers will be gridded using the CPU.");
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/private_imager_generate_w_phase_screen.h"
+#include "imager/private_imager_update_plane_wstack.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftphase.h"
+#include "utility/oskar_timer.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void grid_layers(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status);
+static void flush_buffer(oskar_Imager* h, int i_plane, size_t* num_skipped,
+        int* status);
+static void sort_into_layers(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, size_t* layer_start,
+        size_t* num_clamped, int* status);
+static void grid_layer(oskar_Imager* h, size_t start, size_t num_points,
+        int grid_size, double* plane_norm, size_t* num_skipped, int* status);
+static void add_layer(int size, const oskar_Mem* layer,
+        const oskar_Mem* screen, oskar_Mem* plane, int* status);
+
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int i_plane,
+        oskar_Mem* plane, double* plane_norm, size_t* num_skipped,
+        int* status)
+{
+    WStackBuffer* buf;
+    if (*status) return;
+    *num_skipped = 0;
+
+    /* Grid the visibilities straight away if the plane was supplied. */
+    if (plane)
+    {
+        grid_layers(h, num_vis, uu, vv, ww, amps, weight, plane,
+                plane_norm, num_skipped, status);
+        return;
+    }
+    if (!h->planes)
+    {
+        *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Otherwise, buffer the visibilities for this plane,
+     * so that each layer is transformed as few times as possible. */
+    if (!h->w_stack_buffers)
+        h->w_stack_buffers = (WStackBuffer*) calloc(
+                h->num_planes, sizeof(WStackBuffer));
+    buf = &h->w_stack_buffers[i_plane];
+    if (buf->num_vis + num_vis > h->w_stack_max_vis)
+        flush_buffer(h, i_plane, num_skipped, status);
+    if (num_vis >= h->w_stack_max_vis)
+    {
+        size_t num_skipped_now = 0;
+        grid_layers(h, num_vis, uu, vv, ww, amps, weight, h->planes[i_plane],
+                plane_norm, &num_skipped_now, status);
+        *num_skipped += num_skipped_now;
+        return;
+    }
+    if (!buf->uu)
+    {
+        const int prec = h->imager_prec;
+        const size_t len = h->w_stack_max_vis;
+        buf->uu = oskar_mem_create(prec, OSKAR_CPU, len, status);
+        buf->vv = oskar_mem_create(prec, OSKAR_CPU, len, status);
+        buf->ww = oskar_mem_create(prec, OSKAR_CPU, len, status);
+        buf->vis = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_CPU, len, status);
+        buf->weight = oskar_mem_create(prec, OSKAR_CPU, len, status);
+    }
+    oskar_mem_copy_contents(buf->uu, uu, buf->num_vis, 0, num_vis, status);
+    oskar_mem_copy_contents(buf->vv, vv, buf->num_vis, 0, num_vis, status);
+    oskar_mem_copy_contents(buf->ww, ww, buf->num_vis, 0, num_vis, status);
+    oskar_mem_copy_contents(buf->vis, amps, buf->num_vis, 0, num_vis, status);
+    oskar_mem_copy_contents(buf->weight, weight,
+            buf->num_vis, 0, num_vis, status);
+    if (!*status) buf->num_vis += num_vis;
+}
+
+
+void oskar_imager_flush_wstack(oskar_Imager* h, int* status)
+{
+    int i;
+    size_t num_skipped = 0;
+    if (*status || !h->w_stack_buffers || !h->planes) return;
+    oskar_timer_resume(h->tmr_grid_update);
+    for (i = 0; i < h->num_planes; ++i)
+    {
+        size_t num_skipped_plane = 0;
+        flush_buffer(h, i, &num_skipped_plane, status);
+        num_skipped += num_skipped_plane;
+    }
+    oskar_timer_pause(h->tmr_grid_update);
+    h->num_vis_processed -= num_skipped;
+    if (num_skipped > 0)
+        oskar_log_warning(h->log, "Skipped %lu visibility points.",
+                (unsigned long) num_skipped);
+}
+
+
+void oskar_imager_free_wstack_buffers(oskar_Imager* h, int* status)
+{
+    int i;
+    if (!h->w_stack_buffers) return;
+    for (i = 0; i < h->num_planes; ++i)
+    {
+        WStackBuffer* buf = &h->w_stack_buffers[i];
+        oskar_mem_free(buf->uu, status);
+        oskar_mem_free(buf->vv, status);
+        oskar_mem_free(buf->ww, status);
+        oskar_mem_free(buf->vis, status);
+        oskar_mem_free(buf->weight, status);
+    }
+    free(h->w_stack_buffers);
+    h->w_stack_buffers = 0;
+}
+
+
+static void flush_buffer(oskar_Imager* h, int i_plane, size_t* num_skipped,
+        int* status)
+{
+    WStackBuffer* buf = &h->w_stack_buffers[i_plane];
+    if (buf->num_vis == 0) return;
+    grid_layers(h, buf->num_vis, buf->uu, buf->vv, buf->ww, buf->vis,
+            buf->weight, h->planes[i_plane], &h->plane_norm[i_plane],
+            num_skipped, status);
+    buf->num_vis = 0;
+}
+
+
+static void grid_layers(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status)
+{
+    int k;
+    size_t* layer_start = 0, num_clamped = 0;
+    if (*status) return;
+    if (oskar_mem_location(plane) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(plane) != h->imager_prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    const int num_layers = h->num_w_planes;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
+    oskar_mem_ensure(plane, num_cells, status);
+    if (*status) return;
+
+    /* Sort the visibilities by W-layer. */
+    layer_start = (size_t*) calloc(num_layers + 1, sizeof(size_t));
+    if (!layer_start)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    sort_into_layers(h, num_vis, uu, vv, ww, amps, weight,
+            layer_start, &num_clamped, status);
+    if (num_clamped > 0)
+        oskar_log_warning(h->log, "%lu visibility points with |W| beyond "
+                "%.3f wavelengths were gridded in the last W-layer.",
+                (unsigned long) num_clamped,
+                (num_layers - 1) * h->w_layer_inc);
+
+    /* Grid and transform each layer in turn, so that only one
+     * layer needs to be held in memory at once.
+     * The image of each layer is multiplied by its W-phase screen,
+     * and added to the image plane. */
+    *num_skipped = 0;
+    for (k = 0; k < num_layers; ++k)
+    {
+        size_t layer_skipped = 0;
+        const size_t start = layer_start[k];
+        const size_t num_points = layer_start[k + 1] - start;
+        if (num_points == 0 || *status) continue;
+        oskar_mem_clear_contents(h->w_layer_grid, status);
+        grid_layer(h, start, num_points, grid_size, plane_norm,
+                &layer_skipped, status);
+        *num_skipped += layer_skipped;
+        if (layer_skipped == num_points) continue;
+        oskar_fftphase(grid_size, grid_size, h->w_layer_grid, status);
+        oskar_fft_exec(h->fft, h->w_layer_grid, status);
+        oskar_fftphase(grid_size, grid_size, h->w_layer_grid, status);
+        if (k > 0)
+            oskar_imager_generate_w_phase_screen(1, grid_size, grid_size,
+                    h->cellsize_rad, 1.0 / (k * h->w_layer_inc),
+                    h->w_layer_taper, h->w_layer_screen, status);
+        add_layer(grid_size, h->w_layer_grid,
+                (k > 0 ? h->w_layer_screen : 0), plane, status);
+    }
+    free(layer_start);
+}
+
+
+static int layer_index(double w, double inv_inc, int num_layers)
+{
+    const int k = (int) (fabs(w) * inv_inc + 0.5);
+    return k < num_layers ? k : num_layers - 1;
+}
+
+
+static void sort_into_layers(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, size_t* layer_start,
+        size_t* num_clamped, int* status)
+{
+    int k;
+    size_t i, *fill;
+    const int num_layers = h->num_w_planes;
+    const double inv_inc = h->w_layer_inc > 0.0 ? 1.0 / h->w_layer_inc : 0.0;
+
+    /* Visibilities at or beyond this |W| are put in the last layer. */
+    const double w_clamp = h->w_layer_inc > 0.0 ?
+            (num_layers - 0.5) * h->w_layer_inc : DBL_MAX;
+    oskar_mem_ensure(h->w_layer_uu, num_vis, status);
+    oskar_mem_ensure(h->w_layer_vv, num_vis, status);
+    oskar_mem_ensure(h->w_layer_vis, num_vis, status);
+    oskar_mem_ensure(h->w_layer_weight, num_vis, status);
+    if (*status) return;
+
+    /* Count the visibilities in each layer, and get the layer offsets. */
+    fill = (size_t*) calloc(num_layers, sizeof(size_t));
+    if (!fill)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    *num_clamped = 0;
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        const double* w = oskar_mem_double_const(ww, status);
+        for (i = 0; i < num_vis; ++i)
+        {
+            fill[layer_index(w[i], inv_inc, num_layers)]++;
+            if (fabs(w[i]) >= w_clamp) (*num_clamped)++;
+        }
+    }
+    else
+    {
+        const float* w = oskar_mem_float_const(ww, status);
+        for (i = 0; i < num_vis; ++i)
+        {
+            fill[layer_index(w[i], inv_inc, num_layers)]++;
+            if (fabs(w[i]) >= w_clamp) (*num_clamped)++;
+        }
+    }
+    layer_start[0] = 0;
+    for (k = 0; k < num_layers; ++k)
+    {
+        layer_start[k + 1] = layer_start[k] + fill[k];
+        fill[k] = layer_start[k];
+    }
+
+    /* Copy the visibilities into their layers.
+     * Visibilities with negative W are replaced by their conjugates
+     * at (-u, -v, -w), which contribute the same (real) image. */
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        const double *u = oskar_mem_double_const(uu, status);
+        const double *v = oskar_mem_double_const(vv, status);
+        const double *w = oskar_mem_double_const(ww, status);
+        const double *a = oskar_mem_double_const(amps, status);
+        const double *wt = oskar_mem_double_const(weight, status);
+        double *s_u = oskar_mem_double(h->w_layer_uu, status);
+        double *s_v = oskar_mem_double(h->w_layer_vv, status);
+        double *s_a = oskar_mem_double(h->w_layer_vis, status);
+        double *s_wt = oskar_mem_double(h->w_layer_weight, status);
+        for (i = 0; i < num_vis; ++i)
+        {
+            const size_t j = fill[layer_index(w[i], inv_inc, num_layers)]++;
+            const double sign = (w[i] < 0.0) ? -1.0 : 1.0;
+            s_u[j] = sign * u[i];
+            s_v[j] = sign * v[i];
+            s_a[2 * j]     = a[2 * i];
+            s_a[2 * j + 1] = sign * a[2 * i + 1];
+            s_wt[j] = wt[i];
+        }
+    }
+    else
+    {
+        const float *u = oskar_mem_float_const(uu, status);
+        const float *v = oskar_mem_float_const(vv, status);
+        const float *w = oskar_mem_float_const(ww, status);
+        const float *a = oskar_mem_float_const(amps, status);
+        const float *wt = oskar_mem_float_const(weight, status);
+        float *s_u = oskar_mem_float(h->w_layer_uu, status);
+        float *s_v = oskar_mem_float(h->w_layer_vv, status);
+        float *s_a = oskar_mem_float(h->w_layer_vis, status);
+        float *s_wt = oskar_mem_float(h->w_layer_weight, status);
+        for (i = 0; i < num_vis; ++i)
+        {
+            const size_t j = fill[layer_index(w[i], inv_inc, num_layers)]++;
+            const float sign = (w[i] < 0.0f) ? -1.0f : 1.0f;
+            s_u[j] = sign * u[i];
+            s_v[j] = sign * v[i];
+            s_a[2 * j]     = a[2 * i];
+            s_a[2 * j + 1] = sign * a[2 * i + 1];
+            s_wt[j] = wt[i];
+        }
+    }
+    free(fill);
+}
+
+
+static void grid_layer(oskar_Imager* h, size_t start, size_t num_points,
+        int grid_size, double* plane_norm, size_t* num_skipped, int* status)
+{
+    if (h->imager_prec == OSKAR_DOUBLE)
+        oskar_grid_simple_d(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, status), num_points,
+                oskar_mem_double_const(h->w_layer_uu, status) + start,
+                oskar_mem_double_const(h->w_layer_vv, status) + start,
+                oskar_mem_double_const(h->w_layer_vis, status) + 2 * start,
+                oskar_mem_double_const(h->w_layer_weight, status) + start,
+                h->cellsize_rad, grid_size, num_skipped, plane_norm,
+                oskar_mem_double(h->w_layer_grid, status));
+    else
+        oskar_grid_simple_f(h->support, h->oversample,
+                oskar_mem_float_const(h->conv_func, status), num_points,
+                oskar_mem_float_const(h->w_layer_uu, status) + start,
+                oskar_mem_float_const(h->w_layer_vv, status) + start,
+                oskar_mem_float_const(h->w_layer_vis, status) + 2 * start,
+                oskar_mem_float_const(h->w_layer_weight, status) + start,
+                (float) (h->cellsize_rad), grid_size, num_skipped, plane_norm,
+                oskar_mem_float(h->w_layer_grid, status));
+}
+
+
+static void add_layer(int size, const oskar_Mem* layer,
+        const oskar_Mem* screen, oskar_Mem* plane, int* status)
+{
+    int y;
+    if (*status) return;
+
+    /* The image is centred, but the phase screen has its origin in the
+     * first pixel, so the screen is indexed with a shift of half its size. */
+    const int half = size / 2;
+    if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+    {
+        const double *in = oskar_mem_double_const(layer, status);
+        const double *scr = screen ? oskar_mem_double_const(screen, status) : 0;
+        double *out = oskar_mem_double(plane, status);
+#pragma omp parallel for private(y)
+        for (y = 0; y < size; ++y)
+        {
+            int x;
+            const size_t row = (size_t) y * size;
+            const size_t row_s = (size_t) ((y + half) % size) * size;
+            for (x = 0; x < size; ++x)
+            {
+                const size_t i = 2 * (row + x);
+                if (scr)
+                {
+                    const size_t j = 2 * (row_s + (x + half) % size);
+                    out[i]     += in[i] * scr[j] + in[i + 1] * scr[j + 1];
+                    out[i + 1] += in[i + 1] * scr[j] - in[i] * scr[j + 1];
+                }
+                else
+                {
+                    out[i]     += in[i];
+                    out[i + 1] += in[i + 1];
+                }
+            }
+        }
+    }
+    else
+    {
+        const float *in = oskar_mem_float_const(layer, status);
+        const float *scr = screen ? oskar_mem_float_const(screen, status) : 0;
+        float *out = oskar_mem_float(plane, status);
+#pragma omp parallel for private(y)
+        for (y = 0; y < size; ++y)
+        {
+            int x;
+            const size_t row = (size_t) y * size;
+            const size_t row_s = (size_t) ((y + half) % size) * size;
+            for (x = 0; x < size; ++x)
+            {
+                const size_t i = 2 * (row + x);
+                if (scr)
+                {
+                    const size_t j = 2 * (row_s + (x + half) % size);
+                    out[i]     += in[i] * scr[j] + in[i + 1] * scr[j + 1];
+                    out[i + 1] += in[i + 1] * scr[j] - in[i] * scr[j + 1];
+                }
+                else
+                {
+                    out[i]     += in[i];
+                    out[i + 1] += in[i + 1];
+                }
+            }
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_w_kernel_cache.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_file_exists.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Increment if the kernel generation or the file contents change. */
+#define CACHE_FORMAT_VERSION 1
+#define NUM_PARAMS 12
+
+static void get_params(oskar_Imager* h, int conv_size,
+        double params[NUM_PARAMS])
+{
+    params[0] = CACHE_FORMAT_VERSION;
+    params[1] = h->imager_prec;
+    params[2] = h->kernel_type;
+    params[3] = h->image_size;
+    params[4] = oskar_imager_plane_size(h);
+    params[5] = h->cellsize_rad;
+    params[6] = h->fov_deg;
+    params[7] = h->oversample;
+    params[8] = h->support;
+    params[9] = h->num_w_planes;
+    params[10] = h->w_scale;
+    params[11] = conv_size;
+}
+
+
+char* oskar_imager_w_kernel_cache_path(oskar_Imager* h, int conv_size)
+{
+    char name[64];
+    size_t i;
+    double params[NUM_PARAMS];
+    const unsigned char* bytes = (const unsigned char*) params;
+    unsigned long long hash = 14695981039346656037ULL;
+    if (!h->w_kernel_cache_dir) return 0;
+
+    /* Use the 64-bit FNV-1a hash of the parameters as the file name. */
+    get_params(h, conv_size, params);
+    for (i = 0; i < sizeof(params); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    sprintf(name, "oskar_w_kernels_%016llx.bin", hash);
+    return oskar_dir_get_path(h->w_kernel_cache_dir, name);
+}
+
+
+/* Returns the length of the compacted kernel array needed by the
+ * support sizes and start indices, or 0 if they are invalid. */
+static size_t required_kernel_length(const oskar_Imager* h,
+        const oskar_Mem* support, const oskar_Mem* kernel_start)
+{
+    int w, status = 0;
+    size_t required = 0;
+    const int* supp = oskar_mem_int_const(support, &status);
+    const int* start = oskar_mem_int_const(kernel_start, &status);
+    const size_t height = (size_t) (h->oversample / 2) + 1;
+    if (status) return 0;
+    for (w = 0; w < h->num_w_planes; ++w)
+    {
+        if (supp[w] < 0 || start[w] < 0) return 0;
+        const size_t conv_len = 2 * (size_t) supp[w] + 1;
+        const size_t width =
+                ((size_t) (h->oversample / 2) * conv_len + 1) * conv_len;
+        const size_t end = (size_t) start[w] + width * height;
+        if (end > required) required = end;
+    }
+    return required;
+}
+
+
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h, const char* path,
+        int conv_size)
+{
+    int status = 0;
+    double params[NUM_PARAMS], stored[NUM_PARAMS];
+    oskar_Binary* file = 0;
+    oskar_Mem *support = 0, *kernel_start = 0, *kernels = 0;
+    const unsigned char group = (unsigned char) OSKAR_TAG_GROUP_W_KERNELS;
+    if (!path || !oskar_file_exists(path)) return 0;
+
+    /* Check the parameters stored in the file match the current ones,
+     * in case of a hash collision. */
+    get_params(h, conv_size, params);
+    file = oskar_binary_create(path, 'r', &status);
+    oskar_binary_read(file, OSKAR_DOUBLE, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_PARAMS, 0,
+            sizeof(stored), stored, &status);
+    if (!status && memcmp(params, stored, sizeof(params)))
+    {
+        oskar_log_warning(h->log, "Ignoring W-kernel cache file '%s': "
+                "stored parameters do not match.", path);
+        oskar_binary_free(file);
+        return 0;
+    }
+
+    /* Read the kernels, with their support sizes and start indices. */
+    support = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    kernels = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_binary_read_mem(file, support, group,
+            OSKAR_IMAGER_TAG_W_SUPPORT, 0, &status);
+    oskar_binary_read_mem(file, kernel_start, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_START, 0, &status);
+    oskar_binary_read_mem(file, kernels, group,
+            OSKAR_IMAGER_TAG_W_KERNELS, 0, &status);
+    oskar_binary_free(file);
+    if (!status && (
+            (int) oskar_mem_length(support) != h->num_w_planes ||
+            (int) oskar_mem_length(kernel_start) != h->num_w_planes))
+        status = OSKAR_ERR_DIMENSION_MISMATCH;
+    if (!status)
+    {
+        /* Check the kernels cover every plane's footprint, so that
+         * gridding cannot read past the end of the array. */
+        const size_t required =
+                required_kernel_length(h, support, kernel_start);
+        if (required == 0 || oskar_mem_length(kernels) < required)
+            status = OSKAR_ERR_DIMENSION_MISMATCH;
+    }
+    if (status)
+    {
+        oskar_log_warning(h->log, "Ignoring W-kernel cache file '%s': %s.",
+                path, oskar_get_error_string(status));
+        status = 0;
+        oskar_mem_free(support, &status);
+        oskar_mem_free(kernel_start, &status);
+        oskar_mem_free(kernels, &status);
+        return 0;
+    }
+
+    /* Replace any existing kernels. */
+    oskar_mem_free(h->w_support, &status);
+    oskar_mem_free(h->w_kernel_start, &status);
+    oskar_mem_free(h->w_kernels_compact, &status);
+    h->w_support = support;
+    h->w_kernel_start = kernel_start;
+    h->w_kernels_compact = kernels;
+    return 1;
+}
+
+
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h, const char* path,
+        int conv_size)
+{
+    int status = 0;
+    char* temp_path = 0;
+    double params[NUM_PARAMS];
+    oskar_Binary* file = 0;
+    const unsigned char group = (unsigned char) OSKAR_TAG_GROUP_W_KERNELS;
+    if (!path || !h->w_support || !h->w_kernel_start ||
+            !h->w_kernels_compact) return;
+    if (!oskar_dir_exists(h->w_kernel_cache_dir) &&
+            !oskar_dir_mkpath(h->w_kernel_cache_dir))
+    {
+        oskar_log_warning(h->log, "Could not create W-kernel cache "
+                "directory '%s'.", h->w_kernel_cache_dir);
+        return;
+    }
+
+    /* Write to a temporary file first, then rename it, so that other
+     * processes never see a partially-written cache file.
+     * The temporary name is unique to this process and imager, so that
+     * concurrent writers do not interfere, and a file left behind by a
+     * process that was killed does not stop the cache being written. */
+    temp_path = (char*) calloc(64 + strlen(path), 1);
+    sprintf(temp_path, "%s.%d.%p.tmp", path, (int) getpid(), (void*) h);
+    get_params(h, conv_size, params);
+    file = oskar_binary_create(temp_path, 'w', &status);
+    oskar_binary_write(file, OSKAR_DOUBLE, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_PARAMS, 0,
+            sizeof(params), params, &status);
+    oskar_binary_write_mem(file, h->w_support, group,
+            OSKAR_IMAGER_TAG_W_SUPPORT, 0, 0, &status);
+    oskar_binary_write_mem(file, h->w_kernel_start, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_START, 0, 0, &status);
+    oskar_binary_write_mem(file, h->w_kernels_compact, group,
+            OSKAR_IMAGER_TAG_W_KERNELS, 0, 0, &status);
+    oskar_binary_free(file);
+    if (status || rename(temp_path, path))
+    {
+        remove(temp_path);
+        if (!status && !oskar_file_exists(path)) status = OSKAR_ERR_FILE_IO;
+    }
+    if (status)
+        oskar_log_warning(h->log, "Could not save W-kernel cache file "
+                "'%s': %s.", path, oskar_get_error_string(status));
+    else
+        oskar_log_message(h->log, 'M', 0,
+                "Saved W-kernels to cache file '%s'.", path);
+    free(temp_path);
+}
+
+#ifdef __cplusplus
+}
+#endif
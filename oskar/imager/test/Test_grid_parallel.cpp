@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj2.h"
+
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void set_num_threads(int num_threads)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+}
+
+template <typename FP>
+static void generate_vis(int num_points, std::vector<FP>& uu,
+        std::vector<FP>& vv, std::vector<FP>& ww, std::vector<FP>& vis,
+        std::vector<FP>& weight)
+{
+    uu.resize(num_points);
+    vv.resize(num_points);
+    ww.resize(num_points);
+    vis.resize(2 * num_points);
+    weight.resize(num_points);
+    for (int i = 0; i < num_points; ++i)
+    {
+        // Some of these points will fall off the edge of the grid.
+        const double r = 1100.0 * std::sqrt((i + 0.5) / num_points);
+        uu[i] = (FP) (r * std::sin(0.7 * i));
+        vv[i] = (FP) (r * std::cos(0.7 * i));
+        ww[i] = (FP) (300.0 * std::sin(0.3 * i));
+        vis[2 * i] = (FP) std::cos(0.1 * i);
+        vis[2 * i + 1] = (FP) std::sin(0.2 * i);
+        weight[i] = (FP) (1.0 + 0.5 * std::sin(0.05 * i));
+    }
+}
+
+template <typename FP>
+static void grid_simple(int support, int oversample, int num_threads,
+        std::vector<FP>& grid, double* norm, size_t* num_skipped)
+{
+    const int grid_size = 256, num_points = 40000;
+    const FP cell_size_rad = (FP) (1.0 / 512.0);
+    std::vector<FP> conv_func(oversample * (support + 1));
+    std::vector<FP> uu, vv, ww, vis, weight;
+    for (size_t i = 0; i < conv_func.size(); ++i)
+    {
+        const double x = (double) i / oversample;
+        conv_func[i] = (FP) std::exp(-x * x / 2.0);
+    }
+    generate_vis(num_points, uu, vv, ww, vis, weight);
+    grid.assign(2 * grid_size * grid_size, (FP) 0);
+    *norm = 0.0;
+    set_num_threads(num_threads);
+    if (sizeof(FP) == sizeof(double))
+        oskar_grid_simple_d(support, oversample,
+                (const double*) &conv_func[0], num_points,
+                (const double*) &uu[0], (const double*) &vv[0],
+                (const double*) &vis[0], (const double*) &weight[0],
+                cell_size_rad, grid_size, num_skipped, norm,
+                (double*) &grid[0]);
+    else
+        oskar_grid_simple_f(support, oversample,
+                (const float*) &conv_func[0], num_points,
+                (const float*) &uu[0], (const float*) &vv[0],
+                (const float*) &vis[0], (const float*) &weight[0],
+                (float) cell_size_rad, grid_size, num_skipped, norm,
+                (float*) &grid[0]);
+}
+
+template <typename FP>
+static void grid_wproj2(int num_threads, std::vector<FP>& grid, double* norm,
+        size_t* num_skipped)
+{
+    const int grid_size = 256, num_points = 40000, oversample = 4;
+    const int num_w_planes = 4, support[] = {3, 4, 5, 6};
+    const FP cell_size_rad = (FP) (1.0 / 512.0), w_scale = (FP) 0.1;
+    int wkernel_start[num_w_planes], kernel_size = 0;
+    std::vector<FP> wkernel, uu, vv, ww, vis, weight;
+
+    // Generate arbitrary kernel values for each W-plane.
+    for (int i = 0; i < num_w_planes; ++i)
+    {
+        const int conv_len = 2 * support[i] + 1;
+        const int width = ((oversample / 2) * conv_len + 1) * conv_len;
+        wkernel_start[i] = kernel_size;
+        kernel_size += (oversample / 2 + 1) * width;
+    }
+    wkernel.resize(2 * kernel_size);
+    for (int i = 0; i < 2 * kernel_size; ++i)
+        wkernel[i] = (FP) std::cos(0.01 * i);
+    generate_vis(num_points, uu, vv, ww, vis, weight);
+    grid.assign(2 * grid_size * grid_size, (FP) 0);
+    *norm = 0.0;
+    set_num_threads(num_threads);
+    if (sizeof(FP) == sizeof(double))
+        oskar_grid_wproj2_d(num_w_planes, support, oversample,
+                wkernel_start, (const double*) &wkernel[0], num_points,
+                (const double*) &uu[0], (const double*) &vv[0],
+                (const double*) &ww[0], (const double*) &vis[0],
+                (const double*) &weight[0], cell_size_rad, w_scale,
+                grid_size, num_skipped, norm, (double*) &grid[0]);
+    else
+        oskar_grid_wproj2_f(num_w_planes, support, oversample,
+                wkernel_start, (const float*) &wkernel[0], num_points,
+                (const float*) &uu[0], (const float*) &vv[0],
+                (const float*) &ww[0], (const float*) &vis[0],
+                (const float*) &weight[0], (float) cell_size_rad,
+                (float) w_scale, grid_size, num_skipped, norm,
+                (float*) &grid[0]);
+}
+
+template <typename FP>
+static void check_identical(const std::vector<FP>& grid1, double norm1,
+        size_t num_skipped1, const std::vector<FP>& grid2, double norm2,
+        size_t num_skipped2)
+{
+    EXPECT_GT(num_skipped1, 0u);
+    EXPECT_EQ(num_skipped1, num_skipped2);
+    EXPECT_EQ(norm1, norm2);
+    ASSERT_EQ(grid1.size(), grid2.size());
+    for (size_t i = 0; i < grid1.size(); ++i)
+        ASSERT_EQ(grid1[i], grid2[i]) << "Grid mismatch at " << i;
+}
+
+template <typename FP>
+static void test_simple(int support, int oversample)
+{
+#ifdef _OPENMP
+    const int num_threads = omp_get_max_threads();
+#else
+    const int num_threads = 1;
+#endif
+    std::vector<FP> grid1, grid2;
+    double norm1 = 0.0, norm2 = 0.0;
+    size_t num_skipped1 = 0, num_skipped2 = 0;
+    grid_simple<FP>(support, oversample, 1, grid1, &norm1, &num_skipped1);
+    grid_simple<FP>(support, oversample, 4, grid2, &norm2, &num_skipped2);
+    set_num_threads(num_threads);
+    check_identical(grid1, norm1, num_skipped1, grid2, norm2, num_skipped2);
+}
+
+template <typename FP>
+static void test_wproj2()
+{
+#ifdef _OPENMP
+    const int num_threads = omp_get_max_threads();
+#else
+    const int num_threads = 1;
+#endif
+    std::vector<FP> grid1, grid2;
+    double norm1 = 0.0, norm2 = 0.0;
+    size_t num_skipped1 = 0, num_skipped2 = 0;
+    grid_wproj2<FP>(1, grid1, &norm1, &num_skipped1);
+    grid_wproj2<FP>(4, grid2, &norm2, &num_skipped2);
+    set_num_threads(num_threads);
+    check_identical(grid1, norm1, num_skipped1, grid2, norm2, num_skipped2);
+}
+
+TEST(grid_parallel, simple_default_double)
+{
+    test_simple<double>(3, 100);
+}
+
+TEST(grid_parallel, simple_default_single)
+{
+    test_simple<float>(3, 100);
+}
+
+TEST(grid_parallel, simple_double)
+{
+    test_simple<double>(5, 64);
+}
+
+TEST(grid_parallel, simple_single)
+{
+    test_simple<float>(5, 64);
+}
+
+TEST(grid_parallel, wproj2_double)
+{
+    test_wproj2<double>();
+}
+
+TEST(grid_parallel, wproj2_single)
+{
+    test_wproj2<float>();
+}
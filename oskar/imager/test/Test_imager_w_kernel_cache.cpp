@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "math/oskar_cmath.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const char* cache_dir = "temp_test_w_kernel_cache";
+
+// Returns the number of W-kernel cache files in the cache directory.
+static int num_cache_files()
+{
+    int num_items = 0;
+    char** items = 0;
+    oskar_dir_items(cache_dir, "oskar_w_kernels_*.bin", 1, 0,
+            &num_items, &items);
+    for (int i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+    return num_items;
+}
+
+// Returns the path of the first W-kernel cache file in the cache directory.
+static char* first_cache_file()
+{
+    int num_items = 0;
+    char** items = 0;
+    char* path = 0;
+    oskar_dir_items(cache_dir, "oskar_w_kernels_*.bin", 1, 0,
+            &num_items, &items);
+    if (num_items > 0) path = oskar_dir_get_path(cache_dir, items[0]);
+    for (int i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+    return path;
+}
+
+// Rewrites a cache file with all the W-kernel values set to 1,
+// optionally dropping the second half of the kernel array.
+static void overwrite_cached_kernels(const char* path, int precision,
+        bool truncate = false)
+{
+    int status = 0;
+    const unsigned char group = (unsigned char) OSKAR_TAG_GROUP_W_KERNELS;
+    double params[64];
+    size_t params_size = 0;
+    oskar_Binary* file = oskar_binary_create(path, 'r', &status);
+    oskar_binary_query(file, OSKAR_DOUBLE, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_PARAMS, 0, &params_size, &status);
+    ASSERT_LE(params_size, sizeof(params));
+    oskar_binary_read(file, OSKAR_DOUBLE, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_PARAMS, 0,
+            params_size, params, &status);
+    oskar_Mem* support = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_Mem* start = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_Mem* kernels = oskar_mem_create(precision | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+    oskar_binary_read_mem(file, support, group,
+            OSKAR_IMAGER_TAG_W_SUPPORT, 0, &status);
+    oskar_binary_read_mem(file, start, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_START, 0, &status);
+    oskar_binary_read_mem(file, kernels, group,
+            OSKAR_IMAGER_TAG_W_KERNELS, 0, &status);
+    oskar_binary_free(file);
+    if (truncate)
+        oskar_mem_realloc(kernels, oskar_mem_length(kernels) / 2, &status);
+    oskar_mem_set_value_real(kernels, 1.0, 0, oskar_mem_length(kernels),
+            &status);
+    file = oskar_binary_create(path, 'w', &status);
+    oskar_binary_write(file, OSKAR_DOUBLE, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_PARAMS, 0,
+            params_size, params, &status);
+    oskar_binary_write_mem(file, support, group,
+            OSKAR_IMAGER_TAG_W_SUPPORT, 0, 0, &status);
+    oskar_binary_write_mem(file, start, group,
+            OSKAR_IMAGER_TAG_W_KERNEL_START, 0, 0, &status);
+    oskar_binary_write_mem(file, kernels, group,
+            OSKAR_IMAGER_TAG_W_KERNELS, 0, 0, &status);
+    oskar_binary_free(file);
+    oskar_mem_free(support, &status);
+    oskar_mem_free(start, &status);
+    oskar_mem_free(kernels, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+// Makes a W-projection image of a point source, optionally using the cache.
+static std::vector<double> make_image(int precision, int image_size,
+        bool use_cache)
+{
+    int status = 0;
+    double norm = 0.0;
+    const int num_vis = 1000;
+    const double fov_deg = 10.0;
+    std::vector<double> uu(num_vis), vv(num_vis), ww(num_vis);
+    std::vector<double> vis(2 * num_vis);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        uu[i] = 100.0 * sin(0.7 * i) * sqrt((i + 0.5) / num_vis);
+        vv[i] = 100.0 * cos(0.7 * i) * sqrt((i + 0.5) / num_vis);
+        ww[i] = 50.0 * sin(0.3 * i);
+        const double phase = 2.0 * M_PI * (uu[i] * 0.02 - vv[i] * 0.01);
+        vis[2 * i] = cos(phase);
+        vis[2 * i + 1] = sin(phase);
+    }
+    oskar_Mem *t_uu, *t_vv, *t_ww, *t_vis, *t_weight;
+    t_uu = oskar_mem_create_alias_from_raw(&uu[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_vv = oskar_mem_create_alias_from_raw(&vv[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_ww = oskar_mem_create_alias_from_raw(&ww[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_vis = oskar_mem_create_alias_from_raw(&vis[0],
+            OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_vis, &status);
+    t_weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_mem_set_value_real(t_weight, 1.0, 0, num_vis, &status);
+    oskar_Imager* h = oskar_imager_create(precision, &status);
+    oskar_imager_set_gpus(h, 0, 0, &status);
+    oskar_imager_set_fov(h, fov_deg);
+    oskar_imager_set_size(h, image_size, &status);
+    oskar_imager_set_algorithm(h, "W-projection", &status);
+    if (use_cache) oskar_imager_set_w_kernel_cache_dir(h, cache_dir);
+    const int plane_size = oskar_imager_plane_size(h);
+    oskar_imager_set_coords_only(h, 1);
+    oskar_imager_update_plane(h, num_vis, t_uu, t_vv, t_ww, 0, t_weight,
+            0, 0, 0, 0, &status);
+    oskar_imager_set_coords_only(h, 0);
+    oskar_imager_check_init(h, &status);
+    oskar_Mem* plane = oskar_mem_create(precision | OSKAR_COMPLEX, OSKAR_CPU,
+            (size_t) plane_size * (size_t) plane_size, &status);
+    oskar_imager_update_plane(h, num_vis, t_uu, t_vv, t_ww, t_vis, t_weight,
+            0, plane, &norm, 0, &status);
+    oskar_imager_finalise_plane(h, plane, norm, &status);
+    oskar_imager_trim_image(h, plane, plane_size, image_size, &status);
+    oskar_Mem* image = oskar_mem_convert_precision(plane, OSKAR_DOUBLE,
+            &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    const double* p = oskar_mem_double_const(image, &status);
+    std::vector<double> out(p, p + image_size * image_size);
+    oskar_mem_free(t_uu, &status);
+    oskar_mem_free(t_vv, &status);
+    oskar_mem_free(t_ww, &status);
+    oskar_mem_free(t_vis, &status);
+    oskar_mem_free(t_weight, &status);
+    oskar_mem_free(plane, &status);
+    oskar_mem_free(image, &status);
+    oskar_imager_free(h, &status);
+    return out;
+}
+
+TEST(imager_w_kernel_cache, save_and_load)
+{
+    oskar_dir_remove(cache_dir);
+
+    // Kernels should be saved to the cache on the first run,
+    // and loaded from it on the second.
+    std::vector<double> direct = make_image(OSKAR_DOUBLE, 64, false);
+    EXPECT_FALSE(oskar_dir_exists(cache_dir));
+    std::vector<double> first = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_EQ(1, num_cache_files());
+    std::vector<double> second = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_EQ(1, num_cache_files());
+    EXPECT_TRUE(direct == first);
+    EXPECT_TRUE(direct == second);
+
+    // Check the cached kernels are actually used, by modifying them.
+    char* path = first_cache_file();
+    overwrite_cached_kernels(path, OSKAR_DOUBLE);
+    std::vector<double> modified = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_FALSE(direct == modified);
+    remove(path);
+    free(path);
+    EXPECT_EQ(0, num_cache_files());
+    make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_EQ(1, num_cache_files());
+
+    // Different parameters should use a different cache file.
+    std::vector<double> direct_f = make_image(OSKAR_SINGLE, 64, false);
+    std::vector<double> cached_f = make_image(OSKAR_SINGLE, 64, true);
+    EXPECT_EQ(2, num_cache_files());
+    make_image(OSKAR_DOUBLE, 96, true);
+    EXPECT_EQ(3, num_cache_files());
+    cached_f = make_image(OSKAR_SINGLE, 64, true);
+    EXPECT_EQ(3, num_cache_files());
+    EXPECT_TRUE(direct_f == cached_f);
+
+    oskar_dir_remove(cache_dir);
+}
+
+TEST(imager_w_kernel_cache, ignore_invalid_file)
+{
+    oskar_dir_remove(cache_dir);
+    std::vector<double> direct = make_image(OSKAR_DOUBLE, 64, false);
+    make_image(OSKAR_DOUBLE, 64, true);
+    ASSERT_EQ(1, num_cache_files());
+
+    // Overwrite the cache file with junk, which should be ignored.
+    char* path = first_cache_file();
+    FILE* file = fopen(path, "wb");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "Not a W-kernel cache file.\n");
+    fclose(file);
+    std::vector<double> regenerated = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == regenerated);
+
+    // The file should have been replaced with a valid one.
+    std::vector<double> cached = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == cached);
+    EXPECT_EQ(1, num_cache_files());
+
+    // A file with too few kernel values for the stored support sizes
+    // should also be ignored, and replaced.
+    overwrite_cached_kernels(path, OSKAR_DOUBLE, true);
+    regenerated = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == regenerated);
+    cached = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == cached);
+    EXPECT_EQ(1, num_cache_files());
+    free(path);
+    oskar_dir_remove(cache_dir);
+}
+
+TEST(imager_w_kernel_cache, stale_temp_file)
+{
+    oskar_dir_remove(cache_dir);
+    std::vector<double> direct = make_image(OSKAR_DOUBLE, 64, false);
+    make_image(OSKAR_DOUBLE, 64, true);
+    ASSERT_EQ(1, num_cache_files());
+
+    // Leave a temporary file behind, as if a save had been interrupted,
+    // and check it does not stop the cache file being written again.
+    char* path = first_cache_file();
+    remove(path);
+    std::vector<char> temp_path(strlen(path) + 5);
+    sprintf(&temp_path[0], "%s.tmp", path);
+    FILE* file = fopen(&temp_path[0], "wb");
+    ASSERT_TRUE(file != NULL);
+    fclose(file);
+    EXPECT_EQ(0, num_cache_files());
+    std::vector<double> regenerated = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == regenerated);
+    EXPECT_EQ(1, num_cache_files());
+    std::vector<double> cached = make_image(OSKAR_DOUBLE, 64, true);
+    EXPECT_TRUE(direct == cached);
+    remove(&temp_path[0]);
+    free(path);
+    oskar_dir_remove(cache_dir);
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_imager.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static const int image_size = 64;
+static const double fov_deg = 20.0;
+static const double freq_hz = 299792458.0; // Wavelength of 1 metre.
+
+// Visibilities of a single point source away from the phase centre,
+// using baselines with large W components.
+static void generate_vis(int num_vis, std::vector<double>& uu,
+        std::vector<double>& vv, std::vector<double>& ww,
+        std::vector<double>& vis)
+{
+    const double l_max = sin(0.5 * fov_deg * M_PI / 180.0);
+    const double l = 0.3 * l_max, m = -0.25 * l_max;
+    const double n = sqrt(1.0 - l*l - m*m);
+    const double uv_max = 0.4 * image_size / (2.0 * l_max);
+    uu.resize(num_vis);
+    vv.resize(num_vis);
+    ww.resize(num_vis);
+    vis.resize(2 * num_vis);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        uu[i] = uv_max * sin(0.7 * i) * sqrt((i + 0.5) / num_vis);
+        vv[i] = uv_max * cos(0.7 * i) * sqrt((i + 0.5) / num_vis);
+        ww[i] = 300.0 * sin(0.3 * i);
+        const double phase = 2.0 * M_PI * (uu[i] * l + vv[i] * m +
+                ww[i] * (n - 1.0));
+        vis[2 * i] = cos(phase);
+        vis[2 * i + 1] = sin(phase);
+    }
+}
+
+// Makes an image by supplying the visibilities to a single image plane.
+static std::vector<double> make_image(const char* algorithm, int precision,
+        std::vector<double>& uu, std::vector<double>& vv,
+        std::vector<double>& ww, std::vector<double>& vis)
+{
+    int status = 0;
+    double norm = 0.0;
+    const size_t num_vis = uu.size();
+    const int is_dft = (algorithm[0] == 'D');
+    oskar_Mem *t_uu, *t_vv, *t_ww, *t_vis, *t_weight;
+    t_uu = oskar_mem_create_alias_from_raw(&uu[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_vv = oskar_mem_create_alias_from_raw(&vv[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_ww = oskar_mem_create_alias_from_raw(&ww[0],
+            OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    t_vis = oskar_mem_create_alias_from_raw(&vis[0],
+            OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_vis, &status);
+    t_weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_mem_set_value_real(t_weight, 1.0, 0, num_vis, &status);
+    oskar_Imager* h = oskar_imager_create(precision, &status);
+    oskar_imager_set_fov(h, fov_deg);
+    oskar_imager_set_size(h, image_size, &status);
+    oskar_imager_set_algorithm(h, algorithm, &status);
+    const int plane_size = oskar_imager_plane_size(h);
+    if (algorithm[0] == 'W')
+    {
+        oskar_imager_set_coords_only(h, 1);
+        oskar_imager_update_plane(h, num_vis, t_uu, t_vv, t_ww, 0, t_weight,
+                0, 0, 0, 0, &status);
+        oskar_imager_set_coords_only(h, 0);
+    }
+    oskar_imager_check_init(h, &status);
+    oskar_Mem* plane = oskar_mem_create(
+            is_dft ? precision : (precision | OSKAR_COMPLEX), OSKAR_CPU,
+            (size_t) plane_size * (size_t) plane_size, &status);
+    oskar_imager_update_plane(h, num_vis, t_uu, t_vv, t_ww, t_vis, t_weight,
+            0, plane, &norm, 0, &status);
+    oskar_imager_finalise_plane(h, plane, norm, &status);
+    oskar_imager_trim_image(h, plane, plane_size, image_size, &status);
+    oskar_Mem* image = oskar_mem_convert_precision(plane, OSKAR_DOUBLE,
+            &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    const double* p = oskar_mem_double_const(image, &status);
+    std::vector<double> out(p, p + image_size * image_size);
+    oskar_mem_free(t_uu, &status);
+    oskar_mem_free(t_vv, &status);
+    oskar_mem_free(t_ww, &status);
+    oskar_mem_free(t_vis, &status);
+    oskar_mem_free(t_weight, &status);
+    oskar_mem_free(plane, &status);
+    oskar_mem_free(image, &status);
+    oskar_imager_free(h, &status);
+    return out;
+}
+
+// Returns the maximum difference between two images, ignoring the edges.
+static double max_diff(const std::vector<double>& a,
+        const std::vector<double>& b)
+{
+    double max_diff = 0.0;
+    const int border = image_size / 10;
+    for (int y = border; y < image_size - border; ++y)
+    {
+        for (int x = border; x < image_size - border; ++x)
+        {
+            const int i = y * image_size + x;
+            max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
+        }
+    }
+    return max_diff;
+}
+
+static void test_against_dft(int precision, double tolerance)
+{
+    std::vector<double> uu, vv, ww, vis;
+    generate_vis(5000, uu, vv, ww, vis);
+    std::vector<double> dft = make_image("DFT 3D", OSKAR_DOUBLE,
+            uu, vv, ww, vis);
+    std::vector<double> fft = make_image("FFT", precision, uu, vv, ww, vis);
+    std::vector<double> wstack = make_image("W-stacking", precision,
+            uu, vv, ww, vis);
+
+    // The FFT image is badly distorted; the W-stacking image should not be.
+    const double peak = *std::max_element(dft.begin(), dft.end());
+    EXPECT_GT(max_diff(fft, dft), 0.3 * peak);
+    EXPECT_LT(max_diff(wstack, dft), tolerance * peak);
+}
+
+TEST(imager_wstack, matches_dft_3d_double)
+{
+    test_against_dft(OSKAR_DOUBLE, 0.02);
+}
+
+TEST(imager_wstack, matches_dft_3d_single)
+{
+    test_against_dft(OSKAR_SINGLE, 0.02);
+}
+
+TEST(imager_wstack, buffered_updates)
+{
+    // Check that supplying visibilities in blocks (which are buffered
+    // and gridded in batches) gives the same image as a single update.
+    int status = 0;
+    const int num_vis = 5000, num_blocks = 5;
+    const int block_size = num_vis / num_blocks;
+    std::vector<double> uu, vv, ww, vis;
+    generate_vis(num_vis, uu, vv, ww, vis);
+    std::vector<double> direct = make_image("W-stacking", OSKAR_DOUBLE,
+            uu, vv, ww, vis);
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_fov(h, fov_deg);
+    oskar_imager_set_size(h, image_size, &status);
+    oskar_imager_set_algorithm(h, "W-stacking", &status);
+    oskar_imager_set_vis_frequency(h, freq_hz, 0.0, 1);
+    oskar_Mem *t_uu, *t_vv, *t_ww, *t_vis, *t_weight;
+    t_uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, block_size, &status);
+    t_vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, block_size, &status);
+    t_ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, block_size, &status);
+    t_vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            block_size, &status);
+    t_weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, block_size, &status);
+    oskar_mem_set_value_real(t_weight, 1.0, 0, block_size, &status);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        oskar_imager_set_coords_only(h, pass == 0);
+        for (int b = 0; b < num_blocks; ++b)
+        {
+            const int offset = b * block_size;
+            memcpy(oskar_mem_void(t_uu), &uu[offset],
+                    block_size * sizeof(double));
+            memcpy(oskar_mem_void(t_vv), &vv[offset],
+                    block_size * sizeof(double));
+            memcpy(oskar_mem_void(t_ww), &ww[offset],
+                    block_size * sizeof(double));
+            memcpy(oskar_mem_void(t_vis), &vis[2 * offset],
+                    2 * block_size * sizeof(double));
+            oskar_imager_update(h, block_size, 0, 0, 1, t_uu, t_vv, t_ww,
+                    t_vis, t_weight, 0, &status);
+        }
+    }
+    oskar_Mem* image = 0;
+    oskar_imager_finalise(h, 1, &image, 0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* p = oskar_mem_double_const(image, &status);
+    for (int i = 0; i < image_size * image_size; ++i)
+        ASSERT_NEAR(direct[i], p[i], 1e-10) << "Image mismatch at " << i;
+    oskar_mem_free(t_uu, &status);
+    oskar_mem_free(t_vv, &status);
+    oskar_mem_free(t_ww, &status);
+    oskar_mem_free(t_vis, &status);
+    oskar_mem_free(t_weight, &status);
+    oskar_mem_free(image, &status);
+    oskar_imager_free(h, &status);
+}
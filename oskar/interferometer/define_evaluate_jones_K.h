@@ -65,7 +65,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         phase = u[a] * l[s] + v[a] * m[s];\
         if (!ignore_w_components) phase += w[a] * (n[s] - (FP)1);\
         phase *= wavenumber;\
-        SINCOS(phase, im, re);\
+        VSINCOS(FP, phase, im, re);\
         weight.x = re; weight.y = im;\
     }\
     jones[s + num_sources * a] = weight;\
@@ -0,0 +1,38 @@
+/* Copyright (c) 2020, The University of Oxford. See LICENSE file. */
+
+/* Multiplies Jones matrices in place by the ionospheric phase,
+ * exp(i * phase_scale * TEC), for each station and source.
+ * Pierce points below the minimum elevation have zero TEC. */
+#define OSKAR_JONES_Z_JOIN_SCALAR(NAME, FP, FP2) KERNEL(NAME) (\
+        const int        num,\
+        GLOBAL_IN(FP,    tec),\
+        const FP         phase_scale,\
+        GLOBAL_OUT(FP2,  jones))\
+{\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
+    FP2 z;\
+    FP sin_phase, cos_phase;\
+    const FP phase = tec[i] * phase_scale;\
+    VSINCOS(FP, phase, sin_phase, cos_phase);\
+    z.x = cos_phase; z.y = sin_phase;\
+    OSKAR_MUL_COMPLEX_IN_PLACE(FP2, jones[i], z)\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
+
+#define OSKAR_JONES_Z_JOIN_MATRIX(NAME, FP, FP2, FP4c) KERNEL(NAME) (\
+        const int        num,\
+        GLOBAL_IN(FP,    tec),\
+        const FP         phase_scale,\
+        GLOBAL_OUT(FP4c, jones))\
+{\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
+    FP2 z;\
+    FP sin_phase, cos_phase;\
+    const FP phase = tec[i] * phase_scale;\
+    VSINCOS(FP, phase, sin_phase, cos_phase);\
+    z.x = cos_phase; z.y = sin_phase;\
+    OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, jones[i], z)\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,8 @@
  * Jones matrices (Z Jones).
  *
  * @details
+ * Each array holds one value per station per source, ordered by station
+ * first, so that all pierce points can be evaluated together.
  */
 struct oskar_WorkJonesZ
 {
@@ -57,7 +59,6 @@ struct oskar_WorkJonesZ
                                 the ionospheric column defined by the pierce
                                 point) */
 
-    oskar_Mem* screen_TEC;    /* TEC screen values for each pierce point */
     oskar_Mem* total_TEC;     /* Total TEC values for each pierce point */
 };
 
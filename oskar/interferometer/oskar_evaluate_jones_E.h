@@ -50,8 +50,16 @@ extern "C" {
  * Evaluates station beams for a telescope model at the specified source
  * positions, storing the results in the Jones matrix data structure.
  *
- * If all stations are marked as identical, the results for the first station
- * are copied into the results for the others.
+ * If station beam duplication is allowed, the beam is evaluated only for
+ * the first station in each group of identical stations
+ * (see oskar_telescope_station_equivalent()), and the results are copied
+ * into the results for the others.
+ *
+ * If an interpolation tolerance has been set in the work buffer and the
+ * directions are relative direction cosines, the beams are evaluated using
+ * oskar_evaluate_station_beam_interp(), and the largest error estimate for
+ * each station is recorded in the array returned by
+ * oskar_station_work_beam_interp_error().
  *
  * @param[out] E            Output set of Jones matrices.
  * @param[in]  num_points   Number of direction cosines given.
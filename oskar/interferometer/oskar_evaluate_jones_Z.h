@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,12 +44,78 @@
 extern "C" {
 #endif
 
+/**
+ * @brief
+ * Evaluates ionospheric phase (Jones Z) for all stations and sources.
+ *
+ * @details
+ * Evaluates a scalar Jones Z matrix for each station and source,
+ * using oskar_evaluate_jones_Z_tec() and oskar_evaluate_jones_Z_join().
+ *
+ * @param[out] Z            Output Jones Z matrices.
+ * @param[in] sky           Sky model.
+ * @param[in] telescope     Telescope model (in CPU memory).
+ * @param[in] settings      Ionosphere settings.
+ * @param[in] gast          Greenwich apparent sidereal time, in radians.
+ * @param[in] frequency_hz  Observing frequency, in Hz.
+ * @param[in] work          Work buffers.
+ * @param[in,out] status    Status return code.
+ */
 OSKAR_EXPORT
 void oskar_evaluate_jones_Z(oskar_Jones* Z, const oskar_Sky* sky,
         const oskar_Telescope* telescope,
         const oskar_SettingsIonosphere* settings, double gast,
         double frequency_hz, oskar_WorkJonesZ* work, int* status);
 
+/**
+ * @brief
+ * Evaluates the TEC at the pierce points of all stations and sources.
+ *
+ * @details
+ * The TEC does not depend on frequency, so this can be evaluated once
+ * per time step and used for all channels with
+ * oskar_evaluate_jones_Z_join().
+ *
+ * Pierce points for all stations are evaluated together in double
+ * precision on the CPU, with stations processed in parallel.
+ * Pierce points below the minimum elevation have zero TEC.
+ *
+ * The output array is resized to hold (num_stations * num_sources)
+ * values, in the same order as the elements of a Jones matrix block,
+ * and may be of either precision and in any memory location.
+ *
+ * @param[out] tec          Output TEC values.
+ * @param[in] sky           Sky model.
+ * @param[in] telescope     Telescope model (in CPU memory).
+ * @param[in] settings      Ionosphere settings.
+ * @param[in] gast          Greenwich apparent sidereal time, in radians.
+ * @param[in] work          Work buffers (double precision, in CPU memory).
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_Z_tec(oskar_Mem* tec, const oskar_Sky* sky,
+        const oskar_Telescope* telescope,
+        const oskar_SettingsIonosphere* settings, double gast,
+        oskar_WorkJonesZ* work, int* status);
+
+/**
+ * @brief
+ * Multiplies Jones matrices in place by the ionospheric phase.
+ *
+ * @details
+ * Multiplies each Jones matrix by the scalar ionospheric phase,
+ * exp(i * lambda * 25 * TEC), so that Jones Z does not need to be stored
+ * separately.
+ *
+ * @param[in,out] jones     Jones matrices to update.
+ * @param[in] frequency_hz  Observing frequency, in Hz.
+ * @param[in] tec           TEC values from oskar_evaluate_jones_Z_tec().
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_Z_join(oskar_Jones* jones, double frequency_hz,
+        const oskar_Mem* tec, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,9 +56,16 @@ int oskar_interferometer_num_devices(const oskar_Interferometer* h);
 OSKAR_EXPORT
 int oskar_interferometer_num_gpus(const oskar_Interferometer* h);
 
+OSKAR_EXPORT
+int oskar_interferometer_num_threads_per_device(
+        const oskar_Interferometer* h);
+
 OSKAR_EXPORT
 int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h);
 
+OSKAR_EXPORT
+int oskar_interferometer_num_vis_buffers(const oskar_Interferometer* h);
+
 OSKAR_EXPORT
 void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status);
 
@@ -77,6 +84,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_fused_correlation(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num_gpus,
         const int* cuda_device_ids, int* status);
@@ -88,6 +99,11 @@ OSKAR_EXPORT
 void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_ionosphere(oskar_Interferometer* h,
+        int enable, double min_elevation_rad, double tec0,
+        int num_tid_files, const char* const* tid_files, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value);
@@ -99,6 +115,14 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_num_threads_per_device(oskar_Interferometer* h,
+        int value);
+
+OSKAR_EXPORT
+void oskar_interferometer_set_num_vis_buffers(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels);
@@ -131,6 +155,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_station_beam_interp_tolerance(
+        oskar_Interferometer* h, double value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
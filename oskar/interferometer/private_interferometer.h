@@ -31,13 +31,16 @@
 
 #include <binary/oskar_binary.h>
 #include <interferometer/oskar_jones.h>
+#include <interferometer/oskar_WorkJonesZ.h>
 #include <log/oskar_log.h>
 #include <mem/oskar_mem.h>
 #include <ms/oskar_measurement_set.h>
+#include <settings/old/oskar_Settings_old.h>
 #include <sky/oskar_sky.h>
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_thread.h>
 #include <utility/oskar_timer.h>
+#include <utility/oskar_work_queue.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 
@@ -45,7 +48,7 @@
 struct DeviceData
 {
     /* Host memory. */
-    oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
+    oskar_VisBlock** vis_block_cpu; /* Ring on host, for copy back & write. */
 
     /* Device memory. */
     int previous_chunk_index;
@@ -54,8 +57,12 @@ struct DeviceData
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
-    oskar_Jones *J, *R, *E, *K, *Z;
+    oskar_Jones *J, *R, *E, *K;
+    oskar_Jones* K_step;        /* Jones K for the channel increment. */
     oskar_StationWork* station_work;
+    oskar_Mem* tec;             /* TEC for Jones Z, for this time step. */
+    oskar_WorkJonesZ* work_Z;   /* Pierce point work buffers (CPU). */
+    oskar_Mem* xcorr_work;      /* Cross-correlation work buffer (CPU). */
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
@@ -65,6 +72,7 @@ struct DeviceData
     oskar_Timer* tmr_join;      /* Time spent combining Jones matrices. */
     oskar_Timer* tmr_E;         /* Time spent evaluating E-Jones. */
     oskar_Timer* tmr_K;         /* Time spent evaluating K-Jones. */
+    oskar_Timer* tmr_Z;         /* Time spent evaluating Z-Jones. */
 };
 typedef struct DeviceData DeviceData;
 
@@ -73,20 +81,33 @@ struct oskar_Interferometer
 {
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
+    int num_threads_per_device;
     int num_channels, num_time_steps;
-    int max_sources_per_chunk, max_times_per_block;
+    int max_sources_per_chunk, max_times_per_block, num_vis_buffers;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only, ignore_w_components;
+    int coords_only, ignore_w_components, fused_correlation;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
-    double source_min_jy, source_max_jy;
+    double source_min_jy, source_max_jy, station_beam_interp_tolerance;
     char correlation_type, *vis_name, *ms_name, *settings_path;
+    oskar_SettingsIonosphere ionosphere;
 
     /* State. */
-    int init_sky, work_unit_index;
+    int init_sky;
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
     oskar_Log* log;
 
+    /* Visibility block pipeline, with one slot per host buffer. */
+    oskar_WorkQueue** work_queue; /* Work-stealing queues for each slot. */
+    int* work_queue_block;        /* Block index each slot's queues hold. */
+    int* num_devices_done;        /* Devices finished with each slot. */
+    int blocks_written;           /* Number of blocks finalised & written. */
+    oskar_ConditionVar* pipeline; /* Signals changes to pipeline state. */
+
+    /* Pipeline queue-depth statistics. */
+    int stat_num_compute, stat_num_write;
+    int stat_max_ahead, stat_max_waiting;
+    double stat_sum_ahead, stat_sum_waiting;
+
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
     oskar_Sky** sky_chunks;
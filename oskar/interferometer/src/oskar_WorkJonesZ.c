@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -49,7 +49,6 @@ oskar_WorkJonesZ* oskar_work_jones_z_create(int type, int location, int* status)
     work->pp_lon = oskar_mem_create(type, location, 0, status);
     work->pp_lat = oskar_mem_create(type, location, 0, status);
     work->pp_rel_path = oskar_mem_create(type, location, 0, status);
-    work->screen_TEC = oskar_mem_create(type, location, 0, status);
     work->total_TEC = oskar_mem_create(type, location, 0, status);
 
     return work;
@@ -64,7 +63,6 @@ void oskar_work_jones_z_free(oskar_WorkJonesZ* work, int* status)
     oskar_mem_free(work->pp_lon, status);
     oskar_mem_free(work->pp_lat, status);
     oskar_mem_free(work->pp_rel_path, status);
-    oskar_mem_free(work->screen_TEC, status);
     oskar_mem_free(work->total_TEC, status);
     free(work);
 }
@@ -77,7 +75,6 @@ void oskar_work_jones_z_resize(oskar_WorkJonesZ* work, int n, int* status)
     oskar_mem_realloc(work->pp_lon, n, status);
     oskar_mem_realloc(work->pp_lat, n, status);
     oskar_mem_realloc(work->pp_rel_path, n, status);
-    oskar_mem_realloc(work->screen_TEC, n, status);
     oskar_mem_realloc(work->total_TEC, n, status);
 }
 
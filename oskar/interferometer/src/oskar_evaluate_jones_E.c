@@ -29,17 +29,22 @@
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_jones_accessors.h"
 #include "telescope/station/oskar_evaluate_station_beam.h"
+#include "telescope/station/oskar_evaluate_station_beam_interp.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void get_range(int num_points, const oskar_Mem* values,
+        double* min_val, double* max_val, int* status);
+
 void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
         oskar_Mem* x, oskar_Mem* y, oskar_Mem* z, const oskar_Telescope* tel,
         double gast, double frequency_hz, oskar_StationWork* work,
         int time_index, int* status)
 {
     int i;
+    double lm_range[4], *errors = 0;
     if (*status) return;
     const int num_stations = oskar_telescope_num_stations(tel);
     const int num_sources = oskar_jones_num_sources(E);
@@ -54,27 +59,46 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
         return;
     }
 
-    /* Evaluate the station beams. */
-    if (oskar_telescope_allow_station_beam_duplication(tel) &&
-            oskar_telescope_identical_stations(tel))
+    /* Evaluate the station beams.
+     * If station beam duplication is allowed, evaluate the beam only for
+     * the first station in each group of identical stations,
+     * and copy it for the others. */
+    const int duplicate = oskar_telescope_allow_station_beam_duplication(tel);
+
+    /* Get the extent of the directions if beams can be interpolated,
+     * and the array used to record the error estimate for each station. */
+    const int interp = (coord_type == OSKAR_RELATIVE_DIRECTIONS &&
+            oskar_station_work_beam_interp_tolerance(work) > 0.0);
+    if (interp)
     {
-        /* Identical stations: Evaluate beam for station 0 and copy it. */
-        oskar_evaluate_station_beam(num_points, coord_type, x, y, z,
-                oskar_telescope_phase_centre_ra_rad(tel),
-                oskar_telescope_phase_centre_dec_rad(tel),
-                oskar_telescope_station_const(tel, 0),
-                work, time_index, frequency_hz, gast,
-                0, oskar_jones_mem(E), status);
-        for (i = 1; i < num_stations; ++i)
+        oskar_Mem* error_mem = oskar_station_work_beam_interp_error(work);
+        oskar_mem_ensure(error_mem, (size_t) num_stations, status);
+        errors = oskar_mem_double(error_mem, status);
+        get_range(num_points, x, &lm_range[0], &lm_range[1], status);
+        get_range(num_points, y, &lm_range[2], &lm_range[3], status);
+        if (*status) return;
+    }
+    for (i = 0; i < num_stations; ++i)
+    {
+        const int j = duplicate ?
+                oskar_telescope_station_equivalent(tel, i) : i;
+        if (j != i)
             oskar_mem_copy_contents(
                     oskar_jones_mem(E), oskar_jones_mem(E),
-                    (size_t)(i * num_sources), 0,
+                    (size_t)(i * num_sources), (size_t)(j * num_sources),
                     (size_t)num_sources, status);
-    }
-    else
-    {
-        /* Different stations. */
-        for (i = 0; i < num_stations; ++i)
+        else if (interp)
+        {
+            double error = 0.0;
+            oskar_evaluate_station_beam_interp(num_points, x, y, z, lm_range,
+                    oskar_telescope_phase_centre_ra_rad(tel),
+                    oskar_telescope_phase_centre_dec_rad(tel),
+                    oskar_telescope_station_const(tel, i),
+                    work, time_index, frequency_hz, gast,
+                    i * num_sources, oskar_jones_mem(E), &error, status);
+            if (error > errors[i]) errors[i] = error;
+        }
+        else
             oskar_evaluate_station_beam(num_points, coord_type, x, y, z,
                     oskar_telescope_phase_centre_ra_rad(tel),
                     oskar_telescope_phase_centre_dec_rad(tel),
@@ -84,6 +108,22 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
     }
 }
 
+static void get_range(int num_points, const oskar_Mem* values,
+        double* min_val, double* max_val, int* status)
+{
+    if (oskar_mem_location(values) == OSKAR_CPU)
+        oskar_mem_stats(values, (size_t) num_points,
+                min_val, max_val, 0, 0, status);
+    else
+    {
+        oskar_Mem* values_cpu = oskar_mem_create_copy(values,
+                OSKAR_CPU, status);
+        oskar_mem_stats(values_cpu, (size_t) num_points,
+                min_val, max_val, 0, 0, status);
+        oskar_mem_free(values_cpu, status);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
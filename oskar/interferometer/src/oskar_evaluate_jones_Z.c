@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,146 +27,270 @@
  */
 
 #include "interferometer/oskar_evaluate_jones_Z.h"
+#include "interferometer/define_evaluate_jones_Z.h"
 
 #include "convert/oskar_convert_relative_directions_to_enu_directions.h"
 #include "convert/oskar_convert_offset_ecef_to_ecef.h"
+#include "math/define_multiply.h"
 #include "telescope/station/oskar_evaluate_pierce_points.h"
 #include "sky/oskar_evaluate_tec_tid.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
 
 #include <math.h>
-#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static void oskar_evaluate_TEC(oskar_WorkJonesZ* work, int num_pp,
-        const oskar_SettingsIonosphere* settings,
-        double gast, int* status);
+OSKAR_JONES_Z_JOIN_SCALAR(evaluate_jones_Z_join_scalar_float, float, float2)
+OSKAR_JONES_Z_JOIN_SCALAR(evaluate_jones_Z_join_scalar_double, double, double2)
+OSKAR_JONES_Z_JOIN_MATRIX(evaluate_jones_Z_join_matrix_float,
+        float, float2, float4c)
+OSKAR_JONES_Z_JOIN_MATRIX(evaluate_jones_Z_join_matrix_double,
+        double, double2, double4c)
 
 static void evaluate_station_ECEF_coords(
         double* station_x, double* station_y, double* station_z,
         int stationID, const oskar_Telescope* telescope);
 
-static void evaluate_jones_Z_station(double wavelength,
-        const oskar_Mem* TEC, const oskar_Mem* hor_z,
-        double min_elevation, int num_pp,
-        int offset_out, oskar_Mem* out, int* status);
-
 void oskar_evaluate_jones_Z(oskar_Jones* Z, const oskar_Sky* sky,
         const oskar_Telescope* telescope,
         const oskar_SettingsIonosphere* settings, double gast,
         double frequency_hz, oskar_WorkJonesZ* work, int* status)
 {
-    int i, num_sources, num_stations;
-    /* Station position in ECEF frame */
-    double station_x, station_y, station_z, wavelength;
-    oskar_Sky* sky_cpu; /* Copy of the sky model on the CPU */
+    oskar_Mem* tec;
+    if (*status) return;
+    tec = oskar_mem_create(oskar_type_precision(oskar_jones_type(Z)),
+            oskar_jones_mem_location(Z), 0, status);
+    oskar_evaluate_jones_Z_tec(tec, sky, telescope, settings, gast,
+            work, status);
+    oskar_mem_set_value_real(oskar_jones_mem(Z), 1.0,
+            0, oskar_mem_length(oskar_jones_mem(Z)), status);
+    oskar_evaluate_jones_Z_join(Z, frequency_hz, tec, status);
+    oskar_mem_free(tec, status);
+}
 
-    /* Check if safe to proceed. */
+
+void oskar_evaluate_jones_Z_tec(oskar_Mem* tec, const oskar_Sky* sky,
+        const oskar_Telescope* telescope,
+        const oskar_SettingsIonosphere* settings, double gast,
+        oskar_WorkJonesZ* work, int* status)
+{
+    int i;
+    oskar_Mem *l, *m, *n;
     if (*status) return;
 
-    /* Check data types. */
-    const int type = oskar_sky_precision(sky);
-    if (oskar_telescope_precision(telescope) != type ||
-            oskar_jones_type(Z) != (type | OSKAR_COMPLEX))
+    /* FIXME(BM) For now limit number of screens to 1, this can be removed
+     * if a TEC model which is valid for multiple screens is implemented
+     */
+    if (settings->num_TID_screens > 1)
     {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    if (oskar_mem_location(oskar_telescope_station_true_offset_ecef_metres_const(
+            telescope, 0)) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
         return;
     }
 
-    /* For now, this function requires data is on the CPU .. check this. */
-
-    /* Resize the work array (if needed) */
-    num_stations = oskar_telescope_num_stations(telescope);
-    num_sources = oskar_sky_num_sources(sky);
-    oskar_work_jones_z_resize(work, num_sources, status);
-
-    /* Copy the sky model to the CPU. */
-    sky_cpu = oskar_sky_create_copy(sky, OSKAR_CPU, status);
+    /* Resize the work arrays to hold all pierce points. */
+    const int num_sources = oskar_sky_num_sources(sky);
+    const int num_stations = oskar_telescope_num_stations(telescope);
+    const int num_pp = num_stations * num_sources;
+    oskar_work_jones_z_resize(work, num_pp, status);
+    oskar_mem_ensure(tec, (size_t) num_pp, status);
+    if (*status) return;
+    if (settings->num_TID_screens < 1)
+    {
+        oskar_mem_clear_contents(tec, status);
+        return;
+    }
 
-    wavelength = 299792458.0 / frequency_hz;
+    /* Get source direction cosines in double precision on the CPU. */
+    l = oskar_mem_convert_precision(oskar_sky_l_const(sky), OSKAR_DOUBLE,
+            status);
+    m = oskar_mem_convert_precision(oskar_sky_m_const(sky), OSKAR_DOUBLE,
+            status);
+    n = oskar_mem_convert_precision(oskar_sky_n_const(sky), OSKAR_DOUBLE,
+            status);
 
     /* Evaluate the ionospheric phase screen for each station at each
-     * source pierce point. */
-    for (i = 0; i < num_stations; ++i)
+     * source pierce point. Stations are independent, so are done in
+     * parallel. */
+    /* FIXME(BM) this is current hard-coded to TID height screen 0
+     * this fix is only needed to support multiple screen heights. */
+    const double ra0 = oskar_sky_reference_ra_rad(sky);
+    const double dec0 = oskar_sky_reference_dec_rad(sky);
+    const double screen_height_m = settings->TID[0].height_km * 1000.0;
+    if (!*status)
     {
-        double last, lon, lat;
-        const oskar_Station* station;
-        station = oskar_telescope_station_const(telescope, i);
-        lon = oskar_station_lon_rad(station);
-        lat = oskar_station_lat_rad(station);
-        last = gast + lon;
-
-        /* Evaluate horizontal x,y,z source positions (for which to evaluate
-         * pierce points) */
-        oskar_convert_relative_directions_to_enu_directions(0, 0, 0, num_sources,
-                oskar_sky_l_const(sky_cpu), oskar_sky_m_const(sky_cpu),
-                oskar_sky_n_const(sky_cpu), last - oskar_sky_reference_ra_rad(sky_cpu),
-                oskar_sky_reference_dec_rad(sky_cpu), lat,
-                0, work->hor_x, work->hor_y, work->hor_z, status);
-
-        /* Obtain station coordinates in the ECEF frame. */
-        evaluate_station_ECEF_coords(&station_x, &station_y, &station_z, i,
-                telescope);
+#pragma omp parallel for private(i)
+        for (i = 0; i < num_stations; ++i)
+        {
+            int j, station_status = 0;
+            double station_x, station_y, station_z;
+            const int offset = i * num_sources;
+            const oskar_Station* station =
+                    oskar_telescope_station_const(telescope, i);
+            const double lat = oskar_station_lat_rad(station);
+            const double last = gast + oskar_station_lon_rad(station);
+
+            /* Evaluate horizontal x,y,z source positions (for which to
+             * evaluate pierce points). */
+            oskar_convert_relative_directions_to_enu_directions(0, 0, 0,
+                    num_sources, l, m, n, last - ra0, dec0, lat, offset,
+                    work->hor_x, work->hor_y, work->hor_z, &station_status);
+            const double* hor_x = oskar_mem_double_const(
+                    work->hor_x, &station_status) + offset;
+            const double* hor_y = oskar_mem_double_const(
+                    work->hor_y, &station_status) + offset;
+            const double* hor_z = oskar_mem_double_const(
+                    work->hor_z, &station_status) + offset;
+            double* pp_lon = oskar_mem_double(
+                    work->pp_lon, &station_status) + offset;
+            double* pp_lat = oskar_mem_double(
+                    work->pp_lat, &station_status) + offset;
+            double* pp_rel_path = oskar_mem_double(
+                    work->pp_rel_path, &station_status) + offset;
+            double* total_TEC = oskar_mem_double(
+                    work->total_TEC, &station_status) + offset;
+            if (station_status)
+            {
+#pragma omp critical (jones_Z_status)
+                *status = station_status;
+                continue;
+            }
 
-        /* Obtain the pierce points. */
-        /* FIXME(BM) this is current hard-coded to TID height screen 0
-         * this fix is only needed to support multiple screen heights. */
-        oskar_evaluate_pierce_points(work->pp_lon, work->pp_lat,
-                work->pp_rel_path, station_x, station_y,
-                station_z, settings->TID[0].height_km * 1000., num_sources,
-                work->hor_x, work->hor_y, work->hor_z, status);
+            /* Obtain the pierce points. */
+            evaluate_station_ECEF_coords(&station_x, &station_y, &station_z,
+                    i, telescope);
+            oskar_evaluate_pierce_points_d(num_sources, hor_x, hor_y, hor_z,
+                    pp_lon, pp_lat, pp_rel_path, screen_height_m,
+                    station_x, station_y, station_z);
 
-        /* Evaluate TEC values for the pierce points */
-        oskar_evaluate_TEC(work, num_sources, settings, gast, status);
+            /* Evaluate TEC values for the pierce points. */
+            oskar_evaluate_tec_tid_d(num_sources, pp_lon, pp_lat,
+                    pp_rel_path, settings->TEC0, &settings->TID[0], gast,
+                    total_TEC);
 
-        /* Populate the Jones matrix with ionospheric phase */
-        const int offset_out = i * oskar_jones_num_sources(Z);
-        evaluate_jones_Z_station(wavelength,
-                work->total_TEC, work->hor_z, settings->min_elevation,
-                num_sources, offset_out, oskar_jones_mem(Z), status);
+            /* If the pierce point is below the minimum specified elevation
+             * don't evaluate a phase. */
+            for (j = 0; j < num_sources; ++j)
+                if (asin(hor_z[j]) < settings->min_elevation)
+                    total_TEC[j] = 0.0;
+        }
+    }
+    oskar_mem_free(l, status);
+    oskar_mem_free(m, status);
+    oskar_mem_free(n, status);
+
+    /* Copy TEC values to the output array. */
+    if (oskar_mem_precision(tec) == OSKAR_DOUBLE)
+        oskar_mem_copy_contents(tec, work->total_TEC, 0, 0,
+                (size_t) num_pp, status);
+    else
+    {
+        oskar_Mem* temp = oskar_mem_convert_precision(work->total_TEC,
+                oskar_mem_precision(tec), status);
+        oskar_mem_copy_contents(tec, temp, 0, 0, (size_t) num_pp, status);
+        oskar_mem_free(temp, status);
     }
-
-    oskar_sky_free(sky_cpu, status);
 }
 
 
-/* Evaluate the TEC value for each pierce point - note: at the moment this is
- * just the accumulation of one or more TID screens.
- * TODO convert this to a stand-alone function.
- */
-static void oskar_evaluate_TEC(oskar_WorkJonesZ* work, int num_pp,
-        const oskar_SettingsIonosphere* settings,
-        double gast, int* status)
+void oskar_evaluate_jones_Z_join(oskar_Jones* jones, double frequency_hz,
+        const oskar_Mem* tec, int* status)
 {
-    int i;
-
-    /* FIXME(BM) For now limit number of screens to 1, this can be removed
-     * if a TEC model which is valid for multiple screens is implemented
-     */
-    if (settings->num_TID_screens > 1)
-        *status = OSKAR_ERR_INVALID_ARGUMENT;
-
-    oskar_mem_clear_contents(work->total_TEC, status);
-
-    /* Loop over TID screens to evaluate TEC values */
-    for (i = 0; i < settings->num_TID_screens; ++i)
+    if (*status) return;
+    const int type = oskar_jones_type(jones);
+    const int location = oskar_jones_mem_location(jones);
+    const int num = oskar_jones_num_stations(jones) *
+            oskar_jones_num_sources(jones);
+    if (num > (int) oskar_mem_length(tec))
     {
-        oskar_mem_clear_contents(work->screen_TEC, status);
-
-        /* Evaluate TEC values for the screen */
-        oskar_evaluate_tec_tid(work->screen_TEC, num_pp, work->pp_lon,
-                work->pp_lat, work->pp_rel_path, settings->TEC0,
-                &settings->TID[i], gast);
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (location != oskar_mem_location(tec))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_type_precision(type) != oskar_mem_precision(tec))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
 
-        /* Accumulate into total TEC */
-        /* FIXME(BM) addition is not physical for more than one TEC screen in
-         * the way TIDs are currently evaluated as TEC0 is added into both
-         * screens.
-         */
-        oskar_mem_add(work->total_TEC, work->total_TEC, work->screen_TEC,
-                0, 0, 0, oskar_mem_length(work->total_TEC), status);
+    /* Z phase == exp(i * lambda * 25 * tec) */
+    const double phase_scale = 25.0 * 299792458.0 / frequency_hz;
+    const float phase_scale_f = (float) phase_scale;
+    oskar_Mem* data = oskar_jones_mem(jones);
+    if (location == OSKAR_CPU)
+    {
+        switch (type)
+        {
+        case OSKAR_SINGLE_COMPLEX:
+            evaluate_jones_Z_join_scalar_float(num,
+                    oskar_mem_float_const(tec, status), phase_scale_f,
+                    oskar_mem_float2(data, status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            evaluate_jones_Z_join_scalar_double(num,
+                    oskar_mem_double_const(tec, status), phase_scale,
+                    oskar_mem_double2(data, status));
+            break;
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            evaluate_jones_Z_join_matrix_float(num,
+                    oskar_mem_float_const(tec, status), phase_scale_f,
+                    oskar_mem_float4c(data, status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            evaluate_jones_Z_join_matrix_double(num,
+                    oskar_mem_double_const(tec, status), phase_scale,
+                    oskar_mem_double4c(data, status));
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            break;
+        }
+    }
+    else
+    {
+        size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        const char* k = 0;
+        const int is_dbl = (oskar_type_precision(type) == OSKAR_DOUBLE);
+        switch (type)
+        {
+        case OSKAR_SINGLE_COMPLEX:
+            k = "evaluate_jones_Z_join_scalar_float"; break;
+        case OSKAR_DOUBLE_COMPLEX:
+            k = "evaluate_jones_Z_join_scalar_double"; break;
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            k = "evaluate_jones_Z_join_matrix_float"; break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            k = "evaluate_jones_Z_join_matrix_double"; break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num, local_size[0]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num},
+                {PTR_SZ, oskar_mem_buffer_const(tec)},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&phase_scale :
+                        (const void*)&phase_scale_f},
+                {PTR_SZ, oskar_mem_buffer(data)}
+        };
+        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
 
@@ -210,68 +334,6 @@ static void evaluate_station_ECEF_coords(
             station_x, station_y, station_z);
 }
 
-static void evaluate_jones_Z_station(double wavelength,
-        const oskar_Mem* TEC, const oskar_Mem* hor_z,
-        double min_elevation, int num_pp,
-        int offset_out, oskar_Mem* out, int* status)
-{
-    int i, type;
-    double arg;
-
-    /* Check if safe to proceed. */
-    if (*status) return;
-
-    type = oskar_mem_type(out);
-    if (type == OSKAR_DOUBLE_COMPLEX)
-    {
-        double2* Z_ = oskar_mem_double2(out, status) + offset_out;
-        for (i = 0; i < num_pp; ++i)
-        {
-            /* Initialise as an unit scalar Z = (1 + 0i) i.e. no phase change */
-            Z_[i].x = 1.0;
-            Z_[i].y = 0.0;
-
-            /* If the pierce point is below the minimum specified elevation
-             * don't evaluate a phase */
-            if (asin((oskar_mem_double_const(hor_z, status))[i]) <
-                    min_elevation)
-                continue;
-
-            arg = wavelength * 25. * oskar_mem_double_const(TEC, status)[i];
-
-            /* Z phase == exp(i * lambda * 25 * tec) */
-            Z_[i].x = cos(arg);
-            Z_[i].y = sin(arg);
-        }
-    }
-    else if (type == OSKAR_SINGLE_COMPLEX)
-    {
-        float2* Z_ = oskar_mem_float2(out, status) + offset_out;
-        for (i = 0; i < num_pp; ++i)
-        {
-            /* Initialise as an unit scalar Z = (1 + 0i) i.e. no phase change */
-            Z_[i].x = 1.0;
-            Z_[i].y = 0.0;
-
-            /* If the pierce point is below the minimum specified elevation
-             * don't evaluate a phase */
-            if (asin((oskar_mem_float_const(hor_z, status))[i]) <
-                    min_elevation)
-                continue;
-
-            arg = wavelength * 25. * oskar_mem_float_const(TEC, status)[i];
-
-            /* Z phase == exp(i * lambda * 25 * tec) */
-            Z_[i].x = cos(arg);
-            Z_[i].y = sin(arg);
-        }
-    }
-    else
-    {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
-    }
-}
-
 #ifdef __cplusplus
 }
 #endif
@@ -1,3 +1,5 @@
-/* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2020, The University of Oxford. See LICENSE file. */
 
 OSKAR_JONES_R( M_CAT(evaluate_jones_R_, Real), Real, Real4c)
+OSKAR_JONES_Z_JOIN_SCALAR( M_CAT(evaluate_jones_Z_join_scalar_, Real), Real, Real2)
+OSKAR_JONES_Z_JOIN_MATRIX( M_CAT(evaluate_jones_Z_join_matrix_, Real), Real, Real2, Real4c)
@@ -1,7 +1,9 @@
-/* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2020, The University of Oxford. See LICENSE file. */
 
 #include "interferometer/define_evaluate_jones_K.h"
 #include "interferometer/define_evaluate_jones_R.h"
+#include "interferometer/define_evaluate_jones_Z.h"
+#include "math/define_multiply.h"
 #include "utility/oskar_cuda_registrar.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
@@ -32,6 +32,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "sky/oskar_settings_load_tid_parameter_file.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_device.h"
 
@@ -59,6 +60,22 @@ int oskar_interferometer_num_gpus(const oskar_Interferometer* h)
     return h ? h->num_gpus : 0;
 }
 
+int oskar_interferometer_num_threads_per_device(
+        const oskar_Interferometer* h)
+{
+    int value;
+    if (!h) return 1;
+    value = h->num_threads_per_device;
+    if (value < 1 && h->num_devices > 0)
+        value = oskar_get_num_procs() / h->num_devices;
+    return value < 1 ? 1 : value;
+}
+
+int oskar_interferometer_num_vis_buffers(const oskar_Interferometer* h)
+{
+    return h->num_vis_buffers;
+}
+
 int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 {
     return (h->num_time_steps + h->max_times_per_block - 1) /
@@ -67,7 +84,10 @@ int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h)
 {
-    h->work_unit_index = 0;
+    int i;
+    if (!h->work_queue_block) return;
+    for (i = 0; i < h->num_vis_buffers; ++i)
+        h->work_queue_block[i] = -1;
 }
 
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
@@ -96,6 +116,14 @@ void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
     h->force_polarised_ms = value;
 }
 
+void oskar_interferometer_set_fused_correlation(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    oskar_interferometer_free_device_data(h, &status);
+    h->fused_correlation = value;
+}
+
 void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num,
         const int* ids, int* status)
 {
@@ -147,6 +175,54 @@ void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
     h->ignore_w_components = value;
 }
 
+void oskar_interferometer_set_ionosphere(oskar_Interferometer* h,
+        int enable, double min_elevation_rad, double tec0,
+        int num_tid_files, const char* const* tid_files, int* status)
+{
+    int i;
+    oskar_SettingsIonosphere* s = &h->ionosphere;
+    oskar_interferometer_free_device_data(h, status);
+
+    /* Free any existing TID screens. */
+    for (i = 0; i < s->num_TID_screens; ++i)
+    {
+        free(s->TID_files[i]);
+        free(s->TID[i].amp);
+        free(s->TID[i].speed);
+        free(s->TID[i].wavelength);
+        free(s->TID[i].theta);
+    }
+    free(s->TID_files);
+    free(s->TID);
+    s->TID_files = 0;
+    s->TID = 0;
+    s->num_TID_screens = 0;
+    s->enable = enable;
+    s->min_elevation = min_elevation_rad;
+    s->TEC0 = tec0;
+    if (*status || !enable || num_tid_files <= 0) return;
+
+    /* Load the TID screens. */
+    s->num_TID_screens = num_tid_files;
+    s->TID_files = (char**) calloc(num_tid_files, sizeof(char*));
+    s->TID = (oskar_SettingsTIDscreen*) calloc(num_tid_files,
+            sizeof(oskar_SettingsTIDscreen));
+    for (i = 0; i < num_tid_files; ++i)
+    {
+        const size_t len = strlen(tid_files[i]);
+        s->TID_files[i] = (char*) calloc(1 + len, sizeof(char));
+        memcpy(s->TID_files[i], tid_files[i], len);
+        oskar_settings_load_tid_parameter_file(&s->TID[i],
+                s->TID_files[i], status);
+        if (*status)
+        {
+            oskar_log_error(h->log, "Unable to load TID parameter file '%s'.",
+                    s->TID_files[i]);
+            break;
+        }
+    }
+}
+
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
@@ -159,6 +235,14 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
     h->max_times_per_block = value;
 }
 
+void oskar_interferometer_set_num_vis_buffers(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    oskar_interferometer_free_device_data(h, &status);
+    h->num_vis_buffers = value < 2 ? 2 : value;
+}
+
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 {
     int status = 0;
@@ -171,6 +255,12 @@ void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
     memset(h->d, 0, h->num_devices * sizeof(DeviceData));
 }
 
+void oskar_interferometer_set_num_threads_per_device(oskar_Interferometer* h,
+        int value)
+{
+    h->num_threads_per_device = value;
+}
+
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels)
 {
@@ -285,6 +375,14 @@ void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
     h->source_max_jy = max_jy;
 }
 
+void oskar_interferometer_set_station_beam_interp_tolerance(
+        oskar_Interferometer* h, double value)
+{
+    int status = 0;
+    oskar_interferometer_free_device_data(h, &status);
+    h->station_beam_interp_tolerance = value;
+}
+
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value)
 {
@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <float.h>
 #include <stdlib.h>
 
 #include "interferometer/private_interferometer.h"
@@ -91,6 +92,9 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
 
     /* Check that each compute device has been set up. */
     set_up_device_data(h, status);
+
+    /* Clear the work queues. */
+    oskar_interferometer_reset_work_unit_index(h);
     if (!*status && !h->coords_only)
         oskar_log_section(h->log, 'M', "Starting simulation...");
 
@@ -178,7 +182,7 @@ typedef struct ThreadArgs ThreadArgs;
 
 static void* init_device(void* arg)
 {
-    int dev_loc, vistype, *status;
+    int j, dev_loc, vistype, *status;
     ThreadArgs* a = (ThreadArgs*)arg;
     oskar_Interferometer* h = a->h;
     DeviceData* d = a->d;
@@ -212,6 +216,7 @@ static void* init_device(void* arg)
         d->tmr_clip      = oskar_timer_create(dev_loc);
         d->tmr_E         = oskar_timer_create(dev_loc);
         d->tmr_K         = oskar_timer_create(dev_loc);
+        d->tmr_Z         = oskar_timer_create(dev_loc);
         d->tmr_join      = oskar_timer_create(dev_loc);
         d->tmr_correlate = oskar_timer_create(dev_loc);
     }
@@ -221,14 +226,15 @@ static void* init_device(void* arg)
     {
         d->vis_block = oskar_vis_block_create_from_header(dev_loc,
                 h->header, status);
-        d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                h->header, status);
-        d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                h->header, status);
+        d->vis_block_cpu = (oskar_VisBlock**) calloc(h->num_vis_buffers,
+                sizeof(oskar_VisBlock*));
+        for (j = 0; j < h->num_vis_buffers; ++j)
+            d->vis_block_cpu[j] = oskar_vis_block_create_from_header(
+                    OSKAR_CPU, h->header, status);
     }
     oskar_vis_block_clear(d->vis_block, status);
-    oskar_vis_block_clear(d->vis_block_cpu[0], status);
-    oskar_vis_block_clear(d->vis_block_cpu[1], status);
+    for (j = 0; j < h->num_vis_buffers; ++j)
+        oskar_vis_block_clear(d->vis_block_cpu[j], status);
 
     /* Device scratch memory. */
     if (!d->tel)
@@ -239,21 +245,51 @@ static void* init_device(void* arg)
         d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
-        d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
-                status);
         d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(vistype,
                 dev_loc, num_stations, num_src, status) : 0;
         d->E = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                 status);
-        d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
-                status);
-        d->Z = 0;
+
+        /* Jones K and the joined Jones matrices are not needed if
+         * the interferometer phase is evaluated in the correlator. */
+        if (!h->fused_correlation || dev_loc != OSKAR_CPU)
+        {
+            d->J = oskar_jones_create(vistype, dev_loc, num_stations,
+                    num_src, status);
+            d->K = oskar_jones_create(complx, dev_loc, num_stations,
+                    num_src, status);
+            if (dev_loc == OSKAR_CPU)
+                d->xcorr_work = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0,
+                        status);
+
+            /* Jones K for later channels can be obtained from the first
+             * using the phasor for the channel increment, unless the
+             * flux filter could remove different sources in each channel. */
+            if (h->num_channels > 2 && h->freq_inc_hz != 0.0 &&
+                    h->source_min_jy <= -DBL_MAX &&
+                    h->source_max_jy >= DBL_MAX)
+                d->K_step = oskar_jones_create(complx, dev_loc,
+                        num_stations, num_src, status);
+        }
+
+        /* Ionospheric TEC is evaluated once per time step, if enabled. */
+        if (h->ionosphere.enable && h->ionosphere.num_TID_screens > 0)
+        {
+            d->tec = oskar_mem_create(h->prec, dev_loc, 0, status);
+            d->work_Z = oskar_work_jones_z_create(OSKAR_DOUBLE, OSKAR_CPU,
+                    status);
+        }
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
         oskar_station_work_set_tec_screen_common_params(d->station_work,
                 oskar_telescope_ionosphere_screen_type(d->tel),
                 oskar_telescope_tec_screen_height_km(d->tel),
                 oskar_telescope_tec_screen_pixel_size_m(d->tel),
                 oskar_telescope_tec_screen_time_interval_sec(d->tel));
+        oskar_station_work_set_tec_screen_max_buffer(d->station_work, (size_t)
+                (oskar_telescope_tec_screen_max_buffer_mb(d->tel) *
+                1024.0 * 1024.0));
+        oskar_station_work_set_beam_interp_tolerance(d->station_work,
+                h->station_beam_interp_tolerance);
         if (oskar_telescope_ionosphere_screen_type(d->tel) == 'E')
             oskar_station_work_set_tec_screen_path(d->station_work,
                     oskar_telescope_tec_screen_path(d->tel));
@@ -296,6 +332,17 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     free(threads);
     free(args);
 
+    /* Create the work queues for each slot in the pipeline. */
+    if (!h->work_queue)
+    {
+        h->work_queue = (oskar_WorkQueue**) calloc(h->num_vis_buffers,
+                sizeof(oskar_WorkQueue*));
+        h->work_queue_block = (int*) calloc(h->num_vis_buffers, sizeof(int));
+        h->num_devices_done = (int*) calloc(h->num_vis_buffers, sizeof(int));
+        for (i = 0; i < h->num_vis_buffers; ++i)
+            h->work_queue[i] = oskar_work_queue_create(num_devices);
+    }
+
     /* Record memory usage. */
     if (!*status && init)
     {
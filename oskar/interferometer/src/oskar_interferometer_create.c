@@ -49,7 +49,7 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->t_v       = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->t_w       = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
-    h->barrier   = oskar_barrier_create(0);
+    h->pipeline  = oskar_condition_create();
     h->log       = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_WARNING);
 
     /* Get number of devices available, and device location. */
@@ -64,6 +64,7 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     oskar_interferometer_set_horizon_clip(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
     oskar_interferometer_set_max_times_per_block(h, 8);
+    oskar_interferometer_set_num_vis_buffers(h, 2);
     return h;
 }
 
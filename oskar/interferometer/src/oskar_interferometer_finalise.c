@@ -36,6 +36,7 @@
 extern "C" {
 #endif
 
+static void record_beam_interp_errors(oskar_Interferometer* h, int* status);
 static void record_timing(oskar_Interferometer* h);
 
 void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
@@ -50,6 +51,10 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
         oskar_log_mem(h->log);
     }
 
+    /* Record station beam interpolation error estimates. */
+    if (h->station_beam_interp_tolerance > 0.0 && !*status)
+        record_beam_interp_errors(h, status);
+
     /* If there are sources in the simulation and the station beam is not
      * normalised to 1.0 at the phase centre, the values of noise RMS
      * may give a very unexpected S/N ratio!
@@ -122,11 +127,44 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
 }
 
 
+static void record_beam_interp_errors(oskar_Interferometer* h, int* status)
+{
+    int i, j;
+    const int num_stations = oskar_telescope_num_stations(h->tel);
+    const int duplicate =
+            oskar_telescope_allow_station_beam_duplication(h->tel);
+    oskar_log_section(h->log, 'M', "Station beam interpolation");
+    oskar_log_value(h->log, 'M', 0, "Tolerance", "%.3e",
+            h->station_beam_interp_tolerance);
+    oskar_log_message(h->log, 'M', 0,
+            "Maximum error estimate (0 if evaluated directly):");
+    for (i = 0; i < num_stations; ++i)
+    {
+        double error = 0.0;
+        const int k = duplicate ?
+                oskar_telescope_station_equivalent(h->tel, i) : i;
+        for (j = 0; j < h->num_devices; ++j)
+        {
+            const oskar_Mem* errors;
+            if (!h->d[j].station_work) continue;
+            errors = oskar_station_work_beam_interp_error(
+                    h->d[j].station_work);
+            if ((int)oskar_mem_length(errors) > k)
+            {
+                const double t = oskar_mem_double_const(errors, status)[k];
+                if (t > error) error = t;
+            }
+        }
+        oskar_log_message(h->log, 'M', 1, "Station %4d: %.3e", i, error);
+    }
+}
+
 static void record_timing(oskar_Interferometer* h)
 {
     /* Obtain component times. */
     int i;
-    double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_join = 0.;
+    double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_Z = 0.;
+    double t_join = 0.;
     double t_correlate = 0., t_compute = 0., t_components = 0.;
     double *compute_times;
     compute_times = (double*) calloc(h->num_devices, sizeof(double));
@@ -138,10 +176,11 @@ static void record_timing(oskar_Interferometer* h)
         t_join += oskar_timer_elapsed(h->d[i].tmr_join);
         t_E += oskar_timer_elapsed(h->d[i].tmr_E);
         t_K += oskar_timer_elapsed(h->d[i].tmr_K);
+        t_Z += oskar_timer_elapsed(h->d[i].tmr_Z);
         t_correlate += oskar_timer_elapsed(h->d[i].tmr_correlate);
         t_compute += compute_times[i];
     }
-    t_components = t_copy + t_clip + t_E + t_K + t_join + t_correlate;
+    t_components = t_copy + t_clip + t_E + t_K + t_Z + t_join + t_correlate;
 
     /* Record time taken. */
     oskar_log_section(h->log, 'M', "Simulation timing");
@@ -161,12 +200,26 @@ static void record_timing(oskar_Interferometer* h)
             (t_E / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones K", "%4.1f%%",
             (t_K / t_compute) * 100.0);
+    if (t_Z > 0.0)
+        oskar_log_value(h->log, 'M', 1, "Jones Z", "%4.1f%%",
+                (t_Z / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones join", "%4.1f%%",
             (t_join / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones correlate", "%4.1f%%",
             (t_correlate / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Other", "%4.1f%%",
             ((t_compute - t_components) / t_compute) * 100.0);
+    if (h->stat_num_compute > 0 && h->stat_num_write > 0)
+    {
+        oskar_log_message(h->log, 'M', 0, "Block pipeline (%d buffers):",
+                h->num_vis_buffers);
+        oskar_log_value(h->log, 'M', 1, "Blocks in flight",
+                "%.2f mean, %d max",
+                h->stat_sum_ahead / h->stat_num_compute, h->stat_max_ahead);
+        oskar_log_value(h->log, 'M', 1, "Blocks awaiting write",
+                "%.2f mean, %d max",
+                h->stat_sum_waiting / h->stat_num_write, h->stat_max_waiting);
+    }
     free(compute_times);
 }
 
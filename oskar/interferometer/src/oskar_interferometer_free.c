@@ -42,6 +42,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     int i;
     if (!h) return;
     oskar_interferometer_reset_cache(h, status);
+    oskar_interferometer_set_ionosphere(h, 0, 0.0, 0.0, 0, 0, status);
     for (i = 0; i < h->num_sky_chunks; ++i)
         oskar_sky_free(h->sky_chunks[i], status);
     oskar_telescope_free(h->tel, status);
@@ -52,7 +53,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
-    oskar_barrier_free(h->barrier);
+    oskar_condition_free(h->pipeline);
     oskar_log_free(h->log);
     free(h->sky_chunks);
     free(h->gpu_ids);
@@ -65,7 +66,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
 
 void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
 {
-    int i;
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -78,10 +79,15 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_clip);
         oskar_timer_free(d->tmr_E);
         oskar_timer_free(d->tmr_K);
+        oskar_timer_free(d->tmr_Z);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
-        oskar_vis_block_free(d->vis_block_cpu[0], status);
-        oskar_vis_block_free(d->vis_block_cpu[1], status);
+        if (d->vis_block_cpu)
+        {
+            for (j = 0; j < h->num_vis_buffers; ++j)
+                oskar_vis_block_free(d->vis_block_cpu[j], status);
+            free(d->vis_block_cpu);
+        }
         oskar_vis_block_free(d->vis_block, status);
         oskar_mem_free(d->u, status);
         oskar_mem_free(d->v, status);
@@ -90,12 +96,27 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_sky_free(d->chunk_clip, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
+        oskar_mem_free(d->tec, status);
+        if (d->work_Z) oskar_work_jones_z_free(d->work_Z, status);
+        oskar_mem_free(d->xcorr_work, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
+        oskar_jones_free(d->K_step, status);
         oskar_jones_free(d->R, status);
         memset(d, 0, sizeof(DeviceData));
     }
+    if (h->work_queue)
+    {
+        for (j = 0; j < h->num_vis_buffers; ++j)
+            oskar_work_queue_free(h->work_queue[j]);
+        free(h->work_queue);
+    }
+    free(h->work_queue_block);
+    free(h->num_devices_done);
+    h->work_queue = 0;
+    h->work_queue_block = 0;
+    h->num_devices_done = 0;
 }
 
 void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
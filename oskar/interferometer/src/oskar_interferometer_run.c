@@ -42,61 +42,96 @@ extern "C" {
 struct ThreadArgs
 {
     oskar_Interferometer* h;
-    DeviceData* d;
-    int num_threads, thread_id, *status;
+    int thread_id, *status;
 };
 typedef struct ThreadArgs ThreadArgs;
 
 static void* run_blocks(void* arg)
 {
     oskar_Interferometer* h;
-    int b, thread_id, device_id, num_blocks, num_threads, *status;
+    int b, thread_id, device_id, num_blocks, num_buffers, num_devices;
+    int *status;
 
     /* Get thread function arguments. */
     h = ((ThreadArgs*)arg)->h;
-    num_threads = ((ThreadArgs*)arg)->num_threads;
     thread_id = ((ThreadArgs*)arg)->thread_id;
     device_id = thread_id - 1;
     status = ((ThreadArgs*)arg)->status;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism, and give each compute device its own
+     * team of threads for the CPU kernels. */
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    omp_set_num_threads(oskar_interferometer_num_threads_per_device(h));
 #endif
 
     /* Loop over blocks of observation time, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
-     * by using double buffering, and a dedicated thread is used for file
-     * output.
+     * by using a ring of host visibility buffers, and a dedicated thread is
+     * used for file output.
      *
      * Thread 0 is used for file writes.
      * Threads 1 to n (mapped to compute devices) do the simulation.
      *
-     * Note that no write is launched on the first loop counter (as no
-     * data are ready yet) and no simulation is performed for the last loop
-     * counter (which corresponds to the last block + 1) as this iteration
-     * simply writes the last block.
+     * Compute threads may run ahead of the writer by up to the number of
+     * buffers in the ring, and do not wait for each other between blocks.
+     * Blocks are always finalised and written in order.
+     *
+     * Note that all threads continue to step through all blocks even if an
+     * error occurs, as the functions called will return immediately, and
+     * the pipeline state must still be updated to avoid deadlock.
      */
     num_blocks = oskar_interferometer_num_vis_blocks(h);
-    for (b = 0; b < num_blocks + 1; ++b)
+    num_buffers = h->num_vis_buffers;
+    num_devices = h->num_devices;
+    for (b = 0; b < num_blocks; ++b)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
+        const int slot = b % num_buffers;
+        if (thread_id > 0)
+        {
+            /* Wait for the host buffer for this block to be free. */
+            oskar_condition_lock(h->pipeline);
+            while (b - h->blocks_written >= num_buffers)
+                oskar_condition_wait(h->pipeline);
+            const int ahead = b - h->blocks_written;
+            h->stat_num_compute++;
+            h->stat_sum_ahead += ahead;
+            if (ahead > h->stat_max_ahead) h->stat_max_ahead = ahead;
+            oskar_condition_unlock(h->pipeline);
+
+            /* Simulate the block and signal completion. */
             oskar_interferometer_run_block(h, b, device_id, status);
-        if (thread_id == 0 && b > 0)
+            oskar_condition_lock(h->pipeline);
+            h->num_devices_done[slot]++;
+            oskar_condition_notify_all(h->pipeline);
+            oskar_condition_unlock(h->pipeline);
+        }
+        else
         {
+            int i, waiting = 0;
             oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
-        }
 
-        /* Barrier 1: Reset work unit index and print status. */
-        oskar_barrier_wait(h->barrier);
-        if (thread_id == 0)
-            oskar_interferometer_reset_work_unit_index(h);
-
-        /* Barrier 2: Synchronise before moving to the next block. */
-        oskar_barrier_wait(h->barrier);
+            /* Wait for all devices to finish this block. */
+            oskar_condition_lock(h->pipeline);
+            while (h->num_devices_done[slot] < num_devices)
+                oskar_condition_wait(h->pipeline);
+            for (i = b; i < b + num_buffers && i < num_blocks; ++i)
+                if (h->num_devices_done[i % num_buffers] == num_devices)
+                    waiting++;
+            h->stat_num_write++;
+            h->stat_sum_waiting += waiting;
+            if (waiting > h->stat_max_waiting) h->stat_max_waiting = waiting;
+            oskar_condition_unlock(h->pipeline);
+
+            /* Finalise and write the block, then release its buffer. */
+            block = oskar_interferometer_finalise_block(h, b, status);
+            oskar_interferometer_write_block(h, block, b, status);
+            oskar_condition_lock(h->pipeline);
+            h->num_devices_done[slot] = 0;
+            h->blocks_written = b + 1;
+            oskar_condition_notify_all(h->pipeline);
+            oskar_condition_unlock(h->pipeline);
+        }
     }
     return 0;
 }
@@ -129,32 +164,40 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     /* Initialise if required. */
     oskar_interferometer_check_init(h, status);
 
-    /* Set up worker threads. */
-    const int num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
-    args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
-    for (i = 0; i < num_threads; ++i)
+    /* Run the simulation if initialisation succeeded. */
+    if (!*status)
     {
-        args[i].h = h;
-        args[i].num_threads = num_threads;
-        args[i].thread_id = i;
-        args[i].status = status;
-    }
-
-    /* Start the worker threads. */
-    oskar_interferometer_reset_work_unit_index(h);
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        /* Set up worker threads. */
+        const int num_threads = h->num_devices + 1;
+        threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+        args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
+        for (i = 0; i < num_threads; ++i)
+        {
+            args[i].h = h;
+            args[i].thread_id = i;
+            args[i].status = status;
+        }
 
-    /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
+        /* Reset the pipeline state and start the worker threads. */
+        oskar_interferometer_reset_work_unit_index(h);
+        for (i = 0; i < h->num_vis_buffers; ++i)
+            h->num_devices_done[i] = 0;
+        h->blocks_written = 0;
+        h->stat_num_compute = h->stat_num_write = 0;
+        h->stat_max_ahead = h->stat_max_waiting = 0;
+        h->stat_sum_ahead = h->stat_sum_waiting = 0.0;
+        for (i = 0; i < num_threads; ++i)
+            threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+
+        /* Wait for worker threads to finish. */
+        for (i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        free(threads);
+        free(args);
     }
-    free(threads);
-    free(args);
 
     /* Finalise. */
     oskar_interferometer_finalise(h, status);
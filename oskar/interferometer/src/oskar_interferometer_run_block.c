@@ -33,19 +33,34 @@
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_auto_correlate.h"
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_fused.h"
 #include "interferometer/oskar_evaluate_jones_R.h"
 #include "interferometer/oskar_evaluate_jones_Z.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "math/oskar_round_robin.h"
 #include "utility/oskar_device.h"
 
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Maximum number of channels between direct evaluations of Jones K. */
+#define K_ANCHOR_CHANNELS 16
+
+static void set_up_work_queue(oskar_Interferometer* h,
+        oskar_WorkQueue* queue);
+static void sim_time_step(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, int* status);
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
-        int time_index_simulation, int* status);
+        int time_index_simulation, double gast, int* status);
+static void apply_source_filter(oskar_Jones* E, const oskar_Sky* sky,
+        double min_jy, double max_jy, int* status);
 static unsigned int disp_width(unsigned int v);
 
 void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
@@ -69,8 +84,18 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->dev_loc, h->gpu_ids[device_id], status);
 
+    /* Set up the work queues for this block, if not already done. */
+    const int i_active = block_index % h->num_vis_buffers; /* Active slot. */
+    oskar_WorkQueue* queue = h->work_queue[i_active];
+    oskar_mutex_lock(h->mutex);
+    if (h->work_queue_block[i_active] != block_index)
+    {
+        h->work_queue_block[i_active] = block_index;
+        set_up_work_queue(h, queue);
+    }
+    oskar_mutex_unlock(h->mutex);
+
     /* Clear the visibility block. */
-    const int i_active = block_index % 2; /* Index of the active buffer. */
     d = &(h->d[device_id]);
     oskar_timer_resume(d->tmr_compute);
     oskar_vis_block_clear(d->vis_block, status);
@@ -90,23 +115,30 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     /* Set the number of active times in the block. */
     oskar_vis_block_set_num_times(d->vis_block, num_times_block, status);
     oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
+    oskar_station_work_set_time_range(d->station_work,
+            time_index_start, num_times_block);
 
     /* Go though all possible work units in the block. A work unit is defined
-     * as the simulation for one time and one sky chunk. */
+     * as the simulation for one time and one sky chunk.
+     * Each device takes work units from its own queue of sky chunks first,
+     * and steals from other devices only when its own queue is empty.
+     * The direction of traversal alternates between blocks, so that each
+     * device starts a block with the chunk it finished the last one with. */
+    const int max_times_block = h->max_times_per_block;
+    const int reverse = block_index % 2;
     while (!h->coords_only)
     {
         oskar_Sky* sky;
-        int i_channel;
+        int i_channel, i_work_unit = 0;
 
-        oskar_mutex_lock(h->mutex);
-        const int i_work_unit = (h->work_unit_index)++;
-        oskar_mutex_unlock(h->mutex);
-        if ((i_work_unit >= num_times_block * total_chunks) || *status) break;
+        if (*status || !oskar_work_queue_next(queue, device_id,
+                reverse, &i_work_unit)) break;
 
-        /* Convert slice index to chunk/time index. */
-        const int i_chunk      = i_work_unit / num_times_block;
-        const int i_time       = i_work_unit - i_chunk * num_times_block;
+        /* Convert work unit index to chunk/time index. */
+        const int i_chunk      = i_work_unit / max_times_block;
+        const int i_time       = i_work_unit - i_chunk * max_times_block;
         const int sim_time_idx = time_index_start + i_time;
+        if (i_time >= num_times_block) continue;
 
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
@@ -117,18 +149,22 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         }
         sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
 
+        /* Get the time of the visibility slice being simulated. */
+        const double mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
+        const double gast = oskar_convert_mjd_to_gast_fast(mjd);
+
         /* Apply horizon clip if required. */
         if (h->apply_horizon_clip)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
             oskar_timer_resume(d->tmr_clip);
             oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
                     d->station_work, status);
             oskar_timer_pause(d->tmr_clip);
         }
 
+        /* Evaluate terms that do not depend on frequency. */
+        sim_time_step(h, d, sky, gast, status);
+
         /* Simulate all baselines for all channels for this time and chunk. */
         for (i_channel = 0; i_channel < num_channels; ++i_channel)
         {
@@ -141,7 +177,8 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
                     disp_width(num_channels), i_channel + 1, num_channels,
                     device_id, oskar_sky_num_sources(sky));
             oskar_mutex_unlock(h->mutex);
-            sim_baselines(h, d, sky, i_channel, i_time, sim_time_idx, status);
+            sim_baselines(h, d, sky, i_channel, i_time, sim_time_idx, gast,
+                    status);
         }
         d->previous_chunk_index = i_chunk;
     }
@@ -154,13 +191,89 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 }
 
 
+static void set_up_work_queue(oskar_Interferometer* h,
+        oskar_WorkQueue* queue)
+{
+    int i, num_chunks, start_chunk;
+
+    /* Give each device a contiguous range of sky chunks, so that it keeps
+     * the same chunk across consecutive time indices. Work units are
+     * numbered chunk-major using the maximum number of times per block. */
+    const int num_devices = oskar_work_queue_num_queues(queue);
+    const int max_times = h->max_times_per_block;
+    for (i = 0; i < num_devices; ++i)
+    {
+        oskar_round_robin(h->num_sky_chunks, num_devices, i,
+                &num_chunks, &start_chunk);
+        oskar_work_queue_set_range(queue, i, start_chunk * max_times,
+                (start_chunk + num_chunks) * max_times);
+    }
+}
+
+
+static void sim_time_step(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, int* status)
+{
+    const oskar_Mem *x, *y, *z;
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const int num_src = oskar_sky_num_sources(sky);
+
+    /* Keep the ENU directions of the sources seen by each station,
+     * so station beams for all channels share them. This must be reset
+     * for each work unit, as the sky chunk arrays are reused. */
+    oskar_station_work_set_direction_cache(d->station_work,
+            oskar_sky_l_const(sky), num_src, gast, status);
+    if (num_src == 0 || *status) return;
+
+    /* Evaluate station u,v,w coordinates. */
+    const double ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
+    const double dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
+    x = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 0);
+    y = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 1);
+    z = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 2);
+    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
+            0, 0, d->u, d->v, d->w, status);
+
+    /* Set dimensions of Jones matrices. */
+    if (d->R)
+        oskar_jones_set_size(d->R, num_stations, num_src, status);
+    if (d->J)
+        oskar_jones_set_size(d->J, num_stations, num_src, status);
+    if (d->K)
+        oskar_jones_set_size(d->K, num_stations, num_src, status);
+    if (d->K_step)
+        oskar_jones_set_size(d->K_step, num_stations, num_src, status);
+    oskar_jones_set_size(d->E, num_stations, num_src, status);
+
+    /* Evaluate parallactic angle (Jones R: matrix).
+     * This is kept for all channels, and joined with Jones E later.
+     * TODO Move this into station beam evaluation instead. */
+    if (d->R)
+    {
+        oskar_timer_resume(d->tmr_E);
+        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
+                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
+        oskar_timer_pause(d->tmr_E);
+    }
+
+    /* Evaluate ionospheric TEC at all pierce points (for Jones Z).
+     * This does not depend on frequency, so is kept for all channels. */
+    if (d->tec)
+    {
+        oskar_timer_resume(d->tmr_Z);
+        oskar_evaluate_jones_Z_tec(d->tec, sky, h->tel, &h->ionosphere, gast,
+                d->work_Z, status);
+        oskar_timer_pause(d->tmr_Z);
+    }
+}
+
+
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
-        int time_index_simulation, int* status)
+        int time_index_simulation, double gast, int* status)
 {
     int num_baselines, num_stations, num_src, num_times_block, num_channels;
-    double dt_dump_days, t_start, t_dump, gast, frequency, ra0, dec0;
-    const oskar_Mem *x, *y, *z;
+    double frequency;
 
     /* Get dimensions. */
     num_baselines   = oskar_telescope_num_baselines(d->tel);
@@ -173,34 +286,12 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
      * or if block time index requested is outside the valid range. */
     if (num_src == 0 || time_index_block >= num_times_block) return;
 
-    /* Get the time and frequency of the visibility slice being simulated. */
-    dt_dump_days = h->time_inc_sec / 86400.0;
-    t_start = h->time_start_mjd_utc;
-    t_dump = t_start + dt_dump_days * (time_index_simulation + 0.5);
-    gast = oskar_convert_mjd_to_gast_fast(t_dump);
+    /* Get the frequency of the visibility slice being simulated. */
     frequency = h->freq_start_hz + channel_index_block * h->freq_inc_hz;
 
     /* Scale source fluxes with spectral index and rotation measure. */
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
-    /* Evaluate station u,v,w coordinates. */
-    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
-    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
-    x = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 0);
-    y = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 1);
-    z = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 2);
-    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
-            0, 0, d->u, d->v, d->w, status);
-
-    /* Set dimensions of Jones matrices. */
-    if (d->R)
-        oskar_jones_set_size(d->R, num_stations, num_src, status);
-    if (d->Z)
-        oskar_jones_set_size(d->Z, num_stations, num_src, status);
-    oskar_jones_set_size(d->J, num_stations, num_src, status);
-    oskar_jones_set_size(d->E, num_stations, num_src, status);
-    oskar_jones_set_size(d->K, num_stations, num_src, status);
-
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
     oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
@@ -208,49 +299,73 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             gast, frequency, d->station_work, time_index_simulation, status);
     oskar_timer_pause(d->tmr_E);
 
-#if 0
-    /* Evaluate ionospheric phase (Jones Z: scalar) and join with Jones E.
-     * NOTE this is currently only a CPU implementation. */
-    if (d->Z)
+    /* Join Jones E with ionospheric phase (Jones Z: scalar), using the
+     * TEC evaluated for this time step. */
+    if (d->tec)
     {
-        oskar_evaluate_jones_Z(d->Z, num_src, sky, d->tel,
-                &settings->ionosphere, gast, frequency, &(d->workJonesZ),
-                status);
-        oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->E, d->Z, d->E, status);
-        oskar_timer_pause(d->tmr_join);
+        oskar_timer_resume(d->tmr_Z);
+        oskar_evaluate_jones_Z_join(d->E, frequency, d->tec, status);
+        oskar_timer_pause(d->tmr_Z);
     }
-#endif
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones Z*E.
-     * TODO Move this into station beam evaluation instead. */
+    /* Join Jones E with Jones R, evaluated for this time step. */
     if (d->R)
     {
-        oskar_timer_resume(d->tmr_E);
-        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
-                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
-        oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_jones_join(0, d->E, d->R, status);
         oskar_timer_pause(d->tmr_join);
     }
 
-    /* Evaluate interferometer phase (Jones K: scalar). */
+    /* Calculate output offset. */
+    const int offset = num_channels * time_index_block + channel_index_block;
+
+    /* Correlate Jones E directly if Jones K is not stored. */
+    if (!d->K)
+    {
+        apply_source_filter(d->E, sky, h->source_min_jy, h->source_max_jy,
+                status);
+        oskar_timer_resume(d->tmr_correlate);
+        if (oskar_vis_block_has_auto_correlations(d->vis_block))
+            oskar_auto_correlate(num_src, d->E, sky, num_stations * offset,
+                    oskar_vis_block_auto_correlations(d->vis_block), status);
+        if (oskar_vis_block_has_cross_correlations(d->vis_block))
+            oskar_cross_correlate_fused(num_src, d->E, sky, d->tel,
+                    d->u, d->v, d->w, gast, frequency,
+                    h->ignore_w_components, num_baselines * offset,
+                    oskar_vis_block_cross_correlations(d->vis_block), status);
+        oskar_timer_pause(d->tmr_correlate);
+        return;
+    }
+
+    /* Evaluate interferometer phase (Jones K: scalar).
+     * Channels are evenly spaced, so if Jones K for the channel increment
+     * is available, Jones K for each channel is that for the previous
+     * channel multiplied by it. Jones K is still evaluated directly every
+     * K_ANCHOR_CHANNELS channels, to limit the accumulated rounding error. */
     oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
-            oskar_sky_m_const(sky), oskar_sky_n_const(sky), d->u, d->v, d->w,
-            frequency, oskar_sky_I_const(sky),
-            h->source_min_jy, h->source_max_jy, h->ignore_w_components,
-            status);
+    if (d->K_step && channel_index_block % K_ANCHOR_CHANNELS != 0)
+        oskar_jones_join(0, d->K, d->K_step, status);
+    else
+    {
+        oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                d->u, d->v, d->w, frequency, oskar_sky_I_const(sky),
+                h->source_min_jy, h->source_max_jy, h->ignore_w_components,
+                status);
+        if (d->K_step && channel_index_block == 0)
+            oskar_evaluate_jones_K(d->K_step, num_src,
+                    oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                    oskar_sky_n_const(sky), d->u, d->v, d->w,
+                    h->freq_inc_hz, oskar_sky_I_const(sky),
+                    h->source_min_jy, h->source_max_jy,
+                    h->ignore_w_components, status);
+    }
     oskar_timer_pause(d->tmr_K);
 
-    /* Join Jones K with Jones Z*E. */
+    /* Join Jones K with Jones Z*E*R. */
     oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
+    oskar_jones_join(d->J, d->K, d->E, status);
     oskar_timer_pause(d->tmr_join);
-
-    /* Calculate output offset. */
-    const int offset = num_channels * time_index_block + channel_index_block;
     oskar_timer_resume(d->tmr_correlate);
 
     /* Auto-correlate for this time and channel. */
@@ -262,11 +377,70 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     if (oskar_vis_block_has_cross_correlations(d->vis_block))
         oskar_cross_correlate(num_src, d->J, sky, d->tel, d->u, d->v, d->w,
                 gast, frequency, num_baselines * offset,
-                oskar_vis_block_cross_correlations(d->vis_block), status);
+                oskar_vis_block_cross_correlations(d->vis_block),
+                d->xcorr_work, status);
     oskar_timer_pause(d->tmr_correlate);
 }
 
 
+static void apply_source_filter(oskar_Jones* E, const oskar_Sky* sky,
+        double min_jy, double max_jy, int* status)
+{
+    int i, j, num_filtered = 0, *filtered;
+    if (*status || (min_jy <= -DBL_MAX && max_jy >= DBL_MAX)) return;
+    oskar_Mem* data = oskar_jones_mem(E);
+    if (oskar_mem_location(data) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Find the sources outside the flux range. */
+    const int num_sources = oskar_jones_num_sources(E);
+    const int num_stations = oskar_jones_num_stations(E);
+    filtered = (int*) malloc(num_sources * sizeof(int));
+    if (!filtered)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        const double* I_ = oskar_mem_double_const(oskar_sky_I_const(sky),
+                status);
+        for (i = 0; i < num_sources; ++i)
+            if (!(I_[i] > min_jy && I_[i] <= max_jy))
+                filtered[num_filtered++] = i;
+    }
+    else
+    {
+        const float* I_ = oskar_mem_float_const(oskar_sky_I_const(sky),
+                status);
+        for (i = 0; i < num_sources; ++i)
+            if (!(I_[i] > (float)min_jy && I_[i] <= (float)max_jy))
+                filtered[num_filtered++] = i;
+    }
+
+    /* Zero the station beams for these sources, as would otherwise be
+     * done when evaluating Jones K. Each element is a real, complex or
+     * matrix value, and all are zero when their bytes are zero. */
+    if (num_filtered > 0 && !*status)
+    {
+        char* p = (char*) oskar_mem_void(data);
+        const size_t element_size = oskar_mem_element_size(
+                oskar_mem_type(data));
+        for (j = 0; j < num_stations; ++j)
+        {
+            char* station_data = p + (size_t)j * num_sources * element_size;
+            for (i = 0; i < num_filtered; ++i)
+                memset(station_data + (size_t)filtered[i] * element_size,
+                        0, element_size);
+        }
+    }
+    free(filtered);
+}
+
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
@@ -29,10 +29,13 @@
 #include <gtest/gtest.h>
 
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_vector_types.h"
 
+#include <cfloat>
+#include <cmath>
 #include <cstdio>
 
 static void run_test(int type, double tol)
@@ -125,3 +128,193 @@ TEST(Jones_K, test_double)
 {
     run_test(OSKAR_DOUBLE, 1e-8);
 }
+
+static void run_test_frequency_step(int type, double tol)
+{
+    int num_sources = 1000;
+    int num_stations = 100;
+    int num_channels = 16;
+    int status = 0;
+    double freq_start_hz = 100e6, freq_inc_hz = 0.5e6;
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_step = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_ref = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+
+    srand(2);
+    oskar_mem_random_range(l, -0.5, 0.5, &status);
+    oskar_mem_random_range(m, -0.5, 0.5, &status);
+    oskar_mem_random_range(n, 0.7, 1.0, &status);
+    oskar_mem_random_range(I, 0.0, 1.0, &status);
+    oskar_mem_random_range(u, -1000.0, 1000.0, &status);
+    oskar_mem_random_range(v, -1000.0, 1000.0, &status);
+    oskar_mem_random_range(w, -100.0, 100.0, &status);
+
+    // Evaluate Jones K for the first channel and for the channel increment,
+    // then step through the channels and check against direct evaluation.
+    oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+            freq_start_hz, I, -DBL_MAX, DBL_MAX, 0, &status);
+    oskar_evaluate_jones_K(K_step, num_sources, l, m, n, u, v, w,
+            freq_inc_hz, I, -DBL_MAX, DBL_MAX, 0, &status);
+    for (int c = 1; c < num_channels; ++c)
+    {
+        double max_err = 0.0;
+        oskar_jones_join(0, K, K_step, &status);
+        oskar_evaluate_jones_K(K_ref, num_sources, l, m, n, u, v, w,
+                freq_start_hz + c * freq_inc_hz, I, -DBL_MAX, DBL_MAX, 0,
+                &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int num = num_sources * num_stations;
+        for (int i = 0; i < num; ++i)
+        {
+            double dx, dy;
+            if (type == OSKAR_SINGLE)
+            {
+                const float2* k = oskar_jones_float2_const(K, &status);
+                const float2* r = oskar_jones_float2_const(K_ref, &status);
+                dx = k[i].x - r[i].x;
+                dy = k[i].y - r[i].y;
+            }
+            else
+            {
+                const double2* k = oskar_jones_double2_const(K, &status);
+                const double2* r = oskar_jones_double2_const(K_ref, &status);
+                dx = k[i].x - r[i].x;
+                dy = k[i].y - r[i].y;
+            }
+            const double err = sqrt(dx * dx + dy * dy);
+            if (err > max_err) max_err = err;
+        }
+        EXPECT_LT(max_err, tol) << "Channel " << c;
+    }
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(K_step, &status);
+    oskar_jones_free(K_ref, &status);
+}
+
+TEST(Jones_K, frequency_step_single)
+{
+    run_test_frequency_step(OSKAR_SINGLE, 2e-3);
+}
+
+TEST(Jones_K, frequency_step_double)
+{
+    run_test_frequency_step(OSKAR_DOUBLE, 1e-11);
+}
+
+static void run_test_long_baselines(int type, double tol)
+{
+    int num_sources = 1000;
+    int num_stations = 100;
+    int status = 0;
+    double freq_hz = 10e9;
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+
+    // Use baselines of up to 5000 km at 10 GHz, so that phases reach 3e9.
+    // Coordinates are multiples of 1/8 and 8 metres, so the phase sum is
+    // exact in both precisions, and only the scaling by wavenumber rounds.
+    srand(3);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        oskar_mem_set_element_real(l, i, (rand() % 17 - 8) / 8.0, &status);
+        oskar_mem_set_element_real(m, i, (rand() % 17 - 8) / 8.0, &status);
+        oskar_mem_set_element_real(n, i, 1.0 - (rand() % 9) / 8.0, &status);
+        oskar_mem_set_element_real(I, i, 1.0, &status);
+    }
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_mem_set_element_real(u, i, 8.0 * (rand() % 1250001 - 625000),
+                &status);
+        oskar_mem_set_element_real(v, i, 8.0 * (rand() % 1250001 - 625000),
+                &status);
+        oskar_mem_set_element_real(w, i, 8.0 * (rand() % 1250001 - 625000),
+                &status);
+    }
+    oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+            freq_hz, I, -DBL_MAX, DBL_MAX, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare against the library sine and cosine of the same phase.
+    const double wavenumber = 2.0 * M_PI * freq_hz / 299792458.0;
+    double max_err = 0.0, max_phase = 0.0;
+    for (int a = 0; a < num_stations; ++a)
+    {
+        for (int s = 0; s < num_sources; ++s)
+        {
+            const int i = s + num_sources * a;
+            const double sum =
+                    oskar_mem_get_element(u, a, &status) *
+                    oskar_mem_get_element(l, s, &status) +
+                    oskar_mem_get_element(v, a, &status) *
+                    oskar_mem_get_element(m, s, &status) +
+                    oskar_mem_get_element(w, a, &status) *
+                    (oskar_mem_get_element(n, s, &status) - 1.0);
+            double phase, re, im;
+            if (type == OSKAR_SINGLE)
+            {
+                phase = (float) sum * (float) wavenumber;
+                const float2* k = oskar_jones_float2_const(K, &status);
+                re = k[i].x;
+                im = k[i].y;
+            }
+            else
+            {
+                phase = sum * wavenumber;
+                const double2* k = oskar_jones_double2_const(K, &status);
+                re = k[i].x;
+                im = k[i].y;
+            }
+            const double err_re = fabs(re - cos(phase));
+            const double err_im = fabs(im - sin(phase));
+            if (err_re > max_err) max_err = err_re;
+            if (err_im > max_err) max_err = err_im;
+            if (fabs(phase) > max_phase) max_phase = fabs(phase);
+        }
+    }
+    EXPECT_GT(max_phase, 1e9);
+    EXPECT_LT(max_err, tol);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_jones_free(K, &status);
+}
+
+TEST(Jones_K, long_baselines_single)
+{
+    run_test_long_baselines(OSKAR_SINGLE, 2e-7);
+}
+
+TEST(Jones_K, long_baselines_double)
+{
+    run_test_long_baselines(OSKAR_DOUBLE, 3e-16);
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_offset_ecef_to_ecef.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "interferometer/oskar_evaluate_jones_Z.h"
+#include "interferometer/oskar_jones.h"
+#include "sky/oskar_evaluate_tec_tid.h"
+#include "telescope/station/oskar_evaluate_pierce_points.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_vector_types.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+static const int num_sources = 500;
+static const int num_stations = 20;
+
+class jones_Z : public ::testing::Test
+{
+protected:
+    int status;
+    double gast;
+    double amp[2], speed[2], theta[2], wavelength[2];
+    oskar_SettingsTIDscreen tid;
+    oskar_SettingsIonosphere settings;
+    oskar_Sky* sky;
+    oskar_Telescope* tel;
+
+protected:
+    void SetUp()
+    {
+        status = 0;
+        gast = 1.5;
+        const double lon = 116.6 * M_PI / 180.0;
+        const double lat = -26.7 * M_PI / 180.0;
+        tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+        oskar_telescope_resize(tel, num_stations, &status);
+        oskar_telescope_set_position(tel, lon, lat, 0.0);
+        for (int i = 0; i < num_stations; ++i)
+            oskar_station_set_position(oskar_telescope_station(tel, i),
+                    lon, lat, 0.0, 0.0, 0.0, 0.0);
+        srand(2);
+        for (int i = 0; i < 3; ++i)
+            oskar_mem_random_range(
+                    oskar_telescope_station_true_offset_ecef_metres(tel, i),
+                    -5000.0, 5000.0, &status);
+
+        // Sources spread widely enough that some are below the
+        // minimum elevation.
+        const double ra0 = gast + lon, dec0 = lat;
+        sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        oskar_mem_random_range(oskar_sky_ra_rad(sky),
+                ra0 - 1.2, ra0 + 1.2, &status);
+        oskar_mem_random_range(oskar_sky_dec_rad(sky),
+                dec0 - 1.0, dec0 + 1.0, &status);
+        oskar_sky_evaluate_relative_directions(sky, ra0, dec0, &status);
+
+        // TID screen with two components.
+        amp[0] = 0.1;        amp[1] = 0.05;
+        speed[0] = 200.0;    speed[1] = 100.0;
+        theta[0] = 30.0;     theta[1] = 120.0;
+        wavelength[0] = 100.0; wavelength[1] = 50.0;
+        tid.height_km = 300.0;
+        tid.num_components = 2;
+        tid.amp = amp;
+        tid.speed = speed;
+        tid.theta = theta;
+        tid.wavelength = wavelength;
+        memset(&settings, 0, sizeof(oskar_SettingsIonosphere));
+        settings.enable = 1;
+        settings.min_elevation = 20.0 * M_PI / 180.0;
+        settings.TEC0 = 1.0;
+        settings.num_TID_screens = 1;
+        settings.TID = &tid;
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void TearDown()
+    {
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+    }
+
+    // Evaluates Jones Z one station at a time, using the functions
+    // that operate on whole arrays.
+    void reference(oskar_Jones* Z, double frequency_hz)
+    {
+        oskar_Mem *hor_x, *hor_y, *hor_z, *pp_lon, *pp_lat, *pp_path, *tec;
+        hor_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        hor_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        hor_z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        pp_lon = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        pp_lat = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        pp_path = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources,
+                &status);
+        tec = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        const double wavelength_m = 299792458.0 / frequency_hz;
+        double2* z = oskar_jones_double2(Z, &status);
+        for (int i = 0; i < num_stations; ++i)
+        {
+            double x, y, zz;
+            const oskar_Station* st = oskar_telescope_station_const(tel, i);
+            const double lon = oskar_station_lon_rad(st);
+            const double lat = oskar_station_lat_rad(st);
+            oskar_convert_relative_directions_to_enu_directions(0, 0, 0,
+                    num_sources, oskar_sky_l_const(sky),
+                    oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                    gast + lon - oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), lat, 0,
+                    hor_x, hor_y, hor_z, &status);
+            oskar_convert_offset_ecef_to_ecef(1,
+                    oskar_mem_double_const(
+                    oskar_telescope_station_true_offset_ecef_metres_const(
+                    tel, 0), &status) + i,
+                    oskar_mem_double_const(
+                    oskar_telescope_station_true_offset_ecef_metres_const(
+                    tel, 1), &status) + i,
+                    oskar_mem_double_const(
+                    oskar_telescope_station_true_offset_ecef_metres_const(
+                    tel, 2), &status) + i,
+                    lon, lat, oskar_station_alt_metres(st), &x, &y, &zz);
+            oskar_evaluate_pierce_points(pp_lon, pp_lat, pp_path, x, y, zz,
+                    tid.height_km * 1000.0, num_sources,
+                    hor_x, hor_y, hor_z, &status);
+            oskar_evaluate_tec_tid(tec, num_sources, pp_lon, pp_lat, pp_path,
+                    settings.TEC0, &tid, gast);
+            const double* h_z = oskar_mem_double_const(hor_z, &status);
+            const double* t = oskar_mem_double_const(tec, &status);
+            for (int j = 0; j < num_sources; ++j)
+            {
+                double2& v = z[i * num_sources + j];
+                v.x = 1.0; v.y = 0.0;
+                if (asin(h_z[j]) < settings.min_elevation) continue;
+                v.x = cos(wavelength_m * 25.0 * t[j]);
+                v.y = sin(wavelength_m * 25.0 * t[j]);
+            }
+        }
+        oskar_mem_free(hor_x, &status);
+        oskar_mem_free(hor_y, &status);
+        oskar_mem_free(hor_z, &status);
+        oskar_mem_free(pp_lon, &status);
+        oskar_mem_free(pp_lat, &status);
+        oskar_mem_free(pp_path, &status);
+        oskar_mem_free(tec, &status);
+    }
+};
+
+TEST_F(jones_Z, all_stations_match_reference)
+{
+    const double frequency_hz = 100e6;
+    oskar_Jones* Z = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* Z_ref = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_WorkJonesZ* work = oskar_work_jones_z_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_evaluate_jones_Z(Z, sky, tel, &settings, gast, frequency_hz,
+            work, &status);
+    reference(Z_ref, frequency_hz);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check values, and that some pierce points were masked.
+    int num_masked = 0;
+    const double2* z = oskar_jones_double2_const(Z, &status);
+    const double2* r = oskar_jones_double2_const(Z_ref, &status);
+    for (int i = 0; i < num_stations * num_sources; ++i)
+    {
+        EXPECT_NEAR(r[i].x, z[i].x, 1e-9);
+        EXPECT_NEAR(r[i].y, z[i].y, 1e-9);
+        if (r[i].x == 1.0 && r[i].y == 0.0) num_masked++;
+    }
+    EXPECT_GT(num_masked, 0);
+    EXPECT_LT(num_masked, num_stations * num_sources);
+    oskar_work_jones_z_free(work, &status);
+    oskar_jones_free(Z, &status);
+    oskar_jones_free(Z_ref, &status);
+}
+
+TEST_F(jones_Z, join_matrix)
+{
+    // Check that joining with Jones E gives the same result for every
+    // channel as an explicit join with Jones Z.
+    const int precisions[] = {OSKAR_DOUBLE, OSKAR_SINGLE};
+    oskar_WorkJonesZ* work = oskar_work_jones_z_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    for (int p = 0; p < 2; ++p)
+    {
+        const int prec = precisions[p];
+        const double tol = (prec == OSKAR_DOUBLE) ? 1e-9 : 1e-4;
+        oskar_Mem* tec = oskar_mem_create(prec, OSKAR_CPU, 0, &status);
+        oskar_Jones* E = oskar_jones_create(prec | OSKAR_COMPLEX |
+                OSKAR_MATRIX, OSKAR_CPU, num_stations, num_sources, &status);
+        oskar_Jones* E_ref = oskar_jones_create(prec | OSKAR_COMPLEX |
+                OSKAR_MATRIX, OSKAR_CPU, num_stations, num_sources, &status);
+        oskar_Jones* Z = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        oskar_evaluate_jones_Z_tec(tec, sky, tel, &settings, gast,
+                work, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int c = 0; c < 3; ++c)
+        {
+            const double frequency_hz = 100e6 + c * 1e6;
+            oskar_mem_random_range(oskar_jones_mem(E), -1.0, 1.0, &status);
+            oskar_mem_copy(oskar_jones_mem(E_ref), oskar_jones_mem(E),
+                    &status);
+            oskar_evaluate_jones_Z_join(E, frequency_hz, tec, &status);
+            reference(Z, frequency_hz);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            const double2* z = oskar_jones_double2_const(Z, &status);
+            for (int i = 0; i < num_stations * num_sources; ++i)
+            {
+                double e[8], r[8];
+                if (prec == OSKAR_DOUBLE)
+                {
+                    const double4c& a = oskar_jones_double4c_const(
+                            E, &status)[i];
+                    const double4c& b = oskar_jones_double4c_const(
+                            E_ref, &status)[i];
+                    memcpy(e, &a, sizeof(e));
+                    memcpy(r, &b, sizeof(r));
+                }
+                else
+                {
+                    const float* a = (const float*)
+                            (oskar_jones_float4c_const(E, &status) + i);
+                    const float* b = (const float*)
+                            (oskar_jones_float4c_const(E_ref, &status) + i);
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        e[k] = a[k];
+                        r[k] = b[k];
+                    }
+                }
+                for (int k = 0; k < 8; k += 2)
+                {
+                    EXPECT_NEAR(r[k] * z[i].x - r[k + 1] * z[i].y, e[k], tol);
+                    EXPECT_NEAR(r[k] * z[i].y + r[k + 1] * z[i].x, e[k + 1],
+                            tol);
+                }
+            }
+        }
+        oskar_mem_free(tec, &status);
+        oskar_jones_free(E, &status);
+        oskar_jones_free(E_ref, &status);
+        oskar_jones_free(Z, &status);
+    }
+    oskar_work_jones_z_free(work, &status);
+}
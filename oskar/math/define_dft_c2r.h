@@ -71,7 +71,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     for (i = 0; i < num_in; ++i) {\
         FP re, im, t = xo * x_in[i] + yo * y_in[i];\
         if (IS_3D) t += zo * z_in[i];\
-        SINCOS(-t, im, re);\
+        VSINCOS(FP, -t, im, re);\
         FP2 d = data_in[i];\
         d.x *= weight_in[i];\
         d.y *= weight_in[i];\
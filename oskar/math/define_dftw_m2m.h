@@ -122,7 +122,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     for (i = 0; i < num_in; ++i) {\
         FP re, im, t = xo * x_in[i] + yo * y_in[i];\
         if (IS_3D) t += zo * z_in[i];\
-        SINCOS(t, im, re);\
+        VSINCOS(FP, t, im, re);\
         t = re;\
         const FP2 w = weights_in[i];\
         re *= w.x; re -= w.y * im;\
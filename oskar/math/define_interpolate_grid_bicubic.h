@@ -0,0 +1,44 @@
+/* Copyright (c) 2020, The University of Oxford. See LICENSE file. */
+
+/* Catmull-Rom cubic convolution weights for fractional offset t. */
+#define OSKAR_CUBIC_WEIGHTS(FP, T, W) {\
+        const FP t2_ = T * T, t3_ = t2_ * T;\
+        W[0] = (FP)0.5 * (-t3_ + (FP)2 * t2_ - T);\
+        W[1] = (FP)0.5 * ((FP)3 * t3_ - (FP)5 * t2_ + (FP)2);\
+        W[2] = (FP)0.5 * ((FP)-3 * t3_ + (FP)4 * t2_ + T);\
+        W[3] = (FP)0.5 * (t3_ - t2_); }
+
+/* Grid values are stored with x varying fastest, with num_comp real
+ * components per grid point (2 for complex, 8 for complex matrix). */
+#define OSKAR_INTERPOLATE_GRID_BICUBIC(NAME, FP) KERNEL(NAME) (\
+        const int num_x, const int num_y, const FP x0, const FP y0,\
+        const FP inv_dx, const FP inv_dy, const int num_comp,\
+        GLOBAL_IN(FP, grid), const int num_points,\
+        GLOBAL_IN(FP, x), GLOBAL_IN(FP, y),\
+        const int offset_out, GLOBAL_OUT(FP, out))\
+{\
+    KERNEL_LOOP_PAR_X(int, i, 0, num_points)\
+    FP wx[4], wy[4];\
+    int c, j, k;\
+    const FP px = (x[i] - x0) * inv_dx, py = (y[i] - y0) * inv_dy;\
+    int ix = (int) floor(px), iy = (int) floor(py);\
+    ix = ix < 1 ? 1 : (ix > num_x - 3 ? num_x - 3 : ix);\
+    iy = iy < 1 ? 1 : (iy > num_y - 3 ? num_y - 3 : iy);\
+    const FP tx = px - (FP) ix, ty = py - (FP) iy;\
+    OSKAR_CUBIC_WEIGHTS(FP, tx, wx)\
+    OSKAR_CUBIC_WEIGHTS(FP, ty, wy)\
+    const int i_out = (i + offset_out) * num_comp;\
+    for (c = 0; c < num_comp; ++c) {\
+        FP sum = (FP) 0;\
+        for (j = 0; j < 4; ++j) {\
+            const int row = ((iy - 1 + j) * num_x + ix - 1) * num_comp + c;\
+            FP sum_row = (FP) 0;\
+            for (k = 0; k < 4; ++k)\
+                sum_row += wx[k] * grid[row + k * num_comp];\
+            sum += wy[j] * sum_row;\
+        }\
+        out[i_out + c] = sum;\
+    }\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
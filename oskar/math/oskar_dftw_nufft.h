@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DFTW_NUFFT_H_
+#define OSKAR_DFTW_NUFFT_H_
+
+/**
+ * @file oskar_dftw_nufft.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to evaluate a weighted 2D DFT using a non-uniform FFT.
+ *
+ * @details
+ * This function evaluates the same sum as oskar_dftw() for a 2D transform,
+ * but uses a type-3 (non-uniform to non-uniform) FFT to do so.
+ *
+ * The weighted inputs are spread onto a regular grid using a Gaussian
+ * kernel, the grid is transformed using an FFT, and the result is
+ * interpolated to each output position using a second Gaussian kernel,
+ * following the method of Greengard & Lee (2004, SIAM Review 46, 443).
+ * The cost is roughly proportional to (\p num_in + \p num_out) multiplied
+ * by the number of distinct values in \p data_idx, rather than to
+ * \p num_in * \p num_out, so this is much faster than a direct DFT when
+ * there are many inputs.
+ *
+ * The \p accuracy parameter sets the width of the kernels, and gives the
+ * approximate maximum error of each output value relative to the sum of
+ * the input weight amplitudes.
+ *
+ * Unlike oskar_dftw(), the \p data_idx array is required, and the
+ * \p data array must be of size \p num_out * (1 + max(\p data_idx)).
+ * One transform is performed for each distinct value in \p data_idx.
+ *
+ * Only CPU memory is supported. Outputs for any non-finite output
+ * positions are set to zero.
+ *
+ * @param[in] normalise        If true, divide output values by \p num_in.
+ * @param[in] num_in           Number of input points.
+ * @param[in] wavenumber       Wavenumber (2 pi / wavelength).
+ * @param[in] weights_in       Array of input complex DFT weights.
+ * @param[in] x_in             Array of input x positions.
+ * @param[in] y_in             Array of input y positions.
+ * @param[in] offset_coord_out Start offset into output coordinate arrays.
+ * @param[in] num_out          Number of output points.
+ * @param[in] x_out            Array of output 1/x positions.
+ * @param[in] y_out            Array of output 1/y positions.
+ * @param[in] data_idx         Input data indices (see note, above).
+ * @param[in] data             Input data (see note, above).
+ * @param[in] eval_x           For matrix data, evaluate X components if true.
+ * @param[in] eval_y           For matrix data, evaluate Y components if true.
+ * @param[in] offset_out       Start offset into output data array.
+ * @param[out] output          Output data (see note, above).
+ * @param[in] accuracy         Required relative accuracy (e.g. 1e-6).
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dftw_nufft(
+        int normalise,
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* weights_in,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        int offset_coord_out,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* data_idx,
+        const oskar_Mem* data,
+        int eval_x,
+        int eval_y,
+        int offset_out,
+        oskar_Mem* output,
+        double accuracy,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DFTW_NUFFT_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, The University of Oxford
+ * Copyright (c) 2019-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -52,9 +52,19 @@ typedef struct oskar_FFT oskar_FFT;
  * @details
  * Creates a plan for executing FFTs.
  *
+ * On the CPU, FFTW is used if it was found when OSKAR was built.
+ * Otherwise, a built-in version of FFTPACK is used, which transforms
+ * blocks of rows and columns in parallel using OpenMP.
+ * Transform lengths may have any factors, but those with only factors
+ * of 2, 3, 5 and 7 are fastest.
+ *
+ * For 1D transforms, a batch of \p batch_size_1d transforms, each of
+ * length \p dim_size, is done on contiguous data. On the CPU, the
+ * transforms in the batch are done in parallel.
+ *
  * @param[in] precision     Enumerated data type precision.
  * @param[in] location      Enumerated compute platform.
- * @param[in] num_dim       Number of dimensions.
+ * @param[in] num_dim       Number of dimensions (1 or 2).
  * @param[in] dim_size      The size of each dimension.
  * @param[in] batch_size_1d Batch size for 1D transforms.
  * @param[in,out] status    Status return code.
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_INTERPOLATE_GRID_BICUBIC_H_
+#define OSKAR_INTERPOLATE_GRID_BICUBIC_H_
+
+/**
+ * @file oskar_interpolate_grid_bicubic.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Interpolates complex values on a regular 2D grid at arbitrary points.
+ *
+ * @details
+ * This function uses bicubic (Catmull-Rom) convolution to interpolate
+ * values tabulated on a regular grid to the given (x, y) coordinates.
+ *
+ * The grid must contain at least 4 points in each dimension, and is
+ * stored with x varying fastest, so that the value at grid point (ix, iy)
+ * is at index (iy * num_x + ix), with coordinates
+ * (x0 + ix * dx, y0 + iy * dy).
+ *
+ * Points outside the grid are extrapolated from the nearest cell,
+ * so the grid should enclose all points with a margin of at least
+ * one cell on each side.
+ *
+ * The grid and output arrays must be of the same complex scalar or
+ * complex matrix type. The results are written to the output array
+ * starting at \p offset_out.
+ *
+ * @param[in] num_x       Number of grid points in the x dimension.
+ * @param[in] num_y       Number of grid points in the y dimension.
+ * @param[in] x0          Coordinate of the first grid point in x.
+ * @param[in] y0          Coordinate of the first grid point in y.
+ * @param[in] dx          Grid spacing in x.
+ * @param[in] dy          Grid spacing in y.
+ * @param[in] grid        Grid of values to interpolate.
+ * @param[in] num_points  Number of points at which to interpolate.
+ * @param[in] x           Point x coordinates.
+ * @param[in] y           Point y coordinates.
+ * @param[in] offset_out  Start offset into output array.
+ * @param[out] out        Output array of interpolated values.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interpolate_grid_bicubic(int num_x, int num_y,
+        double x0, double y0, double dx, double dy, const oskar_Mem* grid,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        int offset_out, oskar_Mem* out, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_INTERPOLATE_GRID_BICUBIC_H_ */
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VMATH_H_
+#define OSKAR_VMATH_H_
+
+/**
+ * @file oskar_vmath.h
+ *
+ * @brief
+ * Vectorisable elementary functions for CPU kernels.
+ *
+ * @details
+ * These inline functions evaluate sin and cos, exp and sinc using only
+ * arithmetic, comparisons and bit operations, without branches or library
+ * calls. When they are used inside a loop, the compiler can therefore
+ * vectorise the loop using whichever SIMD instruction set it is compiling
+ * for.
+ *
+ * Sine and cosine reduce the argument to [-pi/4, pi/4] in double
+ * precision, using a Cody-Waite reduction with pi/2 split into four parts,
+ * followed by minimax polynomials. The measured maximum absolute errors,
+ * checked in Test_vmath.cpp, are:
+ *
+ * - oskar_vsincos_d(): 3e-16 for |x| <= 1e14.
+ * - oskar_vsincos_f(): 2e-7 for |x| <= 1e14.
+ *
+ * This covers the phases used in the DFT and Jones kernels, which can be
+ * much larger than 1e5 for long baselines at high frequencies.
+ * Arguments with |x| > 1e14 are not reduced accurately (although the
+ * results are bounded), but the spacing of double precision values there
+ * is already more than 0.01 radians.
+ *
+ * The exponential uses a rational (double precision) or polynomial
+ * (single precision) approximation after a reduction by ln(2).
+ * The maximum relative errors are 5e-16 (double) and 2e-7 (single) for
+ * results in the normal range. Overflow returns infinity. Results in the
+ * subnormal range are less accurate, and are flushed to zero below the
+ * smallest subnormal.
+ *
+ * sinc(x) = sin(x) / x, with sinc(0) = 1, has the same absolute error
+ * bound as the sine, divided by max(|x|, 1).
+ *
+ * These functions are only for use in host code.
+ */
+
+#include <math.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OSKAR_VMATH_INLINE static inline __attribute__((always_inline))
+#else
+#define OSKAR_VMATH_INLINE static inline
+#endif
+
+/* Adding and subtracting these constants rounds to the nearest integer. */
+#define OSKAR_VMATH_ROUND_D 6755399441055744.0 /* 1.5 * 2^52 */
+#define OSKAR_VMATH_ROUND_F 12582912.0f        /* 1.5 * 2^23 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Reduces a non-negative argument to [-pi/4, pi/4] (double precision).
+ *
+ * @details
+ * Returns ax - q * pi/2, where q is the nearest integer to ax * 2/pi,
+ * and stores the two lowest bits of q in \p n.
+ *
+ * The integer q is split into two parts, so that the product of each part
+ * with each of the first three parts of pi/2 (which have 27 significant
+ * bits) is exact. The reduction is accurate for ax <= 1e14.
+ *
+ * @param[in] ax   Argument in radians, with 0 <= ax <= 1e15.
+ * @param[out] n   Quadrant of the argument.
+ */
+OSKAR_VMATH_INLINE double oskar_vreduce_pio2_d(const double ax, int* n)
+{
+    union { double d; long long i; } u;
+
+    /* Find the nearest multiple q of pi/2. */
+    u.d = ax * 0.63661977236758134308 + OSKAR_VMATH_ROUND_D;
+    *n = (int) (u.i & 3);
+    const double q = u.d - OSKAR_VMATH_ROUND_D;
+
+    /* Split q into a multiple of 2^26 and a remainder. */
+    const double qh = ((q * 1.490116119384765625e-08 + OSKAR_VMATH_ROUND_D) -
+            OSKAR_VMATH_ROUND_D) * 67108864.0;
+    const double ql = q - qh;
+
+    /* Subtract q * pi/2, most significant part first. */
+    double z = ax - qh * 1.57079632580280303955e+00;
+    z -= ql * 1.57079632580280303955e+00;
+    z -= qh * 9.92093573959351715530e-10;
+    z -= ql * 9.92093573959351715530e-10;
+    z -= qh * 5.72118870966357490380e-18;
+    z -= ql * 5.72118870966357490380e-18;
+    z -= q * 1.64462569363242576015e-26;
+    return z;
+}
+
+/**
+ * @brief
+ * Evaluates sin(x) and cos(x) (double precision).
+ *
+ * @details
+ * Evaluates sin(x) and cos(x) without branches or library calls.
+ * See the file description for accuracy bounds.
+ *
+ * @param[in] x   Argument in radians.
+ * @param[out] s  sin(x).
+ * @param[out] c  cos(x).
+ */
+OSKAR_VMATH_INLINE void oskar_vsincos_d(const double x, double* s, double* c)
+{
+    int n;
+    const double ax = fabs(x) < 1e15 ? fabs(x) : 1e15;
+
+    /* Find the nearest multiple n of pi/2, and the remainder. */
+    const double z = oskar_vreduce_pio2_d(ax, &n);
+
+    /* Evaluate polynomials for sin and cos on [-pi/4, pi/4]. */
+    const double zz = z * z;
+    const double ps = z + z * zz * (((((
+            1.58962301576546568060e-10 * zz -
+            2.50507477628578072866e-08) * zz +
+            2.75573136213857245213e-06) * zz -
+            1.98412698295895385996e-04) * zz +
+            8.33333333332211858878e-03) * zz -
+            1.66666666666666307295e-01);
+    const double pc = 1.0 - 0.5 * zz + zz * zz * (((((
+            -1.13585365213876817300e-11 * zz +
+            2.08757008419747316778e-09) * zz -
+            2.75573141792967388112e-07) * zz +
+            2.48015872888517045348e-05) * zz -
+            1.38888888888730564116e-03) * zz +
+            4.16666666666665929218e-02);
+
+    /* Select the result for the quadrant. */
+    const double sv = (n & 1) ? pc : ps;
+    const double cv = (n & 1) ? ps : pc;
+    *s = ((n & 2) ? -sv : sv) * (x < 0.0 ? -1.0 : 1.0);
+    *c = ((n + 1) & 2) ? -cv : cv;
+}
+
+/**
+ * @brief
+ * Evaluates sin(x) and cos(x) (single precision).
+ *
+ * @details
+ * Evaluates sin(x) and cos(x) without branches or library calls.
+ * See the file description for accuracy bounds.
+ *
+ * @param[in] x   Argument in radians.
+ * @param[out] s  sin(x).
+ * @param[out] c  cos(x).
+ */
+OSKAR_VMATH_INLINE void oskar_vsincos_f(const float x, float* s, float* c)
+{
+    int n;
+    const double ax = fabsf(x) < 1e15f ? (double) fabsf(x) : 1e15;
+
+    /* Find the nearest multiple n of pi/2, and the remainder.
+     * This is done in double precision, as single precision loses
+     * accuracy quickly for arguments larger than about 1e4. */
+    const float z = (float) oskar_vreduce_pio2_d(ax, &n);
+
+    /* Evaluate polynomials for sin and cos on [-pi/4, pi/4]. */
+    const float zz = z * z;
+    const float ps = z + z * zz * ((
+            -1.9515295891e-4f * zz +
+            8.3321608736e-3f) * zz -
+            1.6666654611e-1f);
+    const float pc = 1.0f - 0.5f * zz + zz * zz * ((
+            2.443315711809948e-5f * zz -
+            1.388731625493765e-3f) * zz +
+            4.166664568298827e-2f);
+
+    /* Select the result for the quadrant. */
+    const float sv = (n & 1) ? pc : ps;
+    const float cv = (n & 1) ? ps : pc;
+    *s = ((n & 2) ? -sv : sv) * (x < 0.0f ? -1.0f : 1.0f);
+    *c = ((n + 1) & 2) ? -cv : cv;
+}
+
+/**
+ * @brief
+ * Evaluates exp(x) (double precision).
+ *
+ * @details
+ * Evaluates exp(x) without branches or library calls.
+ * See the file description for accuracy bounds.
+ *
+ * @param[in] x   Argument.
+ */
+OSKAR_VMATH_INLINE double oskar_vexp_d(const double x)
+{
+    union { double d; long long i; } u, s1, s2;
+    const double xc = x > 709.8 ? 709.8 : (x < -745.2 ? -745.2 : x);
+
+    /* Write exp(x) = 2^n exp(r), with |r| <= ln(2) / 2. */
+    u.d = xc * 1.4426950408889634074 + OSKAR_VMATH_ROUND_D;
+    const double y = u.d - OSKAR_VMATH_ROUND_D;
+    const int n = (int) y;
+    const double r = (xc - y * 6.93145751953125e-1) -
+            y * 1.42860682030941723212e-6;
+
+    /* Rational approximation to exp(r). */
+    const double rr = r * r;
+    const double p = r * ((
+            1.26177193074810590878e-4 * rr +
+            3.02994407707441961300e-2) * rr +
+            9.99999999999999999910e-1);
+    const double q = ((
+            3.00198505138664455042e-6 * rr +
+            2.52448340349684104192e-3) * rr +
+            2.27265548208155028766e-1) * rr +
+            2.00000000000000000009e0;
+    const double e = 1.0 + 2.0 * p / (q - p);
+
+    /* Multiply by 2^n in two steps, to avoid overflow of the exponent. */
+    s1.i = (long long) ((n >> 1) + 1023) << 52;
+    s2.i = (long long) (n - (n >> 1) + 1023) << 52;
+    const double result = e * s1.d * s2.d;
+    return x > 709.782712893384 ? HUGE_VAL : (x < -745.14 ? 0.0 : result);
+}
+
+/**
+ * @brief
+ * Evaluates exp(x) (single precision).
+ *
+ * @details
+ * Evaluates exp(x) without branches or library calls.
+ * See the file description for accuracy bounds.
+ *
+ * @param[in] x   Argument.
+ */
+OSKAR_VMATH_INLINE float oskar_vexp_f(const float x)
+{
+    union { float f; int i; } u, s1, s2;
+    const float xc = x > 88.8f ? 88.8f : (x < -104.0f ? -104.0f : x);
+
+    /* Write exp(x) = 2^n exp(r), with |r| <= ln(2) / 2. */
+    u.f = xc * 1.44269504088896341f + OSKAR_VMATH_ROUND_F;
+    const float y = u.f - OSKAR_VMATH_ROUND_F;
+    const int n = (int) y;
+    const float r = (xc - y * 0.693359375f) + y * 2.12194440e-4f;
+
+    /* Polynomial approximation to exp(r). */
+    const float rr = r * r;
+    const float e = (((((
+            1.9875691500e-4f * r +
+            1.3981999507e-3f) * r +
+            8.3334519073e-3f) * r +
+            4.1665795894e-2f) * r +
+            1.6666665459e-1f) * r +
+            5.0000001201e-1f) * rr + r + 1.0f;
+
+    /* Multiply by 2^n in two steps, to avoid overflow of the exponent. */
+    s1.i = ((n >> 1) + 127) << 23;
+    s2.i = (n - (n >> 1) + 127) << 23;
+    const float result = e * s1.f * s2.f;
+    return x > 88.7228391f ? HUGE_VALF : (x < -103.9721f ? 0.0f : result);
+}
+
+/**
+ * @brief
+ * Evaluates sin(x) / x (double precision).
+ *
+ * @details
+ * Evaluates sin(x) / x without branches or library calls.
+ * Returns 1 if x is 0.
+ *
+ * @param[in] x   Argument in radians.
+ */
+OSKAR_VMATH_INLINE double oskar_vsinc_d(const double x)
+{
+    double s, c;
+    oskar_vsincos_d(x, &s, &c);
+    return x == 0.0 ? 1.0 : s / (x == 0.0 ? 1.0 : x);
+}
+
+/**
+ * @brief
+ * Evaluates sin(x) / x (single precision).
+ *
+ * @details
+ * Evaluates sin(x) / x without branches or library calls.
+ * Returns 1 if x is 0.
+ *
+ * @param[in] x   Argument in radians.
+ */
+OSKAR_VMATH_INLINE float oskar_vsinc_f(const float x)
+{
+    float s, c;
+    oskar_vsincos_f(x, &s, &c);
+    return x == 0.0f ? 1.0f : s / (x == 0.0f ? 1.0f : x);
+}
+
+#ifdef __cplusplus
+}
+
+/* Overloads for use in templates. */
+OSKAR_VMATH_INLINE void oskar_vsincos(const float x, float& s, float& c)
+{
+    oskar_vsincos_f(x, &s, &c);
+}
+
+OSKAR_VMATH_INLINE void oskar_vsincos(const double x, double& s, double& c)
+{
+    oskar_vsincos_d(x, &s, &c);
+}
+
+OSKAR_VMATH_INLINE float oskar_vexp(const float x)
+{
+    return oskar_vexp_f(x);
+}
+
+OSKAR_VMATH_INLINE double oskar_vexp(const double x)
+{
+    return oskar_vexp_d(x);
+}
+
+OSKAR_VMATH_INLINE float oskar_vsinc(const float x)
+{
+    return oskar_vsinc_f(x);
+}
+
+OSKAR_VMATH_INLINE double oskar_vsinc(const double x)
+{
+    return oskar_vsinc_d(x);
+}
+#endif
+
+#endif /* OSKAR_VMATH_H_ */
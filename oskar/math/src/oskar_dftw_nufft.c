@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_cmath.h"
+#include "math/oskar_dftw_nufft.h"
+#include "math/oskar_fft.h"
+
+#include <float.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Oversampling factors of the input and Fourier grids. */
+#define SIGMA_1 2.0
+#define SIGMA_2 2.0
+
+/* Maximum half-width of either Gaussian kernel, in grid points. */
+#define MAX_HALF_WIDTH 24
+
+typedef struct
+{
+    double centre_in, centre_out; /* Centres of input and output ranges. */
+    double h;                     /* Spacing of the input grid. */
+    double tau;                   /* Spreading kernel parameter. */
+    double norm;                  /* Fourier transform of spreading kernel at 0. */
+    int half_width;               /* Half-width of spreading kernel, in grid points. */
+    int half_size;                /* Half-size of the input grid. */
+} Axis;
+
+static void set_up_axis(Axis* a, double in_min, double in_max,
+        double out_min, double out_max, double log_eps)
+{
+    double s = 0.5 * (out_max - out_min);
+    const double x = 0.5 * (in_max - in_min);
+    if (s < 1e-9) s = 1e-9;
+    a->centre_in = 0.5 * (in_max + in_min);
+    a->centre_out = 0.5 * (out_max + out_min);
+
+    /* Choose the grid spacing and kernel so that aliasing of the
+     * kernel spectrum into the output range is below the tolerance. */
+    a->h = M_PI / (SIGMA_1 * s);
+    a->tau = log_eps / (4.0 * SIGMA_1 * (SIGMA_1 - 1.0) * s * s);
+    a->norm = sqrt(4.0 * M_PI * a->tau);
+    a->half_width = (int) ceil(sqrt(4.0 * a->tau * log_eps) / a->h);
+    a->half_size = (int) ceil(x / a->h) + a->half_width;
+}
+
+static int good_fft_size(int n)
+{
+    /* Return the smallest even number >= n with no prime factor above 5. */
+    for (;; ++n)
+    {
+        int m = n;
+        if (n & 1) continue;
+        while (m % 2 == 0) m /= 2;
+        while (m % 3 == 0) m /= 3;
+        while (m % 5 == 0) m /= 5;
+        if (m == 1) return n;
+    }
+}
+
+static double get_value(const void* p, int is_dbl, size_t i)
+{
+    return is_dbl ? ((const double*)p)[i] : (double)((const float*)p)[i];
+}
+
+void oskar_dftw_nufft(
+        int normalise,
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* weights_in,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        int offset_coord_out,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* data_idx,
+        const oskar_Mem* data,
+        int eval_x,
+        int eval_y,
+        int offset_out,
+        oskar_Mem* output,
+        double accuracy,
+        int* status)
+{
+    Axis ax[2];
+    oskar_FFT* fft = 0;
+    oskar_Mem *grids = 0, *deconv = 0;
+    double in_min[2], in_max[2], out_min[2], out_max[2];
+    double log_eps, tau_2, norm_2, r, *dec, *grid;
+    int i, num_types = 0, half_size, n1, nf, half_width_2;
+    const int* idx;
+    if (*status) return;
+    const int type = oskar_mem_precision(output);
+    const int is_dbl = oskar_mem_is_double(output);
+    const int is_matrix = oskar_mem_is_matrix(output);
+    const int num_comp = is_matrix ? 4 : 1;
+    const double norm_factor = normalise ? 1.0 / num_in : 1.0;
+    if (!oskar_mem_is_complex(output) || !oskar_mem_is_complex(weights_in) ||
+            oskar_mem_is_matrix(weights_in))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(data) != OSKAR_CPU ||
+            oskar_mem_location(data_idx) != OSKAR_CPU ||
+            oskar_mem_location(weights_in) != OSKAR_CPU ||
+            oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(y_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU ||
+            oskar_mem_location(y_out) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(weights_in) != type ||
+            oskar_mem_type(x_in) != type ||
+            oskar_mem_type(y_in) != type ||
+            oskar_mem_type(x_out) != type ||
+            oskar_mem_type(y_out) != type ||
+            oskar_mem_type(data) != oskar_mem_type(output) ||
+            oskar_mem_type(data_idx) != OSKAR_INT)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (accuracy <= 0.0 || accuracy >= 1.0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    oskar_mem_ensure(output, (size_t) offset_out + num_out, status);
+    if (*status || num_in <= 0 || num_out <= 0) return;
+
+    /* Get the number of transforms needed. */
+    idx = oskar_mem_int_const(data_idx, status);
+    for (i = 0; i < num_in; ++i)
+    {
+        if (idx[i] < 0)
+        {
+            *status = OSKAR_ERR_OUT_OF_RANGE;
+            return;
+        }
+        if (idx[i] >= num_types) num_types = idx[i] + 1;
+    }
+
+    /* Find the ranges of the inputs (in radians) and the outputs. */
+    const void* p_x_in = oskar_mem_void_const(x_in);
+    const void* p_y_in = oskar_mem_void_const(y_in);
+    const void* p_x_out = oskar_mem_void_const(x_out);
+    const void* p_y_out = oskar_mem_void_const(y_out);
+    in_min[0] = in_max[0] = wavenumber * get_value(p_x_in, is_dbl, 0);
+    in_min[1] = in_max[1] = wavenumber * get_value(p_y_in, is_dbl, 0);
+    for (i = 1; i < num_in; ++i)
+    {
+        const double x = wavenumber * get_value(p_x_in, is_dbl, i);
+        const double y = wavenumber * get_value(p_y_in, is_dbl, i);
+        if (x < in_min[0]) in_min[0] = x;
+        if (x > in_max[0]) in_max[0] = x;
+        if (y < in_min[1]) in_min[1] = y;
+        if (y > in_max[1]) in_max[1] = y;
+    }
+    out_min[0] = out_min[1] = DBL_MAX;
+    out_max[0] = out_max[1] = -DBL_MAX;
+    for (i = 0; i < num_out; ++i)
+    {
+        const double x = get_value(p_x_out, is_dbl, i + offset_coord_out);
+        const double y = get_value(p_y_out, is_dbl, i + offset_coord_out);
+        if (!isfinite(x) || !isfinite(y)) continue;
+        if (x < out_min[0]) out_min[0] = x;
+        if (x > out_max[0]) out_max[0] = x;
+        if (y < out_min[1]) out_min[1] = y;
+        if (y > out_max[1]) out_max[1] = y;
+    }
+
+    if (out_min[0] > out_max[0])
+        out_min[0] = out_max[0] = out_min[1] = out_max[1] = 0.0;
+
+    /* Set up the input grid and the (oversampled) Fourier grid. */
+    if (accuracy < 1e-15) accuracy = 1e-15;
+    log_eps = -log(accuracy);
+    set_up_axis(&ax[0], in_min[0], in_max[0], out_min[0], out_max[0], log_eps);
+    set_up_axis(&ax[1], in_min[1], in_max[1], out_min[1], out_max[1], log_eps);
+    half_size = ax[0].half_size > ax[1].half_size ?
+            ax[0].half_size : ax[1].half_size;
+    n1 = 2 * half_size + 1;
+    half_width_2 = (int) ceil(log_eps * SIGMA_2 / (M_PI * (SIGMA_2 - 0.5)));
+    nf = (int) ceil(SIGMA_2 * n1);
+    if (nf < 2 * half_width_2 + 2) nf = 2 * half_width_2 + 2;
+    nf = good_fft_size(nf);
+    r = (double) nf / n1;
+    tau_2 = M_PI * half_width_2 / ((double) n1 * n1 * r * (r - 0.5));
+    norm_2 = sqrt(4.0 * M_PI * tau_2);
+    if (ax[0].half_width > MAX_HALF_WIDTH ||
+            ax[1].half_width > MAX_HALF_WIDTH ||
+            half_width_2 > MAX_HALF_WIDTH)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+
+    /* Pre-compute the correction for the Fourier grid kernel. */
+    deconv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n1, status);
+    grids = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            (size_t) num_types * nf * nf, status);
+    if (*status)
+    {
+        oskar_mem_free(deconv, status);
+        oskar_mem_free(grids, status);
+        return;
+    }
+    dec = oskar_mem_double(deconv, status);
+    grid = oskar_mem_double(grids, status);
+    for (i = -half_size; i <= half_size; ++i)
+        dec[i + half_size] = exp(tau_2 * i * i) / norm_2;
+
+    /* Spread the weighted inputs onto the grid for each data index. */
+    const void* p_weights = oskar_mem_void_const(weights_in);
+    for (i = 0; i < num_in; ++i)
+    {
+        int k, l;
+        double kx[2 * MAX_HALF_WIDTH + 1], ky[2 * MAX_HALF_WIDTH + 1];
+        double c_re, c_im, w_re, w_im, phase;
+        const double x = wavenumber * get_value(p_x_in, is_dbl, i) -
+                ax[0].centre_in;
+        const double y = wavenumber * get_value(p_y_in, is_dbl, i) -
+                ax[1].centre_in;
+        const int x0 = (int) floor(x / ax[0].h + 0.5);
+        const int y0 = (int) floor(y / ax[1].h + 0.5);
+        const int wx = ax[0].half_width, wy = ax[1].half_width;
+        double* g = grid + 2 * (size_t) nf * nf * idx[i];
+        w_re = get_value(p_weights, is_dbl, 2 * i);
+        w_im = get_value(p_weights, is_dbl, 2 * i + 1);
+        phase = x * ax[0].centre_out + y * ax[1].centre_out;
+        c_re = cos(phase), c_im = sin(phase);
+        phase = w_re * c_re - w_im * c_im;
+        c_im = w_re * c_im + w_im * c_re;
+        c_re = phase;
+        for (k = -wx; k <= wx; ++k)
+        {
+            const double d = (x0 + k) * ax[0].h - x;
+            kx[k + wx] = exp(-d * d / (4.0 * ax[0].tau)) *
+                    dec[x0 + k + half_size];
+        }
+        for (l = -wy; l <= wy; ++l)
+        {
+            const double d = (y0 + l) * ax[1].h - y;
+            ky[l + wy] = exp(-d * d / (4.0 * ax[1].tau)) *
+                    dec[y0 + l + half_size];
+        }
+        for (l = -wy; l <= wy; ++l)
+        {
+            const int iy = (nf - (y0 + l)) % nf;
+            for (k = -wx; k <= wx; ++k)
+            {
+                const int ix = (nf - (x0 + k)) % nf;
+                const double f = kx[k + wx] * ky[l + wy];
+                const size_t j = 2 * ((size_t) iy * nf + ix);
+                g[j]     += f * c_re;
+                g[j + 1] += f * c_im;
+            }
+        }
+    }
+
+    /* Transform each grid. */
+    fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 2, nf, 0, status);
+    for (i = 0; i < num_types; ++i)
+    {
+        oskar_Mem* alias = oskar_mem_create_alias(grids,
+                (size_t) i * nf * nf, (size_t) nf * nf, status);
+        oskar_fft_exec(fft, alias, status);
+        oskar_mem_free(alias, status);
+    }
+    oskar_fft_free(fft);
+
+    /* Interpolate from the Fourier grids to each output point,
+     * and combine with the data for each index. */
+    const void* p_data = oskar_mem_void_const(data);
+    void* p_out = oskar_mem_void(output);
+    const double scale = 4.0 * M_PI * M_PI * ax[0].h * ax[1].h /
+            ((double) nf * nf * ax[0].norm * ax[1].norm);
+    if (!*status)
+    {
+#pragma omp parallel for private(i)
+        for (i = 0; i < num_out; ++i)
+        {
+            int k, l, c, t;
+            int ix[2 * MAX_HALF_WIDTH + 1], iy[2 * MAX_HALF_WIDTH + 1];
+            double kx[2 * MAX_HALF_WIDTH + 1], ky[2 * MAX_HALF_WIDTH + 1];
+            double acc[8], f, ph_re, ph_im;
+            const int w = half_width_2;
+            const double u = get_value(p_x_out, is_dbl, i + offset_coord_out);
+            const double v = get_value(p_y_out, is_dbl, i + offset_coord_out);
+            const int valid = isfinite(u) && isfinite(v);
+            const int num_t = valid ? num_types : 0;
+            const double du = valid ? u - ax[0].centre_out : 0.0;
+            const double dv = valid ? v - ax[1].centre_out : 0.0;
+            const double theta_x = ax[0].h * du, theta_y = ax[1].h * dv;
+            const int x0 = (int) floor(theta_x * nf / (2.0 * M_PI) + 0.5);
+            const int y0 = (int) floor(theta_y * nf / (2.0 * M_PI) + 0.5);
+            for (k = -w; k <= w; ++k)
+            {
+                const double d = theta_x - 2.0 * M_PI * (x0 + k) / nf;
+                kx[k + w] = exp(-d * d / (4.0 * tau_2));
+                ix[k + w] = ((x0 + k) % nf + nf) % nf;
+            }
+            for (l = -w; l <= w; ++l)
+            {
+                const double d = theta_y - 2.0 * M_PI * (y0 + l) / nf;
+                ky[l + w] = exp(-d * d / (4.0 * tau_2));
+                iy[l + w] = ((y0 + l) % nf + nf) % nf;
+            }
+
+            /* Undo the spreading kernel and the shift of the inputs. */
+            f = norm_factor * scale *
+                    exp(ax[0].tau * du * du + ax[1].tau * dv * dv);
+            ph_re = cos(ax[0].centre_in * u + ax[1].centre_in * v) * f;
+            ph_im = sin(ax[0].centre_in * u + ax[1].centre_in * v) * f;
+            for (c = 0; c < 8; ++c) acc[c] = 0.0;
+            for (t = 0; t < num_t; ++t)
+            {
+                double s_re = 0.0, s_im = 0.0, re, im;
+                const double* g = grid + 2 * (size_t) nf * nf * t;
+                for (l = 0; l <= 2 * w; ++l)
+                {
+                    double r_re = 0.0, r_im = 0.0;
+                    const double* row = g + 2 * (size_t) nf * iy[l];
+                    for (k = 0; k <= 2 * w; ++k)
+                    {
+                        r_re += kx[k] * row[2 * ix[k]];
+                        r_im += kx[k] * row[2 * ix[k] + 1];
+                    }
+                    s_re += ky[l] * r_re;
+                    s_im += ky[l] * r_im;
+                }
+                re = s_re * ph_re - s_im * ph_im;
+                im = s_re * ph_im + s_im * ph_re;
+                for (c = 0; c < num_comp; ++c)
+                {
+                    const size_t j = 2 * ((size_t) num_comp * (
+                            (size_t) t * num_out + i) + c);
+                    const double d_re = get_value(p_data, is_dbl, j);
+                    const double d_im = get_value(p_data, is_dbl, j + 1);
+                    acc[2 * c]     += d_re * re - d_im * im;
+                    acc[2 * c + 1] += d_im * re + d_re * im;
+                }
+            }
+            for (c = 0; c < num_comp; ++c)
+            {
+                const size_t j = 2 * ((size_t) num_comp * (i + offset_out) + c);
+                if (is_matrix && ((c < 2 && !eval_x) || (c >= 2 && !eval_y)))
+                    continue;
+                if (is_dbl)
+                {
+                    ((double*)p_out)[j]     = acc[2 * c];
+                    ((double*)p_out)[j + 1] = acc[2 * c + 1];
+                }
+                else
+                {
+                    ((float*)p_out)[j]     = (float) acc[2 * c];
+                    ((float*)p_out)[j + 1] = (float) acc[2 * c + 1];
+                }
+            }
+        }
+    }
+    oskar_mem_free(deconv, status);
+    oskar_mem_free(grids, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, The University of Oxford
+ * Copyright (c) 2019-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -30,6 +30,10 @@
 #include <cufft.h>
 #endif
 
+#ifdef OSKAR_HAVE_FFTW
+#include <fftw3.h>
+#endif
+
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftpack_cfft.h"
@@ -38,6 +42,10 @@
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,12 +54,111 @@ struct oskar_FFT
 {
     size_t num_cells_total;
     oskar_Mem *fftpack_work, *fftpack_wsave;
-    int precision, location, num_dim, dim_size, ensure_consistent_norm;
+    int precision, location, num_dim, dim_size, batch_size;
+    int ensure_consistent_norm;
 #ifdef OSKAR_HAVE_CUDA
     cufftHandle cufft_plan;
 #endif
+#ifdef OSKAR_HAVE_FFTW
+    fftw_plan fftw_plan_d;
+    fftwf_plan fftw_plan_f;
+#endif
 };
 
+#ifdef OSKAR_HAVE_FFTW
+/*
+ * The FFTW planner is not thread-safe, so plans are only created and
+ * destroyed inside this critical section. (A named OpenMP critical section
+ * also excludes threads not created by OpenMP.)
+ */
+static void fftw_create_plan(oskar_FFT* h, void* data, int* status)
+{
+#pragma omp critical (oskar_fftw_planner)
+    {
+#ifdef OSKAR_HAVE_FFTW_THREADS
+        static int threads_initialised = 0;
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (!omp_in_parallel()) num_threads = omp_get_max_threads();
+#endif
+        if (!threads_initialised)
+        {
+            fftw_init_threads();
+            fftwf_init_threads();
+            threads_initialised = 1;
+        }
+        fftw_plan_with_nthreads(num_threads);
+        fftwf_plan_with_nthreads(num_threads);
+#endif
+        /* Planning with FFTW_ESTIMATE does not overwrite the data. */
+        const int n[] = {h->dim_size, h->dim_size};
+        const int dist = (int) h->num_cells_total;
+        if (h->precision == OSKAR_DOUBLE)
+            h->fftw_plan_d = fftw_plan_many_dft(h->num_dim, n,
+                    h->batch_size, (fftw_complex*) data, 0, 1, dist,
+                    (fftw_complex*) data, 0, 1, dist,
+                    FFTW_FORWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+        else
+            h->fftw_plan_f = fftwf_plan_many_dft(h->num_dim, n,
+                    h->batch_size, (fftwf_complex*) data, 0, 1, dist,
+                    (fftwf_complex*) data, 0, 1, dist,
+                    FFTW_FORWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+    }
+    if (!h->fftw_plan_d && !h->fftw_plan_f)
+        *status = OSKAR_ERR_FFT_FAILED;
+}
+#endif
+
+#ifdef OSKAR_HAVE_FFTW
+static void fftw_exec(oskar_FFT* h, void* data, int* status)
+{
+    if (!h->fftw_plan_d && !h->fftw_plan_f)
+        fftw_create_plan(h, data, status);
+    if (h->fftw_plan_d)
+        fftw_execute_dft(h->fftw_plan_d,
+                (fftw_complex*) data, (fftw_complex*) data);
+    else if (h->fftw_plan_f)
+        fftwf_execute_dft(h->fftw_plan_f,
+                (fftwf_complex*) data, (fftwf_complex*) data);
+}
+#else
+static void fftpack_exec(oskar_FFT* h, oskar_Mem* data, int* status)
+{
+    if (h->num_dim == 1)
+    {
+        /* Transforms in the batch are done in parallel. */
+        if (h->precision == OSKAR_DOUBLE)
+            oskar_fftpack_cfftmf(h->batch_size, h->dim_size, h->dim_size, 1,
+                    oskar_mem_double(data, status),
+                    oskar_mem_double(h->fftpack_wsave, status),
+                    oskar_mem_double(h->fftpack_work, status));
+        else
+            oskar_fftpack_cfftmf_f(h->batch_size, h->dim_size, h->dim_size, 1,
+                    oskar_mem_float(data, status),
+                    oskar_mem_float(h->fftpack_wsave, status),
+                    oskar_mem_float(h->fftpack_work, status));
+    }
+    else
+    {
+        if (h->precision == OSKAR_DOUBLE)
+            oskar_fftpack_cfft2f(h->dim_size, h->dim_size, h->dim_size,
+                    oskar_mem_double(data, status),
+                    oskar_mem_double(h->fftpack_wsave, status),
+                    oskar_mem_double(h->fftpack_work, status));
+        else
+            oskar_fftpack_cfft2f_f(h->dim_size, h->dim_size, h->dim_size,
+                    oskar_mem_float(data, status),
+                    oskar_mem_float(h->fftpack_wsave, status),
+                    oskar_mem_float(h->fftpack_work, status));
+    }
+
+    /* This step not needed for W-kernel generation, so turn it off. */
+    if (h->ensure_consistent_norm)
+        oskar_mem_scale_real(data, (double)h->num_cells_total,
+                0, h->num_cells_total * h->batch_size, status);
+}
+#endif
+
 #ifdef OSKAR_HAVE_CUDA
 static void print_cufft_error(cufftResult code)
 {
@@ -106,38 +213,51 @@ oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
     h->location = location;
     h->num_dim = num_dim;
     h->dim_size = dim_size;
+    h->batch_size = (num_dim == 1 && batch_size_1d > 1) ? batch_size_1d : 1;
     h->ensure_consistent_norm = 1;
     h->num_cells_total = (size_t) dim_size;
     for (i = 1; i < num_dim; ++i) h->num_cells_total *= (size_t) dim_size;
     if (location == OSKAR_CPU || (location & OSKAR_CL))
     {
-        int len = 4 * dim_size +
-                2 * (int)(log((double)dim_size) / log(2.0)) + 8;
         if (location & OSKAR_CL)
         {
             h->location = OSKAR_CPU;
             oskar_log_warning(0,
                     "OpenCL FFT not implemented; using CPU version instead.");
         }
-        h->fftpack_wsave = oskar_mem_create(precision, OSKAR_CPU, len, status);
-        if (num_dim == 1)
-        {
-            (void) batch_size_1d;
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        }
-        else if (num_dim == 2)
+        if (num_dim == 1 || num_dim == 2)
         {
-            if (precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2i(dim_size, dim_size,
-                        oskar_mem_double(h->fftpack_wsave, status));
+#ifdef OSKAR_HAVE_FFTW
+            /* FFTW plans are created when first executed. */
+#else
+            const int len = 4 * dim_size +
+                    2 * (int)(log((double)dim_size) / log(2.0)) + 8;
+            h->fftpack_wsave = oskar_mem_create(precision, OSKAR_CPU,
+                    len, status);
+            h->fftpack_work = oskar_mem_create(precision, OSKAR_CPU,
+                    2 * h->num_cells_total * h->batch_size, status);
+            if (num_dim == 1)
+            {
+                if (precision == OSKAR_DOUBLE)
+                    oskar_fftpack_cfftmi(dim_size,
+                            oskar_mem_double(h->fftpack_wsave, status));
+                else
+                    oskar_fftpack_cfftmi_f(dim_size,
+                            oskar_mem_float(h->fftpack_wsave, status));
+            }
             else
-                oskar_fftpack_cfft2i_f(dim_size, dim_size,
-                        oskar_mem_float(h->fftpack_wsave, status));
+            {
+                if (precision == OSKAR_DOUBLE)
+                    oskar_fftpack_cfft2i(dim_size, dim_size,
+                            oskar_mem_double(h->fftpack_wsave, status));
+                else
+                    oskar_fftpack_cfft2i_f(dim_size, dim_size,
+                            oskar_mem_float(h->fftpack_wsave, status));
+            }
+#endif
         }
         else
             *status = OSKAR_ERR_INVALID_ARGUMENT;
-        h->fftpack_work = oskar_mem_create(precision, OSKAR_CPU,
-                2 * h->num_cells_total, status);
     }
     else if (location == OSKAR_GPU)
     {
@@ -175,27 +295,15 @@ void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
     }
     if (h->location == OSKAR_CPU)
     {
-        if (h->num_dim == 1)
-        {
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        }
-        else if (h->num_dim == 2)
-        {
-            if (h->precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_double(data_ptr, status),
-                        oskar_mem_double(h->fftpack_wsave, status),
-                        oskar_mem_double(h->fftpack_work, status));
-            else
-                oskar_fftpack_cfft2f_f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_float(data_ptr, status),
-                        oskar_mem_float(h->fftpack_wsave, status),
-                        oskar_mem_float(h->fftpack_work, status));
-            /* This step not needed for W-kernel generation, so turn it off. */
-            if (h->ensure_consistent_norm)
-                oskar_mem_scale_real(data_ptr, (double)h->num_cells_total,
-                        0, h->num_cells_total, status);
-        }
+        if (oskar_mem_length(data_ptr) < h->num_cells_total * h->batch_size)
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+#ifdef OSKAR_HAVE_FFTW
+        else
+            fftw_exec(h, oskar_mem_void(data_ptr), status);
+#else
+        else
+            fftpack_exec(h, data_ptr, status);
+#endif
     }
     else if (h->location == OSKAR_GPU)
     {
@@ -231,6 +339,13 @@ void oskar_fft_free(oskar_FFT* h)
     if (!h) return;
     oskar_mem_free(h->fftpack_work, &status);
     oskar_mem_free(h->fftpack_wsave, &status);
+#ifdef OSKAR_HAVE_FFTW
+#pragma omp critical (oskar_fftw_planner)
+    {
+        if (h->fftw_plan_d) fftw_destroy_plan(h->fftw_plan_d);
+        if (h->fftw_plan_f) fftwf_destroy_plan(h->fftw_plan_f);
+    }
+#endif
 #ifdef OSKAR_HAVE_CUDA
     if (h->location == OSKAR_GPU)
         cufftDestroy(h->cufft_plan);
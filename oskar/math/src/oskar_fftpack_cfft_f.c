@@ -52,7 +52,7 @@
  * This C translation from the original Fortran sources is also covered by
  * the Modified BSD license, as follows:
  *
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -81,9 +81,17 @@
 
 #include <math.h>
 #include "math/oskar_fftpack_cfft_f.h"
+#include <stddef.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define min(a,b) ((a) < (b) ? (a) : (b))
 
+/* Number of adjacent lines to transform together. */
+#define BLOCK_SIZE 16
+
 static void cfftmb(const int lot, const int jump, const int n, const int inc,
         float *c, float *wsave, float *work);
 static void cfftmf(const int lot, const int jump, const int n, const int inc,
@@ -132,6 +140,9 @@ static void cmfgkf(const int lot, const int ido, const int ip, const int l1,
         const int im1, const int in1, float *ch, float *ch1,
         const int im2, const int in2, const float *RESTRICT wa);
 
+static void transform_lines(const int forward, const int num_lines,
+        const int n, const size_t line_step, const size_t elem_step,
+        float *c, float *wsave, float *work, const size_t work_len);
 static void tables(const int ido, const int ip, float *RESTRICT wa);
 static void factor(const int n, int *nf, float *fac);
 
@@ -139,24 +150,30 @@ static void factor(const int n, int *nf, float *fac);
 void oskar_fftpack_cfft2b_f(const int ldim, const int l, const int m,
         float *c, float *wsave, float *work)
 {
+    const size_t work_len = 2 * (size_t) l * (size_t) m;
+
     /* Transform X lines of C array */
-    cfftmb(l, 1, m, ldim, c,
-            &wsave[(l << 1) + (int) (log((float) l) / log(2.0)) + 2], work);
+    transform_lines(0, l, m, 1, (size_t) ldim, c,
+            &wsave[(l << 1) + (int) (log((float) l) / log(2.0)) + 2],
+            work, work_len);
 
     /* Transform Y lines of C array */
-    cfftmb(m, ldim, l, 1, c, wsave, work);
+    transform_lines(0, m, l, (size_t) ldim, 1, c, wsave, work, work_len);
 }
 
 
 void oskar_fftpack_cfft2f_f(const int ldim, const int l, const int m,
         float *c, float *wsave, float *work)
 {
+    const size_t work_len = 2 * (size_t) l * (size_t) m;
+
     /* Transform X lines of C array */
-    cfftmf(l, 1, m, ldim, c,
-            &wsave[(l << 1) + (int) (log((float) l) / log(2.0)) + 2], work);
+    transform_lines(1, l, m, 1, (size_t) ldim, c,
+            &wsave[(l << 1) + (int) (log((float) l) / log(2.0)) + 2],
+            work, work_len);
 
     /* Transform Y lines of C array */
-    cfftmf(m, ldim, l, 1, c, wsave, work);
+    transform_lines(1, m, l, (size_t) ldim, 1, c, wsave, work, work_len);
 }
 
 
@@ -167,6 +184,113 @@ void oskar_fftpack_cfft2i_f(const int l, const int m, float *wsave)
 }
 
 
+void oskar_fftpack_cfftmb_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    transform_lines(0, lot, n, (size_t) jump, (size_t) inc, c, wsave,
+            work, 2 * (size_t) lot * (size_t) n);
+}
+
+
+void oskar_fftpack_cfftmf_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    transform_lines(1, lot, n, (size_t) jump, (size_t) inc, c, wsave,
+            work, 2 * (size_t) lot * (size_t) n);
+}
+
+
+void oskar_fftpack_cfftmi_f(const int n, float *wsave)
+{
+    cfftmi(n, wsave);
+}
+
+
+/*
+ * Transforms a set of lines in blocks of adjacent lines, in parallel.
+ * Element j of line i is at c[2 * (i * line_step + j * elem_step)].
+ * Each block is copied into scratch space taken from the work array, with
+ * the lines interleaved so that the multiple-transform kernels use unit
+ * stride. This gives the same results as transforming the lines in place.
+ */
+void transform_lines(const int forward, const int num_lines,
+        const int n, const size_t line_step, const size_t elem_step,
+        float *c, float *wsave, float *work, const size_t work_len)
+{
+    int b;
+#ifdef _OPENMP
+    int num_threads = 1;
+#endif
+    const int num_blocks = (num_lines + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const size_t block_len = 2 * (size_t) BLOCK_SIZE * (size_t) n;
+    if (n == 1) return;
+
+    /* Use the original version if there is not enough work space. */
+    if (work_len < 2 * block_len)
+    {
+        if (forward)
+            cfftmf(num_lines, (int) line_step, n, (int) elem_step,
+                    c, wsave, work);
+        else
+            cfftmb(num_lines, (int) line_step, n, (int) elem_step,
+                    c, wsave, work);
+        return;
+    }
+#ifdef _OPENMP
+    if (!omp_in_parallel()) num_threads = omp_get_max_threads();
+    if ((size_t) num_threads > work_len / (2 * block_len))
+        num_threads = (int) (work_len / (2 * block_len));
+    if (num_threads > num_blocks) num_threads = num_blocks;
+#endif
+#pragma omp parallel num_threads(num_threads) private(b)
+    {
+        int thread_id = 0;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+#endif
+        float *buf = work + 2 * block_len * (size_t) thread_id;
+        float *ch = buf + block_len;
+#pragma omp for schedule(dynamic, 1)
+        for (b = 0; b < num_blocks; ++b)
+        {
+            int i, j;
+            const int lot = min(BLOCK_SIZE, num_lines - b * BLOCK_SIZE);
+            float *p = c + 2 * line_step * (size_t) (b * BLOCK_SIZE);
+
+            /* Gather the lines in this block. */
+            for (j = 0; j < n; ++j)
+            {
+                for (i = 0; i < lot; ++i)
+                {
+                    const size_t in = 2 * (i * line_step + j * elem_step);
+                    const int out = (j * lot + i) << 1;
+                    buf[out]     = p[in];
+                    buf[out + 1] = p[in + 1];
+                }
+            }
+
+            /* Transform the lines. */
+            if (forward)
+                cfftmf(lot, 1, n, lot, buf, wsave, ch);
+            else
+                cfftmb(lot, 1, n, lot, buf, wsave, ch);
+
+            /* Scatter the lines back. */
+            for (j = 0; j < n; ++j)
+            {
+                for (i = 0; i < lot; ++i)
+                {
+                    const size_t out = 2 * (i * line_step + j * elem_step);
+                    const int in = (j * lot + i) << 1;
+                    p[out]     = buf[in];
+                    p[out + 1] = buf[in + 1];
+                }
+            }
+        }
+    }
+}
+
+
 void cfftmb(const int lot, const int jump, const int n, const int inc,
         float *c, float *wsave, float *work)
 {
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/define_interpolate_grid_bicubic.h"
+#include "math/oskar_interpolate_grid_bicubic.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_INTERPOLATE_GRID_BICUBIC(interpolate_grid_bicubic_f, float)
+OSKAR_INTERPOLATE_GRID_BICUBIC(interpolate_grid_bicubic_d, double)
+
+void oskar_interpolate_grid_bicubic(int num_x, int num_y,
+        double x0, double y0, double dx, double dy, const oskar_Mem* grid,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        int offset_out, oskar_Mem* out, int* status)
+{
+    if (*status) return;
+    const int location = oskar_mem_location(out);
+    const int type = oskar_mem_precision(out);
+    const int num_comp = oskar_mem_is_matrix(out) ? 8 : 2;
+    const double inv_dx = 1.0 / dx, inv_dy = 1.0 / dy;
+    const float x0_f = (float) x0, y0_f = (float) y0;
+    const float inv_dx_f = (float) inv_dx, inv_dy_f = (float) inv_dy;
+    if (!oskar_mem_is_complex(out) ||
+            oskar_mem_type(grid) != oskar_mem_type(out))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (type != oskar_mem_type(x) || type != oskar_mem_type(y))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (location != oskar_mem_location(grid) ||
+            location != oskar_mem_location(x) ||
+            location != oskar_mem_location(y))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (num_x < 4 || num_y < 4 ||
+            (int)oskar_mem_length(grid) < num_x * num_y ||
+            (int)oskar_mem_length(x) < num_points ||
+            (int)oskar_mem_length(y) < num_points)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    oskar_mem_ensure(out, (size_t) (offset_out + num_points), status);
+    if (*status) return;
+    if (location == OSKAR_CPU)
+    {
+        if (type == OSKAR_DOUBLE)
+            interpolate_grid_bicubic_d(num_x, num_y, x0, y0,
+                    inv_dx, inv_dy, num_comp,
+                    oskar_mem_double_const(grid, status), num_points,
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status), offset_out,
+                    oskar_mem_double(out, status));
+        else
+            interpolate_grid_bicubic_f(num_x, num_y, x0_f, y0_f,
+                    inv_dx_f, inv_dy_f, num_comp,
+                    oskar_mem_float_const(grid, status), num_points,
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status), offset_out,
+                    oskar_mem_float(out, status));
+    }
+    else
+    {
+        size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        const int is_dbl = (type == OSKAR_DOUBLE);
+        const char* k = is_dbl ?
+                "interpolate_grid_bicubic_double" :
+                "interpolate_grid_bicubic_float";
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_points, local_size[0]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_x},
+                {INT_SZ, &num_y},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&x0 : (const void*)&x0_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&y0 : (const void*)&y0_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&inv_dx : (const void*)&inv_dx_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&inv_dy : (const void*)&inv_dy_f},
+                {INT_SZ, &num_comp},
+                {PTR_SZ, oskar_mem_buffer_const(grid)},
+                {INT_SZ, &num_points},
+                {PTR_SZ, oskar_mem_buffer_const(x)},
+                {PTR_SZ, oskar_mem_buffer_const(y)},
+                {INT_SZ, &offset_out},
+                {PTR_SZ, oskar_mem_buffer(out)}
+        };
+        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,7 @@
-/* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2020, The University of Oxford. See LICENSE file. */
 
 OSKAR_FFTPHASE( M_CAT(fftphase_, Real), Real)
 OSKAR_GAUSSIAN_CIRCULAR_COMPLEX( M_CAT(gaussian_circular_complex_, Real), Real, Real2)
 OSKAR_GAUSSIAN_CIRCULAR_MATRIX(  M_CAT(gaussian_circular_matrix_,  Real), Real, Real4c)
+OSKAR_INTERPOLATE_GRID_BICUBIC( M_CAT(interpolate_grid_bicubic_, Real), Real)
 OSKAR_SPHERICAL_HARMONIC_SUM_REAL( M_CAT(spherical_harmonic_sum_real_, Real), Real)
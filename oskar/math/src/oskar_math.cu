@@ -5,6 +5,7 @@
 #include "math/define_dftw_m2m.h"
 #include "math/define_fftphase.h"
 #include "math/define_gaussian_circular.h"
+#include "math/define_interpolate_grid_bicubic.h"
 #include "math/define_legendre_polynomial.h"
 #include "math/define_multiply.h"
 #include "math/define_prefix_sum.h"
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_nufft.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static double rand_range(double lo, double hi)
+{
+    return lo + (hi - lo) * (rand() / (double)RAND_MAX);
+}
+
+static double value(const oskar_Mem* mem, int i)
+{
+    int status = 0;
+    return oskar_mem_is_double(mem) ?
+            oskar_mem_double_const(mem, &status)[i] :
+            oskar_mem_float_const(mem, &status)[i];
+}
+
+static double check_nufft(int type, double accuracy, int eval_x, int eval_y)
+{
+    int i, status = 0;
+    const int num_in = 1500, num_out = 2000, num_types = 2;
+    const int prec = type & (OSKAR_SINGLE | OSKAR_DOUBLE);
+    const int num_comp = (type & OSKAR_MATRIX) ? 4 : 1;
+    const double wavenumber = 2.0 * M_PI * 150e6 / 299792458.0;
+    oskar_Mem *w, *x_in, *y_in, *x_out, *y_out, *idx, *data, *out_dft, *out;
+    srand(2);
+
+    // Generate a random station and element types.
+    w = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, num_in, &status);
+    x_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    y_in = oskar_mem_create(prec, OSKAR_CPU, num_in, &status);
+    idx = oskar_mem_create(OSKAR_INT, OSKAR_CPU, num_in, &status);
+    for (i = 0; i < num_in; ++i)
+    {
+        oskar_mem_set_element_real(x_in, i, rand_range(-20.0, 20.0), &status);
+        oskar_mem_set_element_real(y_in, i, rand_range(-20.0, 20.0), &status);
+        oskar_mem_int(idx, &status)[i] = rand() % num_types;
+    }
+    oskar_mem_random_uniform(w, 1, 2, 3, 4, &status);
+
+    // Generate random directions and data.
+    x_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(prec, OSKAR_CPU, num_out, &status);
+    for (i = 0; i < num_out; ++i)
+    {
+        oskar_mem_set_element_real(x_out, i, rand_range(-0.9, 0.7), &status);
+        oskar_mem_set_element_real(y_out, i, rand_range(-0.5, 0.8), &status);
+    }
+    data = oskar_mem_create(type, OSKAR_CPU, num_types * num_out, &status);
+    oskar_mem_random_uniform(data, 5, 6, 7, 8, &status);
+
+    // Evaluate directly and using the NUFFT.
+    out_dft = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    out = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    oskar_dftw(1, num_in, wavenumber, w, x_in, y_in, 0, 0, num_out,
+            x_out, y_out, 0, idx, data, eval_x, eval_y, 0, out_dft, &status);
+    oskar_dftw_nufft(1, num_in, wavenumber, w, x_in, y_in, 0, num_out,
+            x_out, y_out, idx, data, eval_x, eval_y, 0, out, accuracy,
+            &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Find the maximum error relative to the sum of the weights.
+    double max_err = 0.0, sum_w = 0.0;
+    for (i = 0; i < num_in; ++i)
+    {
+        const double re = value(w, 2 * i), im = value(w, 2 * i + 1);
+        sum_w += sqrt(re * re + im * im) / num_in;
+    }
+    for (i = 0; i < 2 * num_comp * num_out; ++i)
+    {
+        const int c = (i / 2) % num_comp;
+        if (num_comp == 4 && ((c < 2 && !eval_x) || (c >= 2 && !eval_y)))
+            continue;
+        const double err = fabs(value(out, i) - value(out_dft, i)) / sum_w;
+        if (err > max_err) max_err = err;
+    }
+    oskar_mem_free(w, &status);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(idx, &status);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(out_dft, &status);
+    oskar_mem_free(out, &status);
+    return max_err;
+}
+
+TEST(dftw_nufft, complex_double)
+{
+    EXPECT_LT(check_nufft(OSKAR_DOUBLE_COMPLEX, 1e-6, 1, 1), 1e-6);
+    EXPECT_LT(check_nufft(OSKAR_DOUBLE_COMPLEX, 1e-10, 1, 1), 1e-10);
+}
+
+TEST(dftw_nufft, matrix_double)
+{
+    EXPECT_LT(check_nufft(OSKAR_DOUBLE_COMPLEX_MATRIX, 1e-8, 1, 1), 1e-8);
+    EXPECT_LT(check_nufft(OSKAR_DOUBLE_COMPLEX_MATRIX, 1e-8, 1, 0), 1e-8);
+    EXPECT_LT(check_nufft(OSKAR_DOUBLE_COMPLEX_MATRIX, 1e-8, 0, 1), 1e-8);
+}
+
+TEST(dftw_nufft, matrix_single)
+{
+    EXPECT_LT(check_nufft(OSKAR_SINGLE_COMPLEX_MATRIX, 1e-4, 1, 1), 1e-4);
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_fft.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Returns the maximum error of a 2D FFT, relative to a direct 2D DFT.
+static double check_fft_2d(int prec, int size)
+{
+    int status = 0;
+    const size_t num_cells = (size_t) size * size;
+    oskar_Mem* data = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    oskar_mem_random_uniform(data, 1, 2, 3, 4, &status);
+    oskar_Mem* in = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0, &status);
+    oskar_fft_exec(fft, data, &status);
+    oskar_fft_free(fft);
+    oskar_Mem* out = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    if (status) return 1.0;
+
+    // Transform the rows, then the columns.
+    const double2* x = oskar_mem_double2_const(in, &status);
+    const double2* y = oskar_mem_double2_const(out, &status);
+    std::vector<double2> t(num_cells), r(num_cells);
+    for (int iy = 0; iy < size; ++iy)
+    {
+        for (int k = 0; k < size; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < size; ++j)
+            {
+                const double a = -2.0 * M_PI * ((j * k) % size) / size;
+                const double2 v = x[iy * size + j];
+                re += v.x * cos(a) - v.y * sin(a);
+                im += v.x * sin(a) + v.y * cos(a);
+            }
+            t[iy * size + k].x = re;
+            t[iy * size + k].y = im;
+        }
+    }
+    double max_err = 0.0, max_val = 0.0;
+    for (int ix = 0; ix < size; ++ix)
+    {
+        for (int k = 0; k < size; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < size; ++j)
+            {
+                const double a = -2.0 * M_PI * ((j * k) % size) / size;
+                const double2 v = t[j * size + ix];
+                re += v.x * cos(a) - v.y * sin(a);
+                im += v.x * sin(a) + v.y * cos(a);
+            }
+            const double2 f = y[k * size + ix];
+            max_err = std::max(max_err, std::abs(f.x - re));
+            max_err = std::max(max_err, std::abs(f.y - im));
+            max_val = std::max(max_val, std::sqrt(re * re + im * im));
+        }
+    }
+    oskar_mem_free(data, &status);
+    oskar_mem_free(in, &status);
+    oskar_mem_free(out, &status);
+    return max_err / max_val;
+}
+
+// Returns the maximum error of a batch of 1D FFTs, relative to a direct DFT.
+static double check_fft_1d(int prec, int size, int batch_size,
+        int num_threads)
+{
+    int status = 0;
+    const size_t num_elements = (size_t) size * batch_size;
+    oskar_Mem* data = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_elements, &status);
+    oskar_mem_random_uniform(data, 1, 2, 3, 4, &status);
+    oskar_Mem* in = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 1, size, batch_size,
+            &status);
+    oskar_fft_exec(fft, data, &status);
+    oskar_fft_free(fft);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    oskar_Mem* out = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    if (status) return 1.0;
+
+    // Check each transform in the batch.
+    const double2* x = oskar_mem_double2_const(in, &status);
+    const double2* y = oskar_mem_double2_const(out, &status);
+    double max_err = 0.0, max_val = 0.0;
+    for (int b = 0; b < batch_size; ++b)
+    {
+        const size_t offset = (size_t) b * size;
+        for (int k = 0; k < size; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < size; ++j)
+            {
+                const double a = -2.0 * M_PI * ((j * k) % size) / size;
+                const double2 v = x[offset + j];
+                re += v.x * cos(a) - v.y * sin(a);
+                im += v.x * sin(a) + v.y * cos(a);
+            }
+            const double2 f = y[offset + k];
+            max_err = std::max(max_err, std::abs(f.x - re));
+            max_err = std::max(max_err, std::abs(f.y - im));
+            max_val = std::max(max_val, std::sqrt(re * re + im * im));
+        }
+    }
+    oskar_mem_free(data, &status);
+    oskar_mem_free(in, &status);
+    oskar_mem_free(out, &status);
+    return max_err / max_val;
+}
+
+// Returns the maximum difference between a 2D FFT using one thread and
+// a 2D FFT using several threads, relative to the largest value.
+static double check_fft_2d_threads(int prec, int size)
+{
+    int status = 0;
+    const size_t num_cells = (size_t) size * size;
+    oskar_Mem* data[2];
+    for (int k = 0; k < 2; ++k)
+    {
+#ifdef _OPENMP
+        const int num_threads = omp_get_max_threads();
+        omp_set_num_threads(k == 0 ? 1 : 4);
+#endif
+        data[k] = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                num_cells, &status);
+        oskar_mem_random_uniform(data[k], 1, 2, 3, 4, &status);
+        oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0,
+                &status);
+        oskar_fft_exec(fft, data[k], &status);
+        oskar_fft_free(fft);
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#endif
+    }
+    oskar_Mem* out0 = oskar_mem_convert_precision(data[0], OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* out1 = oskar_mem_convert_precision(data[1], OSKAR_DOUBLE,
+            &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    const double* a = (const double*) oskar_mem_void_const(out0);
+    const double* b = (const double*) oskar_mem_void_const(out1);
+    double max_err = 0.0, max_val = 0.0;
+    for (size_t i = 0; i < 2 * num_cells; ++i)
+    {
+        max_err = std::max(max_err, std::abs(a[i] - b[i]));
+        max_val = std::max(max_val, std::abs(a[i]));
+    }
+    oskar_mem_free(data[0], &status);
+    oskar_mem_free(data[1], &status);
+    oskar_mem_free(out0, &status);
+    oskar_mem_free(out1, &status);
+    return max_err / max_val;
+}
+
+TEST(fft, fft_2d_radix_2_double)
+{
+    EXPECT_LT(check_fft_2d(OSKAR_DOUBLE, 64), 1e-13);
+}
+
+TEST(fft, fft_2d_radix_2_single)
+{
+    EXPECT_LT(check_fft_2d(OSKAR_SINGLE, 64), 1e-5);
+}
+
+TEST(fft, fft_2d_mixed_radix_double)
+{
+    EXPECT_LT(check_fft_2d(OSKAR_DOUBLE, 210), 1e-13);
+    EXPECT_LT(check_fft_2d(OSKAR_DOUBLE, 98), 1e-13);
+}
+
+TEST(fft, fft_2d_mixed_radix_single)
+{
+    EXPECT_LT(check_fft_2d(OSKAR_SINGLE, 210), 1e-5);
+    EXPECT_LT(check_fft_2d(OSKAR_SINGLE, 98), 1e-5);
+}
+
+TEST(fft, fft_2d_threads_double)
+{
+    EXPECT_LT(check_fft_2d_threads(OSKAR_DOUBLE, 360), 1e-14);
+}
+
+TEST(fft, fft_2d_threads_single)
+{
+    EXPECT_LT(check_fft_2d_threads(OSKAR_SINGLE, 360), 1e-6);
+}
+
+TEST(fft, fft_1d_batch_double)
+{
+    EXPECT_LT(check_fft_1d(OSKAR_DOUBLE, 210, 37, 1), 1e-13);
+    EXPECT_LT(check_fft_1d(OSKAR_DOUBLE, 210, 37, 4), 1e-13);
+    EXPECT_LT(check_fft_1d(OSKAR_DOUBLE, 128, 1, 1), 1e-13);
+}
+
+TEST(fft, fft_1d_batch_single)
+{
+    EXPECT_LT(check_fft_1d(OSKAR_SINGLE, 210, 37, 1), 1e-5);
+    EXPECT_LT(check_fft_1d(OSKAR_SINGLE, 210, 37, 4), 1e-5);
+    EXPECT_LT(check_fft_1d(OSKAR_SINGLE, 128, 1, 1), 1e-5);
+}
+
+TEST(fft, fft_1d_batch_too_small)
+{
+    int status = 0;
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            100, &status);
+    oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 1, 64, 2,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_fft_exec(fft, data, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    oskar_fft_free(fft);
+    status = 0;
+    oskar_mem_free(data, &status);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_interpolate_grid_bicubic.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+
+static double quad_re(double x, double y)
+{
+    return 1.0 + 0.5 * x - 2.0 * y + 0.25 * x * x + x * y - 0.75 * y * y;
+}
+
+static double quad_im(double x, double y)
+{
+    return -0.5 + 3.0 * x * y * y - x * x;
+}
+
+TEST(interpolate_grid_bicubic, quadratic)
+{
+    int i, j, status = 0;
+    const int num_x = 12, num_y = 9, num_points = 1000;
+    const double x0 = -1.5, y0 = 0.5, dx = 0.25, dy = 0.4;
+
+    // Tabulate a function that is quadratic in each dimension,
+    // which the cubic convolution kernel should reproduce exactly.
+    oskar_Mem* grid = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_x * num_y, &status);
+    double* g = oskar_mem_double(grid, &status);
+    for (j = 0; j < num_y; ++j)
+    {
+        for (i = 0; i < num_x; ++i)
+        {
+            const double x = x0 + i * dx, y = y0 + j * dy;
+            g[2 * (j * num_x + i)] = quad_re(x, y);
+            g[2 * (j * num_x + i) + 1] = quad_im(x, y);
+        }
+    }
+
+    // Generate points inside the grid, excluding the outer cells.
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    srand(1);
+    for (i = 0; i < num_points; ++i)
+    {
+        x_[i] = x0 + dx * (1.0 + (num_x - 3) * (rand() / (double)RAND_MAX));
+        y_[i] = y0 + dy * (1.0 + (num_y - 3) * (rand() / (double)RAND_MAX));
+    }
+
+    // Interpolate and check the results.
+    oskar_Mem* out = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &status);
+    oskar_interpolate_grid_bicubic(num_x, num_y, x0, y0, dx, dy, grid,
+            num_points, x, y, 5, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ((size_t)(num_points + 5), oskar_mem_length(out));
+    const double* o = oskar_mem_double_const(out, &status) + 2 * 5;
+    for (i = 0; i < num_points; ++i)
+    {
+        EXPECT_NEAR(quad_re(x_[i], y_[i]), o[2 * i], 1e-12);
+        EXPECT_NEAR(quad_im(x_[i], y_[i]), o[2 * i + 1], 1e-12);
+    }
+
+#ifdef OSKAR_HAVE_CUDA
+    // Check the results are the same on the GPU.
+    {
+        oskar_Mem *grid_gpu, *x_gpu, *y_gpu, *out_gpu, *out_cpu;
+        grid_gpu = oskar_mem_create_copy(grid, OSKAR_GPU, &status);
+        x_gpu = oskar_mem_create_copy(x, OSKAR_GPU, &status);
+        y_gpu = oskar_mem_create_copy(y, OSKAR_GPU, &status);
+        out_gpu = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_GPU,
+                0, &status);
+        oskar_interpolate_grid_bicubic(num_x, num_y, x0, y0, dx, dy,
+                grid_gpu, num_points, x_gpu, y_gpu, 5, out_gpu, &status);
+        out_cpu = oskar_mem_create_copy(out_gpu, OSKAR_CPU, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const double* o2 = oskar_mem_double_const(out_cpu, &status) + 2 * 5;
+        for (i = 0; i < 2 * num_points; ++i)
+            EXPECT_NEAR(o[i], o2[i], 1e-12);
+        oskar_mem_free(grid_gpu, &status);
+        oskar_mem_free(x_gpu, &status);
+        oskar_mem_free(y_gpu, &status);
+        oskar_mem_free(out_gpu, &status);
+        oskar_mem_free(out_cpu, &status);
+    }
+#endif
+
+    oskar_mem_free(grid, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(out, &status);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_vmath.h"
+#include <cmath>
+#include <cstdio>
+
+static double max_sincos_error_d(double range, int num_points)
+{
+    double max_err = 0.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        double s = 0.0, c = 0.0;
+        const double x = range * (2.0 * i / (num_points - 1) - 1.0);
+        oskar_vsincos_d(x, &s, &c);
+        const double err_s = fabs(s - sin(x)), err_c = fabs(c - cos(x));
+        if (err_s > max_err) max_err = err_s;
+        if (err_c > max_err) max_err = err_c;
+    }
+    return max_err;
+}
+
+static double max_sincos_error_f(double range, int num_points)
+{
+    double max_err = 0.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        float s = 0.0f, c = 0.0f;
+        const float x = (float) (range * (2.0 * i / (num_points - 1) - 1.0));
+        oskar_vsincos_f(x, &s, &c);
+        const double err_s = fabs(s - sin((double) x));
+        const double err_c = fabs(c - cos((double) x));
+        if (err_s > max_err) max_err = err_s;
+        if (err_c > max_err) max_err = err_c;
+    }
+    return max_err;
+}
+
+TEST(vmath, sincos_double)
+{
+    EXPECT_LT(max_sincos_error_d(10.0, 1000003), 3e-16);
+    EXPECT_LT(max_sincos_error_d(1e4, 1000003), 3e-16);
+    EXPECT_LT(max_sincos_error_d(1e8, 1000003), 3e-16);
+    EXPECT_LT(max_sincos_error_d(1e12, 1000003), 3e-16);
+    EXPECT_LT(max_sincos_error_d(1e14, 1000003), 3e-16);
+}
+
+TEST(vmath, sincos_single)
+{
+    EXPECT_LT(max_sincos_error_f(10.0, 1000003), 2e-7);
+    EXPECT_LT(max_sincos_error_f(1e4, 1000003), 2e-7);
+    EXPECT_LT(max_sincos_error_f(1e5, 1000003), 2e-7);
+    EXPECT_LT(max_sincos_error_f(1e8, 1000003), 2e-7);
+    EXPECT_LT(max_sincos_error_f(1e14, 1000003), 2e-7);
+}
+
+TEST(vmath, exp_double)
+{
+    const int num_points = 1000003;
+    double max_err = 0.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double x = -708.0 + 1417.5 * i / (num_points - 1);
+        const double ref = exp(x);
+        const double err = fabs(oskar_vexp_d(x) - ref) / ref;
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 5e-16);
+    EXPECT_EQ(1.0, oskar_vexp_d(0.0));
+    EXPECT_EQ(0.0, oskar_vexp_d(-800.0));
+    EXPECT_TRUE(std::isinf(oskar_vexp_d(710.0)));
+    EXPECT_TRUE(std::isnan(oskar_vexp_d(NAN)));
+}
+
+TEST(vmath, exp_single)
+{
+    const int num_points = 1000003;
+    double max_err = 0.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        const float x = (float) (-87.0 + 175.5 * i / (num_points - 1));
+        const double ref = exp((double) x);
+        const double err = fabs(oskar_vexp_f(x) - ref) / ref;
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 2e-7);
+    EXPECT_EQ(1.0f, oskar_vexp_f(0.0f));
+    EXPECT_EQ(0.0f, oskar_vexp_f(-110.0f));
+    EXPECT_TRUE(std::isinf(oskar_vexp_f(89.0f)));
+}
+
+TEST(vmath, sinc)
+{
+    const int num_points = 1000003;
+    double max_err_d = 0.0, max_err_f = 0.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double x = 100.0 * (2.0 * i / (num_points - 1) - 1.0);
+        if (x == 0.0) continue;
+        const float xf = (float) x;
+        const double err_d = fabs(oskar_vsinc_d(x) - sin(x) / x);
+        const double err_f = fabs(oskar_vsinc_f(xf) - sin((double) xf) / xf);
+        if (err_d > max_err_d) max_err_d = err_d;
+        if (err_f > max_err_f) max_err_f = err_f;
+    }
+    EXPECT_LT(max_err_d, 3e-16);
+    EXPECT_LT(max_err_f, 2e-7);
+    EXPECT_EQ(1.0, oskar_vsinc_d(0.0));
+    EXPECT_EQ(1.0f, oskar_vsinc_f(0.0f));
+}
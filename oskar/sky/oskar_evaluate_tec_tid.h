@@ -63,6 +63,30 @@ void oskar_evaluate_tec_tid(oskar_Mem* tec, int num_directions,
         const oskar_Mem* rel_path_length, double TEC0,
         oskar_SettingsTIDscreen* TID, double gast);
 
+/**
+ * @brief
+ * Evaluates a TEC screen for a TID MIM (double precision).
+ *
+ * @details
+ * Evaluates the TEC at the given pierce points, as
+ * oskar_evaluate_tec_tid(). The output array is overwritten.
+ *
+ * @param num_directions  Number of directions at which to evaluate the TEC.
+ * @param lon             Array of pierce point longitudes, in radians.
+ * @param lat             Array of pierce point latitudes, in radians.
+ * @param rel_path_length Array of relative path lengths in the direction of
+ *                        pierce point from the station.
+ * @param TEC0            Zero offset TEC value.
+ * @param TID             Settings structure describing the TID screen
+ *                        components.
+ * @param gast            Greenwich apparent sidereal time, in radians.
+ * @param tec             Array of TEC values at each pierce point.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_tec_tid_d(int num_directions, const double* lon,
+        const double* lat, const double* rel_path_length, double TEC0,
+        const oskar_SettingsTIDscreen* TID, double gast, double* tec);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2013-2014, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_
+#define OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_
+
+/**
+ * @file oskar_settings_load_tid_parameter_file.h
+ */
+
+#include <oskar_global.h>
+#include <settings/old/oskar_Settings_old.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Loads the parameters of a travelling ionospheric disturbance (TID) screen.
+ *
+ * @details
+ * The first line of the file gives the screen height, in km.
+ * Each subsequent line gives one TID component as the relative amplitude,
+ * the speed (km/h), the direction (deg) and the wavelength (km).
+ * Lines starting with '#' are ignored.
+ *
+ * The component arrays are allocated by this function, and must be freed
+ * by the caller.
+ *
+ * @param[out] settings    Structure to fill.
+ * @param[in] filename     Path of the file to load.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_settings_load_tid_parameter_file(oskar_SettingsTIDscreen* settings,
+        const char* filename, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_ */
@@ -34,6 +34,38 @@
 extern "C" {
 #endif
 
+void oskar_evaluate_tec_tid_d(int num_directions, const double* lon,
+        const double* lat, const double* rel_path_length, double TEC0,
+        const oskar_SettingsTIDscreen* TID, double gast, double* tec)
+{
+    int i, j;
+    const double earth_radius = 6365.0; /* km -- FIXME */
+    const double time = gast * 86400.0; /* days->sec */
+    const double r = earth_radius + TID->height_km;
+    for (j = 0; j < num_directions; ++j)
+    {
+        double pp_tec = 0.0;
+        const double pp_lon = lon[j], pp_lat = lat[j];
+        const double pp_sec = rel_path_length[j];
+
+        /* Loop over TIDs */
+        for (i = 0; i < TID->num_components; ++i)
+        {
+            const double amp = TID->amp[i];
+            /* convert from km to rads */
+            const double w = TID->wavelength[i] / r;
+            const double th = TID->theta[i] * M_PI/180.;
+            /* convert from km/h to rad/s */
+            const double v = (TID->speed[i] / r) / 3600;
+            pp_tec += pp_sec * amp * TEC0 * (
+                    cos( (2.0*M_PI/w) * (cos(th)*pp_lon - v*time) ) +
+                    cos( (2.0*M_PI/w) * (sin(th)*pp_lat - v*time) )
+                    ) + TEC0;
+        }
+        tec[j] = pp_tec;
+    }
+}
+
 void oskar_evaluate_tec_tid(oskar_Mem* tec, int num_directions,
         const oskar_Mem* lon, const oskar_Mem* lat,
         const oskar_Mem* rel_path_length, double TEC0,
@@ -52,6 +84,15 @@ void oskar_evaluate_tec_tid(oskar_Mem* tec, int num_directions,
     type = oskar_mem_type(tec);
 
     oskar_mem_set_value_real(tec, 0.0, 0, oskar_mem_length(tec), &status);
+    if (type == OSKAR_DOUBLE)
+    {
+        oskar_evaluate_tec_tid_d(num_directions,
+                oskar_mem_double_const(lon, &status),
+                oskar_mem_double_const(lat, &status),
+                oskar_mem_double_const(rel_path_length, &status),
+                TEC0, TID, gast, oskar_mem_double(tec, &status));
+        return;
+    }
 
     /* Loop over TIDs */
     for (i = 0; i < TID->num_components; ++i)
@@ -68,30 +109,15 @@ void oskar_evaluate_tec_tid(oskar_Mem* tec, int num_directions,
         /* Loop over directions */
         for (j = 0; j < num_directions; ++j)
         {
-            if (type == OSKAR_DOUBLE)
-            {
-                pp_lon = oskar_mem_double_const(lon, &status)[j];
-                pp_lat = oskar_mem_double_const(lat, &status)[j];
-                pp_sec = oskar_mem_double_const(rel_path_length, &status)[j];
-                pp_tec = pp_sec * amp * TEC0 * (
-                        cos( (2.0*M_PI/w) * (cos(th)*pp_lon - v*time) ) +
-                        cos( (2.0*M_PI/w) * (sin(th)*pp_lat - v*time) )
-                        );
-                pp_tec += TEC0;
-                oskar_mem_double(tec, &status)[j] += pp_tec;
-            }
-            else
-            {
-                pp_lon = (double)oskar_mem_float_const(lon, &status)[j];
-                pp_lat = (double)oskar_mem_float_const(lat, &status)[j];
-                pp_sec = (double)oskar_mem_float_const(rel_path_length, &status)[j];
-                pp_tec = pp_sec * amp * TEC0 * (
-                        cos( (2.0*M_PI/w) * (cos(th)*pp_lon - v*time) ) +
-                        cos( (2.0*M_PI/w) * (sin(th)*pp_lat - v*time) )
-                );
-                pp_tec += TEC0;
-                oskar_mem_float(tec, &status)[j] += (float)pp_tec;
-            }
+            pp_lon = (double)oskar_mem_float_const(lon, &status)[j];
+            pp_lat = (double)oskar_mem_float_const(lat, &status)[j];
+            pp_sec = (double)oskar_mem_float_const(rel_path_length, &status)[j];
+            pp_tec = pp_sec * amp * TEC0 * (
+                    cos( (2.0*M_PI/w) * (cos(th)*pp_lon - v*time) ) +
+                    cos( (2.0*M_PI/w) * (sin(th)*pp_lat - v*time) )
+            );
+            pp_tec += TEC0;
+            oskar_mem_float(tec, &status)[j] += (float)pp_tec;
         } /* loop over directions */
     } /* loop over components. */
 }
@@ -22,7 +22,7 @@
         GLOBAL_IN(FP, c), const int n, GLOBAL_IN(FP, x), GLOBAL_IN(FP, y),\
         const int stride_out, const int offset_out, GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_X(int, i, 0, n)\
     int l, l1, l2, nk1, lx;\
     FP hh[3], wx[4], wy[4], t, x_ = x[i], y_ = y[i];\
     nk1 = nx - 4;\
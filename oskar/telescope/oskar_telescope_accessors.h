@@ -241,6 +241,22 @@ OSKAR_EXPORT
 double oskar_telescope_tec_screen_time_interval_sec(
         const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the maximum memory used for TEC screen time slices, in MB.
+ *
+ * @details
+ * Returns the maximum memory used to hold time slices of an external
+ * TEC screen, in MB.
+ *
+ * @param[in] model   Pointer to telescope model.
+ *
+ * @return The maximum TEC screen buffer size, in MB.
+ */
+OSKAR_EXPORT
+double oskar_telescope_tec_screen_max_buffer_mb(
+        const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the time averaging interval in seconds.
@@ -358,6 +374,47 @@ int oskar_telescope_num_stations(const oskar_Telescope* model);
 OSKAR_EXPORT
 int oskar_telescope_identical_stations(const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the number of different stations in the telescope model.
+ *
+ * @details
+ * Returns the number of groups of identical stations in the telescope model,
+ * as determined by oskar_station_different().
+ *
+ * Note that this value is only valid after calling
+ * oskar_telescope_analyse().
+ *
+ * @param[in] model Pointer to telescope model.
+ *
+ * @return The number of different stations.
+ */
+OSKAR_EXPORT
+int oskar_telescope_num_unique_stations(const oskar_Telescope* model);
+
+/**
+ * @brief
+ * Returns the index of the first station identical to the given station.
+ *
+ * @details
+ * Returns the index of the first station in the telescope model that is
+ * identical to station \p i. If station beam duplication is allowed, the
+ * beam for station \p i can be copied from the beam for this station.
+ *
+ * The returned index is never greater than \p i, and is equal to \p i
+ * for the first station of each group.
+ *
+ * Note that this value is only valid after calling
+ * oskar_telescope_analyse().
+ *
+ * @param[in] model Pointer to telescope model.
+ * @param[in] i     The station index.
+ *
+ * @return The index of the first identical station.
+ */
+OSKAR_EXPORT
+int oskar_telescope_station_equivalent(const oskar_Telescope* model, int i);
+
 /**
  * @brief
  * Returns the flag specifying whether station beam duplication is enabled.
@@ -855,6 +912,21 @@ OSKAR_EXPORT
 void oskar_telescope_set_tec_screen_time_interval(oskar_Telescope* model,
         double time_interval_sec);
 
+/**
+ * @brief
+ * Sets the maximum memory used for TEC screen time slices, in MB.
+ *
+ * @details
+ * Sets the maximum memory used to hold time slices of an external
+ * TEC screen, in MB. At least one slice is always held.
+ *
+ * @param[in] model         Pointer to telescope model.
+ * @param[in] max_buffer_mb Maximum TEC screen buffer size, in MB.
+ */
+OSKAR_EXPORT
+void oskar_telescope_set_tec_screen_max_buffer(oskar_Telescope* model,
+        double max_buffer_mb);
+
 /**
  * @brief
  * Sets the geographic coordinates of the telescope centre.
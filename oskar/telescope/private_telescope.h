@@ -61,6 +61,7 @@ struct oskar_Telescope
     double tec_screen_height_km;
     double tec_screen_pixel_size_m;
     double tec_screen_time_interval_sec;
+    double tec_screen_max_buffer_mb;
 
     /* Station data. */
     int supplied_coord_type;                           /* Type of coordinates specified in telescope model. */
@@ -73,6 +74,8 @@ struct oskar_Telescope
     int max_station_size;                              /* Maximum station size (number of elements) */
     int max_station_depth;                             /* Maximum station depth. */
     int identical_stations;                            /* True if all stations are identical. */
+    int num_unique_stations;                           /* Number of different stations. */
+    oskar_Mem* station_equivalent;                     /* Index of first identical station, for each station. */
     int allow_station_beam_duplication;                /* True if station beam duplication is allowed. */
     int enable_numerical_patterns;                     /* True if numerical element patterns are enabled. */
 };
@@ -111,6 +111,12 @@ double oskar_telescope_tec_screen_time_interval_sec(
     return model->tec_screen_time_interval_sec;
 }
 
+double oskar_telescope_tec_screen_max_buffer_mb(
+        const oskar_Telescope* model)
+{
+    return model->tec_screen_max_buffer_mb;
+}
+
 double oskar_telescope_time_average_sec(const oskar_Telescope* model)
 {
     return model->time_average_sec;
@@ -151,6 +157,17 @@ int oskar_telescope_identical_stations(const oskar_Telescope* model)
     return model->identical_stations;
 }
 
+int oskar_telescope_num_unique_stations(const oskar_Telescope* model)
+{
+    return model->num_unique_stations;
+}
+
+int oskar_telescope_station_equivalent(const oskar_Telescope* model, int i)
+{
+    if ((int) oskar_mem_length(model->station_equivalent) <= i) return i;
+    return ((const int*) oskar_mem_void_const(model->station_equivalent))[i];
+}
+
 int oskar_telescope_allow_station_beam_duplication(
         const oskar_Telescope* model)
 {
@@ -480,6 +497,12 @@ void oskar_telescope_set_tec_screen_time_interval(oskar_Telescope* model,
     model->tec_screen_time_interval_sec = time_interval_sec;
 }
 
+void oskar_telescope_set_tec_screen_max_buffer(oskar_Telescope* model,
+        double max_buffer_mb)
+{
+    model->tec_screen_max_buffer_mb = max_buffer_mb;
+}
+
 void oskar_telescope_set_tec_screen_path(oskar_Telescope* model,
         const char* path)
 {
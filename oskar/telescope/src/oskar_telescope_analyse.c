@@ -84,13 +84,11 @@ static void set_child_station_locations(oskar_Station* s,
 void oskar_telescope_analyse(oskar_Telescope* model, int* status)
 {
     int i = 0, finished_identical_station_check = 0, num_stations;
+    int* equivalent = 0;
 
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Set default flags. */
-    model->identical_stations = 1;
-
     /* Recursively find the maximum number of elements in any station. */
     num_stations = model->num_stations;
     model->max_station_size = 0;
@@ -111,29 +109,38 @@ void oskar_telescope_analyse(oskar_Telescope* model, int* status)
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Check if we need to examine every station. */
-    if (finished_identical_station_check &&
-            (num_stations > 1 && oskar_telescope_station(model, 1) != 0))
-    {
-        model->identical_stations = 0;
-    }
-    else
+    /* Group the stations into sets of identical stations.
+     * Each station is compared only with the first station of each group
+     * found so far. Stations that have been freed because their beams are
+     * duplicated from the first station belong to its group. */
+    oskar_mem_realloc(model->station_equivalent, num_stations, status);
+    if (*status) return;
+    equivalent = oskar_mem_int(model->station_equivalent, status);
+    model->num_unique_stations = 0;
+    for (i = 0; i < num_stations; ++i)
     {
-        /* Check if the stations are different. */
-        const oskar_Station* station0 =
-                oskar_telescope_station_const(model, 0);
-        for (i = 1; i < num_stations; ++i)
+        int j;
+        const oskar_Station* station = oskar_telescope_station_const(model, i);
+        equivalent[i] = i;
+        if (i > 0 && !station)
+            equivalent[i] = 0;
+        else if (!finished_identical_station_check)
         {
-            const oskar_Station* station =
-                    oskar_telescope_station_const(model, i);
-            if (!station) continue;
-            if (oskar_station_different(station0, station, status))
+            for (j = 0; j < i; ++j)
             {
-                model->identical_stations = 0;
-                break;
+                if (equivalent[j] != j) continue;
+                if (!oskar_station_different(
+                        oskar_telescope_station_const(model, j), station,
+                        status))
+                {
+                    equivalent[i] = j;
+                    break;
+                }
             }
         }
+        if (equivalent[i] == i) model->num_unique_stations++;
     }
+    model->identical_stations = (model->num_unique_stations <= 1);
 }
 
 #ifdef __cplusplus
@@ -63,6 +63,7 @@ oskar_Telescope* oskar_telescope_create(int type, int location,
     telescope->uv_filter_max = FLT_MAX;
     telescope->uv_filter_units = OSKAR_METRES;
     telescope->noise_seed = 1;
+    telescope->tec_screen_max_buffer_mb = 256.0;
     for (i = 0; i < 3; ++i)
     {
         telescope->station_true_offset_ecef_metres[i] =
@@ -76,6 +77,8 @@ oskar_Telescope* oskar_telescope_create(int type, int location,
     }
     telescope->tec_screen_path =
             oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, status);
+    telescope->station_equivalent =
+            oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
     if (num_stations > 0)
         telescope->station = (oskar_Station**) calloc(
                 num_stations, sizeof(oskar_Station*));
@@ -38,7 +38,8 @@ extern "C" {
 oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
         int location, int* status)
 {
-    int i = 0;
+    int i = 0, num_element_copies = 0;
+    oskar_Element** element_copies = 0;
     oskar_Telescope* telescope;
 
     /* Create a new, empty model. */
@@ -55,6 +56,7 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->max_station_size = src->max_station_size;
     telescope->max_station_depth = src->max_station_depth;
     telescope->identical_stations = src->identical_stations;
+    telescope->num_unique_stations = src->num_unique_stations;
     telescope->allow_station_beam_duplication = src->allow_station_beam_duplication;
     telescope->enable_numerical_patterns = src->enable_numerical_patterns;
     telescope->lon_rad = src->lon_rad;
@@ -76,6 +78,7 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->tec_screen_height_km = src->tec_screen_height_km;
     telescope->tec_screen_pixel_size_m = src->tec_screen_pixel_size_m;
     telescope->tec_screen_time_interval_sec = src->tec_screen_time_interval_sec;
+    telescope->tec_screen_max_buffer_mb = src->tec_screen_max_buffer_mb;
 
     /* Copy the coordinates. */
     for (i = 0; i < 3; ++i)
@@ -91,15 +94,19 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     }
     oskar_mem_copy(telescope->tec_screen_path,
             src->tec_screen_path, status);
+    oskar_mem_copy(telescope->station_equivalent,
+            src->station_equivalent, status);
 
-    /* Copy each station. */
+    /* Copy each station, sharing element lookup tables between them. */
     telescope->station = (oskar_Station**) calloc(
             src->num_stations, sizeof(oskar_Station*));
     for (i = 0; i < src->num_stations; ++i)
     {
-        telescope->station[i] = oskar_station_create_copy(
-                oskar_telescope_station_const(src, i), location, status);
+        telescope->station[i] = oskar_station_create_copy_shared(
+                oskar_telescope_station_const(src, i), location,
+                &num_element_copies, &element_copies, status);
     }
+    free(element_copies);
 
     /* Return pointer to data structure. */
     return telescope;
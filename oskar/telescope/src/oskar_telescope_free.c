@@ -49,6 +49,7 @@ void oskar_telescope_free(oskar_Telescope* telescope, int* status)
         oskar_mem_free(telescope->station_measured_enu_metres[i], status);
     }
     oskar_mem_free(telescope->tec_screen_path, status);
+    oskar_mem_free(telescope->station_equivalent, status);
 
     /* Free each station. */
     for (i = 0; i < telescope->num_stations; ++i)
@@ -53,6 +53,8 @@ void oskar_telescope_log_summary(const oskar_Telescope* telescope,
             oskar_telescope_max_station_depth(telescope));
     oskar_log_value(log, 'M', 0, "Identical stations", "%s",
             oskar_telescope_identical_stations(telescope) ? "true" : "false");
+    oskar_log_value(log, 'M', 0, "Num. different stations", "%d",
+            oskar_telescope_num_unique_stations(telescope));
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,43 @@
+/* Copyright (c) 2020, The University of Oxford. See LICENSE file. */
+
+/* Table values are stored with phi varying fastest, with num_comp real
+ * components per grid point. The phi axis is periodic, starting at 0. */
+#define OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE(NAME, FP) KERNEL(NAME) (\
+        const int num_theta, const int num_phi, const FP theta0,\
+        const FP inv_dtheta, const FP inv_dphi, const int num_comp,\
+        GLOBAL_IN(FP, table), const int num_points,\
+        GLOBAL_IN(FP, theta), GLOBAL_IN(FP, phi), const int stride,\
+        const int offset_out, GLOBAL_OUT(FP, out))\
+{\
+    KERNEL_LOOP_PAR_X(int, i, 0, num_points)\
+    FP wt[4], wp[4];\
+    int c, j, k, col[4];\
+    const FP pt = (theta[i] - theta0) * inv_dtheta, pp = phi[i] * inv_dphi;\
+    int it = (int) floor(pt), ip = (int) floor(pp);\
+    const FP tp = pp - (FP) ip;\
+    it = it < 1 ? 1 : (it > num_theta - 3 ? num_theta - 3 : it);\
+    const FP tt = pt - (FP) it;\
+    ip = ip % num_phi;\
+    if (ip < 0) ip += num_phi;\
+    for (k = 0; k < 4; ++k) {\
+        int t = ip - 1 + k;\
+        t = t < 0 ? t + num_phi : (t >= num_phi ? t - num_phi : t);\
+        col[k] = t * num_comp;\
+    }\
+    OSKAR_CUBIC_WEIGHTS(FP, tt, wt)\
+    OSKAR_CUBIC_WEIGHTS(FP, tp, wp)\
+    const int i_out = i * stride + offset_out;\
+    for (c = 0; c < num_comp; ++c) {\
+        FP sum = (FP) 0;\
+        for (j = 0; j < 4; ++j) {\
+            const int row = (it - 1 + j) * num_phi * num_comp + c;\
+            FP sum_row = (FP) 0;\
+            for (k = 0; k < 4; ++k)\
+                sum_row += wp[k] * table[row + col[k]];\
+            sum += wt[j] * sum_row;\
+        }\
+        out[i_out + c] = sum;\
+    }\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -88,8 +88,10 @@ enum OSKAR_ELEMENT_TAPER
 #include <telescope/station/element/oskar_element_accessors.h>
 #include <telescope/station/element/oskar_element_copy.h>
 #include <telescope/station/element/oskar_element_create.h>
+#include <telescope/station/element/oskar_element_create_lookup_tables.h>
 #include <telescope/station/element/oskar_element_different.h>
 #include <telescope/station/element/oskar_element_evaluate.h>
+#include <telescope/station/element/oskar_element_evaluate_theta_phi.h>
 #include <telescope/station/element/oskar_element_free.h>
 #include <telescope/station/element/oskar_element_load.h>
 #include <telescope/station/element/oskar_element_load_cst.h>
@@ -98,6 +100,7 @@ enum OSKAR_ELEMENT_TAPER
 #include <telescope/station/element/oskar_element_resize_freq_data.h>
 #include <telescope/station/element/oskar_element_read.h>
 #include <telescope/station/element/oskar_element_save.h>
+#include <telescope/station/element/oskar_element_share_lookup_tables.h>
 #include <telescope/station/element/oskar_element_write.h>
 
 #endif /* OSKAR_ELEMENT_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2013, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -54,6 +54,34 @@ OSKAR_EXPORT
 void oskar_element_copy(oskar_Element* dst, const oskar_Element* src,
         int* status);
 
+/**
+ * @brief
+ * Copies an element model, sharing lookup tables between copies.
+ *
+ * @details
+ * This function behaves like oskar_element_copy(), except that any
+ * lookup tables are shared rather than duplicated where possible.
+ *
+ * Tables in host memory are shared with the source element.
+ * Otherwise, the list of copies made so far is searched for a copy of the
+ * same tables in the same location, and that is shared. Only if none is
+ * found are the tables copied, and the destination element is then
+ * appended to the list.
+ *
+ * The list should start empty, and must be released using free() when all
+ * related copies have been made. Elements in the list must stay alive while
+ * it is in use.
+ *
+ * @param[out] dst             Pointer to destination data structure.
+ * @param[in]  src             Pointer to source data structure.
+ * @param[in,out] num_copies   Number of elements in the list of copies.
+ * @param[in,out] copies       List of elements holding copied tables.
+ * @param[in,out]  status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_copy_shared(oskar_Element* dst, const oskar_Element* src,
+        int* num_copies, oskar_Element*** copies, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ELEMENT_CREATE_LOOKUP_TABLES_H_
+#define OSKAR_ELEMENT_CREATE_LOOKUP_TABLES_H_
+
+/**
+ * @file oskar_element_create_lookup_tables.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Tabulates numerically-defined element patterns on a regular grid.
+ *
+ * @details
+ * This function samples the fitted spline data for each frequency once
+ * on a regular grid in (theta, phi), so that subsequent evaluations of the
+ * element pattern can use bicubic interpolation of the tables instead of
+ * evaluating the splines at every point.
+ *
+ * The grid spacing is at most \p cellsize_rad in both theta and phi.
+ * If \p cellsize_rad is not positive, any existing tables are removed,
+ * and the splines are evaluated directly.
+ *
+ * @param[in,out] model       Element model structure.
+ * @param[in] cellsize_rad    Maximum grid spacing, in radians.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_create_lookup_tables(oskar_Element* model,
+        double cellsize_rad, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ELEMENT_CREATE_LOOKUP_TABLES_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ELEMENT_EVALUATE_THETA_PHI_H_
+#define OSKAR_ELEMENT_EVALUATE_THETA_PHI_H_
+
+/**
+ * @file oskar_element_evaluate_theta_phi.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates the element model at the given element-frame angles.
+ *
+ * @details
+ * This function evaluates the element pattern model at source positions
+ * already converted to the element frame, as returned by
+ * oskar_convert_enu_directions_to_theta_phi().
+ *
+ * The angles do not depend on frequency, so they can be computed once
+ * and used for all channels.
+ *
+ * If \p normalise is set, the input arrays must contain one extra point
+ * (the zenith) after the first \p num_points.
+ *
+ * @param[in] model         Pointer to element model structure.
+ * @param[in] normalise     If true, normalise pattern to value at zenith.
+ * @param[in] swap_xy       If true, swap X and Y responses in output.
+ * @param[in] num_points    Number of points at which to evaluate beam.
+ * @param[in] theta         Polar angles of the points, in radians.
+ * @param[in] phi_x         Azimuth angles relative to the X dipole.
+ * @param[in] phi_y         Azimuth angles relative to the Y dipole.
+ * @param[in] frequency_hz  Current observing frequency in Hz.
+ * @param[in] offset_out    Start offset into output array.
+ * @param[in,out] output    Pointer to output array.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_evaluate_theta_phi(
+        const oskar_Element* model,
+        int normalise,
+        int swap_xy,
+        int num_points,
+        const oskar_Mem* theta,
+        const oskar_Mem* phi_x,
+        const oskar_Mem* phi_y,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* output,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE_H_
+#define OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE_H_
+
+/**
+ * @file oskar_evaluate_element_lookup_table.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Interpolates tabulated element pattern data at the given coordinates.
+ *
+ * @details
+ * This function uses bicubic (Catmull-Rom) interpolation to evaluate
+ * element pattern data that has been sampled on a regular grid in
+ * (theta, phi), where phi varies fastest and is periodic over 2 pi.
+ * Each grid point holds \p num_comp real values, and all components are
+ * interpolated using the same weights.
+ *
+ * Component \p c of point \p i is written to real element
+ * (i * stride + offset_out + c) of the output array.
+ *
+ * @param[in] num_theta      Number of theta rows in the table.
+ * @param[in] num_phi        Number of phi columns in the table.
+ * @param[in] theta0_rad     Theta value of the first row, in radians.
+ * @param[in] dtheta_rad     Theta increment between rows, in radians.
+ * @param[in] dphi_rad       Phi increment between columns, in radians.
+ * @param[in] num_comp       Number of real components per grid point.
+ * @param[in] table          Tabulated data.
+ * @param[in] num_points     Number of points at which to evaluate.
+ * @param[in] theta          Point theta values, in radians.
+ * @param[in] phi            Point phi values, in radians.
+ * @param[in] stride         Stride between points in the output (in reals).
+ * @param[in] offset_out     Start offset into output array (in reals).
+ * @param[in,out] output     Output array.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_element_lookup_table(int num_theta, int num_phi,
+        double theta0_rad, double dtheta_rad, double dphi_rad, int num_comp,
+        const oskar_Mem* table, int num_points, const oskar_Mem* theta,
+        const oskar_Mem* phi, int stride, int offset_out, oskar_Mem* output,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE_H_ */
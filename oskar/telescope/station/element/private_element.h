@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,6 +31,40 @@
 
 #include <mem/oskar_mem.h>
 #include <splines/oskar_splines.h>
+#include <utility/oskar_thread.h>
+
+/* Lookup tables of spline data sampled on a regular (theta, phi) grid.
+ * The tables are reference-counted, so that element models loaded from the
+ * same data files (and copies of them) can share one set of tables. */
+struct oskar_ElementLookupTables
+{
+    int ref_count;
+    oskar_Mutex* mutex;     /* Protects the reference count. */
+    const void* origin;     /* Identifies the tables this was copied from. */
+    int location, num_freq, num_theta, num_phi;
+    double theta0_rad, dtheta_rad, dphi_rad;
+    oskar_Mem **x, **y, **scalar;
+};
+typedef struct oskar_ElementLookupTables oskar_ElementLookupTables;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Creates an empty set of lookup tables, with a reference count of 1. */
+oskar_ElementLookupTables* oskar_element_lookup_tables_create(int location,
+        int num_freq, int* status);
+
+/* Adds a reference to a set of lookup tables. */
+void oskar_element_lookup_tables_retain(oskar_ElementLookupTables* lut);
+
+/* Removes a reference to a set of lookup tables, freeing them if unused. */
+void oskar_element_lookup_tables_release(oskar_ElementLookupTables* lut,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
 
 struct oskar_Element
 {
@@ -70,6 +104,9 @@ struct oskar_Element
     int *common_phi_coords;
     int *l_max;
     oskar_Mem **sph_wave;
+
+    /* Lookup tables of spline data, if created (may be shared). */
+    oskar_ElementLookupTables* lut;
 };
 
 #ifndef OSKAR_ELEMENT_TYPEDEF_
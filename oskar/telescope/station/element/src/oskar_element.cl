@@ -7,4 +7,5 @@ OSKAR_ELEMENT_TAPER_GAUSSIAN_MATRIX( M_CAT(apply_element_taper_gaussian_matrix_,
 OSKAR_EVALUATE_GEOMETRIC_DIPOLE_PATTERN( M_CAT(evaluate_geometric_dipole_pattern_, Real), Real, Real2)
 OSKAR_EVALUATE_DIPOLE_PATTERN( M_CAT(evaluate_dipole_pattern_, Real), Real, Real2)
 OSKAR_EVALUATE_DIPOLE_PATTERN_SCALAR( M_CAT(evaluate_dipole_pattern_scalar_, Real), Real, Real2, Real4c)
+OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE( M_CAT(evaluate_element_lookup_table_, Real), Real)
 OSKAR_EVALUATE_SPHERICAL_WAVE_SUM( M_CAT(evaluate_spherical_wave_sum_, Real), Real, Real2, Real4c)
@@ -1,11 +1,13 @@
 /* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
 
 #include "math/oskar_cmath.h"
+#include "math/define_interpolate_grid_bicubic.h"
 #include "math/define_legendre_polynomial.h"
 #include "math/define_multiply.h"
 #include "telescope/station/element/define_apply_element_taper_cosine.h"
 #include "telescope/station/element/define_apply_element_taper_gaussian.h"
 #include "telescope/station/element/define_evaluate_dipole_pattern.h"
+#include "telescope/station/element/define_evaluate_element_lookup_table.h"
 #include "telescope/station/element/define_evaluate_geometric_dipole_pattern.h"
 #include "telescope/station/element/define_evaluate_spherical_wave.h"
 #include "utility/oskar_cuda_registrar.h"
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,12 +29,26 @@
 #include "telescope/station/element/private_element.h"
 #include "telescope/station/element/oskar_element.h"
 
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void copy_lookup_tables(oskar_Element* dst, const oskar_Element* src,
+        int* num_copies, oskar_Element*** copies, int* status);
+
 void oskar_element_copy(oskar_Element* dst, const oskar_Element* src,
         int* status)
+{
+    int num_copies = 0;
+    oskar_Element** copies = 0;
+    oskar_element_copy_shared(dst, src, &num_copies, &copies, status);
+    free(copies);
+}
+
+void oskar_element_copy_shared(oskar_Element* dst, const oskar_Element* src,
+        int* num_copies, oskar_Element*** copies, int* status)
 {
     int i;
     if (*status) return;
@@ -90,6 +104,70 @@ void oskar_element_copy(oskar_Element* dst, const oskar_Element* src,
             dst->sph_wave[i] = oskar_mem_create(sph_wave_type, loc, 0, status);
         oskar_mem_copy(dst->sph_wave[i], src->sph_wave[i], status);
     }
+    copy_lookup_tables(dst, src, num_copies, copies, status);
+}
+
+static void copy_lookup_tables(oskar_Element* dst, const oskar_Element* src,
+        int* num_copies, oskar_Element*** copies, int* status)
+{
+    int i;
+    oskar_ElementLookupTables* lut = 0;
+    oskar_Element** new_copies = 0;
+    const int loc = dst->mem_location;
+    if (*status || dst->lut == src->lut) return;
+    oskar_element_lookup_tables_release(dst->lut, status);
+    dst->lut = 0;
+    if (!src->lut) return;
+
+    /* Tables in host memory can be shared directly. */
+    if (loc == OSKAR_CPU && src->lut->location == OSKAR_CPU)
+    {
+        oskar_element_lookup_tables_retain(src->lut);
+        dst->lut = src->lut;
+        return;
+    }
+
+    /* Share a copy of the same tables made earlier in this location. */
+    for (i = 0; i < *num_copies; ++i)
+    {
+        oskar_ElementLookupTables* t = (*copies)[i]->lut;
+        if (t && t->origin == src->lut->origin && t->location == loc)
+        {
+            oskar_element_lookup_tables_retain(t);
+            dst->lut = t;
+            return;
+        }
+    }
+
+    /* Otherwise, copy the tables and remember where they are. */
+    lut = oskar_element_lookup_tables_create(loc, src->lut->num_freq, status);
+    if (!lut) return;
+    lut->origin = src->lut->origin;
+    lut->num_theta = src->lut->num_theta;
+    lut->num_phi = src->lut->num_phi;
+    lut->theta0_rad = src->lut->theta0_rad;
+    lut->dtheta_rad = src->lut->dtheta_rad;
+    lut->dphi_rad = src->lut->dphi_rad;
+    for (i = 0; i < lut->num_freq; ++i)
+    {
+        if (src->lut->x[i])
+            lut->x[i] = oskar_mem_create_copy(src->lut->x[i], loc, status);
+        if (src->lut->y[i])
+            lut->y[i] = oskar_mem_create_copy(src->lut->y[i], loc, status);
+        if (src->lut->scalar[i])
+            lut->scalar[i] = oskar_mem_create_copy(src->lut->scalar[i],
+                    loc, status);
+    }
+    dst->lut = lut;
+    new_copies = (oskar_Element**) realloc(*copies,
+            (*num_copies + 1) * sizeof(oskar_Element*));
+    if (!new_copies)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    *copies = new_copies;
+    (*copies)[(*num_copies)++] = dst;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static oskar_Mem* tabulate(oskar_Splines* const* splines, int num_comp,
+        int num_grid, const oskar_Mem* theta, const oskar_Mem* phi,
+        int* status);
+
+void oskar_element_create_lookup_tables(oskar_Element* model,
+        double cellsize_rad, int* status)
+{
+    int i, j, k;
+    oskar_Mem *theta_cpu, *phi_cpu, *theta, *phi;
+    oskar_ElementLookupTables* lut;
+    if (*status) return;
+
+    /* Remove any existing tables (which may be shared with other elements). */
+    oskar_element_lookup_tables_release(model->lut, status);
+    model->lut = 0;
+    if (cellsize_rad <= 0.0) return;
+
+    /* Define the grid.
+     * One extra row is needed beyond each pole, and one more at the end,
+     * so that the interpolation stencil stays inside the table. */
+    const int prec = model->precision, loc = model->mem_location;
+    const int num_rows = (int) ceil(M_PI / cellsize_rad);
+    const int num_theta = num_rows + 3;
+    int num_phi = (int) ceil(2.0 * M_PI / cellsize_rad);
+    if (num_phi < 4) num_phi = 4;
+    const int num_grid = num_theta * num_phi;
+    const double dtheta = M_PI / num_rows, dphi = 2.0 * M_PI / num_phi;
+    const double theta0 = -dtheta;
+
+    /* Generate the grid coordinates.
+     * Rows beyond the poles are reflected across them, which is the same
+     * direction rotated by pi in phi. */
+    theta_cpu = oskar_mem_create(prec, OSKAR_CPU, num_grid, status);
+    phi_cpu = oskar_mem_create(prec, OSKAR_CPU, num_grid, status);
+    for (j = 0; j < num_theta; ++j)
+    {
+        for (k = 0; k < num_phi; ++k)
+        {
+            double t = theta0 + j * dtheta, p = k * dphi;
+            if (t < 0.0)
+            {
+                t = -t;
+                p += M_PI;
+            }
+            else if (t > M_PI)
+            {
+                t = 2.0 * M_PI - t;
+                p += M_PI;
+            }
+            if (p >= 2.0 * M_PI) p -= 2.0 * M_PI;
+            oskar_mem_set_element_real(theta_cpu, j * num_phi + k, t, status);
+            oskar_mem_set_element_real(phi_cpu, j * num_phi + k, p, status);
+        }
+    }
+    theta = oskar_mem_create_copy(theta_cpu, loc, status);
+    phi = oskar_mem_create_copy(phi_cpu, loc, status);
+    lut = oskar_element_lookup_tables_create(loc, model->num_freq, status);
+    if (*status)
+    {
+        oskar_element_lookup_tables_release(lut, status);
+        lut = 0;
+    }
+
+    /* Evaluate the splines at each grid point, for each frequency. */
+    for (i = 0; lut && i < model->num_freq; ++i)
+    {
+        if (oskar_element_has_x_spline_data(model, i))
+        {
+            oskar_Splines* s[] = {model->x_h_re[i], model->x_h_im[i],
+                    model->x_v_re[i], model->x_v_im[i]};
+            lut->x[i] = tabulate(s, 4, num_grid, theta, phi, status);
+        }
+        if (oskar_element_has_y_spline_data(model, i))
+        {
+            oskar_Splines* s[] = {model->y_h_re[i], model->y_h_im[i],
+                    model->y_v_re[i], model->y_v_im[i]};
+            lut->y[i] = tabulate(s, 4, num_grid, theta, phi, status);
+        }
+        if (oskar_element_has_scalar_spline_data(model, i))
+        {
+            oskar_Splines* s[] = {model->scalar_re[i], model->scalar_im[i]};
+            lut->scalar[i] = tabulate(s, 2, num_grid, theta, phi, status);
+        }
+    }
+    if (lut)
+    {
+        lut->num_theta = num_theta;
+        lut->num_phi = num_phi;
+        lut->theta0_rad = theta0;
+        lut->dtheta_rad = dtheta;
+        lut->dphi_rad = dphi;
+        model->lut = lut;
+    }
+    oskar_mem_free(theta_cpu, status);
+    oskar_mem_free(phi_cpu, status);
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi, status);
+}
+
+static oskar_Mem* tabulate(oskar_Splines* const* splines, int num_comp,
+        int num_grid, const oskar_Mem* theta, const oskar_Mem* phi,
+        int* status)
+{
+    int c;
+    oskar_Mem* table = oskar_mem_create(oskar_mem_type(theta),
+            oskar_mem_location(theta), num_grid * num_comp, status);
+    for (c = 0; c < num_comp; ++c)
+        oskar_splines_evaluate(splines[c], num_grid, theta, phi,
+                num_comp, c, table, status);
+    return table;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016, The University of Oxford
+ * Copyright (c) 2015-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -59,6 +59,9 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
     if (a->y_taper_gaussian_fwhm_rad != b->y_taper_gaussian_fwhm_rad) return 1;
     if (a->x_taper_ref_freq_hz != b->x_taper_ref_freq_hz) return 1;
     if (a->y_taper_ref_freq_hz != b->y_taper_ref_freq_hz) return 1;
+    if (!a->lut != !b->lut) return 1;
+    if (a->lut && (a->lut->num_theta != b->lut->num_theta ||
+            a->lut->num_phi != b->lut->num_phi)) return 1;
 
     /* Check frequency-dependent data. */
     if (a->num_freq != b->num_freq) return 1;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -56,6 +56,7 @@ void oskar_element_free(oskar_Element* data, int* status)
         oskar_splines_free(data->scalar_im[i], status);
         oskar_mem_free(data->sph_wave[i], status);
     }
+    oskar_element_lookup_tables_release(data->lut, status);
     free(data->freqs_hz);
     free(data->l_max);
     free(data->common_phi_coords);
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+oskar_ElementLookupTables* oskar_element_lookup_tables_create(int location,
+        int num_freq, int* status)
+{
+    oskar_ElementLookupTables* lut = 0;
+    if (*status) return 0;
+    lut = (oskar_ElementLookupTables*) calloc(1,
+            sizeof(oskar_ElementLookupTables));
+    if (!lut)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    lut->ref_count = 1;
+    lut->mutex = oskar_mutex_create();
+    lut->origin = lut;
+    lut->location = location;
+    lut->num_freq = num_freq;
+    lut->x = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    lut->y = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    lut->scalar = (oskar_Mem**) calloc(num_freq, sizeof(oskar_Mem*));
+    if (num_freq > 0 && (!lut->x || !lut->y || !lut->scalar))
+    {
+        oskar_element_lookup_tables_release(lut, status);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    return lut;
+}
+
+void oskar_element_lookup_tables_retain(oskar_ElementLookupTables* lut)
+{
+    if (!lut) return;
+    oskar_mutex_lock(lut->mutex);
+    lut->ref_count++;
+    oskar_mutex_unlock(lut->mutex);
+}
+
+void oskar_element_lookup_tables_release(oskar_ElementLookupTables* lut,
+        int* status)
+{
+    int i, ref_count;
+    if (!lut) return;
+    oskar_mutex_lock(lut->mutex);
+    ref_count = --lut->ref_count;
+    oskar_mutex_unlock(lut->mutex);
+    if (ref_count > 0) return;
+    for (i = 0; i < lut->num_freq; ++i)
+    {
+        if (lut->x) oskar_mem_free(lut->x[i], status);
+        if (lut->y) oskar_mem_free(lut->y[i], status);
+        if (lut->scalar) oskar_mem_free(lut->scalar[i], status);
+    }
+    free(lut->x);
+    free(lut->y);
+    free(lut->scalar);
+    oskar_mutex_free(lut->mutex);
+    free(lut);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,6 +41,12 @@ void oskar_element_resize_freq_data(oskar_Element* model, int size,
     int i;
     if (*status) return;
     const int old_size = model->num_freq;
+    if (size != old_size)
+    {
+        /* Lookup tables are indexed by frequency, so remove them. */
+        oskar_element_lookup_tables_release(model->lut, status);
+        model->lut = 0;
+    }
     if (size > old_size)
     {
         /* Enlarge the arrays and create new structures. */
@@ -84,7 +90,6 @@ void oskar_element_resize_freq_data(oskar_Element* model, int size,
             oskar_splines_free(model->scalar_re[i], status);
             oskar_splines_free(model->scalar_im[i], status);
             oskar_mem_free(model->sph_wave[i], status);
-
         }
         realloc_arrays(model, size);
     }
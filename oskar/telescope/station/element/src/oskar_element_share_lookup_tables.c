@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int same_file(const oskar_Mem* a, const oskar_Mem* b);
+
+int oskar_element_share_lookup_tables(oskar_Element* dst,
+        const oskar_Element* src, int* status)
+{
+    int i;
+    if (*status || !src->lut || dst == src) return 0;
+    if (dst->lut == src->lut) return 1;
+    if (dst->precision != src->precision ||
+            dst->mem_location != src->mem_location ||
+            dst->num_freq != src->num_freq ||
+            src->lut->num_freq != src->num_freq)
+        return 0;
+
+    /* Check the pattern data came from the same files. */
+    for (i = 0; i < src->num_freq; ++i)
+    {
+        if (dst->freqs_hz[i] != src->freqs_hz[i]) return 0;
+        if (oskar_element_has_x_spline_data(dst, i) !=
+                oskar_element_has_x_spline_data(src, i) ||
+                oskar_element_has_y_spline_data(dst, i) !=
+                oskar_element_has_y_spline_data(src, i) ||
+                oskar_element_has_scalar_spline_data(dst, i) !=
+                oskar_element_has_scalar_spline_data(src, i))
+            return 0;
+        if (oskar_element_has_x_spline_data(src, i) &&
+                !same_file(dst->filename_x[i], src->filename_x[i]))
+            return 0;
+        if (oskar_element_has_y_spline_data(src, i) &&
+                !same_file(dst->filename_y[i], src->filename_y[i]))
+            return 0;
+        if (oskar_element_has_scalar_spline_data(src, i) &&
+                !same_file(dst->filename_scalar[i], src->filename_scalar[i]))
+            return 0;
+    }
+
+    /* Replace any existing tables with a reference to the shared ones. */
+    oskar_element_lookup_tables_release(dst->lut, status);
+    oskar_element_lookup_tables_retain(src->lut);
+    dst->lut = src->lut;
+    return 1;
+}
+
+static int same_file(const oskar_Mem* a, const oskar_Mem* b)
+{
+    const char *name_a, *name_b;
+    if (!a || !b || oskar_mem_length(a) == 0 || oskar_mem_length(b) == 0)
+        return 0;
+    name_a = oskar_mem_char_const(a);
+    name_b = oskar_mem_char_const(b);
+    return name_a[0] != 0 && !strcmp(name_a, name_b);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/define_interpolate_grid_bicubic.h"
+#include "telescope/station/element/define_evaluate_element_lookup_table.h"
+#include "telescope/station/element/oskar_evaluate_element_lookup_table.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE(evaluate_element_lookup_table_f, float)
+OSKAR_EVALUATE_ELEMENT_LOOKUP_TABLE(evaluate_element_lookup_table_d, double)
+
+void oskar_evaluate_element_lookup_table(int num_theta, int num_phi,
+        double theta0_rad, double dtheta_rad, double dphi_rad, int num_comp,
+        const oskar_Mem* table, int num_points, const oskar_Mem* theta,
+        const oskar_Mem* phi, int stride, int offset_out, oskar_Mem* output,
+        int* status)
+{
+    if (*status) return;
+    const int type = oskar_mem_type(table);
+    const int location = oskar_mem_location(output);
+    const double inv_dtheta = 1.0 / dtheta_rad, inv_dphi = 1.0 / dphi_rad;
+    const float theta0_f = (float) theta0_rad;
+    const float inv_dtheta_f = (float) inv_dtheta;
+    const float inv_dphi_f = (float) inv_dphi;
+    if (oskar_mem_location(table) != location ||
+            oskar_mem_location(theta) != location ||
+            oskar_mem_location(phi) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(output) != type ||
+            oskar_mem_type(theta) != type || oskar_mem_type(phi) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (num_theta < 4 || num_phi < 4)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (location == OSKAR_CPU)
+    {
+        if (type == OSKAR_SINGLE)
+            evaluate_element_lookup_table_f(num_theta, num_phi,
+                    theta0_f, inv_dtheta_f, inv_dphi_f, num_comp,
+                    oskar_mem_float_const(table, status), num_points,
+                    oskar_mem_float_const(theta, status),
+                    oskar_mem_float_const(phi, status), stride, offset_out,
+                    oskar_mem_float(output, status));
+        else if (type == OSKAR_DOUBLE)
+            evaluate_element_lookup_table_d(num_theta, num_phi,
+                    theta0_rad, inv_dtheta, inv_dphi, num_comp,
+                    oskar_mem_double_const(table, status), num_points,
+                    oskar_mem_double_const(theta, status),
+                    oskar_mem_double_const(phi, status), stride, offset_out,
+                    oskar_mem_double(output, status));
+        else
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+    }
+    else
+    {
+        size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        const char* k = 0;
+        const int is_dbl = (type == OSKAR_DOUBLE);
+        if (type == OSKAR_DOUBLE)
+            k = "evaluate_element_lookup_table_double";
+        else if (type == OSKAR_SINGLE)
+            k = "evaluate_element_lookup_table_float";
+        else
+        {
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_points, local_size[0]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_theta},
+                {INT_SZ, &num_phi},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&theta0_rad : (const void*)&theta0_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&inv_dtheta : (const void*)&inv_dtheta_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&inv_dphi : (const void*)&inv_dphi_f},
+                {INT_SZ, &num_comp},
+                {PTR_SZ, oskar_mem_buffer_const(table)},
+                {INT_SZ, &num_points},
+                {PTR_SZ, oskar_mem_buffer_const(theta)},
+                {PTR_SZ, oskar_mem_buffer_const(phi)},
+                {INT_SZ, &stride},
+                {INT_SZ, &offset_out},
+                {PTR_SZ, oskar_mem_buffer(output)}
+        };
+        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
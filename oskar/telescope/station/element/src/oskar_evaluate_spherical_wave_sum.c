@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, The University of Oxford
+ * Copyright (c) 2019-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,19 +27,30 @@
  */
 
 #include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
-#include "telescope/station/element/define_evaluate_spherical_wave.h"
 #include "log/oskar_log.h"
-#include "math/define_legendre_polynomial.h"
-#include "math/define_multiply.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_device.h"
-#include "utility/oskar_kernel_macros.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(evaluate_spherical_wave_sum_float, float, float2, float4c)
-OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(evaluate_spherical_wave_sum_double, double, double2, double4c)
+typedef struct
+{
+    double theta;
+    int index;
+} ThetaIndex;
+
+static void spherical_wave_sum_cpu(int num_points, const oskar_Mem* theta,
+        const oskar_Mem* phi_x, const oskar_Mem* phi_y, int l_max,
+        const oskar_Mem* alpha, int offset, oskar_Mem* pattern, int* status);
 
 void oskar_evaluate_spherical_wave_sum(int num_points, const oskar_Mem* theta,
         const oskar_Mem* phi_x, const oskar_Mem* phi_y, int l_max,
@@ -58,20 +69,9 @@ void oskar_evaluate_spherical_wave_sum(int num_points, const oskar_Mem* theta,
         switch (oskar_mem_type(pattern))
         {
         case OSKAR_SINGLE_COMPLEX_MATRIX:
-            evaluate_spherical_wave_sum_float(num_points,
-                    oskar_mem_float_const(theta, status),
-                    oskar_mem_float_const(phi_x, status),
-                    oskar_mem_float_const(phi_y, status), l_max,
-                    oskar_mem_float4c_const(alpha, status), offset,
-                    oskar_mem_float4c(pattern, status));
-            break;
         case OSKAR_DOUBLE_COMPLEX_MATRIX:
-            evaluate_spherical_wave_sum_double(num_points,
-                    oskar_mem_double_const(theta, status),
-                    oskar_mem_double_const(phi_x, status),
-                    oskar_mem_double_const(phi_y, status), l_max,
-                    oskar_mem_double4c_const(alpha, status), offset,
-                    oskar_mem_double4c(pattern, status));
+            spherical_wave_sum_cpu(num_points, theta, phi_x, phi_y,
+                    l_max, alpha, offset, pattern, status);
             break;
         case OSKAR_SINGLE_COMPLEX:
         case OSKAR_DOUBLE_COMPLEX:
@@ -122,6 +122,217 @@ void oskar_evaluate_spherical_wave_sum(int num_points, const oskar_Mem* theta,
     }
 }
 
+static int compare_theta(const void* a, const void* b)
+{
+    const double t1 = ((const ThetaIndex*)a)->theta;
+    const double t2 = ((const ThetaIndex*)b)->theta;
+    if (t1 != t1) return (t2 != t2) ? 0 : 1; /* Sort NAN to the end. */
+    if (t2 != t2) return -1;
+    return (t1 > t2) - (t1 < t2);
+}
+
+/* Accumulates the (l, m) mode into the theta-dependent terms for order m.
+ * Terms are stored as complex (X_theta, X_phi, Y_theta, Y_phi), and
+ * the coefficients as complex (X_TE, X_TM, Y_TE, Y_TM). */
+static void add_mode(double* t, const double* c, double m_pds, double dpms)
+{
+    int k;
+    for (k = 0; k < 2; ++k, t += 4, c += 4)
+    {
+        t[0] += -m_pds * c[3] - dpms * c[0];
+        t[1] +=  m_pds * c[2] - dpms * c[1];
+        t[2] += -dpms * c[2] + m_pds * c[1];
+        t[3] += -dpms * c[3] - m_pds * c[0];
+    }
+}
+
+/* Evaluates the sum over l for each order m at the given theta, as the
+ * product of the matrix of Legendre values with the coefficient vector.
+ * Uses the same recurrences as OSKAR_LEGENDRE2, but generates all degrees
+ * of each order in a single pass. */
+static void evaluate_theta_terms(int l_max, double theta, const double* coeff,
+        double* p, double* terms)
+{
+    int l, m;
+    const double sin_t = sin(theta), cos_t = cos(theta);
+    const double inv_sin_t = 1.0 / sin_t;
+    double p_mm = 1.0;
+    memset(terms, 0, (2 * l_max + 1) * 8 * sizeof(double));
+    for (m = 0; m <= l_max; ++m)
+    {
+        if (m > 0) p_mm *= -(2 * m - 1) * sin_t;
+        p[m] = p_mm;
+        p[m + 1] = cos_t * (2 * m + 1) * p_mm;
+        for (l = m + 2; l <= l_max + 1; ++l)
+            p[l] = ((2 * l - 1) * cos_t * p[l - 1] -
+                    (l + m - 1) * p[l - 2]) / (l - m);
+        for (l = (m > 0 ? m : 1); l <= l_max; ++l)
+        {
+            const int ind0 = l * l - 1 + l;
+            const double pds = p[l] * inv_sin_t;
+            const double dpms = (cos_t * p[l] * (l + 1) -
+                    p[l + 1] * (l - m + 1)) * inv_sin_t;
+            add_mode(&terms[8 * (l_max + m)], &coeff[8 * (ind0 + m)],
+                    m * pds, dpms);
+            if (m > 0)
+                add_mode(&terms[8 * (l_max - m)], &coeff[8 * (ind0 - m)],
+                        -m * pds, dpms);
+        }
+    }
+}
+
+/* Sums the theta-dependent terms over order m, for one polarisation. */
+static void sum_phi_harmonics(int l_max, const double* terms, double phi,
+        double* out)
+{
+    int m, k;
+    const double* t0 = &terms[8 * l_max];
+    const double w_re = cos(phi), w_im = sin(phi);
+    double e_re = 1.0, e_im = 0.0;
+    for (k = 0; k < 4; ++k) out[k] = t0[k];
+    for (m = 1; m <= l_max; ++m)
+    {
+        const double* tp = &terms[8 * (l_max + m)];
+        const double* tm = &terms[8 * (l_max - m)];
+        const double t = e_re * w_re - e_im * w_im;
+        e_im = e_re * w_im + e_im * w_re;
+        e_re = t;
+        for (k = 0; k < 4; k += 2)
+        {
+            /* exp(i m phi) * T(m) + exp(-i m phi) * T(-m) */
+            out[k]     += e_re * (tp[k] + tm[k]) - e_im * (tp[k+1] - tm[k+1]);
+            out[k + 1] += e_re * (tp[k+1] + tm[k+1]) + e_im * (tp[k] - tm[k]);
+        }
+    }
+}
+
+static void spherical_wave_sum_cpu(int num_points, const oskar_Mem* theta,
+        const oskar_Mem* phi_x, const oskar_Mem* phi_y, int l_max,
+        const oskar_Mem* alpha, int offset, oskar_Mem* pattern, int* status)
+{
+    int i, l, m, num_threads = 1;
+    const int is_dbl = oskar_mem_is_double(pattern);
+    const int num_coeff = (l_max + 1) * (l_max + 1) - 1;
+    const size_t num_p = l_max + 2, num_terms = (2 * l_max + 1) * 8;
+    const float *theta_f = 0, *phi_x_f = 0, *phi_y_f = 0, *alpha_f = 0;
+    const double *theta_d = 0, *phi_x_d = 0, *phi_y_d = 0, *alpha_d = 0;
+    float* out_f = 0;
+    double* out_d = 0;
+    if (is_dbl)
+    {
+        theta_d = oskar_mem_double_const(theta, status);
+        phi_x_d = oskar_mem_double_const(phi_x, status);
+        phi_y_d = oskar_mem_double_const(phi_y, status);
+        alpha_d = oskar_mem_double_const(alpha, status);
+        out_d = oskar_mem_double(pattern, status);
+    }
+    else
+    {
+        theta_f = oskar_mem_float_const(theta, status);
+        phi_x_f = oskar_mem_float_const(phi_x, status);
+        phi_y_f = oskar_mem_float_const(phi_y, status);
+        alpha_f = oskar_mem_float_const(alpha, status);
+        out_f = oskar_mem_float(pattern, status);
+    }
+    if (*status) return;
+
+    /* Allocate the coefficients, the sort index and per-thread work. */
+#ifdef _OPENMP
+    if (!omp_in_parallel()) num_threads = omp_get_max_threads();
+#endif
+    double* coeff = (double*) malloc(num_coeff * 8 * sizeof(double));
+    ThetaIndex* sorted = (ThetaIndex*) malloc(
+            num_points * sizeof(ThetaIndex));
+    double* thread_work = (double*) calloc(
+            num_threads * (num_p + num_terms), sizeof(double));
+    if (!coeff || !sorted || !thread_work)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(coeff);
+        free(sorted);
+        free(thread_work);
+        return;
+    }
+
+    /* Scale the coefficients by the normalisation of each mode. */
+    for (l = 1; l <= l_max; ++l)
+    {
+        const int ind0 = l * l - 1 + l;
+        const double f = (2 * l + 1) / (4.0 * M_PI * l * (l + 1));
+        for (m = -l; m <= l; ++m)
+        {
+            int k;
+            double ratio = 1.0; /* (l - |m|)! / (l + |m|)! */
+            for (k = l - abs(m) + 1; k <= l + abs(m); ++k) ratio /= k;
+            const double nf = sqrt(f * ratio);
+            for (k = 0; k < 8; ++k)
+            {
+                const int j = 8 * (ind0 + m) + k;
+                coeff[j] = nf * (is_dbl ? alpha_d[j] : alpha_f[j]);
+            }
+        }
+    }
+
+    /* Sort points by theta, so that terms can be reused when it repeats. */
+    for (i = 0; i < num_points; ++i)
+    {
+        double theta_ = is_dbl ? theta_d[i] : theta_f[i];
+        /* Hack to avoid divide-by-zero (also in Matlab code!). */
+        if (theta_ < 1e-5) theta_ = 1e-5;
+        sorted[i].theta = theta_;
+        sorted[i].index = i;
+    }
+    qsort(sorted, num_points, sizeof(ThetaIndex), compare_theta);
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        int j, thread_id = 0;
+        double cached_theta = 0.0;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+#endif
+        double* p = thread_work + thread_id * (num_p + num_terms);
+        double* terms = p + num_p;
+#pragma omp for schedule(static)
+        for (j = 0; j < num_points; ++j)
+        {
+            int k;
+            double x[4], y[4];
+            const int i_in = sorted[j].index, i_out = 8 * (i_in + offset);
+            const double theta_ = sorted[j].theta;
+            const double phi_x_ = is_dbl ? phi_x_d[i_in] : phi_x_f[i_in];
+            const double phi_y_ = is_dbl ? phi_y_d[i_in] : phi_y_f[i_in];
+            if (phi_x_ != phi_x_)
+            {
+                /* Propagate NAN. */
+                for (k = 0; k < 4; ++k) x[k] = y[k] = phi_x_;
+            }
+            else
+            {
+                if (theta_ != cached_theta)
+                {
+                    evaluate_theta_terms(l_max, theta_, coeff, p, terms);
+                    cached_theta = theta_;
+                }
+                sum_phi_harmonics(l_max, terms, phi_x_, x);
+                sum_phi_harmonics(l_max, terms + 4, phi_y_, y);
+            }
+
+            /* For some reason all components must be reversed in the matrix.
+             * Order is (Y_phi, Y_theta, X_phi, X_theta). */
+            const double v[] = {
+                    y[2], y[3], y[0], y[1], x[2], x[3], x[0], x[1]};
+            if (is_dbl)
+                for (k = 0; k < 8; ++k) out_d[i_out + k] = v[k];
+            else
+                for (k = 0; k < 8; ++k) out_f[i_out + k] = (float) v[k];
+        }
+    }
+    free(coeff);
+    free(sorted);
+    free(thread_work);
+}
+
 #ifdef __cplusplus
 }
 #endif
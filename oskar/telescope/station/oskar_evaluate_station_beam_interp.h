@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVALUATE_STATION_BEAM_INTERP_H_
+#define OSKAR_EVALUATE_STATION_BEAM_INTERP_H_
+
+/**
+ * @file oskar_evaluate_station_beam_interp.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/station/oskar_station.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluate the beam pattern for a station, interpolating from a grid
+ * if possible.
+ *
+ * @details
+ * This function evaluates the beam pattern of a station at the
+ * specified positions, given as relative direction cosines.
+ *
+ * If an interpolation tolerance has been set using
+ * oskar_station_work_set_beam_interp_tolerance(), the beam of an aperture
+ * array station is evaluated on a regular grid in (l, m) that encloses
+ * all the given directions, and bicubic interpolation is used to
+ * obtain the beam at each direction. The initial grid spacing is chosen
+ * from the radius of the station and the wavelength. The interpolation
+ * error is estimated by interpolating from every second grid point to the
+ * others, and scaling the result by the expected convergence rate.
+ * The grid is refined until this estimate is below the tolerance.
+ *
+ * The beam is evaluated directly using oskar_evaluate_station_beam()
+ * if interpolation is not enabled or not possible, if the grid would
+ * contain at least as many points as the number of directions, or if
+ * the tolerance could not be met.
+ *
+ * As for oskar_evaluate_station_beam(), the direction cosine arrays must
+ * be large enough to hold an extra point for beam normalisation.
+ *
+ * @param[in] num_points      Number of direction cosines given.
+ * @param[in] l               Relative direction cosines (x direction).
+ * @param[in] m               Relative direction cosines (y direction).
+ * @param[in] n               Relative direction cosines (z direction).
+ * @param[in] lm_range        Extent of the given directions, as
+ *                            (l_min, l_max, m_min, m_max).
+ * @param[in] norm_ra_rad     RA used for beam normalisation, in radians.
+ * @param[in] norm_dec_rad    Dec used for beam normalisation, in radians.
+ * @param[in] station         Station model.
+ * @param[in] work            Station beam work arrays.
+ * @param[in] time_index      Simulation time index.
+ * @param[in] frequency_hz    The observing frequency in Hz.
+ * @param[in] gast            The Greenwich Apparent Sidereal Time, in radians.
+ * @param[in] offset_out      Output array element offset.
+ * @param[out] beam           Output beam pattern data.
+ * @param[out] error_estimate Estimated maximum absolute error in the beam,
+ *                            or zero if the beam was evaluated directly.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_station_beam_interp(int num_points,
+        oskar_Mem* l, oskar_Mem* m, oskar_Mem* n, const double lm_range[4],
+        double norm_ra_rad, double norm_dec_rad, const oskar_Station* station,
+        oskar_StationWork* work, int time_index, double frequency_hz,
+        double GAST, int offset_out, oskar_Mem* beam,
+        double* error_estimate, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_STATION_BEAM_INTERP_H_ */
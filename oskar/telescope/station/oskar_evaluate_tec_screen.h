@@ -46,6 +46,9 @@ extern "C" {
  * @details
  * Evaluates a TEC screen at the given source positions.
  *
+ * The pixel nearest to the pierce point of each source is used.
+ * Sources with pierce points outside the screen are given unit response.
+ *
  * @param[in] num_points      Number of points at which to evaluate the screen.
  * @param[in] l               Source l-direction cosines.
  * @param[in] m               Source m-direction cosines.
@@ -55,7 +58,8 @@ extern "C" {
  * @param[in] screen_height_m Height of phase screen above array, in metres.
  * @param[in] screen_pixel_size_m Size of each pixel, in metres.
  * @param[in] screen_num_pixels_x Number of pixels along the x-dimension.
- * @param[in] screen_num_pixels_x Number of pixels along the y-dimension.
+ * @param[in] screen_num_pixels_y Number of pixels along the y-dimension.
+ * @param[in] offset_screen   Start offset of the time slice in \p tec_screen.
  * @param[in] tec_screen      TEC screen to evaluate.
  * @param[in] offset_out      Start offset into output array.
  * @param[out] out            Complex output array.
@@ -73,6 +77,7 @@ void oskar_evaluate_tec_screen(
         double screen_pixel_size_m,
         int screen_num_pixels_x,
         int screen_num_pixels_y,
+        int offset_screen,
         const oskar_Mem* tec_screen,
         int offset_out,
         oskar_Mem* out,
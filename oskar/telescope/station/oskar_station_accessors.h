@@ -164,6 +164,9 @@ int oskar_station_normalise_element_pattern(const oskar_Station* model);
 OSKAR_EXPORT
 int oskar_station_enable_array_pattern(const oskar_Station* model);
 
+OSKAR_EXPORT
+double oskar_station_array_pattern_nufft_accuracy(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_common_element_orientation(const oskar_Station* model);
 
@@ -173,9 +176,23 @@ int oskar_station_common_pol_beams(const oskar_Station* model);
 OSKAR_EXPORT
 int oskar_station_array_is_3d(const oskar_Station* model);
 
+/**
+ * @brief
+ * Returns the radius of the station aperture, in metres.
+ *
+ * @details
+ * Returns the maximum distance of any element from the station centre,
+ * including the extent of any child stations.
+ */
+OSKAR_EXPORT
+double oskar_station_max_radius_m(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_apply_element_errors(const oskar_Station* model);
 
+OSKAR_EXPORT
+int oskar_station_time_variable_errors(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_apply_element_weight(const oskar_Station* model);
 
@@ -459,6 +476,24 @@ void oskar_station_set_normalise_element_pattern(
 OSKAR_EXPORT
 void oskar_station_set_enable_array_pattern(oskar_Station* model, int value);
 
+/**
+ * @brief
+ * Sets the accuracy of the NUFFT used to evaluate large array patterns.
+ *
+ * @details
+ * If greater than zero, array patterns evaluated on the CPU are computed
+ * using a non-uniform FFT instead of a direct DFT when the number of
+ * elements multiplied by the number of directions is large.
+ * The value sets the approximate maximum error relative to the sum of the
+ * element weights. If zero (the default), the direct DFT is always used.
+ *
+ * @param[in] model  Pointer to station model.
+ * @param[in] value  Required accuracy, or 0 to disable.
+ */
+OSKAR_EXPORT
+void oskar_station_set_array_pattern_nufft_accuracy(oskar_Station* model,
+        double value);
+
 /**
  * @brief
  * Sets the seed used to generate time-variable errors.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -60,6 +60,33 @@ OSKAR_EXPORT
 oskar_Station* oskar_station_create_copy(const oskar_Station* src,
         int location, int* status);
 
+/**
+ * @brief
+ * Creates a new station model by copying an existing one, sharing
+ * element lookup tables with other copies.
+ *
+ * @details
+ * This function behaves like oskar_station_create_copy(), but passes
+ * the list of element copies to oskar_element_copy_shared(), so that
+ * element lookup tables are copied only once per location when copying
+ * many stations.
+ *
+ * The list should start empty, and must be released using free() once
+ * all the stations have been copied.
+ *
+ * @param[in]  src                    Pointer to station model to copy.
+ * @param[in]  location               Location of new station model.
+ * @param[in,out] num_element_copies  Number of elements in the list.
+ * @param[in,out] element_copies      List of elements holding copied tables.
+ * @param[in,out]  status             Status return code.
+ *
+ * @return A handle to the new data structure.
+ */
+OSKAR_EXPORT
+oskar_Station* oskar_station_create_copy_shared(const oskar_Station* src,
+        int location, int* num_element_copies,
+        oskar_Element*** element_copies, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <mem/oskar_mem.h>
+#include <telescope/station/oskar_station.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -92,11 +93,132 @@ oskar_Mem* oskar_station_work_enu_direction_y(oskar_StationWork* work);
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_enu_direction_z(oskar_StationWork* work);
 
+/**
+ * @brief Sets the maximum memory used to cache source directions.
+ * @details
+ * Sets the maximum number of bytes used to hold the ENU source directions
+ * and element angles kept for each station after a call to
+ * oskar_station_work_set_direction_cache().
+ * Directions for stations beyond this limit are evaluated when needed.
+ * @param[in,out] work       Pointer to work buffer structure.
+ * @param[in]     max_bytes  Maximum cache size, in bytes.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_direction_cache_max(oskar_StationWork* work,
+        size_t max_bytes);
+
+/**
+ * @brief Sets the source directions for which ENU directions are cached.
+ * @details
+ * The ENU directions of a set of sources seen by a station depend only on
+ * the station and the time, and not on the frequency. After this call,
+ * station beams evaluated using oskar_evaluate_station_beam() for the
+ * relative directions \p l (and the corresponding m, n) at the given
+ * Greenwich apparent sidereal time keep the ENU directions for each
+ * station, and the element angles for each element type, so they are
+ * computed only once for all frequency channels.
+ * Any directions cached previously are discarded, so this must be called
+ * again whenever the contents of the direction arrays change.
+ * Pass a null pointer to disable the cache.
+ * @param[in,out] work      Pointer to work buffer structure.
+ * @param[in] l             Relative direction cosines of the sources.
+ * @param[in] num_points    Number of sources.
+ * @param[in] gast          Greenwich apparent sidereal time, in radians.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_direction_cache(oskar_StationWork* work,
+        const oskar_Mem* l, int num_points, double gast, int* status);
+
+/**
+ * @brief Returns arrays for the ENU source directions seen by a station.
+ * @details
+ * Returns the arrays used to hold the ENU direction cosines of the
+ * sources for the given station. If the relative directions \p l and
+ * time match those set by oskar_station_work_set_direction_cache(),
+ * the arrays are kept for the station, within the memory limit, and the
+ * function returns 1 if they already hold the directions.
+ * Otherwise, it returns 0, and the directions must be computed into
+ * the returned arrays.
+ * @param[in,out] work      Pointer to work buffer structure.
+ * @param[in] station       Station model.
+ * @param[in] l             Relative direction cosines of the sources.
+ * @param[in] num_points    Number of directions.
+ * @param[in] gast          Greenwich apparent sidereal time, in radians.
+ * @param[out] x            ENU direction cosines, x-component.
+ * @param[out] y            ENU direction cosines, y-component.
+ * @param[out] z            ENU direction cosines, z-component.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+int oskar_station_work_enu_directions(oskar_StationWork* work,
+        const oskar_Station* station, const oskar_Mem* l, int num_points,
+        double gast, oskar_Mem** x, oskar_Mem** y, oskar_Mem** z,
+        int* status);
+
+/**
+ * @brief Returns arrays for the element angles of sources seen by a station.
+ * @details
+ * Returns the arrays used to hold the element-frame angles (theta, phi_x,
+ * phi_y) of the sources for an element type in the given station.
+ * The angles do not depend on frequency, so if \p x is an array of
+ * ENU directions cached for the station by
+ * oskar_station_work_enu_directions(), the arrays are kept for the
+ * element type, within the memory limit, and the function returns 1 if
+ * they already hold the angles.
+ * Otherwise, it returns 0, and the angles must be computed into
+ * the returned arrays, which have space for \p num_points + 1 points.
+ * @param[in,out] work      Pointer to work buffer structure.
+ * @param[in] station       Station model.
+ * @param[in] element_type_index Index of the element type in the station.
+ * @param[in] x             ENU direction cosines, x-component.
+ * @param[in] num_points    Number of directions.
+ * @param[out] theta        Polar angles of the sources.
+ * @param[out] phi_x        Azimuth angles relative to the X dipole.
+ * @param[out] phi_y        Azimuth angles relative to the Y dipole.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+int oskar_station_work_element_theta_phi(oskar_StationWork* work,
+        const oskar_Station* station, int element_type_index,
+        const oskar_Mem* x, int num_points, oskar_Mem** theta,
+        oskar_Mem** phi_x, oskar_Mem** phi_y, int* status);
+
 OSKAR_EXPORT
 void oskar_station_work_set_tec_screen_common_params(oskar_StationWork* work,
         char screen_type, double screen_height_km, double screen_pixel_size_m,
         double screen_time_interval_sec);
 
+/**
+ * @brief Sets the maximum memory used for TEC screen time slices.
+ *
+ * @details
+ * Sets the maximum number of bytes used to hold time slices of an
+ * external TEC screen. At least one slice is always held.
+ *
+ * @param[in,out] work       Pointer to work buffer structure.
+ * @param[in]     max_bytes  Maximum buffer size, in bytes.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_tec_screen_max_buffer(oskar_StationWork* work,
+        size_t max_bytes);
+
+/**
+ * @brief Sets the range of time indices in the block being simulated.
+ *
+ * @details
+ * Sets the range of simulation time indices in the current block.
+ * Time slices of an external TEC screen are read only for the time steps
+ * left in this range. If no range is set, one slice is read at a time.
+ *
+ * @param[in,out] work              Pointer to work buffer structure.
+ * @param[in]     start_time_index  First time index in the block.
+ * @param[in]     num_times         Number of time steps in the block.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_time_range(oskar_StationWork* work,
+        int start_time_index, int num_times);
+
 OSKAR_EXPORT
 void oskar_station_work_set_tec_screen_path(oskar_StationWork* work,
         const char* path);
@@ -107,14 +229,94 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
         double station_u_m, double station_v_m, int time_index,
         double frequency_hz, int* status);
 
+/**
+ * @brief Returns element beamforming weights for a station, using a cache.
+ *
+ * @details
+ * Returns the weights from oskar_station_evaluate_element_weights()
+ * for the given station and feed. The weights are kept in the work
+ * buffer for each station (identified by its unique ID) and feed, and are
+ * evaluated again only if the beam direction or the wavenumber has
+ * changed, or if the time index has changed and the station has
+ * time-variable element errors (see oskar_station_analyse()).
+ * This allows them to be reused across chunks of sources, and across
+ * time steps for a fixed pointing.
+ *
+ * The station element data must not be modified while the work buffer
+ * is in use.
+ *
+ * @param[in,out] work    Pointer to work buffer structure.
+ * @param[in] station     Station model.
+ * @param[in] feed        Feed index (0 = X, 1 = Y).
+ * @param[in] wavenumber  Wavenumber (2 pi / wavelength).
+ * @param[in] x_beam      Beam direction cosine, horizontal x-component.
+ * @param[in] y_beam      Beam direction cosine, horizontal y-component.
+ * @param[in] z_beam      Beam direction cosine, horizontal z-component.
+ * @param[in] time_index  Time index of simulation.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_station_work_element_weights(oskar_StationWork* work,
+        const oskar_Station* station, int feed, double wavenumber,
+        double x_beam, double y_beam, double z_beam, int time_index,
+        int* status);
+
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam_out(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int* status);
 
+/**
+ * @brief Sets the error tolerance used for interpolated station beams.
+ *
+ * @details
+ * If the tolerance is greater than zero, aperture array station beams
+ * evaluated using oskar_evaluate_station_beam_interp() will be
+ * interpolated from a grid of directions, provided the estimated
+ * interpolation error is below this value.
+ *
+ * @param[in,out] work   Pointer to work buffer structure.
+ * @param[in]     value  Maximum allowed absolute error in the beam.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_beam_interp_tolerance(oskar_StationWork* work,
+        double value);
+
+OSKAR_EXPORT
+double oskar_station_work_beam_interp_tolerance(const oskar_StationWork* work);
+
+/**
+ * @brief Returns the maximum interpolation error estimate for each station.
+ *
+ * @details
+ * Returns a double-precision array in CPU memory, which holds the maximum
+ * error estimate for each station recorded by oskar_evaluate_jones_E().
+ * Stations that have not been interpolated have an error estimate of zero.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_station_work_beam_interp_error(oskar_StationWork* work);
+
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
 
+/**
+ * @brief Returns the work buffer for a concurrent task.
+ *
+ * @details
+ * Returns the work buffer structure owned by \p work for the given task
+ * index, creating it if necessary. This is used to evaluate the beams of
+ * child stations concurrently, where each task needs its own scratch arrays.
+ *
+ * This function must not be called concurrently for the same \p work.
+ *
+ * @param[in,out] work    Pointer to work buffer structure.
+ * @param[in] task        Task index (typically the thread index).
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+oskar_StationWork* oskar_station_work_task(oskar_StationWork* work,
+        int task, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -73,11 +73,14 @@ struct oskar_Station
     int normalise_array_pattern;  /* True if the array pattern should be normalised by the number of antennas. */
     int normalise_element_pattern;/* True if the element patterns should be normalised. */
     int enable_array_pattern;     /* True if the array factor should be evaluated. */
+    double array_pattern_nufft_accuracy; /* Accuracy of NUFFT used for large array patterns (0 to disable). */
     int common_element_orientation; /* True if elements share a common orientation (auto determined). */
     int common_pol_beams;         /* True if beams for both polarisations can be formed in the same way (auto determined). */
     int swap_xy;                  /* True if the X and Y antennas should be swapped in the output. */
     int array_is_3d;              /* True if array is 3-dimensional (auto determined; default false). */
+    double max_radius_m;          /* Maximum distance of any element from the station centre, in metres (auto determined). */
     int apply_element_errors;     /* True if element gain and phase errors should be applied (auto determined; default false). */
+    int time_variable_errors;     /* True if element errors vary with time (auto determined; default false). */
     int apply_element_weight;     /* True if weights should be modified by user-supplied complex beamforming weights (auto determined; default false). */
     unsigned int seed_time_variable_errors;       /* Seed for time variable errors. */
     oskar_Mem* element_true_enu_metres[2][3];     /* True horizon element ENU coordinates, in metres. */
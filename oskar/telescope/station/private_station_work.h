@@ -31,6 +31,26 @@
 
 #include <mem/oskar_mem.h>
 
+/* Element weights evaluated for a station feed, and the inputs used. */
+struct WeightsCache
+{
+    const void* station;         /* Station the weights belong to. */
+    int time_index;              /* -1 if weights do not vary with time. */
+    double wavenumber, beam_x, beam_y, beam_z;
+    oskar_Mem* weights;          /* Complex scalar. */
+};
+typedef struct WeightsCache WeightsCache;
+
+/* Frequency-independent source coordinates evaluated for a station. */
+struct DirectionCache
+{
+    const void* station;         /* Station the coordinates belong to. */
+    int index;                   /* -1 for ENU directions, else element type. */
+    int num_points;
+    oskar_Mem* data[3];          /* Real scalar. (x, y, z) or (theta, phi). */
+};
+typedef struct DirectionCache DirectionCache;
+
 struct oskar_StationWork
 {
     oskar_Mem* weights;          /* Complex scalar. */
@@ -47,9 +67,24 @@ struct oskar_StationWork
     oskar_Mem* phi_y;            /* Real scalar. */
     oskar_Mem* beam_out_scratch; /* Output scratch array. */
 
+    /* Element weights, per station unique ID and feed. */
+    int num_weights_cache;
+    WeightsCache* weights_cache;
+
+    /* ENU source directions and element angles for each station,
+     * at one time. */
+    const void* direction_cache_source; /* Relative directions used. */
+    double direction_cache_gast;
+    size_t direction_cache_max_bytes;
+    int direction_cache_max_slots, num_direction_cache_used;
+    int num_direction_cache;
+    DirectionCache* direction_cache;
+
     /* TEC screen. */
     char screen_type;
-    int previous_time_index;
+    int screen_first_slice, screen_num_slices; /* Time slices in memory. */
+    int screen_time_end; /* One past the last time index in the block. */
+    size_t screen_max_buffer_bytes;
     int screen_num_pixels_x, screen_num_pixels_y, screen_num_pixels_t;
     double screen_height_km;
     double screen_pixel_size_m;
@@ -57,8 +92,23 @@ struct oskar_StationWork
     oskar_Mem *tec_screen_path, *tec_screen;
     oskar_Mem *screen_output;
 
+    /* Interpolated station beams. */
+    double beam_interp_tolerance;
+    oskar_Mem *interp_lmn_cpu[3];  /* Grid directions. */
+    oskar_Mem *interp_lmn[3];      /* Grid directions. */
+    oskar_Mem *interp_beam;        /* Beam on grid. */
+    oskar_Mem *interp_beam_cpu;    /* Beam on grid, in CPU memory. */
+    oskar_Mem *interp_coarse;      /* Beam on half-resolution grid. */
+    oskar_Mem *interp_check;       /* Beam at check points. */
+    oskar_Mem *interp_check_ref;   /* Reference beam at check points. */
+    oskar_Mem *beam_interp_error;  /* Maximum error estimate per station. */
+
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Work buffers for child stations evaluated concurrently. */
+    int num_tasks;
+    struct oskar_StationWork** task_work;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -147,11 +147,12 @@ static void evaluate_station_beam_relative_directions(oskar_Mem* beam_pattern,
     oskar_Mem *x, *y, *z; /* ENU direction cosines */
     if (*status) return;
 
-    /* ENU directions are needed for horizon clip in all cases */
-    x = oskar_station_work_enu_direction_x(work);
-    y = oskar_station_work_enu_direction_y(work);
-    z = oskar_station_work_enu_direction_z(work);
-    compute_enu_directions(x, y, z, np, l, m, n, station, GAST, status);
+    /* ENU directions are needed for horizon clip in all cases.
+     * They do not depend on frequency, so are computed only if not already
+     * cached in the work buffer for this station and time. */
+    if (!oskar_station_work_enu_directions(work, station, l, np, GAST,
+            &x, &y, &z, status))
+        compute_enu_directions(x, y, z, np, l, m, n, station, GAST, status);
 
     switch (oskar_station_type(station))
     {
@@ -29,19 +29,35 @@
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
-#include "telescope/station/oskar_station_evaluate_element_weights.h"
+#include "telescope/station/oskar_station_work.h"
 #include "telescope/station/element/oskar_element_evaluate.h"
+#include "telescope/station/element/oskar_element_evaluate_theta_phi.h"
+#include "convert/oskar_convert_enu_directions_to_theta_phi.h"
 #include "telescope/station/oskar_blank_below_horizon.h"
 #include "telescope/station/private_station_work.h"
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dftw.h"
+#include "math/oskar_dftw_nufft.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if !defined(OSKAR_OS_WIN)
+#include <unistd.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define MAX_CHUNK_SIZE 49152
+/* Scratch memory for a chunk of points in hierarchical stations. */
+#define DEFAULT_CACHE_SIZE (8 << 20)
+#define DEVICE_CHUNK_BYTES (256 << 20)
+#define MIN_CHUNK_SIZE 1024
+
+/* Minimum value of (elements * directions) to use the NUFFT. */
+#define NUFFT_THRESHOLD (1 << 20)
 
 static void oskar_evaluate_station_beam_aperture_array_private(
         const oskar_Station* s, oskar_StationWork* work, int offset_points,
@@ -49,6 +65,58 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         const oskar_Mem* z, int time_index, double gast, double frequency_hz,
         int depth, int offset_out, oskar_Mem* beam, int* status);
 
+static size_t cache_size(void)
+{
+    long size = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    if (size <= 0) size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return (size > 0) ? (size_t) size : DEFAULT_CACHE_SIZE;
+}
+
+static int num_tasks(const oskar_Mem* beam)
+{
+    int num_threads = 1;
+#ifdef _OPENMP
+    if (oskar_mem_location(beam) == OSKAR_CPU && !omp_in_parallel())
+        num_threads = omp_get_max_threads();
+#endif
+    return num_threads;
+}
+
+static int task_index(void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/* Returns the number of bytes of scratch memory needed per point. */
+static size_t scratch_bytes(const oskar_Station* s, size_t element_size,
+        int num_tasks)
+{
+    int i;
+    size_t bytes = 0;
+    const int num_elements = oskar_station_num_elements(s);
+    if (oskar_station_has_child(s))
+    {
+        const int identical = oskar_station_identical_children(s);
+        for (i = 0; i < (identical ? 1 : num_elements); ++i)
+        {
+            const size_t b = scratch_bytes(oskar_station_child_const(s, i),
+                    element_size, 1);
+            if (b > bytes) bytes = b;
+        }
+        if (!identical) bytes *= num_tasks;
+    }
+    return bytes + num_elements * element_size;
+}
+
 
 void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
         const oskar_Station* station, int num_points, const oskar_Mem* x,
@@ -65,12 +133,20 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
                 gast, frequency_hz, 0, 0, beam, status);
     else
     {
-        /* Split up list of input points into manageable chunks. */
-        int start;
-        for (start = 0; start < num_points; start += MAX_CHUNK_SIZE)
+        /* Split up list of input points into chunks, so that the scratch
+         * arrays for all levels fit in the cache on the CPU, or within
+         * a fixed memory budget on other devices. */
+        int start, max_chunk_size;
+        const size_t budget = oskar_mem_location(beam) == OSKAR_CPU ?
+                cache_size() : DEVICE_CHUNK_BYTES;
+        max_chunk_size = (int) (budget / scratch_bytes(station,
+                oskar_mem_element_size(oskar_mem_type(beam)),
+                num_tasks(beam)));
+        if (max_chunk_size < MIN_CHUNK_SIZE) max_chunk_size = MIN_CHUNK_SIZE;
+        for (start = 0; start < num_points; start += max_chunk_size)
         {
             int chunk_size = num_points - start;
-            if (chunk_size > MAX_CHUNK_SIZE) chunk_size = MAX_CHUNK_SIZE;
+            if (chunk_size > max_chunk_size) chunk_size = max_chunk_size;
 
             /* Start recursive call at depth 1 (depth 0 is element level). */
             oskar_evaluate_station_beam_aperture_array_private(station, work,
@@ -98,6 +174,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(
     const int norm_array    = oskar_station_normalise_array_pattern(s);
     const int norm_element  = oskar_station_normalise_element_pattern(s);
     const int num_elements  = oskar_station_num_elements(s);
+    const double nufft_acc  = oskar_station_array_pattern_nufft_accuracy(s);
     const int num_feeds     = (oskar_station_common_pol_beams(s) ||
             !oskar_mem_is_matrix(beam)) ? 1 : 2;
     theta = work->theta_modified;
@@ -115,18 +192,30 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         const int num_element_types = oskar_station_num_element_types(s);
         if (oskar_station_common_element_orientation(s))
         {
-            /* Evaluate element patterns for each element type. */
+            /* Evaluate element patterns for each element type.
+             * The element angles do not depend on frequency, so they are
+             * kept in the work buffer if the directions are cached. */
+            const double orientation_x =
+                    oskar_station_element_euler_index_rad(s, 0, 0, 0) + M_PI/2.0; /* FIXME Will change: This matches the old convention. */
+            const double orientation_y =
+                    oskar_station_element_euler_index_rad(s, 1, 0, 0);
             element_types_ptr = oskar_station_element_types_const(s);
             signal = oskar_station_work_beam(work, beam,
                     num_element_types * (num_points + 1), 0, status);
             for (i = 0; i < num_element_types; ++i)
-                oskar_element_evaluate(
+            {
+                if (!oskar_station_work_element_theta_phi(work, s, i, x,
+                        num_points, &theta, &phi_x, &phi_y, status))
+                    oskar_convert_enu_directions_to_theta_phi(offset_points,
+                            num_points, x, y, z, norm_element,
+                            (M_PI/2) - orientation_x, (M_PI/2) - orientation_y,
+                            theta, phi_x, phi_y, status);
+                oskar_element_evaluate_theta_phi(
                         oskar_station_element_const(s, i),
-                        norm_element, swap_xy,
-                        oskar_station_element_euler_index_rad(s, 0, 0, 0) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
-                        oskar_station_element_euler_index_rad(s, 1, 0, 0),
-                        offset_points, num_points, x, y, z, frequency_hz,
-                        theta, phi_x, phi_y, i * num_points, signal, status);
+                        norm_element, swap_xy, num_points,
+                        theta, phi_x, phi_y, frequency_hz,
+                        i * num_points, signal, status);
+            }
         }
         else
         {
@@ -152,20 +241,34 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         }
         if (oskar_station_enable_array_pattern(s))
         {
+            /* Use the NUFFT for large 2D arrays on the CPU, if enabled. */
+            const int use_nufft = nufft_acc > 0.0 && element_types_ptr &&
+                    !is_3d && oskar_mem_location(beam) == OSKAR_CPU &&
+                    (double) num_elements * num_points >= NUFFT_THRESHOLD;
             for (i = 0; i < num_feeds; ++i)
             {
                 const int eval_x = (i == 0 || num_feeds == 1) ? 1 : 0;
                 const int eval_y = (i == 1 || num_feeds == 1) ? 1 : 0;
-                oskar_station_evaluate_element_weights(s, i, wavenumber,
-                        beam_x, beam_y, beam_z, time_index,
-                        work->weights, work->weights_scratch, status);
-                oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
-                        oskar_station_element_true_enu_metres_const(s, i, 0),
-                        oskar_station_element_true_enu_metres_const(s, i, 1),
-                        oskar_station_element_true_enu_metres_const(s, i, 2),
-                        offset_points, num_points, x, y, (is_3d ? z : 0),
-                        element_types_ptr, signal, eval_x, eval_y,
-                        offset_out, beam, status);
+                const oskar_Mem* weights = oskar_station_work_element_weights(
+                        work, s, i, wavenumber, beam_x, beam_y, beam_z,
+                        time_index, status);
+                if (use_nufft)
+                    oskar_dftw_nufft(norm_array, num_elements, wavenumber,
+                            weights,
+                            oskar_station_element_true_enu_metres_const(s, i, 0),
+                            oskar_station_element_true_enu_metres_const(s, i, 1),
+                            offset_points, num_points, x, y,
+                            element_types_ptr, signal, eval_x, eval_y,
+                            offset_out, beam, nufft_acc, status);
+                else
+                    oskar_dftw(norm_array, num_elements, wavenumber,
+                            weights,
+                            oskar_station_element_true_enu_metres_const(s, i, 0),
+                            oskar_station_element_true_enu_metres_const(s, i, 1),
+                            oskar_station_element_true_enu_metres_const(s, i, 2),
+                            offset_points, num_points, x, y, (is_3d ? z : 0),
+                            element_types_ptr, signal, eval_x, eval_y,
+                            offset_out, beam, status);
             }
         }
         else
@@ -204,20 +307,49 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         }
         else
         {
-            for (i = 0; i < num_elements; ++i)
-                oskar_evaluate_station_beam_aperture_array_private(
-                        oskar_station_child_const(s, i), work, offset_points,
-                        num_points, x, y, z, time_index, gast, frequency_hz,
-                        depth + 1, i * num_points, signal, status);
+            /* Evaluate non-identical child stations concurrently on the CPU,
+             * each task using its own work buffers. */
+            const int num_threads = num_tasks(signal);
+            if (num_threads > 1 && num_elements > 1)
+            {
+                for (i = 0; i < num_threads; ++i)
+                    oskar_station_work_task(work, i, status);
+                if (*status) return;
+#pragma omp parallel for schedule(static)
+                for (i = 0; i < num_elements; ++i)
+                {
+                    int task_status = 0;
+                    oskar_evaluate_station_beam_aperture_array_private(
+                            oskar_station_child_const(s, i),
+                            work->task_work[task_index()], offset_points,
+                            num_points, x, y, z, time_index, gast,
+                            frequency_hz, depth + 1, i * num_points, signal,
+                            &task_status);
+                    if (task_status)
+                    {
+#pragma omp critical (station_beam_status)
+                        *status = task_status;
+                    }
+                }
+            }
+            else
+            {
+                for (i = 0; i < num_elements; ++i)
+                    oskar_evaluate_station_beam_aperture_array_private(
+                            oskar_station_child_const(s, i), work,
+                            offset_points, num_points, x, y, z, time_index,
+                            gast, frequency_hz, depth + 1, i * num_points,
+                            signal, status);
+            }
         }
         for (i = 0; i < num_feeds; ++i)
         {
             const int eval_x = (i == 0 || num_feeds == 1) ? 1 : 0;
             const int eval_y = (i == 1 || num_feeds == 1) ? 1 : 0;
-            oskar_station_evaluate_element_weights(s, i, wavenumber,
-                    beam_x, beam_y, beam_z, time_index,
-                    work->weights, work->weights_scratch, status);
-            oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
+            const oskar_Mem* weights = oskar_station_work_element_weights(
+                    work, s, i, wavenumber, beam_x, beam_y, beam_z,
+                    time_index, status);
+            oskar_dftw(norm_array, num_elements, wavenumber, weights,
                     oskar_station_element_true_enu_metres_const(s, i, 0),
                     oskar_station_element_true_enu_metres_const(s, i, 1),
                     oskar_station_element_true_enu_metres_const(s, i, 2),
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/oskar_evaluate_station_beam.h"
+#include "telescope/station/oskar_evaluate_station_beam_interp.h"
+#include "telescope/station/private_station_work.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_interpolate_grid_bicubic.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_REFINEMENTS 4
+#define MIN_GRID_SIZE 8
+
+static double estimate_error(int num_x, int num_y, double x0, double y0,
+        double h, oskar_StationWork* work, int* status);
+static double subsampled_error(int step, int num_x, int num_y,
+        double x0, double y0, double h, const oskar_Mem* fine,
+        oskar_StationWork* work, int* status);
+static void set_direction(oskar_Mem* const lmn[3], int i, double l, double m);
+static void get_mem(oskar_Mem** b, int type, int location, size_t length,
+        int* status);
+
+void oskar_evaluate_station_beam_interp(int num_points,
+        oskar_Mem* l, oskar_Mem* m, oskar_Mem* n, const double lm_range[4],
+        double norm_ra_rad, double norm_dec_rad, const oskar_Station* station,
+        oskar_StationWork* work, int time_index, double frequency_hz,
+        double GAST, int offset_out, oskar_Mem* beam,
+        double* error_estimate, int* status)
+{
+    int i, j, refine;
+    if (*status) return;
+    *error_estimate = 0.0;
+    const double tol = work->beam_interp_tolerance;
+    const double radius_m = oskar_station_max_radius_m(station);
+    const int location = oskar_mem_location(beam);
+    if (tol > 0.0 && radius_m > 0.0 && work->screen_type == 'N' &&
+            oskar_station_type(station) == OSKAR_STATION_TYPE_AA)
+    {
+        /* The interpolation error for the highest spatial frequency
+         * in the beam scales as (k R h)^3, for wavenumber k, station
+         * radius R and grid spacing h. Start with a coarse grid,
+         * and halve the spacing until the error is small enough. */
+        const double wavenumber = 2.0 * M_PI * frequency_hz / 299792458.0;
+        double h = 8.0 * cbrt(tol) / (wavenumber * radius_m);
+        for (refine = 0; refine <= MAX_REFINEMENTS; ++refine, h *= 0.5)
+        {
+            /* Check the grid is worth using. The grid has one extra point
+             * before and two after the range of directions in each axis. */
+            double num_x_d = 4.0 + ceil((lm_range[1] - lm_range[0]) / h);
+            double num_y_d = 4.0 + ceil((lm_range[3] - lm_range[2]) / h);
+            if (num_x_d < MIN_GRID_SIZE) num_x_d = MIN_GRID_SIZE;
+            if (num_y_d < MIN_GRID_SIZE) num_y_d = MIN_GRID_SIZE;
+            if (num_x_d * num_y_d >= num_points) break;
+            const int num_x = (int) num_x_d, num_y = (int) num_y_d;
+            const int num_grid = num_x * num_y;
+            const double x0 = lm_range[0] - h, y0 = lm_range[2] - h;
+
+            /* Generate the grid directions. */
+            oskar_Mem** lmn = work->interp_lmn_cpu;
+            for (i = 0; i < 3; ++i)
+                oskar_mem_ensure(lmn[i], (size_t) (num_grid + 1), status);
+            if (*status) return;
+            for (j = 0; j < num_y; ++j)
+                for (i = 0; i < num_x; ++i)
+                    set_direction(lmn, j * num_x + i, x0 + i * h, y0 + j * h);
+            if (location != OSKAR_CPU)
+            {
+                for (i = 0; i < 3; ++i)
+                    oskar_mem_copy(work->interp_lmn[i], lmn[i], status);
+                lmn = work->interp_lmn;
+            }
+
+            /* Evaluate the beam on the grid, and estimate the error. */
+            get_mem(&work->interp_beam, oskar_mem_type(beam), location,
+                    (size_t) num_grid, status);
+            oskar_evaluate_station_beam(num_grid, OSKAR_RELATIVE_DIRECTIONS,
+                    lmn[0], lmn[1], lmn[2], norm_ra_rad, norm_dec_rad,
+                    station, work, time_index, frequency_hz, GAST,
+                    0, work->interp_beam, status);
+            const double error = estimate_error(num_x, num_y, x0, y0, h,
+                    work, status);
+            if (*status) return;
+
+            /* Interpolate at all points if the error is small enough. */
+            if (error <= tol)
+            {
+                oskar_interpolate_grid_bicubic(num_x, num_y, x0, y0, h, h,
+                        work->interp_beam, num_points, l, m,
+                        offset_out, beam, status);
+                *error_estimate = error;
+                return;
+            }
+        }
+    }
+
+    /* Otherwise, evaluate the beam directly. */
+    oskar_evaluate_station_beam(num_points, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, norm_ra_rad, norm_dec_rad, station, work,
+            time_index, frequency_hz, GAST, offset_out, beam, status);
+}
+
+/* Estimates the interpolation error on the grid with spacing h.
+ *
+ * Catmull-Rom interpolation is third-order accurate, so for a smooth beam
+ * the error scales as h^3, and halving the spacing divides it by 8.
+ * The error at spacing 2h is measured by interpolating from every second
+ * grid point to the others, and the error at spacing 4h is measured in the
+ * same way using every fourth point. Their ratio is the reduction actually
+ * achieved by halving the spacing, so the error at spacing h is estimated
+ * as the error at 2h divided by this ratio. The ratio is limited to the
+ * range 1 to 8: it is smaller than 8 when the grid is too coarse to
+ * resolve the beam, or near the horizon, where the beam is not smooth,
+ * and the estimate is then more conservative. If the grid is too small
+ * to measure the error at 4h, the error at 2h is used as the estimate. */
+static double estimate_error(int num_x, int num_y, double x0, double y0,
+        double h, oskar_StationWork* work, int* status)
+{
+    if (*status) return 0.0;
+
+    /* Copy the grid to CPU memory if required. */
+    const oskar_Mem* fine = work->interp_beam;
+    const int type = oskar_mem_type(fine);
+    if (oskar_mem_location(fine) != OSKAR_CPU)
+    {
+        get_mem(&work->interp_beam_cpu, type, OSKAR_CPU,
+                (size_t) (num_x * num_y), status);
+        oskar_mem_copy_contents(work->interp_beam_cpu, fine, 0, 0,
+                (size_t) (num_x * num_y), status);
+        fine = work->interp_beam_cpu;
+    }
+    const double err_2h = subsampled_error(2, num_x, num_y, x0, y0, h,
+            fine, work, status);
+    if (err_2h <= 0.0 || *status) return 0.0;
+    const double err_4h = subsampled_error(4, num_x, num_y, x0, y0, h,
+            fine, work, status);
+    double ratio = err_4h / err_2h;
+    if (!(ratio >= 1.0)) ratio = 1.0;
+    if (ratio > 8.0) ratio = 8.0;
+    return err_2h / ratio;
+}
+
+/* Returns the largest error from interpolating the grid using every
+ * step-th point to the other grid points that are inside the range of
+ * directions and above the horizon, or -1 if there are no such points. */
+static double subsampled_error(int step, int num_x, int num_y,
+        double x0, double y0, double h, const oskar_Mem* fine,
+        oskar_StationWork* work, int* status)
+{
+    int i, j, num_check = 0;
+    double max_err = 0.0;
+    const int type = oskar_mem_type(fine);
+    const int is_dbl = oskar_mem_is_double(fine);
+    const int num_x_coarse = (num_x + step - 1) / step;
+    const int num_y_coarse = (num_y + step - 1) / step;
+    const int i_max = step * (num_x_coarse - 2) - 1 < num_x - 3 ?
+            step * (num_x_coarse - 2) - 1 : num_x - 3;
+    const int j_max = step * (num_y_coarse - 2) - 1 < num_y - 3 ?
+            step * (num_y_coarse - 2) - 1 : num_y - 3;
+    const size_t element_size = oskar_mem_element_size(type);
+    const int num_comp = oskar_mem_is_matrix(fine) ? 8 : 2;
+    if (num_x_coarse < 4 || num_y_coarse < 4) return -1.0;
+
+    /* Extract the coarse grid. */
+    get_mem(&work->interp_coarse, type, OSKAR_CPU,
+            (size_t) (num_x_coarse * num_y_coarse), status);
+    get_mem(&work->interp_check_ref, type, OSKAR_CPU,
+            (size_t) (num_x * num_y), status);
+    if (*status) return -1.0;
+    const char* fine_ = (const char*) oskar_mem_void_const(fine);
+    char* coarse_ = (char*) oskar_mem_void(work->interp_coarse);
+    char* ref_ = (char*) oskar_mem_void(work->interp_check_ref);
+    for (j = 0; j < num_y_coarse; ++j)
+        for (i = 0; i < num_x_coarse; ++i)
+            memcpy(coarse_ + (j * num_x_coarse + i) * element_size,
+                    fine_ + (step * (j * num_x + i)) * element_size,
+                    element_size);
+
+    /* Get the check point coordinates and the reference values.
+     * The grid coordinate arrays are no longer needed, so use them. */
+    oskar_Mem* check_x = work->interp_lmn_cpu[0];
+    oskar_Mem* check_y = work->interp_lmn_cpu[1];
+    double* check_x_d = is_dbl ? oskar_mem_double(check_x, status) : 0;
+    double* check_y_d = is_dbl ? oskar_mem_double(check_y, status) : 0;
+    float* check_x_f = is_dbl ? 0 : oskar_mem_float(check_x, status);
+    float* check_y_f = is_dbl ? 0 : oskar_mem_float(check_y, status);
+    if (*status) return -1.0;
+    for (j = step; j <= j_max; ++j)
+    {
+        for (i = step; i <= i_max; ++i)
+        {
+            const double x = x0 + i * h, y = y0 + j * h;
+            if ((i % step == 0 && j % step == 0) || x * x + y * y > 1.0)
+                continue;
+            memcpy(ref_ + num_check * element_size,
+                    fine_ + (j * num_x + i) * element_size, element_size);
+            if (is_dbl)
+            {
+                check_x_d[num_check] = x;
+                check_y_d[num_check] = y;
+            }
+            else
+            {
+                check_x_f[num_check] = (float) x;
+                check_y_f[num_check] = (float) y;
+            }
+            num_check++;
+        }
+    }
+    if (num_check == 0) return -1.0;
+
+    /* Interpolate from the coarse grid and compare. */
+    get_mem(&work->interp_check, type, OSKAR_CPU, (size_t) num_check, status);
+    oskar_interpolate_grid_bicubic(num_x_coarse, num_y_coarse, x0, y0,
+            step * h, step * h, work->interp_coarse, num_check,
+            check_x, check_y, 0, work->interp_check, status);
+    if (*status) return -1.0;
+    const double* a_d = is_dbl ?
+            oskar_mem_double_const(work->interp_check, status) : 0;
+    const double* b_d = is_dbl ?
+            oskar_mem_double_const(work->interp_check_ref, status) : 0;
+    const float* a_f = is_dbl ?
+            0 : oskar_mem_float_const(work->interp_check, status);
+    const float* b_f = is_dbl ?
+            0 : oskar_mem_float_const(work->interp_check_ref, status);
+    for (i = 0; i < num_check * num_comp; i += 2)
+    {
+        double re, im;
+        if (is_dbl)
+        {
+            re = a_d[i] - b_d[i];
+            im = a_d[i + 1] - b_d[i + 1];
+        }
+        else
+        {
+            re = a_f[i] - b_f[i];
+            im = a_f[i + 1] - b_f[i + 1];
+        }
+        const double err = sqrt(re * re + im * im);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+static void set_direction(oskar_Mem* const lmn[3], int i, double l, double m)
+{
+    /* Directions beyond the horizon are moved onto it,
+     * to extend the beam smoothly outside the unit circle. */
+    double n = 0.0;
+    const double r2 = l * l + m * m;
+    if (r2 < 1.0)
+        n = sqrt(1.0 - r2);
+    else
+    {
+        const double r = sqrt(r2);
+        l /= r;
+        m /= r;
+    }
+    if (oskar_mem_precision(lmn[0]) == OSKAR_DOUBLE)
+    {
+        ((double*) oskar_mem_void(lmn[0]))[i] = l;
+        ((double*) oskar_mem_void(lmn[1]))[i] = m;
+        ((double*) oskar_mem_void(lmn[2]))[i] = n;
+    }
+    else
+    {
+        ((float*) oskar_mem_void(lmn[0]))[i] = (float) l;
+        ((float*) oskar_mem_void(lmn[1]))[i] = (float) m;
+        ((float*) oskar_mem_void(lmn[2]))[i] = (float) n;
+    }
+}
+
+static void get_mem(oskar_Mem** b, int type, int location, size_t length,
+        int* status)
+{
+    if (*b && (oskar_mem_type(*b) != type ||
+            oskar_mem_location(*b) != location))
+    {
+        oskar_mem_free(*b, status);
+        *b = 0;
+    }
+    if (!*b)
+        *b = oskar_mem_create(type, location, length, status);
+    else
+        oskar_mem_ensure(*b, length, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
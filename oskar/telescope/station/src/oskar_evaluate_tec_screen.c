@@ -49,6 +49,7 @@ void oskar_evaluate_tec_screen(
         double screen_pixel_size_m,
         int screen_num_pixels_x,
         int screen_num_pixels_y,
+        int offset_screen,
         const oskar_Mem* tec_screen,
         int offset_out,
         oskar_Mem* out,
@@ -72,7 +73,7 @@ void oskar_evaluate_tec_screen(
                     oskar_mem_float_const(m, status),
                     station_u_f, station_v_f, inv_freq_hz_f,
                     screen_height_m_f, inv_pixel_size_m_f,
-                    screen_num_pixels_x, screen_num_pixels_y,
+                    screen_num_pixels_x, screen_num_pixels_y, offset_screen,
                     oskar_mem_float_const(tec_screen, status), offset_out,
                     oskar_mem_float2(out, status));
         }
@@ -83,7 +84,7 @@ void oskar_evaluate_tec_screen(
                     oskar_mem_double_const(m, status),
                     station_u_m, station_v_m, inv_freq_hz,
                     screen_height_m, inv_pixel_size_m,
-                    screen_num_pixels_x, screen_num_pixels_y,
+                    screen_num_pixels_x, screen_num_pixels_y, offset_screen,
                     oskar_mem_double_const(tec_screen, status), offset_out,
                     oskar_mem_double2(out, status));
         }
@@ -125,6 +126,7 @@ void oskar_evaluate_tec_screen(
                         (const void*)&inv_pixel_size_m_f},
                 {INT_SZ, &screen_num_pixels_x},
                 {INT_SZ, &screen_num_pixels_y},
+                {INT_SZ, &offset_screen},
                 {PTR_SZ, oskar_mem_buffer_const(tec_screen)},
                 {INT_SZ, &offset_out},
                 {PTR_SZ, oskar_mem_buffer(out)}
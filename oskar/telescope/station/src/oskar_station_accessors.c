@@ -180,6 +180,11 @@ int oskar_station_enable_array_pattern(const oskar_Station* model)
     return model ? model->enable_array_pattern : 0;
 }
 
+double oskar_station_array_pattern_nufft_accuracy(const oskar_Station* model)
+{
+    return model ? model->array_pattern_nufft_accuracy : 0.0;
+}
+
 int oskar_station_common_element_orientation(const oskar_Station* model)
 {
     return model ? model->common_element_orientation : 0;
@@ -195,11 +200,32 @@ int oskar_station_array_is_3d(const oskar_Station* model)
     return model ? model->array_is_3d : 0;
 }
 
+double oskar_station_max_radius_m(const oskar_Station* model)
+{
+    int i;
+    double child_radius = 0.0;
+    if (!model) return 0.0;
+    if (model->child)
+    {
+        for (i = 0; i < model->num_elements; ++i)
+        {
+            const double r = oskar_station_max_radius_m(model->child[i]);
+            if (r > child_radius) child_radius = r;
+        }
+    }
+    return model->max_radius_m + child_radius;
+}
+
 int oskar_station_apply_element_errors(const oskar_Station* model)
 {
     return model ? model->apply_element_errors : 0;
 }
 
+int oskar_station_time_variable_errors(const oskar_Station* model)
+{
+    return model ? model->time_variable_errors : 0;
+}
+
 int oskar_station_apply_element_weight(const oskar_Station* model)
 {
     return model ? model->apply_element_weight : 0;
@@ -550,6 +576,13 @@ void oskar_station_set_enable_array_pattern(oskar_Station* model, int value)
     model->enable_array_pattern = value;
 }
 
+void oskar_station_set_array_pattern_nufft_accuracy(oskar_Station* model,
+        double value)
+{
+    if (!model) return;
+    model->array_pattern_nufft_accuracy = value;
+}
+
 void oskar_station_set_seed_time_variable_errors(oskar_Station* model,
         unsigned int value)
 {
@@ -29,6 +29,7 @@
 #include "telescope/station/private_station.h"
 #include "telescope/station/oskar_station.h"
 
+#include <math.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -53,9 +54,11 @@ void oskar_station_analyse(oskar_Station* station,
     /* Set default station flags. */
     station->array_is_3d = 0;
     station->apply_element_errors = 0;
+    station->time_variable_errors = 0;
     station->apply_element_weight = 0;
     station->common_element_orientation = 1;
     station->common_pol_beams = 1;
+    station->max_radius_m = 0.0;
 
     /* Check orientations in both polarisations. */
     for (feed = 0; feed < 2; feed++)
@@ -104,8 +107,13 @@ void oskar_station_analyse(oskar_Station* station,
     {
         if (type == OSKAR_DOUBLE)
         {
-            double *z_true, *z_meas, *amp, *amp_err, *phase, *phase_err;
+            double *x_true, *y_true, *z_true, *z_meas;
+            double *amp, *amp_err, *phase, *phase_err;
             double2 *weights;
+            x_true    = (double*) oskar_mem_void(
+                    oskar_station_element_true_enu_metres(station, feed, 0));
+            y_true    = (double*) oskar_mem_void(
+                    oskar_station_element_true_enu_metres(station, feed, 1));
             z_true    = (double*) oskar_mem_void(
                     oskar_station_element_true_enu_metres(station, feed, 2));
             z_meas    = (double*) oskar_mem_void(
@@ -130,6 +138,13 @@ void oskar_station_analyse(oskar_Station* station,
                 }
             }
             for (i = 0; i < num_elements; ++i)
+            {
+                const double r = sqrt(x_true[i] * x_true[i] +
+                        y_true[i] * y_true[i] + z_true[i] * z_true[i]);
+                if (r > station->max_radius_m) station->max_radius_m = r;
+            }
+            /* Static gain and phase offsets do not change with time. */
+            for (i = 0; i < num_elements; ++i)
             {
                 if (amp[i] != 1.0 || phase[i] != 0.0)
                 {
@@ -137,11 +152,13 @@ void oskar_station_analyse(oskar_Station* station,
                     break;
                 }
             }
+            /* Random errors are generated again at each time index. */
             for (i = 0; i < num_elements; ++i)
             {
                 if (amp_err[i] != 0.0 || phase_err[i] != 0.0)
                 {
                     station->apply_element_errors = 1;
+                    station->time_variable_errors = 1;
                     *finished_identical_station_check = 1;
                     break;
                 }
@@ -157,8 +174,13 @@ void oskar_station_analyse(oskar_Station* station,
         }
         else if (type == OSKAR_SINGLE)
         {
-            float *z_true, *z_meas, *amp, *amp_err, *phase, *phase_err;
+            float *x_true, *y_true, *z_true, *z_meas;
+            float *amp, *amp_err, *phase, *phase_err;
             float2 *weights;
+            x_true    = (float*) oskar_mem_void(
+                    oskar_station_element_true_enu_metres(station, feed, 0));
+            y_true    = (float*) oskar_mem_void(
+                    oskar_station_element_true_enu_metres(station, feed, 1));
             z_true    = (float*) oskar_mem_void(
                     oskar_station_element_true_enu_metres(station, feed, 2));
             z_meas    = (float*) oskar_mem_void(
@@ -183,6 +205,13 @@ void oskar_station_analyse(oskar_Station* station,
                 }
             }
             for (i = 0; i < num_elements; ++i)
+            {
+                const double r = sqrt(x_true[i] * x_true[i] +
+                        y_true[i] * y_true[i] + z_true[i] * z_true[i]);
+                if (r > station->max_radius_m) station->max_radius_m = r;
+            }
+            /* Static gain and phase offsets do not change with time. */
+            for (i = 0; i < num_elements; ++i)
             {
                 if (amp[i] != 1.0 || phase[i] != 0.0)
                 {
@@ -190,11 +219,13 @@ void oskar_station_analyse(oskar_Station* station,
                     break;
                 }
             }
+            /* Random errors are generated again at each time index. */
             for (i = 0; i < num_elements; ++i)
             {
                 if (amp_err[i] != 0.0 || phase_err[i] != 0.0)
                 {
                     station->apply_element_errors = 1;
+                    station->time_variable_errors = 1;
                     *finished_identical_station_check = 1;
                     break;
                 }
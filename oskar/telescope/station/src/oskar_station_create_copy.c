@@ -47,6 +47,18 @@ extern "C" {
 
 oskar_Station* oskar_station_create_copy(const oskar_Station* src,
         int location, int* status)
+{
+    int num_element_copies = 0;
+    oskar_Element** element_copies = 0;
+    oskar_Station* dst = oskar_station_create_copy_shared(src, location,
+            &num_element_copies, &element_copies, status);
+    free(element_copies);
+    return dst;
+}
+
+oskar_Station* oskar_station_create_copy_shared(const oskar_Station* src,
+        int location, int* num_element_copies,
+        oskar_Element*** element_copies, int* status)
 {
     int i, feed, dim;
     oskar_Station* dst = 0;
@@ -86,10 +98,13 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
     dst->normalise_array_pattern = src->normalise_array_pattern;
     dst->normalise_element_pattern = src->normalise_element_pattern;
     dst->enable_array_pattern = src->enable_array_pattern;
+    dst->array_pattern_nufft_accuracy = src->array_pattern_nufft_accuracy;
     dst->common_element_orientation = src->common_element_orientation;
     dst->common_pol_beams = src->common_pol_beams;
     dst->array_is_3d = src->array_is_3d;
+    dst->max_radius_m = src->max_radius_m;
     dst->apply_element_errors = src->apply_element_errors;
+    dst->time_variable_errors = src->time_variable_errors;
     dst->apply_element_weight = src->apply_element_weight;
     dst->seed_time_variable_errors = src->seed_time_variable_errors;
     dst->swap_xy = src->swap_xy;
@@ -131,7 +146,8 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
         /* Copy the element model data. */
         for (i = 0; i < src->num_element_types; ++i)
         {
-            oskar_element_copy(dst->element[i], src->element[i], status);
+            oskar_element_copy_shared(dst->element[i], src->element[i],
+                    num_element_copies, element_copies, status);
         }
     }
 
@@ -148,8 +164,9 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
 
         for (i = 0; i < src->num_elements; ++i)
         {
-            dst->child[i] = oskar_station_create_copy(
-                    oskar_station_child_const(src, i), location, status);
+            dst->child[i] = oskar_station_create_copy_shared(
+                    oskar_station_child_const(src, i), location,
+                    num_element_copies, element_copies, status);
         }
     }
 
@@ -59,10 +59,12 @@ int oskar_station_different(const oskar_Station* a, const oskar_Station* b,
             a->normalise_array_pattern != b->normalise_array_pattern ||
             a->normalise_element_pattern != b->normalise_element_pattern ||
             a->enable_array_pattern != b->enable_array_pattern ||
+            a->array_pattern_nufft_accuracy != b->array_pattern_nufft_accuracy ||
             a->common_element_orientation != b->common_element_orientation ||
             a->common_pol_beams != b->common_pol_beams ||
             a->array_is_3d != b->array_is_3d ||
             a->apply_element_errors != b->apply_element_errors ||
+            a->time_variable_errors != b->time_variable_errors ||
             a->apply_element_weight != b->apply_element_weight ||
             a->gaussian_beam_fwhm_rad != b->gaussian_beam_fwhm_rad ||
             a->gaussian_beam_reference_freq_hz != b->gaussian_beam_reference_freq_hz ||
@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <math.h>
 #include <stdlib.h>
 
 #include "telescope/station/private_station.h"
@@ -56,6 +57,11 @@ void oskar_station_set_element_coords(oskar_Station* station, int feed,
         num_dim = 3;
     }
 
+    /* Update the maximum element distance from the station centre. */
+    const double r = sqrt(true_enu[0] * true_enu[0] +
+            true_enu[1] * true_enu[1] + true_enu[2] * true_enu[2]);
+    if (r > station->max_radius_m) station->max_radius_m = r;
+
     const int type = station->precision;
     const int loc = station->mem_location;
     for (dim = 0; dim < num_dim; dim++)
@@ -29,7 +29,9 @@
 #include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 #include "telescope/station/oskar_evaluate_tec_screen.h"
+#include "telescope/station/oskar_station_evaluate_element_weights.h"
 
+#include <limits.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -42,6 +44,7 @@ static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
 oskar_StationWork* oskar_station_work_create(int type,
         int location, int* status)
 {
+    int i;
     oskar_StationWork* work;
     work = (oskar_StationWork*) calloc(1, sizeof(oskar_StationWork));
     if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
@@ -63,7 +66,15 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->tec_screen_path = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, status);
     work->screen_output = oskar_mem_create(complex_type, location, 0, status);
     work->screen_type = 'N'; /* None */
-    work->previous_time_index = -1;
+    work->screen_max_buffer_bytes = (size_t) 256 << 20;
+    work->direction_cache_max_bytes = (size_t) 256 << 20;
+    for (i = 0; i < 3; ++i)
+    {
+        work->interp_lmn_cpu[i] = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        work->interp_lmn[i] = oskar_mem_create(type, location, 0, status);
+    }
+    work->beam_interp_error = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            0, status);
     return work;
 }
 
@@ -82,11 +93,36 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->enu_direction_y, status);
     oskar_mem_free(work->enu_direction_z, status);
     oskar_mem_free(work->beam_out_scratch, status);
+    for (i = 0; i < work->num_weights_cache; ++i)
+        oskar_mem_free(work->weights_cache[i].weights, status);
+    free(work->weights_cache);
+    for (i = 0; i < work->num_direction_cache; ++i)
+    {
+        oskar_mem_free(work->direction_cache[i].data[0], status);
+        oskar_mem_free(work->direction_cache[i].data[1], status);
+        oskar_mem_free(work->direction_cache[i].data[2], status);
+    }
+    free(work->direction_cache);
     oskar_mem_free(work->tec_screen, status);
     oskar_mem_free(work->tec_screen_path, status);
     oskar_mem_free(work->screen_output, status);
+    for (i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(work->interp_lmn_cpu[i], status);
+        oskar_mem_free(work->interp_lmn[i], status);
+    }
+    oskar_mem_free(work->interp_beam, status);
+    oskar_mem_free(work->interp_beam_cpu, status);
+    oskar_mem_free(work->interp_coarse, status);
+    oskar_mem_free(work->interp_check, status);
+    oskar_mem_free(work->interp_check_ref, status);
+    oskar_mem_free(work->beam_interp_error, status);
     for (i = 0; i < work->num_depths; ++i)
         oskar_mem_free(work->beam[i], status);
+    free(work->beam);
+    for (i = 0; i < work->num_tasks; ++i)
+        oskar_station_work_free(work->task_work[i], status);
+    free(work->task_work);
     free(work);
 }
 
@@ -115,6 +151,161 @@ oskar_Mem* oskar_station_work_enu_direction_z(oskar_StationWork* work)
     return work->enu_direction_z;
 }
 
+void oskar_station_work_set_direction_cache_max(oskar_StationWork* work,
+        size_t max_bytes)
+{
+    work->direction_cache_max_bytes = max_bytes;
+}
+
+void oskar_station_work_set_direction_cache(oskar_StationWork* work,
+        const oskar_Mem* l, int num_points, double gast, int* status)
+{
+    int i, j, max_slots = 0;
+    if (*status) return;
+    if (l && num_points > 0)
+    {
+        /* Allow for the extra points used to normalise the beams. */
+        const size_t slot_bytes = 3 * (size_t) (num_points + 2) *
+                oskar_mem_element_size(oskar_mem_type(work->enu_direction_x));
+        const size_t slots = work->direction_cache_max_bytes / slot_bytes;
+        max_slots = slots > INT_MAX ? INT_MAX : (int) slots;
+    }
+
+    /* Free the slots beyond the memory limit, and discard the others. */
+    for (i = max_slots; i < work->num_direction_cache; ++i)
+        for (j = 0; j < 3; ++j)
+            oskar_mem_free(work->direction_cache[i].data[j], status);
+    if (work->num_direction_cache > max_slots)
+        work->num_direction_cache = max_slots;
+    for (i = 0; i < work->num_direction_cache; ++i)
+        work->direction_cache[i].station = 0;
+    work->num_direction_cache_used = 0;
+    work->direction_cache_max_slots = max_slots;
+    work->direction_cache_source = max_slots > 0 ? l : 0;
+    work->direction_cache_gast = gast;
+}
+
+static DirectionCache* find_direction_cache(oskar_StationWork* work,
+        const void* station, int index, int num_points)
+{
+    int i;
+    for (i = 0; i < work->num_direction_cache_used; ++i)
+    {
+        DirectionCache* c = &work->direction_cache[i];
+        if (c->station == station && c->index == index &&
+                c->num_points == num_points)
+            return c;
+    }
+    return 0;
+}
+
+static DirectionCache* new_direction_cache(oskar_StationWork* work,
+        const void* station, int index, int num_points, size_t length,
+        int* status)
+{
+    int i;
+    DirectionCache* c;
+    if (*status) return 0;
+    if (work->num_direction_cache_used >= work->direction_cache_max_slots)
+        return 0;
+    if (work->num_direction_cache_used == work->num_direction_cache)
+    {
+        DirectionCache* new_cache = (DirectionCache*) realloc(
+                work->direction_cache,
+                (work->num_direction_cache + 1) * sizeof(DirectionCache));
+        if (!new_cache)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        work->direction_cache = new_cache;
+        c = &work->direction_cache[work->num_direction_cache++];
+        c->station = 0;
+        for (i = 0; i < 3; ++i)
+            c->data[i] = oskar_mem_create(
+                    oskar_mem_type(work->enu_direction_x),
+                    oskar_mem_location(work->enu_direction_x), 0, status);
+    }
+    c = &work->direction_cache[work->num_direction_cache_used];
+    for (i = 0; i < 3; ++i)
+        oskar_mem_realloc(c->data[i], length, status);
+    if (*status) return 0;
+    work->num_direction_cache_used++;
+    c->station = station;
+    c->index = index;
+    c->num_points = num_points;
+    return c;
+}
+
+int oskar_station_work_enu_directions(oskar_StationWork* work,
+        const oskar_Station* station, const oskar_Mem* l, int num_points,
+        double gast, oskar_Mem** x, oskar_Mem** y, oskar_Mem** z,
+        int* status)
+{
+    int found = 0;
+    DirectionCache* c = 0;
+    *x = work->enu_direction_x;
+    *y = work->enu_direction_y;
+    *z = work->enu_direction_z;
+    if (*status || !l || l != work->direction_cache_source ||
+            gast != work->direction_cache_gast)
+        return 0;
+
+    /* Return the cached directions if they have been computed already.
+     * Otherwise use the next slot to hold them, if there is one. */
+    c = find_direction_cache(work, station, -1, num_points);
+    if (c)
+        found = 1;
+    else
+        c = new_direction_cache(work, station, -1, num_points,
+                (size_t) num_points, status);
+    if (!c) return 0;
+    *x = c->data[0];
+    *y = c->data[1];
+    *z = c->data[2];
+    return found;
+}
+
+int oskar_station_work_element_theta_phi(oskar_StationWork* work,
+        const oskar_Station* station, int element_type_index,
+        const oskar_Mem* x, int num_points, oskar_Mem** theta,
+        oskar_Mem** phi_x, oskar_Mem** phi_y, int* status)
+{
+    int found = 0;
+    DirectionCache *c = 0, *enu = 0;
+    *theta = work->theta_modified;
+    *phi_x = work->phi_x;
+    *phi_y = work->phi_y;
+    if (*status) return 0;
+
+    /* Angles can only be kept if they are for cached ENU directions. */
+    enu = find_direction_cache(work, station, -1, num_points);
+    if (enu && enu->data[0] == x)
+    {
+        /* Allow for the extra point used to normalise the element. */
+        c = find_direction_cache(work, station, element_type_index,
+                num_points);
+        if (c)
+            found = 1;
+        else
+            c = new_direction_cache(work, station, element_type_index,
+                    num_points, (size_t) num_points + 1, status);
+    }
+    if (c)
+    {
+        *theta = c->data[0];
+        *phi_x = c->data[1];
+        *phi_y = c->data[2];
+    }
+    else
+    {
+        oskar_mem_ensure(*theta, (size_t) num_points + 1, status);
+        oskar_mem_ensure(*phi_x, (size_t) num_points + 1, status);
+        oskar_mem_ensure(*phi_y, (size_t) num_points + 1, status);
+    }
+    return found;
+}
+
 void oskar_station_work_set_tec_screen_common_params(oskar_StationWork* work,
         char screen_type, double screen_height_km, double screen_pixel_size_m,
         double screen_time_interval_sec)
@@ -125,6 +316,18 @@ void oskar_station_work_set_tec_screen_common_params(oskar_StationWork* work,
     work->screen_time_interval_sec = screen_time_interval_sec;
 }
 
+void oskar_station_work_set_tec_screen_max_buffer(oskar_StationWork* work,
+        size_t max_bytes)
+{
+    work->screen_max_buffer_bytes = max_bytes;
+}
+
+void oskar_station_work_set_time_range(oskar_StationWork* work,
+        int start_time_index, int num_times)
+{
+    work->screen_time_end = start_time_index + num_times;
+}
+
 void oskar_station_work_set_tec_screen_path(oskar_StationWork* work,
         const char* path)
 {
@@ -140,6 +343,8 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
         double station_u_m, double station_v_m, int time_index,
         double frequency_hz, int* status)
 {
+    int offset_screen = 0;
+
     /* Check if we have a phase screen. */
     if (work->screen_type == 'N')
         return 0;
@@ -153,35 +358,105 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
             oskar_mem_read_fits(0, 0, 0,
                     oskar_mem_char_const(work->tec_screen_path), 0, 0,
                     &num_axes, &axis_size, 0, status);
+            if (*status) return 0;
             work->screen_num_pixels_x = axis_size[0];
-            work->screen_num_pixels_y = axis_size[1];
-            work->screen_num_pixels_t = axis_size[2];
+            work->screen_num_pixels_y = num_axes > 1 ? axis_size[1] : 1;
+            work->screen_num_pixels_t = num_axes > 2 ? axis_size[2] : 1;
+            work->screen_num_slices = 0;
             free(axis_size);
         }
-        if (time_index != work->previous_time_index)
+        /* FIXME(FD) Work out which time index to use here! */
+        const int num_pixels =
+                work->screen_num_pixels_x * work->screen_num_pixels_y;
+        const int t = time_index < work->screen_num_pixels_t ?
+                time_index : work->screen_num_pixels_t - 1;
+        if (t < work->screen_first_slice ||
+                t >= work->screen_first_slice + work->screen_num_slices)
         {
-            work->previous_time_index = time_index;
-            const size_t num_pixels =
-                    work->screen_num_pixels_x * work->screen_num_pixels_y;
-            /* FIXME(FD) Work out which time index to use here!
-             * Also consider loading a few at once? */
-            int start_index[3] = {0, 0, time_index};
-            if (time_index >= work->screen_num_pixels_t)
-                start_index[2] = work->screen_num_pixels_t - 1;
-            oskar_mem_read_fits(work->tec_screen, 0, num_pixels,
+            /* Read the slices for the time steps left in the block,
+             * up to the buffer limit, so the file is accessed again only
+             * when the time index moves outside them. */
+            int start_index[3] = {0, 0, 0}, num_slices, max_slices;
+            num_slices = work->screen_time_end - time_index;
+            max_slices = (int) (work->screen_max_buffer_bytes /
+                    ((size_t) num_pixels * oskar_mem_element_size(
+                            oskar_mem_type(work->tec_screen))));
+            if (num_slices > max_slices)
+                num_slices = max_slices;
+            if (num_slices > work->screen_num_pixels_t - t)
+                num_slices = work->screen_num_pixels_t - t;
+            if (num_slices < 1) num_slices = 1;
+            start_index[2] = t;
+            oskar_mem_read_fits(work->tec_screen, 0,
+                    (size_t) num_slices * num_pixels,
                     oskar_mem_char_const(work->tec_screen_path),
                     3, start_index, 0, 0, 0, status);
+            work->screen_first_slice = t;
+            work->screen_num_slices = *status ? 0 : num_slices;
         }
+        offset_screen = (t - work->screen_first_slice) * num_pixels;
     }
     oskar_mem_ensure(work->screen_output, (size_t) num_points, status);
     oskar_evaluate_tec_screen(num_points, l, m, station_u_m, station_v_m,
             frequency_hz, work->screen_height_km * 1000.0,
             work->screen_pixel_size_m,
             work->screen_num_pixels_x, work->screen_num_pixels_y,
-            work->tec_screen, 0, work->screen_output, status);
+            offset_screen, work->tec_screen, 0, work->screen_output, status);
     return work->screen_output;
 }
 
+const oskar_Mem* oskar_station_work_element_weights(oskar_StationWork* work,
+        const oskar_Station* station, int feed, double wavenumber,
+        double x_beam, double y_beam, double z_beam, int time_index,
+        int* status)
+{
+    WeightsCache* c;
+    if (*status) return 0;
+
+    /* Get the cache entry for this station and feed. */
+    const int index = 2 * oskar_station_unique_id(station) + feed;
+    if (index >= work->num_weights_cache)
+    {
+        const int old_size = work->num_weights_cache;
+        WeightsCache* new_cache = (WeightsCache*) realloc(work->weights_cache,
+                (index + 1) * sizeof(WeightsCache));
+        if (!new_cache)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        work->weights_cache = new_cache;
+        work->num_weights_cache = index + 1;
+        memset(work->weights_cache + old_size, 0,
+                (work->num_weights_cache - old_size) * sizeof(WeightsCache));
+    }
+    c = &work->weights_cache[index];
+    if (!c->weights)
+        c->weights = oskar_mem_create(oskar_mem_type(work->weights),
+                oskar_mem_location(work->weights), 0, status);
+
+    /* Re-evaluate the weights only if the inputs have changed. */
+    const int t = oskar_station_time_variable_errors(station) ?
+            time_index : -1;
+    if (c->station != station || c->time_index != t ||
+            c->wavenumber != wavenumber || c->beam_x != x_beam ||
+            c->beam_y != y_beam || c->beam_z != z_beam ||
+            oskar_mem_length(c->weights) !=
+                    (size_t) oskar_station_num_elements(station))
+    {
+        oskar_station_evaluate_element_weights(station, feed, wavenumber,
+                x_beam, y_beam, z_beam, time_index, c->weights,
+                work->weights_scratch, status);
+        c->station = *status ? 0 : station;
+        c->time_index = t;
+        c->wavenumber = wavenumber;
+        c->beam_x = x_beam;
+        c->beam_y = y_beam;
+        c->beam_z = z_beam;
+    }
+    return c->weights;
+}
+
 oskar_Mem* oskar_station_work_beam_out(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int* status)
 {
@@ -190,6 +465,22 @@ oskar_Mem* oskar_station_work_beam_out(oskar_StationWork* work,
     return work->beam_out_scratch;
 }
 
+void oskar_station_work_set_beam_interp_tolerance(oskar_StationWork* work,
+        double value)
+{
+    work->beam_interp_tolerance = value;
+}
+
+double oskar_station_work_beam_interp_tolerance(const oskar_StationWork* work)
+{
+    return work->beam_interp_tolerance;
+}
+
+oskar_Mem* oskar_station_work_beam_interp_error(oskar_StationWork* work)
+{
+    return work->beam_interp_error;
+}
+
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status)
 {
@@ -210,6 +501,27 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+oskar_StationWork* oskar_station_work_task(oskar_StationWork* work,
+        int task, int* status)
+{
+    if (*status) return 0;
+    if (task > work->num_tasks - 1)
+    {
+        int i, old_num_tasks;
+        old_num_tasks = work->num_tasks;
+        work->num_tasks = task + 1;
+        work->task_work = (oskar_StationWork**) realloc(work->task_work,
+                work->num_tasks * sizeof(oskar_StationWork*));
+        for (i = old_num_tasks; i < work->num_tasks; ++i)
+        {
+            work->task_work[i] = oskar_station_work_create(
+                    oskar_mem_precision(work->weights),
+                    oskar_mem_location(work->weights), status);
+        }
+    }
+    return work->task_work[task];
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include "math/oskar_cmath.h"
+
+static void write_cst_file(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    fprintf(file, "Theta [deg.]  Phi [deg.]  Abs(Dir.)[ ]  Abs(Theta)[ ]  "
+            "Phase(Theta)[deg.]  Abs(Phi)[ ]  Phase(Phi)[deg.]  "
+            "Ax.Ratio[ ]\n");
+    for (int p = 0; p < 360; p += 5)
+    {
+        for (int t = 0; t <= 90; t += 5)
+        {
+            const double theta = t * M_PI / 180.0, phi = p * M_PI / 180.0;
+            const double e_theta = cos(theta) * cos(phi), e_phi = -sin(phi);
+            fprintf(file, "%d %d 0 %.12f %d %.12f %d 0\n", t, p,
+                    fabs(e_theta), e_theta < 0.0 ? 180 : 0,
+                    fabs(e_phi), e_phi < 0.0 ? 180 : 0);
+        }
+    }
+    fclose(file);
+}
+
+TEST(element_lookup_table, matches_splines)
+{
+    int status = 0;
+    const int num_points = 10000;
+    const double freq_hz = 100e6;
+    const char* filename = "temp_test_element_lookup_table.txt";
+    write_cst_file(filename);
+
+    // Load the element pattern for both polarisations.
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_element_load_cst(element, 1, freq_hz, filename,
+            0.02, 2.0, 0, 1, 0, &status);
+    oskar_element_load_cst(element, 2, freq_hz, filename,
+            0.02, 2.0, 0, 1, 0, &status);
+    remove(filename);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate random directions above the horizon.
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    double* z_ = oskar_mem_double(z, &status);
+    srand(1);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double theta = 0.5 * M_PI * rand() / (double)RAND_MAX;
+        const double phi = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        x_[i] = sin(theta) * cos(phi);
+        y_[i] = sin(theta) * sin(phi);
+        z_[i] = cos(theta);
+    }
+
+    // Evaluate the element pattern using splines and lookup tables.
+    oskar_Mem *theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem *phi_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem *phi_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem* spline = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* table = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_element_evaluate(element, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, spline, &status);
+    oskar_element_create_lookup_tables(element, 0.25 * M_PI / 180.0, &status);
+    oskar_element_evaluate(element, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, table, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* s_ = oskar_mem_double_const(spline, &status);
+    const double* t_ = oskar_mem_double_const(table, &status);
+    double max_err = 0.0;
+    for (int i = 0; i < 8 * num_points; ++i)
+    {
+        const double err = fabs(s_[i] - t_[i]);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 1e-6);
+
+    // Check that removing the tables reverts to the spline evaluation.
+    oskar_element_create_lookup_tables(element, 0.0, &status);
+    oskar_element_evaluate(element, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, table, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_mem_different(spline, table, 0, &status));
+
+    // Clean up.
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi_x, &status);
+    oskar_mem_free(phi_y, &status);
+    oskar_mem_free(spline, &status);
+    oskar_mem_free(table, &status);
+    oskar_element_free(element, &status);
+}
+
+TEST(element_lookup_table, shared_between_elements)
+{
+    int status = 0;
+    const int num_points = 1000;
+    const double freq_hz = 100e6;
+    const char* filename = "temp_test_element_lookup_table_shared.txt";
+    const char* file_x = "temp_test_element_lookup_table_shared_x.bin";
+    const char* file_y = "temp_test_element_lookup_table_shared_y.bin";
+    write_cst_file(filename);
+
+    // Fit the element pattern, and save the fitted data.
+    oskar_Element* fitted = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_element_load_cst(fitted, 1, freq_hz, filename,
+            0.02, 2.0, 0, 1, 0, &status);
+    oskar_element_load_cst(fitted, 2, freq_hz, filename,
+            0.02, 2.0, 0, 1, 0, &status);
+    oskar_element_write(fitted, file_x, 1, freq_hz, 0, &status);
+    oskar_element_write(fitted, file_y, 2, freq_hz, 0, &status);
+    remove(filename);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Load the same files into two elements, and tabulate only the first.
+    oskar_Element* a = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_Element* b = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_read(a, file_x, 1, freq_hz, &status);
+    oskar_element_read(a, file_y, 2, freq_hz, &status);
+    oskar_element_read(b, file_x, 1, freq_hz, &status);
+    oskar_element_read(b, file_y, 2, freq_hz, &status);
+    remove(file_x);
+    remove(file_y);
+    oskar_element_create_lookup_tables(a, 0.5 * M_PI / 180.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Tables can be shared only between elements loaded from the same files.
+    EXPECT_EQ(0, oskar_element_share_lookup_tables(fitted, a, &status));
+    EXPECT_EQ(1, oskar_element_share_lookup_tables(b, a, &status));
+    EXPECT_EQ(0, oskar_element_different(a, b, &status));
+
+    // Copy the first element, then free it.
+    oskar_Element* c = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_copy(c, a, &status);
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* x_ = oskar_mem_double(x, &status);
+    double* y_ = oskar_mem_double(y, &status);
+    double* z_ = oskar_mem_double(z, &status);
+    srand(2);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double theta = 0.5 * M_PI * rand() / (double)RAND_MAX;
+        const double phi = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        x_[i] = sin(theta) * cos(phi);
+        y_[i] = sin(theta) * sin(phi);
+        z_[i] = cos(theta);
+    }
+    oskar_Mem *theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem *phi_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem *phi_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem* out_a = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* out_b = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* out_c = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_element_evaluate(a, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, out_a, &status);
+    oskar_element_free(a, &status);
+
+    // Check the remaining elements still use the same tables.
+    oskar_element_evaluate(b, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, out_b, &status);
+    oskar_element_evaluate(c, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, out_c, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_mem_different(out_a, out_b, 0, &status));
+    EXPECT_EQ(0, oskar_mem_different(out_a, out_c, 0, &status));
+
+    // Removing the tables from one element must not affect the other.
+    oskar_element_create_lookup_tables(b, 0.0, &status);
+    oskar_element_evaluate(c, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, 0, out_b, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_mem_different(out_a, out_b, 0, &status));
+
+    // Clean up.
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi_x, &status);
+    oskar_mem_free(phi_y, &status);
+    oskar_mem_free(out_a, &status);
+    oskar_mem_free(out_b, &status);
+    oskar_mem_free(out_c, &status);
+    oskar_element_free(b, &status);
+    oskar_element_free(c, &status);
+    oskar_element_free(fitted, &status);
+}
@@ -183,3 +183,201 @@ TEST(evaluate_jones_E, evaluate_e)
     ASSERT_EQ(0, error) << oskar_get_error_string(error);
 }
 
+
+TEST(evaluate_jones_E, station_equivalence)
+{
+    int error = 0, prec = OSKAR_DOUBLE;
+    double frequency = 100e6;
+
+    // Construct a telescope model with two different station designs.
+    int num_stations = 6, station_dim = 8;
+    oskar_Telescope* tel = oskar_telescope_create(prec,
+            OSKAR_CPU, num_stations, &error);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, station_dim * station_dim, &error);
+        oskar_station_resize_element_types(s, 1, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        oskar_station_set_position(s, 0.0, M_PI / 2.0, 0.0, 0.0, 0.0, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Isotropic", &error);
+
+        // Alternate between the two station sizes.
+        const double station_size_m = (i % 2 == 0) ? 30.0 : 40.0;
+        std::vector<double> x_pos(station_dim);
+        oskar_linspace_d(&x_pos[0], -station_size_m/2.0, station_size_m/2.0,
+                station_dim);
+        oskar_meshgrid_d(
+                oskar_mem_double(
+                        oskar_station_element_true_enu_metres(s, 0, 0), &error),
+                oskar_mem_double(
+                        oskar_station_element_true_enu_metres(s, 0, 1), &error),
+                &x_pos[0], station_dim, &x_pos[0], station_dim);
+        oskar_mem_copy(oskar_station_element_measured_enu_metres(s, 0, 0),
+                oskar_station_element_true_enu_metres(s, 0, 0), &error);
+        oskar_mem_copy(oskar_station_element_measured_enu_metres(s, 0, 1),
+                oskar_station_element_true_enu_metres(s, 0, 1), &error);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, M_PI/2.0);
+    oskar_telescope_analyse(tel, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Check the station groups.
+    EXPECT_EQ(0, oskar_telescope_identical_stations(tel));
+    EXPECT_EQ(2, oskar_telescope_num_unique_stations(tel));
+    for (int i = 0; i < num_stations; ++i)
+        EXPECT_EQ(i % 2, oskar_telescope_station_equivalent(tel, i));
+
+    // Create pixel positions.
+    int num_l = 32, num_m = 32;
+    int num_pts = num_l * num_m;
+    oskar_Mem* l = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    oskar_Mem* m = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    oskar_Mem* n = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    oskar_evaluate_image_lmn_grid(num_l, num_m, 40.0 * D2R, 40.0 * D2R,
+            1, l, m, n, &error);
+    oskar_StationWork* work = oskar_station_work_create(prec,
+            OSKAR_CPU, &error);
+
+    // Evaluate Jones E with and without station beam duplication.
+    oskar_Jones* E_all = oskar_jones_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_Jones* E_dup = oskar_jones_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_FALSE);
+    oskar_evaluate_jones_E(E_all, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, frequency, work, 0, &error);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_evaluate_jones_E(E_dup, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, frequency, work, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    EXPECT_EQ(0, oskar_mem_different(oskar_jones_mem(E_all),
+            oskar_jones_mem(E_dup), 0, &error));
+
+    // Check the two station designs have different beams.
+    oskar_Mem* beam0 = oskar_mem_create_alias(oskar_jones_mem(E_all),
+            0, num_pts, &error);
+    oskar_Mem* beam1 = oskar_mem_create_alias(oskar_jones_mem(E_all),
+            num_pts, num_pts, &error);
+    EXPECT_EQ(1, oskar_mem_different(beam0, beam1, 0, &error));
+    oskar_mem_free(beam0, &error);
+    oskar_mem_free(beam1, &error);
+    oskar_jones_free(E_all, &error);
+    oskar_jones_free(E_dup, &error);
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_telescope_free(tel, &error);
+    oskar_station_work_free(work, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+
+TEST(evaluate_jones_E, interpolated)
+{
+    int error = 0, prec = OSKAR_DOUBLE;
+    double frequency = 100e6, tolerance = 1e-3;
+
+    // Construct telescope model.
+    int num_stations = 3, station_dim = 8;
+    double station_size_m = 30.0;
+    oskar_Telescope* tel = oskar_telescope_create(prec,
+            OSKAR_CPU, num_stations, &error);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, station_dim * station_dim, &error);
+        oskar_station_resize_element_types(s, 1, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        oskar_station_set_position(s, 0.0, M_PI / 2.0, 0.0, 0.0, 0.0, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Isotropic", &error);
+        std::vector<double> x_pos(station_dim);
+        oskar_linspace_d(&x_pos[0], -station_size_m/2.0, station_size_m/2.0,
+                station_dim);
+        oskar_meshgrid_d(
+                oskar_mem_double(
+                        oskar_station_element_true_enu_metres(s, 0, 0), &error),
+                oskar_mem_double(
+                        oskar_station_element_true_enu_metres(s, 0, 1), &error),
+                &x_pos[0], station_dim, &x_pos[0], station_dim);
+        oskar_mem_copy(oskar_station_element_measured_enu_metres(s, 0, 0),
+                oskar_station_element_true_enu_metres(s, 0, 0), &error);
+        oskar_mem_copy(oskar_station_element_measured_enu_metres(s, 0, 1),
+                oskar_station_element_true_enu_metres(s, 0, 1), &error);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, M_PI/2.0);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_FALSE);
+    oskar_telescope_analyse(tel, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    EXPECT_NEAR(station_size_m / sqrt(2.0),
+            oskar_station_max_radius_m(oskar_telescope_station(tel, 0)),
+            1e-9);
+
+    // Generate random source positions in a patch of sky.
+    int num_pts = 20000;
+    oskar_Mem* l = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    oskar_Mem* m = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    oskar_Mem* n = oskar_mem_create(prec, OSKAR_CPU, 1 + num_pts, &error);
+    double* l_ = oskar_mem_double(l, &error);
+    double* m_ = oskar_mem_double(m, &error);
+    double* n_ = oskar_mem_double(n, &error);
+    srand(2);
+    for (int i = 0; i < num_pts; ++i)
+    {
+        l_[i] = 0.15 + 0.1 * (rand() / (double)RAND_MAX);
+        m_[i] = 0.05 + 0.1 * (rand() / (double)RAND_MAX);
+        n_[i] = sqrt(1.0 - l_[i] * l_[i] - m_[i] * m_[i]);
+    }
+
+    // Evaluate Jones E directly and by interpolation.
+    oskar_Jones* E_direct = oskar_jones_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_Jones* E_interp = oskar_jones_create(prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts, &error);
+    oskar_StationWork* work = oskar_station_work_create(prec,
+            OSKAR_CPU, &error);
+    oskar_evaluate_jones_E(E_direct, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, frequency, work, 0, &error);
+    oskar_station_work_set_beam_interp_tolerance(work, tolerance);
+    oskar_evaluate_jones_E(E_interp, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, 0.0, frequency, work, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Check the error estimates, and the actual errors.
+    const double* errors = oskar_mem_double_const(
+            oskar_station_work_beam_interp_error(work), &error);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        EXPECT_GT(errors[i], 0.0);
+        EXPECT_LE(errors[i], tolerance);
+    }
+    const double2* a = oskar_mem_double2_const(
+            oskar_jones_mem(E_direct), &error);
+    const double2* b = oskar_mem_double2_const(
+            oskar_jones_mem(E_interp), &error);
+    double max_err = 0.0;
+    for (int i = 0; i < num_stations * num_pts; ++i)
+    {
+        const double re = a[i].x - b[i].x, im = a[i].y - b[i].y;
+        const double err = sqrt(re * re + im * im);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 2.0 * tolerance);
+    EXPECT_EQ(1, oskar_mem_different(oskar_jones_mem(E_direct),
+            oskar_jones_mem(E_interp), 0, &error));
+
+    oskar_jones_free(E_direct, &error);
+    oskar_jones_free(E_interp, &error);
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_telescope_free(tel, &error);
+    oskar_station_work_free(work, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
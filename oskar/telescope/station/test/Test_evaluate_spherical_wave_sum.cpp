@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
+#include "telescope/station/element/define_evaluate_spherical_wave.h"
+#include "math/define_legendre_polynomial.h"
+#include "math/define_multiply.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+#include "mem/oskar_mem.h"
+
+#include <cstdlib>
+#include "math/oskar_cmath.h"
+
+// Direct per-point evaluation, used as a reference.
+OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(spherical_wave_sum_ref, double, double2, double4c)
+
+TEST(evaluate_spherical_wave_sum, matches_direct_evaluation)
+{
+    int status = 0;
+    const int l_max = 12, num_rows = 20, num_cols = 50;
+    const int num_points = num_rows * num_cols, offset = 3;
+    const int num_coeff = (l_max + 1) * (l_max + 1) - 1;
+
+    // Generate random coefficients.
+    oskar_Mem* alpha = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_coeff, &status);
+    double* a_ = oskar_mem_double(alpha, &status);
+    srand(2);
+    for (int i = 0; i < 8 * num_coeff; ++i)
+        a_[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+
+    // Generate points on a grid of repeated theta values,
+    // including the pole.
+    oskar_Mem* theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* phi_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* phi_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* t_ = oskar_mem_double(theta, &status);
+    double* px_ = oskar_mem_double(phi_x, &status);
+    double* py_ = oskar_mem_double(phi_y, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const int row = i % num_rows, col = i / num_rows;
+        t_[i] = 0.5 * M_PI * row / (num_rows - 1.0);
+        px_[i] = 2.0 * M_PI * col / num_cols;
+        py_[i] = px_[i] + 0.5 * M_PI;
+    }
+    px_[7] = NAN;
+
+    // Evaluate the sum and the reference.
+    oskar_Mem* pattern = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points + offset, &status);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points + offset, &status);
+    oskar_evaluate_spherical_wave_sum(num_points, theta, phi_x, phi_y,
+            l_max, alpha, offset, pattern, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    spherical_wave_sum_ref(num_points, t_, px_, py_, l_max,
+            oskar_mem_double4c_const(alpha, &status), offset,
+            oskar_mem_double4c(ref, &status));
+    const double* p_ = oskar_mem_double_const(pattern, &status);
+    const double* r_ = oskar_mem_double_const(ref, &status);
+    double max_abs = 0.0, max_err = 0.0;
+    for (int i = 8 * offset; i < 8 * (num_points + offset); ++i)
+    {
+        if (i / 8 == 7 + offset)
+        {
+            EXPECT_TRUE(p_[i] != p_[i]);
+            continue;
+        }
+        if (fabs(r_[i]) > max_abs) max_abs = fabs(r_[i]);
+        if (fabs(p_[i] - r_[i]) > max_err) max_err = fabs(p_[i] - r_[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(max_err, 1e-10 * max_abs);
+
+    // Check single precision.
+    oskar_Mem* alpha_f = oskar_mem_convert_precision(alpha,
+            OSKAR_SINGLE, &status);
+    oskar_Mem* theta_f = oskar_mem_convert_precision(theta,
+            OSKAR_SINGLE, &status);
+    oskar_Mem* phi_x_f = oskar_mem_convert_precision(phi_x,
+            OSKAR_SINGLE, &status);
+    oskar_Mem* phi_y_f = oskar_mem_convert_precision(phi_y,
+            OSKAR_SINGLE, &status);
+    oskar_Mem* pattern_f = oskar_mem_create(OSKAR_SINGLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points + offset, &status);
+    oskar_evaluate_spherical_wave_sum(num_points, theta_f, phi_x_f, phi_y_f,
+            l_max, alpha_f, offset, pattern_f, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float* f_ = oskar_mem_float_const(pattern_f, &status);
+    max_err = 0.0;
+    for (int i = 8 * offset; i < 8 * (num_points + offset); ++i)
+    {
+        if (i / 8 == 7 + offset) continue;
+        if (fabs(f_[i] - r_[i]) > max_err) max_err = fabs(f_[i] - r_[i]);
+    }
+    EXPECT_LT(max_err, 1e-4 * max_abs);
+
+    // Clean up.
+    oskar_mem_free(alpha, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi_x, &status);
+    oskar_mem_free(phi_y, &status);
+    oskar_mem_free(pattern, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(alpha_f, &status);
+    oskar_mem_free(theta_f, &status);
+    oskar_mem_free(phi_x_f, &status);
+    oskar_mem_free(phi_y_f, &status);
+    oskar_mem_free(pattern_f, &status);
+}
@@ -29,9 +29,13 @@
 #include <gtest/gtest.h>
 
 #include "telescope/station/oskar_station.h"
+#include "telescope/station/oskar_evaluate_station_beam.h"
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
+#include "telescope/station/oskar_station_evaluate_element_weights.h"
+#include "telescope/station/oskar_station_work.h"
+#include "telescope/station/private_station_work.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_linspace.h"
 #include "math/oskar_meshgrid.h"
@@ -42,6 +46,9 @@
 #include "math/oskar_cmath.h"
 #include <cstdio>
 #include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -315,3 +322,272 @@ TEST(evaluate_station_beam, gaussian)
         oskar_mem_free(beam, &error);
     }
 }
+
+
+TEST(evaluate_station_beam, element_weights_cache)
+{
+    int error = 0, dummy = 0;
+    const int num_elements = 100;
+    const double wavenumber = 2.0 * M_PI;
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_elements, &error);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        const double xyz[] = {0.7 * (i % 10), 0.9 * (i / 10), 0.0};
+        oskar_station_set_element_coords(station, 0, i, xyz, xyz, &error);
+        oskar_station_set_element_errors(station, 0, i,
+                1.0, 0.1, 0.0, 5.0, &error);
+    }
+    oskar_station_analyse(station, &dummy, &error);
+    ASSERT_EQ(1, oskar_station_time_variable_errors(station));
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &error);
+    oskar_Mem* scratch = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Check that cached weights follow changes in direction and time.
+    const double dir[][3] = {{0.1, 0.2, 0.97}, {0.1, 0.2, 0.97},
+            {0.3, -0.1, 0.95}, {0.3, -0.1, 0.95}};
+    const int time_index[] = {0, 0, 0, 1};
+    for (int k = 0; k < 4; ++k)
+    {
+        const oskar_Mem* w = oskar_station_work_element_weights(work,
+                station, 0, wavenumber, dir[k][0], dir[k][1], dir[k][2],
+                time_index[k], &error);
+        oskar_station_evaluate_element_weights(station, 0, wavenumber,
+                dir[k][0], dir[k][1], dir[k][2], time_index[k],
+                ref, scratch, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        EXPECT_EQ(0, oskar_mem_different(w, ref, 0, &error)) << k;
+    }
+    oskar_mem_free(ref, &error);
+    oskar_mem_free(scratch, &error);
+    oskar_station_work_free(work, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST(evaluate_station_beam, direction_cache)
+{
+    int error = 0;
+    const int num_elements = 16, num_points = 500;
+    const double gast = 0.1, ra0 = 0.3, dec0 = -0.5;
+    const double freqs[] = {100e6, 150e6};
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_elements, &error);
+    oskar_station_resize_element_types(station, 1, &error);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Dipole", &error);
+    oskar_station_set_position(station, 0.2, -0.45, 0.0, 0.0, 0.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, ra0, dec0);
+    oskar_station_set_normalise_final_beam(station, 1);
+    oskar_station_set_normalise_element_pattern(station, 1);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        const double xyz[] = {1.5 * (i % 4), 1.5 * (i / 4), 0.0};
+        oskar_station_set_element_coords(station, 0, i, xyz, xyz, &error);
+    }
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Generate source directions, with space for the normalisation point.
+    oskar_Mem *lmn[3];
+    for (int j = 0; j < 3; ++j)
+        lmn[j] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                num_points + 1, &error);
+    double *l_ = oskar_mem_double(lmn[0], &error);
+    double *m_ = oskar_mem_double(lmn[1], &error);
+    double *n_ = oskar_mem_double(lmn[2], &error);
+    srand(2);
+    for (int i = 0; i < num_points; ++i)
+    {
+        l_[i] = 0.6 * (rand() / (double)RAND_MAX - 0.5);
+        m_[i] = 0.6 * (rand() / (double)RAND_MAX - 0.5);
+        n_[i] = sqrt(1.0 - l_[i] * l_[i] - m_[i] * m_[i]);
+    }
+
+    // Check beams using cached directions match those without the cache.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_StationWork* work_ref = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_Mem* beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &error);
+    oskar_Mem* beam_ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_points, &error);
+    oskar_station_work_set_direction_cache(work, lmn[0], num_points,
+            gast, &error);
+    for (int k = 0; k < 2; ++k)
+    {
+        oskar_evaluate_station_beam(num_points, OSKAR_RELATIVE_DIRECTIONS,
+                lmn[0], lmn[1], lmn[2], ra0, dec0, station, work, 0,
+                freqs[k], gast, 0, beam, &error);
+        oskar_evaluate_station_beam(num_points, OSKAR_RELATIVE_DIRECTIONS,
+                lmn[0], lmn[1], lmn[2], ra0, dec0, station, work_ref, 0,
+                freqs[k], gast, 0, beam_ref, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        EXPECT_EQ(0, oskar_mem_different(beam, beam_ref, 0, &error)) << k;
+    }
+
+    // Check the directions and element angles were kept.
+    oskar_Mem *x, *y, *z, *theta, *phi_x, *phi_y;
+    EXPECT_EQ(1, oskar_station_work_enu_directions(work, station, lmn[0],
+            num_points + 1, gast, &x, &y, &z, &error));
+    EXPECT_EQ(1, oskar_station_work_element_theta_phi(work, station, 0, x,
+            num_points + 1, &theta, &phi_x, &phi_y, &error));
+    EXPECT_EQ(0, oskar_station_work_enu_directions(work, station, lmn[0],
+            num_points + 1, gast + 0.1, &x, &y, &z, &error));
+    EXPECT_EQ(0, oskar_station_work_element_theta_phi(work, station, 0, x,
+            num_points + 1, &theta, &phi_x, &phi_y, &error));
+
+    // Check nothing is kept once the cache is disabled.
+    oskar_station_work_set_direction_cache(work, 0, 0, 0.0, &error);
+    EXPECT_EQ(0, oskar_station_work_enu_directions(work, station, lmn[0],
+            num_points + 1, gast, &x, &y, &z, &error));
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    for (int j = 0; j < 3; ++j) oskar_mem_free(lmn[j], &error);
+    oskar_mem_free(beam, &error);
+    oskar_mem_free(beam_ref, &error);
+    oskar_station_work_free(work, &error);
+    oskar_station_work_free(work_ref, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST(evaluate_station_beam, hierarchical_concurrent_children)
+{
+    int error = 0, dummy = 0, counter = 0;
+    const int num_tiles = 8, tile_dim = 4, num_points = 3000;
+    const int num_tile_elements = tile_dim * tile_dim;
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_tiles, &error);
+    oskar_station_set_position(station, 0.0, M_PI / 4.0, 0.0, 0.0, 0.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_AZEL, 0.3, 1.2);
+    oskar_station_create_child_stations(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Give each tile a slightly different layout.
+    for (int i = 0; i < num_tiles; ++i)
+    {
+        const double xyz[] = {5.0 * (i % 4), 5.0 * (i / 4), 0.0};
+        oskar_Station* tile = oskar_station_child(station, i);
+        oskar_station_set_element_coords(station, 0, i, xyz, xyz, &error);
+        oskar_station_resize(tile, num_tile_elements, &error);
+        oskar_station_resize_element_types(tile, 1, &error);
+        oskar_station_set_position(tile, 0.0, M_PI / 4.0, 0.0, 0.0, 0.0, 0.0);
+        oskar_station_set_phase_centre(tile,
+                OSKAR_SPHERICAL_TYPE_AZEL, 0.3, 1.2);
+        for (int j = 0; j < num_tile_elements; ++j)
+        {
+            const double d = 1.1 + 0.01 * i;
+            const double e[] = {d * (j % tile_dim), d * (j / tile_dim), 0.0};
+            oskar_station_set_element_coords(tile, 0, j, e, e, &error);
+        }
+    }
+    oskar_station_resize_element_types(station, 1, &error);
+    oskar_station_analyse(station, &dummy, &error);
+    oskar_station_set_unique_ids(station, &counter);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    ASSERT_EQ(0, oskar_station_identical_children(station));
+
+    // Generate directions above the horizon.
+    oskar_Mem *x, *y, *z, *beam[2];
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    double *x_ = oskar_mem_double(x, &error);
+    double *y_ = oskar_mem_double(y, &error);
+    double *z_ = oskar_mem_double(z, &error);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double r = 0.9 * (i + 0.5) / num_points, p = 0.1 * i;
+        x_[i] = r * sin(p);
+        y_[i] = r * cos(p);
+        z_[i] = sqrt(1.0 - r * r);
+    }
+
+    // Evaluate the beam using one thread, and then using several threads.
+    for (int k = 0; k < 2; ++k)
+    {
+#ifdef _OPENMP
+        const int num_threads = omp_get_max_threads();
+        omp_set_num_threads(k == 0 ? 1 : 4);
+#endif
+        oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+                OSKAR_CPU, &error);
+        beam[k] = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+                num_points, &error);
+        oskar_evaluate_station_beam_aperture_array(beam[k], station,
+                num_points, x, y, z, 0.0, 100e6, work, 0, &error);
+        oskar_station_work_free(work, &error);
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#endif
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    }
+    const double* b0 = oskar_mem_double_const(beam[0], &error);
+    const double* b1 = oskar_mem_double_const(beam[1], &error);
+    double max_abs = 0.0;
+    for (int i = 0; i < 8 * num_points; ++i)
+    {
+        EXPECT_NEAR(b0[i], b1[i], 1e-12) << i;
+        if (fabs(b0[i]) > max_abs) max_abs = fabs(b0[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    oskar_mem_free(x, &error);
+    oskar_mem_free(y, &error);
+    oskar_mem_free(z, &error);
+    oskar_mem_free(beam[0], &error);
+    oskar_mem_free(beam[1], &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+
+TEST(evaluate_station_beam, element_weights_cache_static_errors)
+{
+    int error = 0, dummy = 0;
+    const int num_elements = 16;
+    const double wavenumber = 2.0 * M_PI;
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_elements, &error);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        const double xyz[] = {0.7 * (i % 4), 0.9 * (i / 4), 0.0};
+        oskar_station_set_element_coords(station, 0, i, xyz, xyz, &error);
+        oskar_station_set_element_errors(station, 0, i,
+                1.0 + 0.01 * i, 0.0, 2.0 * i, 0.0, &error);
+    }
+    oskar_station_analyse(station, &dummy, &error);
+    ASSERT_EQ(1, oskar_station_apply_element_errors(station));
+    ASSERT_EQ(0, oskar_station_time_variable_errors(station));
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &error);
+    oskar_Mem* scratch = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Check that weights with static offsets are not keyed by time.
+    for (int t = 0; t < 3; ++t)
+    {
+        const oskar_Mem* w = oskar_station_work_element_weights(work,
+                station, 0, wavenumber, 0.1, 0.2, 0.97, t, &error);
+        oskar_station_evaluate_element_weights(station, 0, wavenumber,
+                0.1, 0.2, 0.97, t, ref, scratch, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        EXPECT_EQ(0, oskar_mem_different(w, ref, 0, &error)) << t;
+        EXPECT_EQ(-1, work->weights_cache[0].time_index) << t;
+    }
+    oskar_mem_free(ref, &error);
+    oskar_mem_free(scratch, &error);
+    oskar_station_work_free(work, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/oskar_station_work.h"
+#include "telescope/station/private_station_work.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+
+TEST(evaluate_tec_screen, external_screen_time_slices)
+{
+    int status = 0;
+    const int nx = 20, ny = 16, nt = 5, num_points = 200;
+    const double height_km = 300.0, pixel_size_m = 5000.0, freq_hz = 100e6;
+    const double u = 1200.0, v = -800.0;
+    const char* filename = "temp_test_tec_screen.fits";
+
+    // Write a TEC screen cube with a different pattern for each time.
+    oskar_Mem* cube = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            nx * ny * nt, &status);
+    double* c = oskar_mem_double(cube, &status);
+    for (int t = 0; t < nt; ++t)
+        for (int y = 0; y < ny; ++y)
+            for (int x = 0; x < nx; ++x)
+                c[x + nx * (y + ny * t)] = 0.01 * (1 + t) * sin(0.3 * x) +
+                        0.02 * cos(0.5 * y + t);
+    oskar_mem_write_fits_cube(cube, filename, nx, ny, nt, -1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate directions, some with pierce points outside the screen.
+    oskar_Mem* l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* l_ = oskar_mem_double(l, &status);
+    double* m_ = oskar_mem_double(m, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        l_[i] = 0.7 * sin(0.37 * i);
+        m_[i] = 0.6 * cos(0.23 * i);
+    }
+
+    // Evaluate the screen out of time order, and beyond the last slice.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_station_work_set_tec_screen_common_params(work, 'E',
+            height_km, pixel_size_m, 60.0);
+    oskar_station_work_set_tec_screen_path(work, filename);
+    const int time_index[] = {3, 0, 1, 4, 7, 2};
+    for (int k = 0; k < (int)(sizeof(time_index) / sizeof(int)); ++k)
+    {
+        const int t = time_index[k] < nt ? time_index[k] : nt - 1;
+        const oskar_Mem* out = oskar_station_work_evaluate_tec_screen(work,
+                num_points, l, m, u, v, time_index[k], freq_hz, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const double* o = oskar_mem_double_const(out, &status);
+        for (int i = 0; i < num_points; ++i)
+        {
+            double phase = 0.0;
+            const int px = nx / 2 + (int) round(
+                    (u + l_[i] * height_km * 1000.0) / pixel_size_m);
+            const int py = ny / 2 + (int) round(
+                    (v + m_[i] * height_km * 1000.0) / pixel_size_m);
+            if (px >= 0 && py >= 0 && px < nx && py < ny)
+                phase = c[px + nx * (py + ny * t)] * -8.44797245e9 / freq_hz;
+            EXPECT_NEAR(cos(phase), o[2 * i], 1e-12) << t << ", " << i;
+            EXPECT_NEAR(sin(phase), o[2 * i + 1], 1e-12) << t << ", " << i;
+        }
+    }
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(cube, &status);
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    remove(filename);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(evaluate_tec_screen, external_screen_batch_size)
+{
+    int status = 0;
+    const int nx = 8, ny = 8, nt = 10, num_points = 4;
+    const char* filename = "temp_test_tec_screen_batch.fits";
+    const size_t slice_bytes = nx * ny * sizeof(double);
+
+    // Write a TEC screen cube.
+    oskar_Mem* cube = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            nx * ny * nt, &status);
+    oskar_mem_set_value_real(cube, 0.01, 0, 0, &status);
+    oskar_mem_write_fits_cube(cube, filename, nx, ny, nt, -1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Mem* l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_mem_clear_contents(l, &status);
+    oskar_mem_clear_contents(m, &status);
+
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_station_work_set_tec_screen_common_params(work, 'E',
+            300.0, 5000.0, 60.0);
+    oskar_station_work_set_tec_screen_path(work, filename);
+
+    // With no time range, only the slice needed is read.
+    oskar_station_work_evaluate_tec_screen(work, num_points, l, m,
+            0.0, 0.0, 2, 100e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(2, work->screen_first_slice);
+    EXPECT_EQ(1, work->screen_num_slices);
+
+    // Read only the time steps left in the block.
+    oskar_station_work_set_time_range(work, 4, 3);
+    oskar_station_work_evaluate_tec_screen(work, num_points, l, m,
+            0.0, 0.0, 5, 100e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(5, work->screen_first_slice);
+    EXPECT_EQ(2, work->screen_num_slices);
+    EXPECT_EQ(2 * (size_t) (nx * ny), oskar_mem_length(work->tec_screen));
+
+    // Limit the batch by the buffer size.
+    oskar_station_work_set_tec_screen_max_buffer(work, 3 * slice_bytes + 1);
+    oskar_station_work_set_time_range(work, 0, nt);
+    oskar_station_work_evaluate_tec_screen(work, num_points, l, m,
+            0.0, 0.0, 0, 100e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, work->screen_first_slice);
+    EXPECT_EQ(3, work->screen_num_slices);
+
+    // Always read at least one slice.
+    oskar_station_work_set_tec_screen_max_buffer(work, 0);
+    oskar_station_work_evaluate_tec_screen(work, num_points, l, m,
+            0.0, 0.0, 8, 100e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(8, work->screen_first_slice);
+    EXPECT_EQ(1, work->screen_num_slices);
+
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(cube, &status);
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    remove(filename);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CPU_ISA_H_
+#define OSKAR_CPU_ISA_H_
+
+/**
+ * @file oskar_cpu_isa.h
+ */
+
+#include <oskar_global.h>
+
+/* Function attributes used to compile kernels for a given instruction set.
+ * These are only defined if the compiler supports runtime selection. */
+#if (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__x86_64__) || defined(__i386__)) && !defined(__CUDACC__)
+#define OSKAR_HAVE_CPU_ISA_DISPATCH 1
+#define OSKAR_TARGET_SSE4   __attribute__((target("sse4.2")))
+#define OSKAR_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define OSKAR_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+enum OSKAR_CPU_ISA
+{
+    OSKAR_CPU_ISA_GENERIC = 0,
+    OSKAR_CPU_ISA_SSE4    = 1,
+    OSKAR_CPU_ISA_AVX2    = 2,
+    OSKAR_CPU_ISA_AVX512  = 3
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the best SIMD instruction set available on the host CPU.
+ *
+ * @details
+ * Returns the best SIMD instruction set supported by both the host CPU and
+ * the compiler, as one of the values in the OSKAR_CPU_ISA enumeration.
+ *
+ * The result can be lowered (but not raised) by setting the environment
+ * variable OSKAR_CPU_ISA to one of "generic", "sse4", "avx2" or "avx512".
+ * This is intended for testing and benchmarking.
+ *
+ * The value is determined on the first call and cached thereafter.
+ */
+OSKAR_EXPORT
+int oskar_cpu_isa(void);
+
+/**
+ * @brief
+ * Returns a string describing the given SIMD instruction set.
+ *
+ * @details
+ * Returns a string describing the given SIMD instruction set.
+ *
+ * @param[in] isa One of the values in the OSKAR_CPU_ISA enumeration.
+ */
+OSKAR_EXPORT
+const char* oskar_cpu_isa_string(int isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CPU_ISA_H_ */
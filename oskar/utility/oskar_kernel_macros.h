@@ -1,4 +1,4 @@
-/* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2020, The University of Oxford. See LICENSE file. */
 
 #ifndef M_CAT
 #define M_CAT(A, B) M_CAT_(A, B)
@@ -24,6 +24,8 @@
 #define ATOMIC_ADD_UPDATE(TYPE, ARRAY, IDX, VAL)\
     M_CAT(ATOMIC_ADD_UPDATE_, TYPE)(ARRAY, IDX, VAL)
 #define ROUND(FP, X) M_CAT(ROUND_, FP)(X)
+#define VSINC(FP, X) M_CAT(VSINC_, FP)(X)
+#define VSINCOS(FP, X, S, C) M_CAT(VSINCOS_, FP)(X, S, C)
 
 #ifdef __CUDACC__
 
@@ -79,6 +81,10 @@
 #define RSQRT(X) rsqrt(X)
 #define SINCOS(X, S, C) sincos(X, &S, &C)
 #define THREADFENCE_BLOCK __threadfence_block()
+#define VSINC_float(X) ((X) == 0.0f ? 1.0f : sin(X) / (X))
+#define VSINC_double(X) ((X) == 0.0 ? 1.0 : sin(X) / (X))
+#define VSINCOS_float(X, S, C) SINCOS(X, S, C)
+#define VSINCOS_double(X, S, C) SINCOS(X, S, C)
 
 #if __CUDA_ARCH__ >= 600
 /* Native atomics. */
@@ -194,6 +200,10 @@
 #define RSQRT(X) rsqrt(X)
 #define SINCOS(X, S, C) S = sincos(X, &C)
 #define THREADFENCE_BLOCK mem_fence()
+#define VSINC_float(X) ((X) == 0.0f ? 1.0f : sin(X) / (X))
+#define VSINC_double(X) ((X) == 0.0 ? 1.0 : sin(X) / (X))
+#define VSINCOS_float(X, S, C) SINCOS(X, S, C)
+#define VSINCOS_double(X, S, C) SINCOS(X, S, C)
 #define WARP_BROADCAST(VAR, SRC_LANE) barrier(CLK_LOCAL_MEM_FENCE)
 #define WARP_DECL(X) local X
 
@@ -205,6 +215,7 @@
 #elif defined(__cplusplus) || defined(_MSC_VER)
 #include <cmath>
 #endif
+#include "math/oskar_vmath.h"
 
 #define ATOMIC_ADD_CAPTURE_double(ARRAY, IDX, VAL, OLD)\
     DO_PRAGMA(omp atomic capture) { OLD = ARRAY[IDX]; ARRAY[IDX] += VAL; }
@@ -252,6 +263,10 @@
 #define RSQRT(X) (1 / sqrt(X))
 #define SINCOS(X, S, C) S = sin(X); C = cos(X)
 #define THREADFENCE_BLOCK
+#define VSINC_float(X) oskar_vsinc_f(X)
+#define VSINC_double(X) oskar_vsinc_d(X)
+#define VSINCOS_float(X, S, C) oskar_vsincos_f(X, &S, &C)
+#define VSINCOS_double(X, S, C) oskar_vsincos_d(X, &S, &C)
 
 #endif
 
@@ -268,4 +283,4 @@
 
 #endif
 
-#define OSKAR_SINC(FP, X) ( (X) == (FP)0 ? (FP)1 : (sin((FP) (X)) / (X)) )
+#define OSKAR_SINC(FP, X) VSINC(FP, X)
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_WORK_QUEUE_H_
+#define OSKAR_WORK_QUEUE_H_
+
+/**
+ * @file oskar_work_queue.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_WorkQueue;
+#ifndef OSKAR_WORK_QUEUE_TYPEDEF_
+#define OSKAR_WORK_QUEUE_TYPEDEF_
+typedef struct oskar_WorkQueue oskar_WorkQueue;
+#endif /* OSKAR_WORK_QUEUE_TYPEDEF_ */
+
+/**
+ * @brief Creates a set of work-stealing queues.
+ *
+ * @details
+ * Creates a set of work-stealing queues, one for each worker thread.
+ *
+ * Each queue holds a contiguous range of integer work item indices.
+ * The owner of a queue takes items from one end of its range, and
+ * when its own queue is empty it steals items from the other end of
+ * the queue with the most remaining items.
+ *
+ * Items are taken using atomic compare-and-swap operations,
+ * so no locks are needed.
+ *
+ * All queues are created empty.
+ *
+ * @param[in] num_queues Number of queues (worker threads) to create.
+ */
+OSKAR_EXPORT
+oskar_WorkQueue* oskar_work_queue_create(int num_queues);
+
+/**
+ * @brief Destroys the work queues.
+ *
+ * @details
+ * Destroys the work queues.
+ *
+ * @param[in,out] queue Pointer to work queues.
+ */
+OSKAR_EXPORT
+void oskar_work_queue_free(oskar_WorkQueue* queue);
+
+/**
+ * @brief Returns the number of queues in the set.
+ *
+ * @details
+ * Returns the number of queues in the set.
+ *
+ * @param[in] queue Pointer to work queues.
+ */
+OSKAR_EXPORT
+int oskar_work_queue_num_queues(const oskar_WorkQueue* queue);
+
+/**
+ * @brief Returns the number of items stolen by a queue owner.
+ *
+ * @details
+ * Returns the number of items taken by the owner of the given queue
+ * from other queues since the range was last set.
+ *
+ * @param[in] queue      Pointer to work queues.
+ * @param[in] queue_id   Index of the queue.
+ */
+OSKAR_EXPORT
+int oskar_work_queue_num_stolen(const oskar_WorkQueue* queue, int queue_id);
+
+/**
+ * @brief Sets the range of work items held by one queue.
+ *
+ * @details
+ * Sets the half-open range [\p start, \p end) of work item indices held
+ * by the given queue, and resets its statistics.
+ *
+ * This function is not thread-safe, and must only be called when no
+ * other thread is taking items from any queue in the set.
+ *
+ * @param[in,out] queue  Pointer to work queues.
+ * @param[in] queue_id   Index of the queue to set.
+ * @param[in] start      First work item index in the range.
+ * @param[in] end        One past the last work item index in the range.
+ */
+OSKAR_EXPORT
+void oskar_work_queue_set_range(oskar_WorkQueue* queue, int queue_id,
+        int start, int end);
+
+/**
+ * @brief Takes the next work item for a worker thread.
+ *
+ * @details
+ * Takes the next work item from the given queue, or steals one from
+ * another queue if the given queue is empty.
+ *
+ * If \p reverse is false, the owner takes items from the start of its
+ * range and thieves take items from the end; if true, the directions
+ * are swapped. All threads using the set of queues at the same time must
+ * use the same value of \p reverse.
+ *
+ * Returns 1 if an item was taken, or 0 if all queues are empty.
+ *
+ * @param[in,out] queue  Pointer to work queues.
+ * @param[in] queue_id   Index of the queue owned by the calling thread.
+ * @param[in] reverse    If set, reverse the direction of traversal.
+ * @param[out] item      The work item index, if one was taken.
+ */
+OSKAR_EXPORT
+int oskar_work_queue_next(oskar_WorkQueue* queue, int queue_id,
+        int reverse, int* item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_WORK_QUEUE_H_ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_cpu_isa.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int detect_isa(void)
+{
+    int isa = OSKAR_CPU_ISA_GENERIC;
+#ifdef OSKAR_HAVE_CPU_ISA_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        isa = OSKAR_CPU_ISA_SSE4;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        isa = OSKAR_CPU_ISA_AVX2;
+    if (isa == OSKAR_CPU_ISA_AVX2 && __builtin_cpu_supports("avx512f"))
+        isa = OSKAR_CPU_ISA_AVX512;
+#endif
+    return isa;
+}
+
+int oskar_cpu_isa(void)
+{
+    /* Cached value: concurrent first calls all store the same result. */
+    static volatile int isa = -1;
+    int i, requested = -1;
+    if (isa >= 0) return isa;
+
+    /* Allow the instruction set to be lowered using the environment. */
+    const int detected = detect_isa();
+    const char* env = getenv("OSKAR_CPU_ISA");
+    if (env)
+    {
+        for (i = OSKAR_CPU_ISA_GENERIC; i <= OSKAR_CPU_ISA_AVX512; ++i)
+            if (!strcmp(env, oskar_cpu_isa_string(i))) requested = i;
+    }
+    isa = (requested >= 0 && requested < detected) ? requested : detected;
+    return isa;
+}
+
+const char* oskar_cpu_isa_string(int isa)
+{
+    switch (isa)
+    {
+    case OSKAR_CPU_ISA_SSE4:   return "sse4";
+    case OSKAR_CPU_ISA_AVX2:   return "avx2";
+    case OSKAR_CPU_ISA_AVX512: return "avx512";
+    default:                   return "generic";
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, The University of Oxford
+ * Copyright (c) 2019-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,7 @@
 #include "utility/oskar_get_binary_tag_string.h"
 
 #include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
 #include "splines/oskar_splines.h"
 #include "sky/oskar_sky.h"
 #include "telescope/station/element/oskar_element.h"
@@ -224,6 +225,23 @@ const char* oskar_get_binary_tag_string(char group, char tag)
         }
         break;
     }
+    case OSKAR_TAG_GROUP_W_KERNELS:
+    {
+        switch (tag)
+        {
+        case OSKAR_IMAGER_TAG_W_KERNEL_PARAMS:
+            return "W-kernel parameters";
+        case OSKAR_IMAGER_TAG_W_SUPPORT:
+            return "W-kernel support sizes";
+        case OSKAR_IMAGER_TAG_W_KERNEL_START:
+            return "W-kernel start indices";
+        case OSKAR_IMAGER_TAG_W_KERNELS:
+            return "W-kernel data";
+        default:
+            return "Unknown W-kernel group tag";
+        }
+        break;
+    }
     default:
         break;
     }
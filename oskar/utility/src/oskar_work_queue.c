@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_work_queue.h"
+#include "utility/oskar_thread.h"
+#include <stdlib.h>
+
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define OSKAR_ATOMIC_WIN
+#elif defined(__GNUC__) || defined(__clang__)
+#define OSKAR_ATOMIC_GCC
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pad each queue to its own cache line to avoid false sharing. */
+#define CACHE_LINE_SIZE 64
+
+struct oskar_WorkQueueRange
+{
+    /* Packed range: start index in the upper 32 bits, end in the lower. */
+    volatile long long range;
+    int num_stolen, last_victim;
+    char padding[CACHE_LINE_SIZE - sizeof(long long) - 2 * sizeof(int)];
+};
+typedef struct oskar_WorkQueueRange oskar_WorkQueueRange;
+
+struct oskar_WorkQueue
+{
+    int num_queues;
+    oskar_WorkQueueRange* q;
+#if !defined(OSKAR_ATOMIC_WIN) && !defined(OSKAR_ATOMIC_GCC)
+    oskar_Mutex* mutex;
+#endif
+};
+
+static long long pack(unsigned int start, unsigned int end)
+{
+    return (long long) (((unsigned long long) start << 32) | end);
+}
+
+static long long atomic_load_range(oskar_WorkQueue* queue, int queue_id)
+{
+#if defined(OSKAR_ATOMIC_GCC)
+    (void)queue;
+    return __atomic_load_n(&queue->q[queue_id].range, __ATOMIC_ACQUIRE);
+#elif defined(OSKAR_ATOMIC_WIN)
+    return InterlockedCompareExchange64(&queue->q[queue_id].range, 0, 0);
+#else
+    long long val;
+    oskar_mutex_lock(queue->mutex);
+    val = queue->q[queue_id].range;
+    oskar_mutex_unlock(queue->mutex);
+    return val;
+#endif
+}
+
+static int atomic_cas_range(oskar_WorkQueue* queue, int queue_id,
+        long long old_val, long long new_val)
+{
+#if defined(OSKAR_ATOMIC_GCC)
+    return __atomic_compare_exchange_n(&queue->q[queue_id].range,
+            &old_val, new_val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(OSKAR_ATOMIC_WIN)
+    return InterlockedCompareExchange64(&queue->q[queue_id].range,
+            new_val, old_val) == old_val;
+#else
+    int swapped = 0;
+    oskar_mutex_lock(queue->mutex);
+    if (queue->q[queue_id].range == old_val)
+    {
+        queue->q[queue_id].range = new_val;
+        swapped = 1;
+    }
+    oskar_mutex_unlock(queue->mutex);
+    return swapped;
+#endif
+}
+
+static int remaining(long long range)
+{
+    const unsigned int start = (unsigned int) ((unsigned long long) range >> 32);
+    const unsigned int end = (unsigned int) (range & 0xFFFFFFFF);
+    return (start < end) ? (int) (end - start) : 0;
+}
+
+static int take(oskar_WorkQueue* queue, int queue_id, int from_end, int* item)
+{
+    for (;;)
+    {
+        const long long old_val = atomic_load_range(queue, queue_id);
+        unsigned int start = (unsigned int) ((unsigned long long) old_val >> 32);
+        unsigned int end = (unsigned int) (old_val & 0xFFFFFFFF);
+        if (start >= end) return 0;
+        if (from_end)
+            *item = (int) (--end);
+        else
+            *item = (int) (start++);
+        if (atomic_cas_range(queue, queue_id, old_val, pack(start, end)))
+            return 1;
+    }
+}
+
+oskar_WorkQueue* oskar_work_queue_create(int num_queues)
+{
+    int i;
+    oskar_WorkQueue* queue = 0;
+    queue = (oskar_WorkQueue*) calloc(1, sizeof(oskar_WorkQueue));
+    queue->num_queues = num_queues;
+    queue->q = (oskar_WorkQueueRange*) calloc(
+            num_queues > 0 ? num_queues : 1, sizeof(oskar_WorkQueueRange));
+    for (i = 0; i < num_queues; ++i)
+        queue->q[i].last_victim = -1;
+#if !defined(OSKAR_ATOMIC_WIN) && !defined(OSKAR_ATOMIC_GCC)
+    queue->mutex = oskar_mutex_create();
+#endif
+    return queue;
+}
+
+void oskar_work_queue_free(oskar_WorkQueue* queue)
+{
+    if (!queue) return;
+#if !defined(OSKAR_ATOMIC_WIN) && !defined(OSKAR_ATOMIC_GCC)
+    oskar_mutex_free(queue->mutex);
+#endif
+    free(queue->q);
+    free(queue);
+}
+
+int oskar_work_queue_num_queues(const oskar_WorkQueue* queue)
+{
+    return queue->num_queues;
+}
+
+int oskar_work_queue_num_stolen(const oskar_WorkQueue* queue, int queue_id)
+{
+    return queue->q[queue_id].num_stolen;
+}
+
+void oskar_work_queue_set_range(oskar_WorkQueue* queue, int queue_id,
+        int start, int end)
+{
+    if (queue_id < 0 || queue_id >= queue->num_queues) return;
+    if (start < 0) start = 0;
+    if (end < start) end = start;
+    queue->q[queue_id].range = pack((unsigned int) start, (unsigned int) end);
+    queue->q[queue_id].num_stolen = 0;
+    queue->q[queue_id].last_victim = -1;
+}
+
+int oskar_work_queue_next(oskar_WorkQueue* queue, int queue_id,
+        int reverse, int* item)
+{
+    int i;
+    if (queue_id < 0 || queue_id >= queue->num_queues) return 0;
+
+    /* Take from the owner's end of its own queue first. */
+    if (take(queue, queue_id, reverse, item)) return 1;
+
+    /* Own queue is empty, so steal from the other end of another queue.
+     * Prefer the last victim, as its next item from that end is likely
+     * to belong to the same group as the last one stolen. */
+    for (;;)
+    {
+        int victim = queue->q[queue_id].last_victim, max_remaining = 0;
+        if (victim < 0 ||
+                !remaining(atomic_load_range(queue, victim)))
+        {
+            victim = -1;
+            for (i = 0; i < queue->num_queues; ++i)
+            {
+                if (i == queue_id) continue;
+                const int r = remaining(atomic_load_range(queue, i));
+                if (r > max_remaining)
+                {
+                    max_remaining = r;
+                    victim = i;
+                }
+            }
+            if (victim < 0) return 0;
+        }
+        if (take(queue, victim, !reverse, item))
+        {
+            queue->q[queue_id].last_victim = victim;
+            queue->q[queue_id].num_stolen++;
+            return 1;
+        }
+        queue->q[queue_id].last_victim = -1;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "utility/oskar_thread.h"
+#include "utility/oskar_work_queue.h"
+#include <cstdlib>
+#include <vector>
+
+struct QueueThreadArgs
+{
+    int thread_id, reverse;
+    int* counts;
+    oskar_WorkQueue* queue;
+};
+typedef struct QueueThreadArgs QueueThreadArgs;
+
+static void* thread_take_items(void* arg)
+{
+    QueueThreadArgs* args = (QueueThreadArgs*) arg;
+    int item = 0;
+    while (oskar_work_queue_next(args->queue, args->thread_id,
+            args->reverse, &item))
+    {
+        // Each item must be taken by exactly one thread.
+        args->counts[item]++;
+    }
+    return 0;
+}
+
+TEST(work_queue, owner_order)
+{
+    oskar_WorkQueue* queue = oskar_work_queue_create(2);
+    oskar_work_queue_set_range(queue, 0, 0, 4);
+    oskar_work_queue_set_range(queue, 1, 4, 8);
+    int item = -1;
+
+    // Owner takes from the start of its own range.
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 0, 0, &item));
+    EXPECT_EQ(0, item);
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 0, 0, &item));
+    EXPECT_EQ(1, item);
+
+    // Owner takes from the end of its own range if reversed.
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 1, 1, &item));
+    EXPECT_EQ(7, item);
+
+    // Empty queue 0, then steal from the start of queue 1 (reversed).
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 0, 1, &item));
+    EXPECT_EQ(3, item);
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 0, 1, &item));
+    EXPECT_EQ(2, item);
+    ASSERT_EQ(1, oskar_work_queue_next(queue, 0, 1, &item));
+    EXPECT_EQ(4, item);
+    EXPECT_EQ(1, oskar_work_queue_num_stolen(queue, 0));
+    EXPECT_EQ(0, oskar_work_queue_num_stolen(queue, 1));
+
+    // Drain the rest.
+    int n = 0;
+    while (oskar_work_queue_next(queue, 1, 1, &item)) n++;
+    EXPECT_EQ(2, n);
+    EXPECT_EQ(0, oskar_work_queue_next(queue, 0, 0, &item));
+    oskar_work_queue_free(queue);
+}
+
+TEST(work_queue, concurrent_stealing)
+{
+    const int num_threads = 8, num_items = 100000;
+    std::vector<int> counts(num_items, 0);
+    oskar_WorkQueue* queue = oskar_work_queue_create(num_threads);
+    std::vector<QueueThreadArgs> args(num_threads);
+    std::vector<oskar_Thread*> threads(num_threads);
+
+    for (int reverse = 0; reverse < 2; ++reverse)
+    {
+        // Give all the work to the first two queues, so others must steal.
+        for (int i = 0; i < num_items; ++i) counts[i] = 0;
+        oskar_work_queue_set_range(queue, 0, 0, num_items / 4);
+        oskar_work_queue_set_range(queue, 1, num_items / 4, num_items);
+        for (int i = 0; i < num_threads; ++i)
+        {
+            args[i].thread_id = i;
+            args[i].reverse = reverse;
+            args[i].counts = &counts[0];
+            args[i].queue = queue;
+            threads[i] = oskar_thread_create(thread_take_items,
+                    (void*)(&args[i]), 0);
+        }
+        for (int i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        for (int i = 0; i < num_items; ++i)
+            ASSERT_EQ(1, counts[i]) << "Item " << i;
+    }
+    oskar_work_queue_free(queue);
+}
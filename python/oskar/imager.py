@@ -199,7 +199,8 @@ class Imager(object):
     @property
     def algorithm(self):
         """Returns or sets the algorithm used by the imager.
-        Currently one of 'FFT', 'DFT 2D', 'DFT 3D' or 'W-projection'.
+        Currently one of 'FFT', 'DFT 2D', 'DFT 3D', 'W-projection'
+        or 'W-stacking'.
 
         The default is 'FFT', which corresponds to basic but quick 2D gridding,
         ignoring baseline w-components.
@@ -219,6 +220,12 @@ class Imager(object):
         of image you are making, as an extra copy of the grid
         will be made by the FFT library.
 
+        'W-stacking' also corrects for non-coplanar baselines, by gridding
+        visibilities into a stack of W-layers and applying the W-phase
+        screen to each layer after its FFT. It runs only on the CPU, and
+        needs no W-kernels, so it can be faster and more accurate than
+        W-projection when the W-range is large.
+
         Type
             str
         """
@@ -451,7 +458,8 @@ class Imager(object):
     @property
     def num_w_planes(self):
         """Returns or sets the number of W-projection planes to use,
-        if using W-projection.
+        if using W-projection, or the number of W-layers to use,
+        if using W-stacking.
 
         A number less than or equal to zero means 'automatic'.
 
@@ -612,6 +620,24 @@ class Imager(object):
     def uv_filter_min(self, value):
         self.set_uv_filter_min(value)
 
+    @property
+    def w_kernel_cache_dir(self):
+        """Returns or sets the directory used to cache W-projection kernels.
+
+        If set, W-kernels are saved to this directory when they are
+        generated, and loaded from it by later runs that use the same
+        imaging parameters. The default is None (no cache).
+
+        Type
+            str
+        """
+        self.capsule_ensure()
+        return _imager_lib.w_kernel_cache_dir(self._capsule)
+
+    @w_kernel_cache_dir.setter
+    def w_kernel_cache_dir(self, value):
+        self.set_w_kernel_cache_dir(value)
+
     @property
     def weighting(self):
         """Returns or sets the type of visibility weighting to use.
@@ -824,7 +850,8 @@ class Imager(object):
             return _imager_lib.run(self._capsule, return_images, return_grids)
         else:
             self.reset_cache()
-            if self.weighting == 'Uniform' or self.algorithm == 'W-projection':
+            if self.weighting == 'Uniform' or \
+                    self.algorithm in ('W-projection', 'W-stacking'):
                 self.set_coords_only(True)
                 self.update(uu, vv, ww, amps, weight, time_centroid,
                             start_channel, end_channel, num_pols)
@@ -845,8 +872,8 @@ class Imager(object):
         """Sets the algorithm used by the imager.
 
         Args:
-            algorithm_type (str): Either 'FFT', 'DFT 2D', 'DFT 3D' or
-                'W-projection'.
+            algorithm_type (str): Either 'FFT', 'DFT 2D', 'DFT 3D',
+                'W-projection' or 'W-stacking'.
         """
         self.capsule_ensure()
         _imager_lib.set_algorithm(self._capsule, algorithm_type)
@@ -1023,7 +1050,8 @@ class Imager(object):
         _imager_lib.set_ms_column(self._capsule, column)
 
     def set_num_w_planes(self, num_planes):
-        """Sets the number of W-planes to use, if using W-projection.
+        """Sets the number of W-planes to use, if using W-projection,
+        or the number of W-layers to use, if using W-stacking.
 
         A number less than or equal to zero means 'automatic'.
 
@@ -1133,6 +1161,15 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.set_vis_phase_centre(self._capsule, ra_deg, dec_deg)
 
+    def set_w_kernel_cache_dir(self, dir_path):
+        """Sets the directory used to cache W-projection kernels.
+
+        Args:
+            dir_path (str): Path of the cache directory.
+        """
+        self.capsule_ensure()
+        _imager_lib.set_w_kernel_cache_dir(self._capsule, dir_path)
+
     def set_weighting(self, weighting):
         """Sets the type of visibility weighting to use.
 
@@ -1431,7 +1468,8 @@ class Imager(object):
             weighting (Optional[str]):
                 Either 'Natural', 'Radial' or 'Uniform'.
             algorithm (Optional[str]):
-                Algorithm type: 'FFT', 'DFT 2D', 'DFT 3D' or 'W-projection'.
+                Algorithm type: 'FFT', 'DFT 2D', 'DFT 3D', 'W-projection'
+                or 'W-stacking'.
             weight (Optional[float, array-like, shape (n,)]):
                 Visibility weights.
             wprojplanes (Optional[int]):
@@ -1,6 +1,6 @@
 # -*- coding: utf-8 -*-
 #
-# Copyright (c) 2016-2017, The University of Oxford
+# Copyright (c) 2016-2020, The University of Oxford
 # All rights reserved.
 #
 #  Redistribution and use in source and binary forms, with or without
@@ -91,10 +91,11 @@ class ImagingInterferometer(Interferometer):
         self._return_images = return_images
         self._return_grids = return_grids
 
-        # Iterate imagers to find any with uniform weighting or W-projection.
+        # Iterate imagers to find any with uniform weighting or W-correction.
         need_coords_first = False
         for im in self._imagers:
-            if im.weighting == 'Uniform' or im.algorithm == 'W-projection':
+            if im.weighting == 'Uniform' or \
+                    im.algorithm in ('W-projection', 'W-stacking'):
                 need_coords_first = True
 
         # Simulate coordinates first, if required.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -1162,6 +1162,18 @@ static PyObject* set_vis_phase_centre(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* set_w_kernel_cache_dir(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    const char* dir_path = 0;
+    if (!PyArg_ParseTuple(args, "Os", &capsule, &dir_path)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    oskar_imager_set_w_kernel_cache_dir(h, dir_path);
+    return Py_BuildValue("");
+}
+
+
 static PyObject* set_weighting(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1593,6 +1605,16 @@ static PyObject* uv_filter_min(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* w_kernel_cache_dir(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("s", oskar_imager_w_kernel_cache_dir(h));
+}
+
+
 static PyObject* weighting(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1888,6 +1910,8 @@ static PyMethodDef methods[] =
                 "set_vis_frequency(ref_hz, inc_hz, num_channels)"},
         {"set_vis_phase_centre", (PyCFunction)set_vis_phase_centre,
                 METH_VARARGS, "set_vis_phase_centre(ra_deg, dec_deg)"},
+        {"set_w_kernel_cache_dir", (PyCFunction)set_w_kernel_cache_dir,
+                METH_VARARGS, "set_w_kernel_cache_dir(dir_path)"},
         {"set_weighting", (PyCFunction)set_weighting,
                 METH_VARARGS, "set_weighting(type)"},
         {"size", (PyCFunction)size, METH_VARARGS, "size()"},
@@ -1906,6 +1930,8 @@ static PyMethodDef methods[] =
                 METH_VARARGS, "uv_filter_max()"},
         {"uv_filter_min", (PyCFunction)uv_filter_min,
                 METH_VARARGS, "uv_filter_min()"},
+        {"w_kernel_cache_dir", (PyCFunction)w_kernel_cache_dir,
+                METH_VARARGS, "w_kernel_cache_dir()"},
         {"weighting", (PyCFunction)weighting, METH_VARARGS, "weighting()"},
         {NULL, NULL, 0, NULL}
 };